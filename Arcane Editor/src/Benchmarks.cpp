@@ -0,0 +1,886 @@
+#include "arcpch.h"
+#include "Benchmarks.h"
+
+#include <Arcane/Core/Threads/ThreadSafeQueue.h>
+#include <Arcane/Core/Threads/LockFreeQueue.h>
+#include <Arcane/Core/Threads/JobSystem.h>
+#include <Arcane/Graphics/Texture/TextureCompressor.h>
+#include <Arcane/Graphics/Camera/Frustum.h>
+#include <Arcane/Scene/BVH.h>
+#include <Arcane/Animation/AnimationClip.h>
+#include <Arcane/Animation/PoseAnimator.h>
+#include <Arcane/Animation/AnimationSystem.h>
+#include <Arcane/Animation/AnimationBlendTree.h>
+#include <Arcane/Core/Application.h>
+#include <Arcane/Scene/Scene.h>
+#include <Arcane/Scene/Entity.h>
+#include <Arcane/Scene/Components.h>
+#include <Arcane/Graphics/Renderer/Renderpass/ShadowmapPass.h>
+#include <Arcane/Graphics/Renderer/Renderpass/Deferred/DeferredGeometryPass.h>
+#include <Arcane/Graphics/Renderer/Renderpass/Deferred/DeferredLightingPass.h>
+#include <Arcane/Graphics/Renderer/Renderer.h>
+#include <Arcane/Util/Loaders/AssetManager.h>
+
+#include <chrono>
+#include <functional>
+#include <thread>
+
+using namespace Arcane;
+
+namespace
+{
+	// Splits the threads evenly between producers and consumers (always at least one of each) and pushes itemsPerProducer through the queue per producer. Returns millions of items per second
+	template<typename Queue>
+	double MeasureQueueThroughput(Queue &queue, int threadCount, int itemsPerProducer, size_t batchSize)
+	{
+		int producerCount = glm::max(1, threadCount / 2);
+		int consumerCount = glm::max(1, threadCount - producerCount);
+		u64 totalItems = (u64)producerCount * (u64)itemsPerProducer;
+
+		std::atomic<bool> start = false;
+		std::atomic<u64> consumedCount = 0;
+		std::vector<std::thread> threads;
+		threads.reserve(producerCount + consumerCount);
+
+		for (int p = 0; p < producerCount; p++)
+		{
+			threads.emplace_back([&queue, &start, itemsPerProducer, batchSize]()
+			{
+				std::vector<u64> batch(batchSize);
+				while (!start) std::this_thread::yield();
+
+				int pushed = 0;
+				while (pushed < itemsPerProducer)
+				{
+					if (batchSize > 1)
+					{
+						size_t count = glm::min(batchSize, (size_t)(itemsPerProducer - pushed));
+						for (size_t i = 0; i < count; i++)
+							batch[i] = (u64)(pushed + i);
+
+						size_t offset = 0;
+						while (offset < count)
+						{
+							size_t batchPushed = queue.PushBatch(&batch[offset], count - offset);
+							if (batchPushed == 0)
+								std::this_thread::yield();
+							offset += batchPushed;
+						}
+						pushed += (int)count;
+					}
+					else
+					{
+						queue.Push((u64)pushed++);
+					}
+				}
+			});
+		}
+
+		for (int c = 0; c < consumerCount; c++)
+		{
+			threads.emplace_back([&queue, &start, &consumedCount, totalItems, batchSize]()
+			{
+				std::vector<u64> batch(batchSize);
+				while (!start) std::this_thread::yield();
+
+				while (consumedCount.load(std::memory_order_relaxed) < totalItems)
+				{
+					size_t popped = 0;
+					if (batchSize > 1)
+					{
+						popped = queue.TryPopBatch(&batch[0], batchSize);
+					}
+					else
+					{
+						u64 val;
+						popped = queue.TryPop(val) ? 1 : 0;
+					}
+
+					if (popped > 0)
+						consumedCount.fetch_add(popped, std::memory_order_relaxed);
+					else
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		start = true;
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		return ((double)totalItems / seconds) / 1000000.0;
+	}
+
+	// Synthetic mocap clip: a spine with limbs branching off of it, every joint animated and deforming the mesh
+	std::unique_ptr<AnimationClip> CreateBenchmarkClip(int jointCount, int keyCount, float ticksPerSecond, std::mt19937 &rng)
+	{
+		std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+		Skeleton skeleton;
+		for (int i = 0; i < jointCount; i++)
+		{
+			int parentIndex = i == 0 ? -1 : (i < 10 ? i - 1 : (i % 10 == 0 ? static_cast<int>(rng() % 10) : i - 1));
+			glm::mat4 bindTransform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.1f, 0.0f));
+			skeleton.AddJoint("Joint" + std::to_string(i), parentIndex, bindTransform, i, glm::inverse(bindTransform));
+		}
+
+		std::vector<AnimationTrackData> tracks(jointCount);
+		for (int i = 0; i < jointCount; i++)
+		{
+			AnimationTrackData &track = tracks[i];
+			track.JointName = "Joint" + std::to_string(i);
+			glm::vec3 axis = glm::normalize(glm::vec3(unitDistribution(rng), unitDistribution(rng), unitDistribution(rng)));
+			for (int key = 0; key < keyCount; key++)
+			{
+				float time = static_cast<float>(key);
+				track.Positions.push_back(KeyPosition{ glm::vec3(0.0f, 0.1f, 0.0f) + 0.01f * glm::vec3(unitDistribution(rng), unitDistribution(rng), unitDistribution(rng)), time });
+				track.Rotations.push_back(KeyRotation{ glm::angleAxis(glm::sin(time * 0.1f), axis), time });
+			}
+			track.Scales.push_back(KeyScale{ glm::vec3(1.0f), 0.0f });
+		}
+		return std::make_unique<AnimationClip>(std::move(skeleton), tracks, static_cast<float>(keyCount - 1), ticksPerSecond);
+	}
+
+	// Average GPU time of the work in milliseconds, waits on the result so only use it outside of a frame
+	double MeasureGPUTime(const std::function<void()> &work, int iterations)
+	{
+		GLuint query;
+		glGenQueries(1, &query);
+
+		work(); // Warm up, the first run can include uploads and shader compiles
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		for (int i = 0; i < iterations; i++)
+		{
+			work();
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 elapsedNanoseconds = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNanoseconds);
+		glDeleteQueries(1, &query);
+		return static_cast<double>(elapsedNanoseconds) / 1000000.0 / iterations;
+	}
+
+	// CPU time of the work in milliseconds. It runs as a frame of its own since the renderer only publishes its counters (draw calls etc) at the end of a frame
+	double MeasureFrameCPUTime(const std::function<void()> &work)
+	{
+		Renderer::BeginFrame();
+		auto begin = std::chrono::steady_clock::now();
+		work();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		Renderer::EndFrame();
+		return ms;
+	}
+
+	// Lights a benchmark adds on top of the scene that is already loaded, along with the shadow caching toggle the benchmark is free to change. The scene has no
+	// way to destroy entities, so when this goes away the lights are left behind as empty entities and the toggle is put back
+	class BenchmarkLights
+	{
+	public:
+		BenchmarkLights(Scene *scene) : m_Scene(scene), m_ShadowCachingEnabled(Renderer::GetShadowCachingEnabled()) {}
+		~BenchmarkLights()
+		{
+			for (Entity &light : m_Lights)
+			{
+				light.RemoveComponent<LightComponent>();
+			}
+			m_Scene->GetLightManager()->Update();
+			Renderer::SetShadowCachingEnabled(m_ShadowCachingEnabled);
+		}
+
+		// Adding another light can move the components around, so the returned component is only good until the next one is added
+		LightComponent& Add(const std::string &name, LightType type, const glm::vec3 &translation, const glm::vec3 &rotation = glm::vec3(0.0f))
+		{
+			Entity light = m_Scene->CreateEntity(name);
+			TransformComponent &transformComponent = light.GetComponent<TransformComponent>();
+			transformComponent.Translation = translation;
+			transformComponent.Rotation = rotation;
+			m_Lights.push_back(light);
+
+			LightComponent &lightComponent = light.AddComponent<LightComponent>();
+			lightComponent.Type = type;
+			return lightComponent;
+		}
+
+		LightComponent& AddShadowCaster(const std::string &name, LightType type, ShadowQuality resolution, const glm::vec3 &translation, const glm::vec3 &rotation = glm::vec3(0.0f))
+		{
+			LightComponent &lightComponent = Add(name, type, translation, rotation);
+			lightComponent.CastShadows = true;
+			lightComponent.ShadowResolution = resolution;
+			return lightComponent;
+		}
+
+		inline size_t GetCount() const { return m_Lights.size(); }
+	private:
+		Scene *m_Scene;
+		std::vector<Entity> m_Lights;
+		bool m_ShadowCachingEnabled;
+	};
+}
+
+void Benchmarks::RunQueueBenchmark()
+{
+	const int itemsPerProducer = 200000;
+	const size_t batchSize = 32;
+	const size_t capacity = 4096;
+
+	ARC_LOG_INFO("Queue Benchmark - {0} items per producer, throughput in millions of items/sec", itemsPerProducer);
+	ARC_LOG_INFO("{0:>8} | {1:>12} | {2:>12} | {3:>12} | {4:>12}", "Threads", "Mutex", "Mutex Batch", "MPMC", "MPMC Batch");
+	for (int threadCount = 1; threadCount <= 32; threadCount *= 2)
+	{
+		ThreadSafeQueue<u64> mutexQueue, mutexBatchQueue;
+		LockFreeQueue<u64> mpmcQueue(capacity), mpmcBatchQueue(capacity);
+
+		double mutexResult = MeasureQueueThroughput(mutexQueue, threadCount, itemsPerProducer, 1);
+		double mutexBatchResult = MeasureQueueThroughput(mutexBatchQueue, threadCount, itemsPerProducer, batchSize);
+		double mpmcResult = MeasureQueueThroughput(mpmcQueue, threadCount, itemsPerProducer, 1);
+		double mpmcBatchResult = MeasureQueueThroughput(mpmcBatchQueue, threadCount, itemsPerProducer, batchSize);
+
+		ARC_LOG_INFO("{0:>8} | {1:>12.2f} | {2:>12.2f} | {3:>12.2f} | {4:>12.2f}", threadCount, mutexResult, mutexBatchResult, mpmcResult, mpmcBatchResult);
+	}
+
+	// The SPSC specialization only supports a single producer and consumer
+	SPSCQueue<u64> spscQueue(capacity), spscBatchQueue(capacity);
+	double spscResult = MeasureQueueThroughput(spscQueue, 2, itemsPerProducer, 1);
+	double spscBatchResult = MeasureQueueThroughput(spscBatchQueue, 2, itemsPerProducer, batchSize);
+	ARC_LOG_INFO("SPSC (1 producer, 1 consumer): {0:.2f} - Batched: {1:.2f}", spscResult, spscBatchResult);
+}
+
+void Benchmarks::RunTextureCompressionBenchmark()
+{
+	const int size = 2048;
+	const int iterations = 3;
+
+	// Smooth gradients with noisy tiles and a varying alpha, so the encoders see both easy and hard blocks
+	std::vector<unsigned char> pixels(size * size * 4);
+	u32 noiseState = 12345;
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			noiseState = noiseState * 1664525u + 1013904223u;
+			unsigned char noise = ((x / 64 + y / 64) & 1) ? static_cast<unsigned char>(noiseState >> 27) : 0;
+
+			unsigned char *texel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+			texel[0] = static_cast<unsigned char>((x * 255) / size) + noise;
+			texel[1] = static_cast<unsigned char>((y * 255) / size);
+			texel[2] = static_cast<unsigned char>(((x ^ y) >> 3) & 0xFF);
+			texel[3] = static_cast<unsigned char>(128.0f + 127.0f * glm::sin(x * 0.01f));
+		}
+	}
+
+	ARC_LOG_INFO("Texture Compression Benchmark - {0}x{0} (mip 0 only), throughput in millions of texels/sec, {1} workers", size, JobSystem::GetInstance().GetWorkerCount());
+	ARC_LOG_INFO("{0:>6} | {1:>14} | {2:>14} | {3:>8}", "Format", "Single Thread", "Job System", "Speedup");
+
+	const TextureCompression formats[] = { TextureCompression::BC1, TextureCompression::BC3, TextureCompression::BC4, TextureCompression::BC5, TextureCompression::BC7 };
+	for (TextureCompression format : formats)
+	{
+		CompressedImageInfo info = { size, size, 1, format, false };
+		std::vector<unsigned char> compressed(TextureCompressor::GetCompressedSize(info));
+
+		double results[2];
+		for (int multithreaded = 0; multithreaded < 2; multithreaded++)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				TextureCompressor::Compress(pixels.data(), size, size, 4, info, compressed.data(), multithreaded != 0);
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			results[multithreaded] = ((double)size * size * iterations / seconds) / 1000000.0;
+		}
+
+		ARC_LOG_INFO("{0:>6} | {1:>14.2f} | {2:>14.2f} | {3:>7.2f}x", TextureCompressor::GetFormatName(format), results[0], results[1], results[1] / results[0]);
+	}
+}
+
+void Benchmarks::RunBVHBenchmark()
+{
+	const int entityCount = 100000;
+	const int queryCount = 1000;
+	const float worldSize = 2000.0f;
+
+	// Props scattered over a large flat-ish world, like a big level with a lot of static clutter
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> positionDistribution(-worldSize * 0.5f, worldSize * 0.5f);
+	std::uniform_real_distribution<float> heightDistribution(0.0f, 50.0f);
+	std::uniform_real_distribution<float> sizeDistribution(0.25f, 4.0f);
+	std::vector<AABB> bounds(entityCount);
+	std::vector<u32> userData(entityCount);
+	for (int i = 0; i < entityCount; i++)
+	{
+		glm::vec3 center(positionDistribution(rng), heightDistribution(rng), positionDistribution(rng));
+		glm::vec3 extents(sizeDistribution(rng), sizeDistribution(rng), sizeDistribution(rng));
+		bounds[i] = AABB(center - extents, center + extents);
+		userData[i] = static_cast<u32>(i);
+	}
+
+	ARC_LOG_INFO("BVH Benchmark - {0} entities, {1} queries of each type", entityCount, queryCount);
+
+	// Build
+	BVH staticBVH;
+	auto begin = std::chrono::steady_clock::now();
+	staticBVH.Build(bounds, userData);
+	double sahBuildMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	BVH dynamicBVH(0.5f);
+	std::vector<int> proxies(entityCount);
+	begin = std::chrono::steady_clock::now();
+	for (int i = 0; i < entityCount; i++)
+	{
+		proxies[i] = dynamicBVH.Insert(bounds[i], userData[i]);
+	}
+	double insertBuildMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	BVHStats sahStats = staticBVH.GetStats(), insertStats = dynamicBVH.GetStats();
+	ARC_LOG_INFO("SAH Build: {0:.2f}ms (height {1}, SAH cost {2:.1f}) - Incremental Inserts: {3:.2f}ms (height {4}, SAH cost {5:.1f})",
+		sahBuildMS, sahStats.Height, sahStats.SAHCost, insertBuildMS, insertStats.Height, insertStats.SAHCost);
+
+	// Refit, every entity moves a little each frame and occasionally far enough to get reinserted
+	const int refitFrames = 10;
+	std::uniform_real_distribution<float> moveDistribution(-1.0f, 1.0f);
+	double refitMS = 0.0;
+	for (int frame = 0; frame < refitFrames; frame++)
+	{
+		for (int i = 0; i < entityCount; i++)
+		{
+			glm::vec3 movement(moveDistribution(rng), 0.0f, moveDistribution(rng));
+			bounds[i].Min += movement;
+			bounds[i].Max += movement;
+		}
+
+		begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < entityCount; i++)
+		{
+			dynamicBVH.Update(proxies[i], bounds[i]);
+		}
+		refitMS += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+	insertStats = dynamicBVH.GetStats();
+	ARC_LOG_INFO("Refit: {0:.2f}ms per frame with every entity moving (height {1}, SAH cost {2:.1f} afterwards)", refitMS / refitFrames, insertStats.Height, insertStats.SAHCost);
+	staticBVH.Build(bounds, userData);
+
+	// Queries, each one is compared against a linear scan over the same bounds
+	std::vector<Frustum> frustums(queryCount);
+	std::vector<glm::vec3> points(queryCount), directions(queryCount);
+	for (int i = 0; i < queryCount; i++)
+	{
+		points[i] = glm::vec3(positionDistribution(rng), 10.0f, positionDistribution(rng));
+		directions[i] = glm::normalize(glm::vec3(moveDistribution(rng), moveDistribution(rng) * 0.1f, moveDistribution(rng)));
+		glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, DEFAULT_NEAR_PLANE, 250.0f);
+		frustums[i] = Frustum(projection * glm::lookAt(points[i], points[i] + directions[i], glm::vec3(0.0f, 1.0f, 0.0f)));
+	}
+
+	auto measure = [queryCount](const std::function<size_t(int)> &query, size_t &outResultCount)
+	{
+		outResultCount = 0;
+		auto queryBegin = std::chrono::steady_clock::now();
+		for (int i = 0; i < queryCount; i++)
+		{
+			outResultCount += query(i);
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - queryBegin).count();
+		return static_cast<double>(queryCount) / seconds;
+	};
+
+	std::vector<u32> inside, intersecting;
+	size_t bvhResults, linearResults;
+	ARC_LOG_INFO("{0:>8} | {1:>16} | {2:>16} | {3:>8} | {4:>12}", "Query", "BVH (queries/s)", "Linear (queries/s)", "Speedup", "Avg Results");
+
+	double bvhRate = measure([&](int i) { inside.clear(); intersecting.clear(); staticBVH.QueryFrustum(frustums[i], inside, intersecting); return inside.size() + intersecting.size(); }, bvhResults);
+	double linearRate = measure([&](int i)
+	{
+		size_t count = 0;
+		for (const AABB &aabb : bounds)
+			count += frustums[i].IntersectsAABB(aabb.Min, aabb.Max) ? 1 : 0;
+		return count;
+	}, linearResults);
+	ARC_LOG_INFO("{0:>8} | {1:>16.0f} | {2:>16.0f} | {3:>7.1f}x | {4:>12.1f}", "Frustum", bvhRate, linearRate, bvhRate / linearRate, (double)bvhResults / queryCount);
+
+	const float sphereRadius = 25.0f;
+	bvhRate = measure([&](int i) { intersecting.clear(); staticBVH.QuerySphere(points[i], sphereRadius, intersecting); return intersecting.size(); }, bvhResults);
+	linearRate = measure([&](int i)
+	{
+		size_t count = 0;
+		for (const AABB &aabb : bounds)
+			count += glm::length2(glm::clamp(points[i], aabb.Min, aabb.Max) - points[i]) <= sphereRadius * sphereRadius ? 1 : 0;
+		return count;
+	}, linearResults);
+	ARC_LOG_INFO("{0:>8} | {1:>16.0f} | {2:>16.0f} | {3:>7.1f}x | {4:>12.1f}", "Sphere", bvhRate, linearRate, bvhRate / linearRate, (double)bvhResults / queryCount);
+
+	const glm::vec3 boxExtents(20.0f);
+	bvhRate = measure([&](int i) { intersecting.clear(); staticBVH.QueryAABB(AABB(points[i] - boxExtents, points[i] + boxExtents), intersecting); return intersecting.size(); }, bvhResults);
+	linearRate = measure([&](int i)
+	{
+		AABB queryBounds(points[i] - boxExtents, points[i] + boxExtents);
+		size_t count = 0;
+		for (const AABB &aabb : bounds)
+			count += queryBounds.Intersects(aabb) ? 1 : 0;
+		return count;
+	}, linearResults);
+	ARC_LOG_INFO("{0:>8} | {1:>16.0f} | {2:>16.0f} | {3:>7.1f}x | {4:>12.1f}", "AABB", bvhRate, linearRate, bvhRate / linearRate, (double)bvhResults / queryCount);
+
+	bvhRate = measure([&](int i) { BVHRayHit hit; return staticBVH.Raycast(points[i], directions[i], worldSize, hit) ? size_t(1) : size_t(0); }, bvhResults);
+	linearRate = measure([&](int i)
+	{
+		glm::vec3 inverseDirection = 1.0f / directions[i];
+		float closest = worldSize;
+		bool hit = false;
+		for (const AABB &aabb : bounds)
+		{
+			glm::vec3 t1 = (aabb.Min - points[i]) * inverseDirection, t2 = (aabb.Max - points[i]) * inverseDirection;
+			glm::vec3 tNear = glm::min(t1, t2), tFar = glm::max(t1, t2);
+			float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+			float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, closest));
+			if (enter <= exit)
+			{
+				closest = enter;
+				hit = true;
+			}
+		}
+		return hit ? size_t(1) : size_t(0);
+	}, linearResults);
+	ARC_LOG_INFO("{0:>8} | {1:>16.0f} | {2:>16.0f} | {3:>7.1f}x | {4:>12.1f}", "Ray", bvhRate, linearRate, bvhRate / linearRate, (double)bvhResults / queryCount);
+}
+
+void Benchmarks::RunAnimationBenchmark()
+{
+	const int characterCount = 1000;
+	const int jointCount = 60;
+	const int keyCount = 300; // 10 seconds of 30fps mocap
+	const float ticksPerSecond = 30.0f;
+	const int frameCount = 100;
+
+	std::mt19937 rng(1234);
+	std::unique_ptr<AnimationClip> clip = CreateBenchmarkClip(jointCount, keyCount, ticksPerSecond, rng);
+
+	// Characters start at different points in the clip so they don't all read the same keys
+	std::uniform_real_distribution<float> offsetDistribution(0.0f, keyCount / ticksPerSecond);
+	std::vector<PoseAnimator> animators(characterCount);
+	for (PoseAnimator &animator : animators)
+	{
+		animator.SetAnimationClip(clip.get());
+		animator.UpdateAnimation(offsetDistribution(rng));
+	}
+
+	ARC_LOG_INFO("Animation Benchmark - {0} characters, {1} joints, {2} keys per track, single thread", characterCount, jointCount, keyCount);
+	auto measure = [&](float deltaTime)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			for (PoseAnimator &animator : animators)
+			{
+				animator.UpdateAnimation(deltaTime);
+			}
+		}
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / frameCount;
+	};
+
+	// Playing forward reuses the cached keys, big jumps through the clip have to binary search every track
+	double playbackMS = measure(1.0f / 60.0f);
+	double seekMS = measure(3.7f);
+	ARC_LOG_INFO("Playback: {0:.3f}ms per frame ({1:.1f}ns per joint) - Seeking: {2:.3f}ms per frame", playbackMS, playbackMS * 1000000.0 / (characterCount * jointCount), seekMS);
+}
+
+void Benchmarks::RunAnimationCrowdBenchmark()
+{
+	const int characterCount = 4000;
+	const int jointCount = 60;
+	const int keyCount = 300;
+	const float ticksPerSecond = 30.0f;
+	const int frameCount = 50;
+	const float deltaTime = 1.0f / 60.0f;
+
+	std::mt19937 rng(1234);
+	std::unique_ptr<AnimationClip> clip = CreateBenchmarkClip(jointCount, keyCount, ticksPerSecond, rng);
+
+	// Two identical crowds, one is only ever updated deterministically so the parallel results can be checked against it
+	std::uniform_real_distribution<float> offsetDistribution(0.0f, keyCount / ticksPerSecond);
+	std::vector<PoseAnimator> crowd(characterCount), referenceCrowd(characterCount);
+	std::vector<PoseAnimator*> animators(characterCount), referenceAnimators(characterCount);
+	for (int i = 0; i < characterCount; i++)
+	{
+		float offset = offsetDistribution(rng);
+		crowd[i].SetAnimationClip(clip.get());
+		crowd[i].UpdateAnimation(offset);
+		referenceCrowd[i].SetAnimationClip(clip.get());
+		referenceCrowd[i].UpdateAnimation(offset);
+		animators[i] = &crowd[i];
+		referenceAnimators[i] = &referenceCrowd[i];
+	}
+
+	AnimationSystem animationSystem, referenceSystem;
+	referenceSystem.SetDeterministic(true);
+	auto measure = [&](u32 maxJobCount)
+	{
+		animationSystem.SetMaxJobCount(maxJobCount);
+		auto begin = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			animationSystem.Update(animators.data(), animators.size(), deltaTime);
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / frameCount;
+
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			referenceSystem.Update(referenceAnimators.data(), referenceAnimators.size(), deltaTime);
+		}
+		return ms;
+	};
+
+	// A job per core at most, the thread waiting at the sync point helps out so it counts as one
+	unsigned int coreCount = JobSystem::GetInstance().GetWorkerCount() + 1;
+	ARC_LOG_INFO("Animation Crowd Benchmark - {0} characters, {1} joints, {2} animators per job, {3} cores available", characterCount, jointCount, ANIMATION_ANIMATORS_PER_JOB, coreCount);
+	ARC_LOG_INFO("{0:>6} | {1:>10} | {2:>8} | {3:>10}", "Cores", "ms/frame", "Speedup", "Efficiency");
+	double singleCoreMS = 0.0;
+	for (unsigned int cores = 1; ; cores = glm::min(cores * 2, coreCount))
+	{
+		double ms = measure(cores);
+		if (cores == 1)
+			singleCoreMS = ms;
+		ARC_LOG_INFO("{0:>6} | {1:>10.3f} | {2:>7.2f}x | {3:>9.0f}%", cores, ms, singleCoreMS / ms, 100.0 * singleCoreMS / (ms * cores));
+		if (cores == coreCount)
+			break;
+	}
+
+	// Every animator only writes its own palette, so the results have to be bit for bit the same no matter how the chunks were scheduled
+	bool matches = true;
+	for (int i = 0; i < characterCount; i++)
+	{
+		const std::vector<glm::mat4> &palette = crowd[i].GetFinalBoneMatrices(), &referencePalette = referenceCrowd[i].GetFinalBoneMatrices();
+		matches &= memcmp(palette.data(), referencePalette.data(), palette.size() * sizeof(glm::mat4)) == 0;
+	}
+	ARC_LOG_INFO("Parallel bone palettes {0} the deterministic update", matches ? "match" : "DO NOT match");
+}
+
+void Benchmarks::RunAnimationBlendingBenchmark()
+{
+	const int characterCount = 1000;
+	const int jointCount = 60;
+	const int keyCount = 300;
+	const float ticksPerSecond = 30.0f;
+	const int frameCount = 100;
+	const float deltaTime = 1.0f / 60.0f;
+
+	// A 2D locomotion blend space (idle in the middle, a clip for each direction) with a masked additive layer on top of the spine and its children
+	std::mt19937 rng(1234);
+	std::vector<std::unique_ptr<AnimationClip>> clips;
+	for (int i = 0; i < 6; i++)
+	{
+		// Same seed so every clip is made for the same skeleton, the lengths differ so the blend space has to keep them in sync
+		std::mt19937 clipRng(1234);
+		clips.push_back(CreateBenchmarkClip(jointCount, keyCount - i * 20, ticksPerSecond, clipRng));
+	}
+
+	AnimationBlendTree locomotion;
+	u32 moveX = locomotion.AddParameter("MoveX"), moveY = locomotion.AddParameter("MoveY");
+	const glm::vec2 positions[5] = { glm::vec2(0.0f), glm::vec2(0.0f, 1.0f), glm::vec2(0.0f, -1.0f), glm::vec2(-1.0f, 0.0f), glm::vec2(1.0f, 0.0f) };
+	std::vector<std::pair<u32, glm::vec2>> blendSpaceChildren;
+	for (int i = 0; i < 5; i++)
+	{
+		blendSpaceChildren.push_back({ locomotion.AddClipNode(clips[i].get()), positions[i] });
+	}
+	locomotion.AddBlend2DNode(moveX, moveY, blendSpaceChildren);
+	BoneMask upperBodyMask = BoneMask::FromJoint(clips[0]->GetSkeleton(), "Joint5");
+
+	std::uniform_real_distribution<float> offsetDistribution(0.0f, keyCount / ticksPerSecond), unitDistribution(-1.0f, 1.0f);
+	std::vector<PoseAnimator> singleClipAnimators(characterCount), blendedAnimators(characterCount);
+	std::vector<glm::vec2> moveDirections(characterCount);
+	for (int i = 0; i < characterCount; i++)
+	{
+		float offset = offsetDistribution(rng);
+		singleClipAnimators[i].SetAnimationClip(clips[0].get());
+		singleClipAnimators[i].UpdateAnimation(offset);
+
+		PoseAnimator &animator = blendedAnimators[i];
+		animator.CrossFade(&locomotion, 0.0f);
+		u32 layer = animator.AddLayer(AnimationLayerBlendMode::Additive, 0.5f, upperBodyMask);
+		animator.CrossFade(clips[5].get(), 0.0f, layer);
+		moveDirections[i] = glm::vec2(unitDistribution(rng), unitDistribution(rng));
+		animator.SetBlendParameter(moveX, moveDirections[i].x);
+		animator.SetBlendParameter(moveY, moveDirections[i].y);
+		animator.UpdateAnimation(offset);
+	}
+
+	auto measure = [&](std::vector<PoseAnimator> &animators, bool crossFade)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			for (int i = 0; i < characterCount; i++)
+			{
+				// Every character crosses into the same blend space again every 30 frames, fading over 20 so a fifth of the crowd is always mid-fade
+				if (crossFade && (frame + i) % 30 == 0)
+					animators[i].CrossFade(&locomotion, 20.0f * deltaTime);
+				animators[i].UpdateAnimation(deltaTime);
+			}
+		}
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / frameCount;
+	};
+
+	ARC_LOG_INFO("Animation Blending Benchmark - {0} characters, {1} joints, single thread", characterCount, jointCount);
+	double singleClipMS = measure(singleClipAnimators, false);
+	double blendedMS = measure(blendedAnimators, false);
+	double crossFadeMS = measure(blendedAnimators, true);
+	ARC_LOG_INFO("Single clip: {0:.3f}ms per frame", singleClipMS);
+	ARC_LOG_INFO("2D blend space + masked additive layer: {0:.3f}ms per frame", blendedMS);
+	ARC_LOG_INFO("Same with cross-fades: {0:.3f}ms per frame", crossFadeMS);
+
+	// The cost of the blending on its own, without any sampling
+	AnimationPose a, b;
+	a.Resize(jointCount);
+	b.Resize(jointCount);
+	const int blendCount = 100000;
+	auto blendBegin = std::chrono::steady_clock::now();
+	for (int i = 0; i < blendCount; i++)
+	{
+		BlendPoses(a, b, 0.3f, nullptr, a);
+	}
+	double blendNS = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - blendBegin).count() / (static_cast<double>(blendCount) * jointCount);
+	ARC_LOG_INFO("BlendPoses: {0:.2f}ns per joint", blendNS);
+}
+
+void Benchmarks::RunAnimationCompressionBenchmark()
+{
+	const int characterCount = 1000;
+	const int jointCount = 60;
+	const int keyCount = 9000; // 5 minutes of 30fps mocap
+	const float ticksPerSecond = 30.0f;
+	const int frameCount = 100;
+
+	// Smooth motion with a little capture jitter on top, which is what keeps mocap from reducing down to nothing
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+	Skeleton skeleton;
+	for (int i = 0; i < jointCount; i++)
+	{
+		int parentIndex = i == 0 ? -1 : (i < 10 ? i - 1 : (i % 10 == 0 ? static_cast<int>(rng() % 10) : i - 1));
+		glm::mat4 bindTransform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.1f, 0.0f));
+		skeleton.AddJoint("Joint" + std::to_string(i), parentIndex, bindTransform, i, glm::inverse(bindTransform));
+	}
+
+	std::vector<AnimationTrackData> tracks(jointCount);
+	for (int i = 0; i < jointCount; i++)
+	{
+		AnimationTrackData &track = tracks[i];
+		track.JointName = "Joint" + std::to_string(i);
+		glm::vec3 axis = glm::normalize(glm::vec3(unitDistribution(rng), unitDistribution(rng), unitDistribution(rng)));
+		float frequency = 0.05f + 0.05f * unitDistribution(rng), phase = 3.0f * unitDistribution(rng);
+		for (int key = 0; key < keyCount; key++)
+		{
+			float time = static_cast<float>(key);
+			glm::vec3 jitter = 0.00005f * glm::vec3(unitDistribution(rng), unitDistribution(rng), unitDistribution(rng));
+			glm::vec3 position = i == 0 ? glm::vec3(0.02f * time, 0.1f + 0.05f * glm::sin(time * 0.3f), 0.0f) : glm::vec3(0.0f, 0.1f, 0.0f);
+			track.Positions.push_back(KeyPosition{ position + jitter, time });
+			track.Rotations.push_back(KeyRotation{ glm::angleAxis(0.8f * glm::sin(time * frequency + phase) + 0.0001f * unitDistribution(rng), axis), time });
+			track.Scales.push_back(KeyScale{ glm::vec3(1.0f), time });
+		}
+	}
+
+	ARC_LOG_INFO("Animation Compression Benchmark - {0} joints, {1} keys per channel, playback with {2} characters", jointCount, keyCount, characterCount);
+	ARC_LOG_INFO("{0:>18} | {1:>10} | {2:>10} | {3:>10} | {4:>14} | {5:>10}", "Settings", "Keys", "KB", "Ratio", "Max Error", "ms/frame");
+	auto measure = [&](const char *name, const AnimationCompressionSettings &settings)
+	{
+		Skeleton clipSkeleton = skeleton;
+		AnimationClip clip(std::move(clipSkeleton), tracks, static_cast<float>(keyCount - 1), ticksPerSecond, settings);
+
+		std::uniform_real_distribution<float> offsetDistribution(0.0f, keyCount / ticksPerSecond);
+		std::vector<PoseAnimator> animators(characterCount);
+		for (PoseAnimator &animator : animators)
+		{
+			animator.SetAnimationClip(&clip);
+			animator.UpdateAnimation(offsetDistribution(rng));
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			for (PoseAnimator &animator : animators)
+				animator.UpdateAnimation(1.0f / 60.0f);
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / frameCount;
+
+		const AnimationCompressionStats &stats = clip.GetCompressionStats();
+		ARC_LOG_INFO("{0:>18} | {1:>10} | {2:>10.1f} | {3:>9.1f}x | {4:>14.6f} | {5:>10.3f}", name, stats.KeyCount, stats.CompressedBytes / 1024.0,
+			static_cast<double>(stats.SourceBytes) / stats.CompressedBytes, stats.MaxJointError, ms);
+	};
+
+	AnimationCompressionSettings quantizeOnly;
+	quantizeOnly.ReduceKeyframes = false;
+	measure("Quantized only", quantizeOnly);
+	measure("Default errors", AnimationCompressionSettings());
+
+	AnimationCompressionSettings aggressive;
+	aggressive.MaxTranslationError *= 4.0f;
+	aggressive.MaxRotationError *= 4.0f;
+	aggressive.MaxScaleError *= 4.0f;
+	measure("4x default errors", aggressive);
+}
+
+void Benchmarks::RunClusteredLightingBenchmark()
+{
+	const int lightCounts[] = { 0, 64, 256, 1024, 4096 };
+	const int iterations = 20;
+	const float lightDistance = 150.0f;
+
+	// Shades the scene that is already loaded, the lights are added on top of its own and scattered around the camera so most of them are on screen
+	Scene *scene = Application::GetInstance().GetScene();
+	ICamera *camera = scene->GetCamera();
+	ShadowmapPass shadowmapPass(scene);
+	DeferredGeometryPass geometryPass(scene);
+	DeferredLightingPass lightingPass(scene);
+
+	ShadowmapPassOutput shadowmapOutput = shadowmapPass.GenerateShadowmaps(camera, false);
+	GeometryPassOutput geometryOutput = geometryPass.ExecuteGeometryPass(camera, false);
+	PreLightingPassOutput preLightingOutput;
+	preLightingOutput.ssaoTexture = AssetManager::GetWhiteTexture();
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> offsetDistribution(-lightDistance, lightDistance);
+	std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+	BenchmarkLights lights(scene);
+
+	ARC_LOG_INFO("Clustered Lighting Benchmark - {0}x{1}x{2} clusters, up to {3} lights per cluster, {4} iterations, GPU ms per deferred lighting pass", LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y,
+		LIGHT_CLUSTER_GRID_Z, LIGHT_CLUSTER_MAX_LIGHTS, iterations);
+	ARC_LOG_INFO("{0:>8} | {1:>14} | {2:>20}", "Lights", "Static Camera", "Moving Camera (+bin)");
+	for (int lightCount : lightCounts)
+	{
+		// Half point and half spot lights
+		while (static_cast<int>(lights.GetCount()) < lightCount)
+		{
+			glm::vec3 translation = camera->GetPosition() + glm::vec3(offsetDistribution(rng), 0.1f * offsetDistribution(rng), offsetDistribution(rng));
+			glm::vec3 rotation(glm::radians(-90.0f) * unitDistribution(rng), glm::two_pi<float>() * unitDistribution(rng), 0.0f);
+			LightComponent &lightComponent = lights.Add("Benchmark Light", lights.GetCount() % 2 == 0 ? LightType::LightType_Point : LightType::LightType_Spot, translation, rotation);
+			lightComponent.Intensity = 10.0f;
+			lightComponent.LightColour = glm::vec3(unitDistribution(rng), unitDistribution(rng), unitDistribution(rng));
+			lightComponent.AttenuationRange = 5.0f + 20.0f * unitDistribution(rng);
+		}
+
+		// Nudging the camera every pass changes the view the clusters were built for, so the second column also pays for binning the lights each time
+		double staticMS = MeasureGPUTime([&]() { lightingPass.ExecuteLightingPass(shadowmapOutput, geometryOutput.outputGBuffer, preLightingOutput, camera, false); }, iterations);
+		glm::vec3 cameraPosition = camera->GetPosition();
+		int pass = 0;
+		double movingMS = MeasureGPUTime([&]()
+		{
+			camera->SetPosition(cameraPosition + glm::vec3(0.0001f * (++pass % 2), 0.0f, 0.0f));
+			lightingPass.ExecuteLightingPass(shadowmapOutput, geometryOutput.outputGBuffer, preLightingOutput, camera, false);
+		}, iterations);
+		camera->SetPosition(cameraPosition);
+
+		ARC_LOG_INFO("{0:>8} | {1:>14.3f} | {2:>20.3f}", lightCount, staticMS, movingMS);
+	}
+}
+
+void Benchmarks::RunCascadedShadowBenchmark()
+{
+	const int iterations = 20;
+
+	// Renders the directional shadows of the scene that is already loaded, a shadow casting sun is added so the light manager picks it as the caster
+	Scene *scene = Application::GetInstance().GetScene();
+	ICamera *camera = scene->GetCamera();
+	LightManager *lightManager = scene->GetLightManager();
+	ShadowmapPass shadowmapPass(scene);
+
+	BenchmarkLights lights(scene);
+	LightComponent &sunComponent = lights.AddShadowCaster("Benchmark Sun", LightType::LightType_Directional, ShadowQuality::ShadowQuality_Ultra, camera->GetPosition(),
+		glm::vec3(glm::radians(-60.0f), glm::radians(30.0f), 0.0f));
+	Renderer::SetShadowCachingEnabled(false); // Every cascade has to draw all of its casters every iteration
+
+	ARC_LOG_INFO("Cascaded Shadow Benchmark - {0} iterations, {1} shadow distance, GPU ms per shadow pass, draw calls of a single pass per cascade", iterations, sunComponent.ShadowCascadeDistance);
+	ARC_LOG_INFO("{0:>8} | {1:>8} | {2:>8} | {3:>30}", "Cascades", "GPU ms", "CPU ms", "Draw Calls (per cascade)");
+	for (int cascadeCount = 1; cascadeCount <= SHADOW_CASCADE_MAX_COUNT; cascadeCount++)
+	{
+		sunComponent.ShadowCascadeCount = cascadeCount;
+		lightManager->Update();
+
+		double cpuMS = MeasureFrameCPUTime([&]() { shadowmapPass.GenerateShadowmaps(camera, false); });
+		std::string drawCalls;
+		const RendererData &rendererData = Renderer::GetRendererData();
+		for (int i = 0; i < cascadeCount; i++)
+		{
+			drawCalls += (i > 0 ? " / " : "") + std::to_string(rendererData.ShadowCascadeDrawCallCount[i]);
+		}
+
+		double gpuMS = MeasureGPUTime([&]() { shadowmapPass.GenerateShadowmaps(camera, false); }, iterations);
+		ARC_LOG_INFO("{0:>8} | {1:>8.3f} | {2:>8.3f} | {3:>30}", cascadeCount, gpuMS, cpuMS, drawCalls);
+	}
+}
+
+void Benchmarks::RunPointShadowBenchmark()
+{
+	const int iterations = 20;
+
+	// Renders the shadows of the scene that is already loaded, a shadow casting point light is added at the camera so the light manager picks it as the caster
+	Scene *scene = Application::GetInstance().GetScene();
+	ICamera *camera = scene->GetCamera();
+	ShadowmapPass shadowmapPass(scene);
+
+	BenchmarkLights lights(scene);
+	LightComponent &pointComponent = lights.AddShadowCaster("Benchmark Point Light", LightType::LightType_Point, ShadowQuality::ShadowQuality_High, camera->GetPosition());
+	scene->GetLightManager()->Update();
+	Renderer::SetShadowCachingEnabled(false); // Both modes have to draw every caster into the cubemap
+
+	// GPU time is for the whole shadow pass, the other lights' shadows cost the same either way
+	ARC_LOG_INFO("Point Shadow Benchmark - {0} iterations, {1} shadow far plane, CPU submit ms and draw calls of a single cubemap", iterations, pointComponent.ShadowFarPlane);
+	ARC_LOG_INFO("{0:>12} | {1:>8} | {2:>10} | {3:>10} | {4:>16}", "Mode", "GPU ms", "Submit ms", "Draw Calls", "Meshes Submitted");
+	bool singlePassEnabled = Renderer::GetSinglePassPointShadowsEnabled();
+	for (int singlePass = 0; singlePass <= 1; singlePass++)
+	{
+		Renderer::SetSinglePassPointShadowsEnabled(singlePass == 1);
+
+		MeasureFrameCPUTime([&]() { shadowmapPass.GenerateShadowmaps(camera, false); });
+		RendererData rendererData = Renderer::GetRendererData();
+
+		double gpuMS = MeasureGPUTime([&]() { shadowmapPass.GenerateShadowmaps(camera, false); }, iterations);
+		ARC_LOG_INFO("{0:>12} | {1:>8.3f} | {2:>10.3f} | {3:>10} | {4:>16}", singlePass ? "Single Pass" : "Per Face", gpuMS, rendererData.PointShadowSubmitTimeMS,
+			rendererData.PointShadowDrawCallCount, rendererData.MeshesSubmittedCount);
+	}
+	Renderer::SetSinglePassPointShadowsEnabled(singlePassEnabled);
+}
+
+void Benchmarks::RunStaticShadowCacheBenchmark()
+{
+	const int iterations = 20;
+
+	// Renders the shadows of the scene that is already loaded, which is expected to be mostly static models. A sun, a spot light and a point light are added
+	// at the camera so every kind of shadow map is cached
+	Scene *scene = Application::GetInstance().GetScene();
+	ICamera *camera = scene->GetCamera();
+	ShadowmapPass shadowmapPass(scene);
+
+	BenchmarkLights lights(scene);
+	lights.AddShadowCaster("Benchmark Sun", LightType::LightType_Directional, ShadowQuality::ShadowQuality_Ultra, camera->GetPosition(), glm::vec3(glm::radians(-60.0f), glm::radians(30.0f), 0.0f));
+	lights.AddShadowCaster("Benchmark Spot Light", LightType::LightType_Spot, ShadowQuality::ShadowQuality_High, camera->GetPosition(), glm::vec3(glm::radians(-45.0f), 0.0f, 0.0f)).AttenuationRange = 50.0f;
+	lights.AddShadowCaster("Benchmark Point Light", LightType::LightType_Point, ShadowQuality::ShadowQuality_High, camera->GetPosition());
+	scene->GetLightManager()->Update();
+
+	// With a still camera nothing moves between iterations, so with caching on every shadow map only copies its cache and draws the dynamic models. The warm up
+	// run in MeasureGPUTime fills the caches. A moving camera drags the cascades along with it, they can't use their cache and are drawn uncached instead
+	ARC_LOG_INFO("Static Shadow Cache Benchmark - {0} iterations, GPU and CPU ms per shadow pass, draw calls of a single pass", iterations);
+	ARC_LOG_INFO("{0:>10} | {1:>8} | {2:>8} | {3:>8} | {4:>10}", "Caching", "Camera", "GPU ms", "CPU ms", "Draw Calls");
+	glm::vec3 cameraPosition = camera->GetPosition();
+	for (int moving = 0; moving <= 1; moving++)
+	{
+		for (int caching = 0; caching <= 1; caching++)
+		{
+			Renderer::SetShadowCachingEnabled(caching == 1);
+			int pass = 0;
+			auto generateShadowmaps = [&]()
+			{
+				// Far enough that every cascade snaps to a new texel
+				if (moving)
+					camera->SetPosition(cameraPosition + glm::vec3(0.5f * ++pass, 0.0f, 0.0f));
+				shadowmapPass.GenerateShadowmaps(camera, false);
+			};
+			double gpuMS = MeasureGPUTime(generateShadowmaps, iterations);
+			double cpuMS = MeasureFrameCPUTime(generateShadowmaps);
+
+			ARC_LOG_INFO("{0:>10} | {1:>8} | {2:>8.3f} | {3:>8.3f} | {4:>10}", caching ? "On" : "Off", moving ? "Moving" : "Still", gpuMS, cpuMS, Renderer::GetRendererData().DrawCallCount);
+		}
+		camera->SetPosition(cameraPosition);
+	}
+}
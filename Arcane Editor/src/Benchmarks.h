@@ -0,0 +1,18 @@
+#pragma once
+
+// Micro benchmarks for engine systems. Results are written to the console, call them from EditorLayer::OnAttach when needed
+class Benchmarks
+{
+public:
+	static void RunQueueBenchmark();
+	static void RunTextureCompressionBenchmark();
+	static void RunBVHBenchmark();
+	static void RunAnimationBenchmark();
+	static void RunAnimationCrowdBenchmark();
+	static void RunAnimationBlendingBenchmark();
+	static void RunAnimationCompressionBenchmark();
+	static void RunClusteredLightingBenchmark();
+	static void RunCascadedShadowBenchmark();
+	static void RunPointShadowBenchmark();
+	static void RunStaticShadowCacheBenchmark();
+};
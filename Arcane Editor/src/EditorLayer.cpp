@@ -3,6 +3,7 @@
 #include <Arcane/Core/Application.h>
 #include <Arcane/Graphics/Renderer/Renderpass/EditorPass.h>
 #include <Arcane/Vendor/Imgui/imgui.h>
+#include <Benchmarks.h>
 #include <Testbed.h>
 
 extern bool g_ApplicationRunning;
@@ -22,6 +23,22 @@ namespace Arcane
 		Testbed::LoadTestbedGraphics();
 		//Testbed::LoadTestbedAnimation();
 		//Testbed::LoadTestbedGraphics2D();
+		//Testbed::LoadTestbedTextureStreaming();
+		//Testbed::LoadTestbedDrawCallSorting();
+		//Testbed::LoadTestbedInstancing();
+		//Testbed::LoadTestbedSkinning();
+
+		//Benchmarks::RunQueueBenchmark();
+		//Benchmarks::RunTextureCompressionBenchmark();
+		//Benchmarks::RunBVHBenchmark();
+		//Benchmarks::RunAnimationBenchmark();
+		//Benchmarks::RunAnimationCrowdBenchmark();
+		//Benchmarks::RunAnimationBlendingBenchmark();
+		//Benchmarks::RunAnimationCompressionBenchmark();
+		//Benchmarks::RunClusteredLightingBenchmark();
+		//Benchmarks::RunCascadedShadowBenchmark();
+		//Benchmarks::RunPointShadowBenchmark();
+		//Benchmarks::RunStaticShadowCacheBenchmark();
 
 #ifdef OLD_LOADING_METHOD
 		//Model *simpsonsBuilding = new Arcane::Model("res/3D_Models/Simpsons/MoesTavern.obj");
@@ -156,6 +173,7 @@ namespace Arcane
 		m_ScenePanel.OnImGuiRender();
 		m_InspectorPanel.OnImGuiRender();
 		m_RendererStatsDisplay.OnImGuiRender();
+		m_TextureStreamingPanel.OnImGuiRender();
 		if (m_ShowGraphicsSettings) m_GraphicsSettings.OnImGuiRender(&m_ShowGraphicsSettings);
 
 		ImGui::End();
@@ -8,6 +8,7 @@
 #include <Arcane/Editor/InspectorPanel.h>
 #include <Arcane/Editor/ScenePanel.h>
 #include <Arcane/Editor/RendererStatsDisplay.h>
+#include <Arcane/Editor/TextureStreamingPanel.h>
 
 namespace Arcane
 {
@@ -34,6 +35,7 @@ namespace Arcane
 		ScenePanel m_ScenePanel;
 		InspectorPanel m_InspectorPanel;
 		RendererStatsDisplay m_RendererStatsDisplay;
+		TextureStreamingPanel m_TextureStreamingPanel;
 
 		GraphicsSettings m_GraphicsSettings;
 
@@ -3,8 +3,10 @@
 
 #include <Arcane/Core/Application.h>
 #include <Arcane/Util/Loaders/AssetManager.h>
+#include <Arcane/Util/Loaders/TextureStreamer.h>
 #include <Arcane/Graphics/Mesh/Common/Cube.h>
 #include <Arcane/Graphics/Mesh/Common/Quad.h>
+#include <Arcane/Graphics/Mesh/Common/Sphere.h>
 #include <Arcane/Graphics/Mesh/Model.h>
 #include <Arcane/Scene/Components.h>
 #include <Arcane/Scene/Scene.h>
@@ -13,6 +15,8 @@
 #include <Arcane/Graphics/Renderer/Renderpass/MasterRenderPass.h>
 #include <Arcane/Graphics/Renderer/Renderpass/PostProcessPass.h>
 
+#include <functional>
+
 
 using namespace Arcane;
 
@@ -353,3 +357,179 @@ void Testbed::LoadTestbedAnimation()
 		waterComponent.WaterNormalMap = assetManager.Load2DTextureAsync(std::string("res/water/normals.png"));
 	}
 }
+
+void Testbed::LoadTestbedTextureStreaming()
+{
+	// Meant to be loaded on top of the graphics testbed for its lighting. Every image under res/ goes on its own cube in a long grid, so the camera
+	// can fly through it and watch textures get raised near the camera and evicted behind it. The budget is lowered so the scene can't fit all of it at once
+	Scene* scene = Arcane::Application::GetInstance().GetScene();
+	AssetManager& assetManager = AssetManager::GetInstance();
+	TextureStreamer::GetInstance().SetBudget(64ull * 1024 * 1024);
+
+	static const std::unordered_set<std::string> imageExtensions = { ".png", ".jpg", ".jpeg", ".tga", ".dds" };
+	std::vector<std::string> imagePaths;
+	std::error_code error;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator("res", error))
+	{
+		std::string extension = entry.path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (entry.is_regular_file(error) && imageExtensions.find(extension) != imageExtensions.end())
+			imagePaths.push_back(entry.path().generic_string());
+	}
+
+	TextureSettings srgbTextureSettings;
+	srgbTextureSettings.IsSRGB = true;
+
+	Cube* cube = new Cube();
+	const int gridWidth = 8;
+	const float spacing = 12.0f;
+	for (int i = 0; i < imagePaths.size(); i++)
+	{
+		Model* cubeModel = new Model(*cube);
+		Material& material = cubeModel->GetMeshes()[0].GetMaterial();
+		material.SetAlbedoMap(assetManager.Load2DTextureAsync(imagePaths[i], &srgbTextureSettings));
+		material.SetRoughnessValue(0.6f);
+
+		auto streamingCube = scene->CreateEntity("Streaming Cube " + std::to_string(i));
+		auto& transformComponent = streamingCube.GetComponent<TransformComponent>();
+		transformComponent.Translation = { (i % gridWidth) * spacing, 40.0f, (i / gridWidth) * -spacing };
+		transformComponent.Scale = { 4.0f, 4.0f, 4.0f };
+		auto& meshComponent = streamingCube.AddComponent<MeshComponent>(cubeModel);
+		meshComponent.IsStatic = true;
+		meshComponent.IsTransparent = false;
+	}
+}
+
+void Testbed::LoadTestbedDrawCallSorting()
+{
+	// Meant to be loaded on top of the graphics testbed for its lighting. Every object picks one of a few shapes and materials at random so consecutive
+	// entities almost never share state, toggle "Sort Draw Calls" in the renderer stats to compare the binds and the mesh submit time with and without sorting
+	Scene* scene = Arcane::Application::GetInstance().GetScene();
+	AssetManager& assetManager = AssetManager::GetInstance();
+
+	TextureSettings srgbTextureSettings;
+	srgbTextureSettings.IsSRGB = true;
+
+	std::vector<Mesh*> shapes = { new Cube(), new Sphere(), new Quad() };
+	std::vector<std::function<void(Material&)>> materialSetups =
+	{
+		[&](Material& material) { material.SetAlbedoMap(assetManager.Load2DTextureAsync(std::string("res/textures/bricks2.jpg"), &srgbTextureSettings)); material.SetNormalMap(assetManager.Load2DTextureAsync(std::string("res/textures/bricks2_normal.jpg"))); },
+		[&](Material& material) { material.SetAlbedoMap(assetManager.Load2DTextureAsync(std::string("res/textures/Pebles_001_COLOR.png"), &srgbTextureSettings)); material.SetNormalMap(assetManager.Load2DTextureAsync(std::string("res/textures/Pebles_001_NRM.png"))); material.SetAmbientOcclusionMap(assetManager.Load2DTextureAsync(std::string("res/textures/Pebles_001_OCC.png"))); },
+		[&](Material& material) { material.SetAlbedoMap(assetManager.Load2DTextureAsync(std::string("res/textures/grass.png"), &srgbTextureSettings)); },
+		[&](Material& material) { material.SetEmissionMap(assetManager.Load2DTextureAsync(std::string("res/textures/circuitry-emission.png"), &srgbTextureSettings)); material.SetEmissionIntensity(5.0f); },
+		[&](Material& material) { glm::vec4 red(0.8f, 0.1f, 0.1f, 1.0f); material.SetAlbedoColour(red); material.SetMetallicValue(1.0f); material.SetRoughnessValue(0.2f); },
+		[&](Material& material) { glm::vec4 blue(0.1f, 0.6f, 0.9f, 1.0f); material.SetAlbedoColour(blue); material.SetRoughnessValue(0.7f); },
+	};
+
+	// One model per shape and material pair, entities using the same pair share the model so they share its mesh and material as well
+	std::vector<Model*> models;
+	for (Mesh* shape : shapes)
+	{
+		for (auto& materialSetup : materialSetups)
+		{
+			Model* model = new Model(*shape);
+			materialSetup(model->GetMeshes()[0].GetMaterial());
+			models.push_back(model);
+		}
+	}
+
+	const int objectCount = 5000;
+	const int gridWidth = 100;
+	const float spacing = 3.0f;
+	std::mt19937 random(1337);
+	std::uniform_int_distribution<size_t> modelDistribution(0, models.size() - 1);
+	for (int i = 0; i < objectCount; i++)
+	{
+		auto object = scene->CreateEntity("Sorting Object " + std::to_string(i));
+		auto& transformComponent = object.GetComponent<TransformComponent>();
+		transformComponent.Translation = { (i % gridWidth) * spacing, 60.0f, (i / gridWidth) * -spacing };
+		auto& meshComponent = object.AddComponent<MeshComponent>(models[modelDistribution(random)]);
+		meshComponent.IsStatic = true;
+		meshComponent.IsTransparent = false;
+	}
+}
+
+void Testbed::LoadTestbedInstancing()
+{
+	// Meant to be loaded on top of the graphics testbed for its lighting. Every entity uses the same model, toggle "Instanced Rendering" in the renderer
+	// stats to compare the draw calls, mesh submit time, and frametime with and without instancing
+	Scene* scene = Arcane::Application::GetInstance().GetScene();
+	AssetManager& assetManager = AssetManager::GetInstance();
+
+	TextureSettings srgbTextureSettings;
+	srgbTextureSettings.IsSRGB = true;
+
+	Cube* cube = new Cube();
+	Model* propModel = new Model(*cube);
+	Material& material = propModel->GetMeshes()[0].GetMaterial();
+	material.SetAlbedoMap(assetManager.Load2DTextureAsync(std::string("res/textures/bricks2.jpg"), &srgbTextureSettings));
+	material.SetNormalMap(assetManager.Load2DTextureAsync(std::string("res/textures/bricks2_normal.jpg")));
+	material.SetRoughnessValue(0.8f);
+
+	const int propCount = 10000;
+	const int gridWidth = 100;
+	const float spacing = 2.5f;
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<float> rotationDistribution(0.0f, glm::two_pi<float>());
+	for (int i = 0; i < propCount; i++)
+	{
+		auto prop = scene->CreateEntity("Instanced Prop " + std::to_string(i));
+		auto& transformComponent = prop.GetComponent<TransformComponent>();
+		transformComponent.Translation = { (i % gridWidth) * spacing, 80.0f, (i / gridWidth) * -spacing };
+		transformComponent.Rotation = { 0.0f, rotationDistribution(random), 0.0f };
+		transformComponent.Scale = { 0.5f, 0.5f, 0.5f };
+		auto& meshComponent = prop.AddComponent<MeshComponent>(propModel);
+		meshComponent.IsStatic = true;
+		meshComponent.IsTransparent = false;
+	}
+}
+
+void Testbed::LoadTestbedSkinning()
+{
+	// Meant to be loaded on top of the graphics testbed for its directional shadows. Each character is drawn by the camera, the directional shadow, and the
+	// six faces of the point light's shadow. Toggle "GPU Skinning" in the renderer stats to compare skinning once a frame against skinning in every pass
+	Scene* scene = Arcane::Application::GetInstance().GetScene();
+	AssetManager& assetManager = AssetManager::GetInstance();
+
+	// Every character shares the model and clip, only the animators are per entity
+	Model* animatedVampire = assetManager.LoadModel(std::string("res/3D_Models/Vampire/Dancing_Vampire.dae"));
+	AnimationClip *clip = new AnimationClip(std::string("res/3D_Models/Vampire/Dancing_Vampire.dae"), 0, animatedVampire);
+	Material& meshMaterial = animatedVampire->GetMeshes()[0].GetMaterial();
+	meshMaterial.SetRoughnessValue(1.0f);
+	meshMaterial.SetNormalMap(assetManager.Load2DTextureAsync(std::string("res/3D_Models/Vampire/textures/Vampire_normal.png")));
+	meshMaterial.SetMetallicMap(assetManager.Load2DTextureAsync(std::string("res/3D_Models/Vampire/textures/Vampire_specular.png")));
+
+	const int characterCount = 200;
+	const int gridWidth = 20;
+	const float spacing = 4.0f;
+	const glm::vec3 gridOrigin = { -40.0f, -6.12f, -20.0f };
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<float> timeOffsetDistribution(0.0f, 5.0f);
+	for (int i = 0; i < characterCount; i++)
+	{
+		auto character = scene->CreateEntity("Animated Character " + std::to_string(i));
+		auto& transformComponent = character.GetComponent<TransformComponent>();
+		transformComponent.Translation = gridOrigin + glm::vec3((i % gridWidth) * spacing, 0.0f, (i / gridWidth) * -spacing);
+		transformComponent.Scale = { 0.05f, 0.05f, 0.05f };
+		auto& meshComponent = character.AddComponent<MeshComponent>(animatedVampire);
+		meshComponent.IsStatic = false;
+		meshComponent.IsTransparent = false;
+		meshComponent.ShouldBackfaceCull = false;
+		auto& poseAnimatorComponent = character.AddComponent<PoseAnimatorComponent>();
+		poseAnimatorComponent.PoseAnimator.SetAnimationClip(clip);
+		poseAnimatorComponent.PoseAnimator.UpdateAnimation(timeOffsetDistribution(random)); // Keeps the characters out of step so the poses differ
+	}
+
+	{
+		auto pointLight = scene->CreateEntity("Skinning Point Light");
+		auto& transformComponent = pointLight.GetComponent<TransformComponent>();
+		transformComponent.Translation = gridOrigin + glm::vec3(gridWidth * spacing * 0.5f, 8.0f, (characterCount / gridWidth) * -spacing * 0.5f);
+		auto& lightComponent = pointLight.AddComponent<LightComponent>();
+		lightComponent.Type = LightType::LightType_Point;
+		lightComponent.Intensity = 40.0f;
+		lightComponent.LightColour = glm::vec3(1.0f, 0.9f, 0.8f);
+		lightComponent.AttenuationRange = 60.0f;
+		lightComponent.IsStatic = false;
+		lightComponent.CastShadows = true;
+	}
+}
@@ -8,4 +8,8 @@ public:
 	static void LoadTestbedGraphics2D();
 	static void LoadTestbedPhysics();
 	static void LoadTestbedAnimation();
+	static void LoadTestbedTextureStreaming(); // Stress scene with more texture data than the streaming budget allows
+	static void LoadTestbedDrawCallSorting(); // 5k objects sharing a few meshes and materials, submitted in a shuffled order
+	static void LoadTestbedInstancing(); // 10k copies of the same prop
+	static void LoadTestbedSkinning(); // 200 animated characters lit by shadow casting lights
 };
@@ -0,0 +1,219 @@
+#include "arcpch.h"
+#include "AnimationBlendTree.h"
+
+#include <Arcane/Animation/PoseBlending.h>
+
+namespace Arcane
+{
+	// Clips blended in with less than this are skipped, they wouldn't make a visible difference
+	static const float s_MinClipWeight = 0.001f;
+
+	static thread_local AnimationPose s_ClipPose;
+
+	u32 AnimationBlendTree::AddParameter(const std::string &name, float defaultValue)
+	{
+		m_Parameters.push_back(BlendTreeParameter{ name, defaultValue });
+		return GetParameterCount() - 1;
+	}
+
+	int AnimationBlendTree::FindParameter(const std::string &name) const
+	{
+		for (u32 i = 0; i < GetParameterCount(); i++)
+		{
+			if (m_Parameters[i].Name == name)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	u32 AnimationBlendTree::AddClipNode(AnimationClip *clip)
+	{
+		ARC_ASSERT(clip, "Blend tree clip nodes need a clip");
+		ARC_ASSERT(m_Clips.empty() || clip->GetSkeleton().GetJointCount() == GetSkeleton().GetJointCount(), "Every clip in a blend tree has to be made for the same skeleton");
+
+		BlendTreeNode node = {};
+		node.Type = BlendTreeNodeType::Clip;
+		node.ClipIndex = GetClipCount();
+		m_Nodes.push_back(node);
+
+		m_Clips.push_back(BlendTreeClip{ clip, m_KeyframeCursorCount });
+		m_KeyframeCursorCount += clip->GetTimelineCount();
+
+		m_RootNode = static_cast<u32>(m_Nodes.size()) - 1;
+		return m_RootNode;
+	}
+
+	u32 AnimationBlendTree::AddBlend1DNode(u32 parameter, const std::vector<std::pair<u32, float>> &childrenAndThresholds)
+	{
+		std::vector<BlendTreeChild> children;
+		for (const auto &child : childrenAndThresholds)
+		{
+			children.push_back(BlendTreeChild{ child.first, glm::vec2(child.second, 0.0f) });
+		}
+
+		// Sorted by threshold so evaluating only has to find the first threshold past the parameter
+		std::sort(children.begin(), children.end(), [](const BlendTreeChild &a, const BlendTreeChild &b) { return a.Position.x < b.Position.x; });
+		return AddBlendNode(BlendTreeNodeType::Blend1D, parameter, parameter, std::move(children));
+	}
+
+	u32 AnimationBlendTree::AddBlend2DNode(u32 parameterX, u32 parameterY, const std::vector<std::pair<u32, glm::vec2>> &childrenAndPositions)
+	{
+		std::vector<BlendTreeChild> children;
+		for (const auto &child : childrenAndPositions)
+		{
+			children.push_back(BlendTreeChild{ child.first, child.second });
+		}
+		return AddBlendNode(BlendTreeNodeType::Blend2D, parameterX, parameterY, std::move(children));
+	}
+
+	u32 AnimationBlendTree::AddBlendNode(BlendTreeNodeType type, u32 parameterX, u32 parameterY, std::vector<BlendTreeChild> &&children)
+	{
+		ARC_ASSERT(!children.empty(), "Blend nodes need at least one child");
+		ARC_ASSERT(parameterX < GetParameterCount() && parameterY < GetParameterCount(), "Blend node references a parameter that doesn't exist");
+		for (const BlendTreeChild &child : children)
+		{
+			ARC_ASSERT(child.Node < m_Nodes.size(), "Blend node children have to be added before the node");
+		}
+
+		BlendTreeNode node = {};
+		node.Type = type;
+		node.ParameterX = parameterX;
+		node.ParameterY = parameterY;
+		node.FirstChild = static_cast<u32>(m_Children.size());
+		node.ChildCount = static_cast<u32>(children.size());
+		m_Nodes.push_back(node);
+		m_Children.insert(m_Children.end(), children.begin(), children.end());
+
+		m_RootNode = static_cast<u32>(m_Nodes.size()) - 1;
+		return m_RootNode;
+	}
+
+	void AnimationBlendTree::ComputeClipWeights(const float *parameters, float *outClipWeights) const
+	{
+		ARC_ASSERT(!m_Nodes.empty(), "Blend tree has no nodes");
+
+		std::fill(outClipWeights, outClipWeights + GetClipCount(), 0.0f);
+		AccumulateClipWeights(m_RootNode, 1.0f, parameters, outClipWeights);
+	}
+
+	void AnimationBlendTree::AccumulateClipWeights(u32 nodeIndex, float weight, const float *parameters, float *outClipWeights) const
+	{
+		const BlendTreeNode &node = m_Nodes[nodeIndex];
+		const BlendTreeChild *children = node.ChildCount > 0 ? &m_Children[node.FirstChild] : nullptr;
+		switch (node.Type)
+		{
+		case BlendTreeNodeType::Clip:
+		{
+			outClipWeights[node.ClipIndex] += weight;
+			break;
+		}
+		case BlendTreeNodeType::Blend1D:
+		{
+			// Past either end the closest child plays on its own
+			float parameter = parameters[node.ParameterX];
+			if (node.ChildCount == 1 || parameter <= children[0].Position.x)
+			{
+				AccumulateClipWeights(children[0].Node, weight, parameters, outClipWeights);
+				break;
+			}
+
+			u32 next = 1;
+			while (next < node.ChildCount - 1 && children[next].Position.x < parameter)
+				next++;
+
+			float start = children[next - 1].Position.x, end = children[next].Position.x;
+			float amount = end > start ? glm::clamp((parameter - start) / (end - start), 0.0f, 1.0f) : 1.0f;
+			if (amount < 1.0f)
+				AccumulateClipWeights(children[next - 1].Node, weight * (1.0f - amount), parameters, outClipWeights);
+			if (amount > 0.0f)
+				AccumulateClipWeights(children[next].Node, weight * amount, parameters, outClipWeights);
+			break;
+		}
+		case BlendTreeNodeType::Blend2D:
+		{
+			// Gradient band interpolation: each child's influence falls off linearly towards every other child, taking the smallest of those as its weight.
+			// Unlike triangulating the samples it handles any layout and is continuous everywhere, blend spaces rarely have more than ~9 children so O(n^2) is fine
+			glm::vec2 parameter(parameters[node.ParameterX], parameters[node.ParameterY]);
+			float childWeights[16];
+			ARC_ASSERT(node.ChildCount <= 16, "2D blend nodes support up to 16 children");
+
+			float totalWeight = 0.0f;
+			for (u32 i = 0; i < node.ChildCount; i++)
+			{
+				glm::vec2 toParameter = parameter - children[i].Position;
+				float childWeight = 1.0f;
+				for (u32 j = 0; j < node.ChildCount && childWeight > 0.0f; j++)
+				{
+					if (i == j)
+						continue;
+
+					glm::vec2 toOther = children[j].Position - children[i].Position;
+					float lengthSquared = glm::dot(toOther, toOther);
+					if (lengthSquared > 0.0f)
+						childWeight = glm::min(childWeight, 1.0f - glm::dot(toParameter, toOther) / lengthSquared);
+				}
+				childWeights[i] = glm::max(childWeight, 0.0f);
+				totalWeight += childWeights[i];
+			}
+
+			for (u32 i = 0; i < node.ChildCount; i++)
+			{
+				float childWeight = totalWeight > 0.0f ? childWeights[i] / totalWeight : (i == 0 ? 1.0f : 0.0f);
+				if (childWeight > 0.0f)
+					AccumulateClipWeights(children[i].Node, weight * childWeight, parameters, outClipWeights);
+			}
+			break;
+		}
+		}
+	}
+
+	float AnimationBlendTree::GetDuration(const float *clipWeights) const
+	{
+		float duration = 0.0f;
+		for (u32 i = 0; i < GetClipCount(); i++)
+		{
+			const AnimationClip *clip = m_Clips[i].Clip;
+			duration += clipWeights[i] * (clip->GetDuration() / clip->GetTicksPerSecond());
+		}
+		return duration;
+	}
+
+	void AnimationBlendTree::Evaluate(float normalizedTime, const float *clipWeights, u32 *keyframeCursors, AnimationPose &outPose) const
+	{
+		// Running blend, each clip is lerped in by its share of the weight so far. That gives the same weighted average for the translations and scales as summing
+		// them, and is close enough for the rotations since the clips in a blend space are similar poses anyway
+		float accumulatedWeight = 0.0f;
+		for (u32 i = 0; i < GetClipCount(); i++)
+		{
+			float clipWeight = clipWeights[i];
+			if (clipWeight < s_MinClipWeight)
+				continue;
+
+			const BlendTreeClip &blendClip = m_Clips[i];
+			float time = normalizedTime * blendClip.Clip->GetDuration();
+			if (accumulatedWeight == 0.0f)
+			{
+				blendClip.Clip->SamplePose(time, keyframeCursors + blendClip.FirstKeyframeCursor, outPose);
+				accumulatedWeight = clipWeight;
+				continue;
+			}
+
+			s_ClipPose.Resize(outPose.GetJointCount());
+			blendClip.Clip->SamplePose(time, keyframeCursors + blendClip.FirstKeyframeCursor, s_ClipPose);
+			accumulatedWeight += clipWeight;
+			BlendPoses(outPose, s_ClipPose, clipWeight / accumulatedWeight, nullptr, outPose);
+		}
+	}
+
+	const Skeleton& AnimationBlendTree::GetSkeleton() const
+	{
+		ARC_ASSERT(!m_Clips.empty(), "Blend tree has no clips");
+		return m_Clips[0].Clip->GetSkeleton();
+	}
+
+	const glm::mat4& AnimationBlendTree::GetGlobalInverseTransform() const
+	{
+		ARC_ASSERT(!m_Clips.empty(), "Blend tree has no clips");
+		return m_Clips[0].Clip->GetGlobalInverseTransform();
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef ANIMATIONBLENDTREE_H
+#define ANIMATIONBLENDTREE_H
+
+#ifndef ANIMATIONCLIP_H
+#include <Arcane/Animation/AnimationClip.h>
+#endif
+
+namespace Arcane
+{
+	enum class BlendTreeNodeType
+	{
+		Clip,
+		Blend1D, // Children are placed along a line by threshold, only the two around the parameter are blended
+		Blend2D  // Children are placed on a plane, weighted with gradient band interpolation so any layout of samples works (ie. directional locomotion)
+	};
+
+	// Describes how clips are blended together based on a set of parameters (speed, direction etc). A tree only holds the description and can be shared between
+	// any number of animators, the playback state (phase, keyframe cursors, parameter values) lives in the animator. Every clip in a tree has to be made for the same
+	// skeleton, the children of blend nodes are played in sync by normalized time so footsteps line up while they are blended
+	class AnimationBlendTree
+	{
+	public:
+		AnimationBlendTree() = default;
+
+		// Parameters are referenced by the index returned here
+		u32 AddParameter(const std::string &name, float defaultValue = 0.0f);
+		int FindParameter(const std::string &name) const;
+
+		// Nodes are referenced by the index returned here, children have to be added before their parent
+		u32 AddClipNode(AnimationClip *clip);
+		u32 AddBlend1DNode(u32 parameter, const std::vector<std::pair<u32, float>> &childrenAndThresholds);
+		u32 AddBlend2DNode(u32 parameterX, u32 parameterY, const std::vector<std::pair<u32, glm::vec2>> &childrenAndPositions);
+		inline void SetRootNode(u32 node) { m_RootNode = node; }
+
+		// Writes the weight of every clip node (by the order they were added in) for the given parameter values, clips with a weight of 0 don't have to be sampled
+		void ComputeClipWeights(const float *parameters, float *outClipWeights) const;
+
+		// Length of one cycle through the tree in seconds, the clip lengths are blended by the same weights as the poses
+		float GetDuration(const float *clipWeights) const;
+
+		// Samples every clip with a weight at the normalized time (0 to 1 through each clip) and blends them into outPose. keyframeCursors needs GetKeyframeCursorCount entries
+		void Evaluate(float normalizedTime, const float *clipWeights, u32 *keyframeCursors, AnimationPose &outPose) const;
+
+		inline u32 GetParameterCount() const { return static_cast<u32>(m_Parameters.size()); }
+		inline float GetParameterDefault(u32 parameter) const { return m_Parameters[parameter].DefaultValue; }
+		inline u32 GetClipCount() const { return static_cast<u32>(m_Clips.size()); }
+		inline u32 GetKeyframeCursorCount() const { return m_KeyframeCursorCount; }
+
+		// The skeleton and root transform of the first clip, which every other clip has to match
+		const Skeleton& GetSkeleton() const;
+		const glm::mat4& GetGlobalInverseTransform() const;
+	private:
+		struct BlendTreeParameter
+		{
+			std::string Name;
+			float DefaultValue;
+		};
+
+		struct BlendTreeNode
+		{
+			BlendTreeNodeType Type;
+			u32 ClipIndex; // Only for clip nodes
+			u32 ParameterX, ParameterY;
+			u32 FirstChild, ChildCount; // Into m_Children
+		};
+
+		struct BlendTreeChild
+		{
+			u32 Node;
+			glm::vec2 Position; // Only x is used by 1D blends
+		};
+
+		struct BlendTreeClip
+		{
+			AnimationClip *Clip;
+			u32 FirstKeyframeCursor;
+		};
+
+		u32 AddBlendNode(BlendTreeNodeType type, u32 parameterX, u32 parameterY, std::vector<BlendTreeChild> &&children);
+		void AccumulateClipWeights(u32 nodeIndex, float weight, const float *parameters, float *outClipWeights) const;
+	private:
+		std::vector<BlendTreeParameter> m_Parameters;
+		std::vector<BlendTreeNode> m_Nodes;
+		std::vector<BlendTreeChild> m_Children;
+		std::vector<BlendTreeClip> m_Clips;
+		u32 m_RootNode = 0;
+		u32 m_KeyframeCursorCount = 0;
+	};
+}
+#endif
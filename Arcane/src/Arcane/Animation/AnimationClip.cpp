@@ -9,7 +9,7 @@
 
 namespace Arcane
 {
-	AnimationClip::AnimationClip(const std::string &animationPath, int animationIndex, Model *model) : m_Model(model)
+	AnimationClip::AnimationClip(const std::string &animationPath, int animationIndex, Model *model, const AnimationCompressionSettings &compressionSettings)
 	{
 		Assimp::Importer importer;
 		const aiScene *scene = importer.ReadFile(animationPath, aiProcess_Triangulate);
@@ -22,10 +22,48 @@ namespace Arcane
 #endif
 		m_ClipDuration = static_cast<float>(assimpAnimation->mDuration);
 		m_TicksPerSecond = assimpAnimation->mTicksPerSecond != 0 ? static_cast<float>(assimpAnimation->mTicksPerSecond) : 1.0f;
+		m_GlobalInverseTransform = model->GetGlobalInverseTransform();
 
-		// Setup our root node bone and recursively build the others
-		ReadHierarchyData(m_RootNode, scene->mRootNode);
-		ReadMissingBones(assimpAnimation);
+		// Bones only referenced by the animation need an ID before the skeleton is flattened, then every joint knows which bone matrix it writes
+		ReadMissingBones(assimpAnimation, model);
+		ReadHierarchyData(scene->mRootNode, -1, model);
+
+		std::vector<AnimationTrackData> tracks(assimpAnimation->mNumChannels);
+		for (unsigned int i = 0; i < assimpAnimation->mNumChannels; i++)
+		{
+			const aiNodeAnim *channel = assimpAnimation->mChannels[i];
+			AnimationTrackData &track = tracks[i];
+			track.JointName = channel->mNodeName.data;
+
+			track.Positions.reserve(channel->mNumPositionKeys);
+			for (unsigned int key = 0; key < channel->mNumPositionKeys; key++)
+			{
+				const aiVector3D &aiPosition = channel->mPositionKeys[key].mValue;
+				track.Positions.push_back(KeyPosition{ glm::vec3(aiPosition.x, aiPosition.y, aiPosition.z), static_cast<float>(channel->mPositionKeys[key].mTime) });
+			}
+			track.Rotations.reserve(channel->mNumRotationKeys);
+			for (unsigned int key = 0; key < channel->mNumRotationKeys; key++)
+			{
+				const aiQuaternion &aiOrientation = channel->mRotationKeys[key].mValue;
+				track.Rotations.push_back(KeyRotation{ glm::quat(aiOrientation.w, aiOrientation.x, aiOrientation.y, aiOrientation.z), static_cast<float>(channel->mRotationKeys[key].mTime) });
+			}
+			track.Scales.reserve(channel->mNumScalingKeys);
+			for (unsigned int key = 0; key < channel->mNumScalingKeys; key++)
+			{
+				const aiVector3D &aiScale = channel->mScalingKeys[key].mValue;
+				track.Scales.push_back(KeyScale{ glm::vec3(aiScale.x, aiScale.y, aiScale.z), static_cast<float>(channel->mScalingKeys[key].mTime) });
+			}
+		}
+		BakeTracks(tracks, compressionSettings);
+
+		ARC_LOG_INFO("Animation clip {0} ({1}): {2} keys reduced to {3}, {4:.1f}KB compressed to {5:.1f}KB, max joint error {6}", animationPath, animationIndex,
+			m_CompressionStats.SourceKeyCount, m_CompressionStats.KeyCount, m_CompressionStats.SourceBytes / 1024.0, m_CompressionStats.CompressedBytes / 1024.0, m_CompressionStats.MaxJointError);
+	}
+
+	AnimationClip::AnimationClip(Skeleton &&skeleton, const std::vector<AnimationTrackData> &tracks, float duration, float ticksPerSecond, const AnimationCompressionSettings &compressionSettings)
+		: m_ClipDuration(duration), m_TicksPerSecond(ticksPerSecond), m_GlobalInverseTransform(1.0f), m_Skeleton(std::move(skeleton))
+	{
+		BakeTracks(tracks, compressionSettings);
 	}
 
 	AnimationClip::~AnimationClip()
@@ -33,28 +71,101 @@ namespace Arcane
 
 	}
 
-	Bone* AnimationClip::FindBone(const std::string &name)
+	// Finds the key at or before time, so the sample is between it and the next key. Only meant for timelines with at least two keys
+	static u32 FindKeyframe(const float *timestamps, u32 keyCount, float time, u32 &cursor)
 	{
-		auto iter = std::find_if(m_Bones.begin(), m_Bones.end(),
-			[&](const Bone& bone)
+		// A frame's worth of playback rarely moves past more than a key or two, anything further (loops, seeks, big time steps) falls back to a binary search
+		const u32 maxForwardSteps = 4;
+		u32 key = cursor;
+		if (key < keyCount - 1 && timestamps[key] <= time)
+		{
+			u32 steps = 0;
+			while (key < keyCount - 2 && timestamps[key + 1] <= time && steps < maxForwardSteps)
 			{
-				return bone.GetName() == name;
+				key++;
+				steps++;
 			}
-		);
+			if (key >= keyCount - 2 || time < timestamps[key + 1])
+			{
+				cursor = key;
+				return key;
+			}
+		}
 
-		// If we didn't find just return nullptr
-		if (iter == m_Bones.end()) return nullptr;
-		
-		// Otherwise we found it
-		return &(*iter);
+		const float *upper = std::upper_bound(timestamps, timestamps + keyCount, time);
+		key = static_cast<u32>(glm::clamp(static_cast<int>(upper - timestamps) - 1, 0, static_cast<int>(keyCount) - 2));
+		cursor = key;
+		return key;
 	}
 
-	void AnimationClip::ReadMissingBones(aiAnimation *assimpAnimation)
+	// Where every timeline is at for the sample being taken, shared by every channel on it
+	struct TimelineSample
+	{
+		u32 Key;
+		u32 NextKeyOffset; // 0 for timelines with a single key so the same lookup works for them
+		float Amount;
+	};
+	static thread_local std::vector<TimelineSample> s_TimelineSamples;
+
+	void AnimationClip::SamplePose(float time, u32 *keyframeCursors, AnimationPose &outPose) const
+	{
+		ARC_ASSERT(outPose.GetJointCount() == m_Skeleton.GetJointCount(), "Pose was not made for this clip's skeleton");
+
+		s_TimelineSamples.resize(m_Timelines.size());
+		for (u32 i = 0; i < static_cast<u32>(m_Timelines.size()); i++)
+		{
+			const AnimationTimeline &timeline = m_Timelines[i];
+			TimelineSample &sample = s_TimelineSamples[i];
+			if (timeline.KeyCount == 1)
+			{
+				sample = TimelineSample{ 0, 0, 0.0f };
+				continue;
+			}
+
+			const float *timestamps = &m_Timestamps[timeline.FirstTimestamp];
+			u32 key = FindKeyframe(timestamps, timeline.KeyCount, time, keyframeCursors[i]);
+			float amount = glm::clamp((time - timestamps[key]) / (timestamps[key + 1] - timestamps[key]), 0.0f, 1.0f);
+			sample = TimelineSample{ key, 1, amount };
+		}
+
+		const AnimationPose &bindPose = m_Skeleton.GetBindPose();
+		for (u32 jointIndex : m_UntrackedJoints)
+		{
+			outPose.Translations[jointIndex] = bindPose.Translations[jointIndex];
+			outPose.Rotations[jointIndex] = bindPose.Rotations[jointIndex];
+			outPose.Scales[jointIndex] = bindPose.Scales[jointIndex];
+		}
+
+		// Keys are decompressed on the fly, only the two around the sample time are ever touched
+		for (const AnimationTrack &track : m_Tracks)
+		{
+			const TimelineSample &positionSample = s_TimelineSamples[track.PositionTimeline];
+			const QuantizedVector *positions = &m_PositionKeys[track.FirstPositionKey + positionSample.Key];
+			glm::vec3 position = DequantizeVector(positions[0], track.PositionRange), nextPosition = DequantizeVector(positions[positionSample.NextKeyOffset], track.PositionRange);
+			outPose.Translations[track.JointIndex] = glm::mix(position, nextPosition, positionSample.Amount);
+
+			// Normalized lerp instead of slerp, the keys are close enough together that the difference isn't visible and it avoids the trig. Quantizing loses
+			// which hemisphere a key was in, so the next key is flipped over to take the short way around
+			const TimelineSample &rotationSample = s_TimelineSamples[track.RotationTimeline];
+			const QuantizedRotation *rotations = &m_RotationKeys[track.FirstRotationKey + rotationSample.Key];
+			glm::quat rotation = DequantizeRotation(rotations[0]), nextRotation = DequantizeRotation(rotations[rotationSample.NextKeyOffset]);
+			if (glm::dot(rotation, nextRotation) < 0.0f)
+				nextRotation = -nextRotation;
+			outPose.Rotations[track.JointIndex] = glm::normalize(rotation * (1.0f - rotationSample.Amount) + nextRotation * rotationSample.Amount);
+
+			const TimelineSample &scaleSample = s_TimelineSamples[track.ScaleTimeline];
+			const QuantizedVector *scales = &m_ScaleKeys[track.FirstScaleKey + scaleSample.Key];
+			glm::vec3 scale = DequantizeVector(scales[0], track.ScaleRange), nextScale = DequantizeVector(scales[scaleSample.NextKeyOffset], track.ScaleRange);
+			outPose.Scales[track.JointIndex] = glm::mix(scale, nextScale, scaleSample.Amount);
+		}
+	}
+
+	void AnimationClip::ReadMissingBones(aiAnimation *assimpAnimation, Model *model)
 	{
 		int size = assimpAnimation->mNumChannels;
 
-		auto boneInfoMap = m_Model->GetBoneDataMap();
-		int &boneCount = m_Model->GetBoneCountRef();
+		auto boneInfoMap = model->GetBoneDataMap();
+		int &boneCount = model->GetBoneCountRef();
 
 		// Sometimes we miss bones, so this function will find any other bones engaged in the animation and add them. Assimp struggles..
 		for (int i = 0; i < size; i++)
@@ -66,24 +177,222 @@ namespace Arcane
 			{
 				(*boneInfoMap)[boneName].boneID = boneCount++;
 			}
-			m_Bones.push_back(Bone(channel->mNodeName.data, (*boneInfoMap)[channel->mNodeName.data].boneID, channel));
 		}
 	}
 
-	void AnimationClip::ReadHierarchyData(AssimpBoneData &dest, const aiNode *src)
+	void AnimationClip::ReadHierarchyData(const aiNode *node, int parentIndex, Model *model)
+	{
+		ARC_ASSERT(node, "Needs src data to read in AnimationClip");
+
+		std::string name = node->mName.data;
+		int boneID = -1;
+		glm::mat4 inverseBindPose(1.0f);
+		auto boneDataMap = model->GetBoneDataMap();
+		auto iter = boneDataMap->find(name);
+		if (iter != boneDataMap->end())
+		{
+			boneID = iter->second.boneID;
+			inverseBindPose = iter->second.inverseBindPose;
+		}
+
+		// Depth first, so every joint is added after its parent
+		u32 jointIndex = m_Skeleton.AddJoint(name, parentIndex, Model::ConvertAssimpMatrixToGLM(node->mTransformation), boneID, inverseBindPose);
+		for (unsigned int i = 0; i < node->mNumChildren; i++)
+		{
+			ReadHierarchyData(node->mChildren[i], static_cast<int>(jointIndex), model);
+		}
+	}
+
+	void AnimationClip::BakeTracks(const std::vector<AnimationTrackData> &tracks, const AnimationCompressionSettings &compressionSettings)
+	{
+		std::map<std::vector<float>, u32> timelineLookup;
+		std::vector<float> timestamps, keptTimestamps;
+		std::vector<glm::vec3> vectorValues;
+		std::vector<glm::quat> rotationValues;
+		std::vector<u32> keptKeys;
+		std::vector<bool> isJointTracked(m_Skeleton.GetJointCount(), false);
+		m_Tracks.clear();
+		m_Tracks.reserve(tracks.size());
+		m_CompressionStats = {};
+
+		// Keys that survive reduction get their timestamp put into the channel's timeline
+		auto addKeptTimeline = [&]()
+		{
+			keptTimestamps.clear();
+			for (u32 key : keptKeys)
+				keptTimestamps.push_back(timestamps[key]);
+			m_CompressionStats.KeyCount += static_cast<u32>(keptKeys.size());
+			return AddTimeline(keptTimestamps, timelineLookup);
+		};
+		auto reduceAllKeys = [&](size_t count)
+		{
+			keptKeys.resize(count);
+			for (u32 i = 0; i < count; i++)
+				keptKeys[i] = i;
+		};
+
+		for (const AnimationTrackData &trackData : tracks)
+		{
+			// Channels that don't match a node have nothing to drive, looking the joint up here means sampling never deals with names
+			int jointIndex = m_Skeleton.FindJoint(trackData.JointName);
+			if (jointIndex < 0 || isJointTracked[jointIndex] || trackData.Positions.empty() || trackData.Rotations.empty() || trackData.Scales.empty())
+			{
+				ARC_LOG_WARN("Animation channel {0} has no joint to drive or no keys, skipping it", trackData.JointName);
+				continue;
+			}
+			isJointTracked[jointIndex] = true;
+
+			AnimationTrack track;
+			track.JointIndex = static_cast<u32>(jointIndex);
+			m_CompressionStats.SourceKeyCount += static_cast<u32>(trackData.Positions.size() + trackData.Rotations.size() + trackData.Scales.size());
+			m_CompressionStats.SourceBytes += trackData.Positions.size() * sizeof(KeyPosition) + trackData.Rotations.size() * sizeof(KeyRotation) + trackData.Scales.size() * sizeof(KeyScale);
+
+			timestamps.clear();
+			vectorValues.clear();
+			for (const KeyPosition &key : trackData.Positions)
+			{
+				timestamps.push_back(key.timestamp);
+				vectorValues.push_back(key.position);
+			}
+			track.PositionRange = ComputeQuantizationRange(vectorValues.data(), vectorValues.size());
+			if (compressionSettings.ReduceKeyframes)
+				ReduceVectorKeys(timestamps.data(), vectorValues.data(), vectorValues.size(), track.PositionRange, compressionSettings.MaxTranslationError, keptKeys);
+			else
+				reduceAllKeys(vectorValues.size());
+			track.FirstPositionKey = static_cast<u32>(m_PositionKeys.size());
+			for (u32 key : keptKeys)
+				m_PositionKeys.push_back(QuantizeVector(vectorValues[key], track.PositionRange));
+			track.PositionTimeline = addKeptTimeline();
+
+			timestamps.clear();
+			rotationValues.clear();
+			for (const KeyRotation &key : trackData.Rotations)
+			{
+				timestamps.push_back(key.timestamp);
+				rotationValues.push_back(glm::normalize(key.orientation));
+			}
+			if (compressionSettings.ReduceKeyframes)
+				ReduceRotationKeys(timestamps.data(), rotationValues.data(), rotationValues.size(), compressionSettings.MaxRotationError, keptKeys);
+			else
+				reduceAllKeys(rotationValues.size());
+			track.FirstRotationKey = static_cast<u32>(m_RotationKeys.size());
+			for (u32 key : keptKeys)
+				m_RotationKeys.push_back(QuantizeRotation(rotationValues[key]));
+			track.RotationTimeline = addKeptTimeline();
+
+			timestamps.clear();
+			vectorValues.clear();
+			for (const KeyScale &key : trackData.Scales)
+			{
+				timestamps.push_back(key.timestamp);
+				vectorValues.push_back(key.scale);
+			}
+			track.ScaleRange = ComputeQuantizationRange(vectorValues.data(), vectorValues.size());
+			if (compressionSettings.ReduceKeyframes)
+				ReduceVectorKeys(timestamps.data(), vectorValues.data(), vectorValues.size(), track.ScaleRange, compressionSettings.MaxScaleError, keptKeys);
+			else
+				reduceAllKeys(vectorValues.size());
+			track.FirstScaleKey = static_cast<u32>(m_ScaleKeys.size());
+			for (u32 key : keptKeys)
+				m_ScaleKeys.push_back(QuantizeVector(vectorValues[key], track.ScaleRange));
+			track.ScaleTimeline = addKeptTimeline();
+
+			m_Tracks.push_back(track);
+		}
+
+		m_UntrackedJoints.clear();
+		for (u32 i = 0; i < m_Skeleton.GetJointCount(); i++)
+		{
+			if (!isJointTracked[i])
+				m_UntrackedJoints.push_back(i);
+		}
+
+		m_CompressionStats.CompressedBytes = m_Tracks.size() * sizeof(AnimationTrack) + m_UntrackedJoints.size() * sizeof(u32) + m_Timelines.size() * sizeof(AnimationTimeline) +
+			m_Timestamps.size() * sizeof(float) + m_PositionKeys.size() * sizeof(QuantizedVector) + m_RotationKeys.size() * sizeof(QuantizedRotation) + m_ScaleKeys.size() * sizeof(QuantizedVector);
+		m_CompressionStats.MaxJointError = MeasureMaxJointError(tracks);
+	}
+
+	u32 AnimationClip::AddTimeline(const std::vector<float> &timestamps, std::map<std::vector<float>, u32> &timelineLookup)
+	{
+		auto iter = timelineLookup.find(timestamps);
+		if (iter != timelineLookup.end())
+			return iter->second;
+
+		u32 timelineIndex = static_cast<u32>(m_Timelines.size());
+		m_Timelines.push_back(AnimationTimeline{ static_cast<u32>(m_Timestamps.size()), static_cast<u32>(timestamps.size()) });
+		m_Timestamps.insert(m_Timestamps.end(), timestamps.begin(), timestamps.end());
+		timelineLookup[timestamps] = timelineIndex;
+		return timelineIndex;
+	}
+
+	// Interpolates the imported keys the same way the sampler does, without any of the compression
+	template<typename Key, typename Value, typename Interpolate>
+	static Value SampleSourceKeys(const std::vector<Key> &keys, Value Key::*value, float time, Interpolate interpolate)
+	{
+		if (keys.size() == 1)
+			return keys[0].*value;
+
+		auto upper = std::upper_bound(keys.begin(), keys.end(), time, [](float t, const Key &key) { return t < key.timestamp; });
+		size_t next = glm::clamp(static_cast<size_t>(upper - keys.begin()), static_cast<size_t>(1), keys.size() - 1);
+		const Key &key = keys[next - 1], &nextKey = keys[next];
+		float length = nextKey.timestamp - key.timestamp;
+		float amount = length > 0.0f ? glm::clamp((time - key.timestamp) / length, 0.0f, 1.0f) : 0.0f;
+		return interpolate(key.*value, nextKey.*value, amount);
+	}
+
+	float AnimationClip::MeasureMaxJointError(const std::vector<AnimationTrackData> &tracks)
 	{
-		ARC_ASSERT(src, "Needs src data to read in AnimationClip");
+		// Every time any channel had a key at is checked, which is where the reduction is most likely to have moved something
+		std::set<float> sampleTimes;
+		std::vector<std::pair<u32, const AnimationTrackData*>> jointTracks;
+		std::vector<bool> isJointTracked(m_Skeleton.GetJointCount(), false);
+		for (const AnimationTrackData &trackData : tracks)
+		{
+			int jointIndex = m_Skeleton.FindJoint(trackData.JointName);
+			if (jointIndex < 0 || isJointTracked[jointIndex] || trackData.Positions.empty() || trackData.Rotations.empty() || trackData.Scales.empty())
+				continue;
+			isJointTracked[jointIndex] = true;
+
+			jointTracks.push_back({ static_cast<u32>(jointIndex), &trackData });
+			for (const KeyPosition &key : trackData.Positions) sampleTimes.insert(key.timestamp);
+			for (const KeyRotation &key : trackData.Rotations) sampleTimes.insert(key.timestamp);
+			for (const KeyScale &key : trackData.Scales) sampleTimes.insert(key.timestamp);
+		}
+
+		u32 jointCount = m_Skeleton.GetJointCount();
+		AnimationPose sourcePose, compressedPose;
+		sourcePose.Resize(jointCount);
+		compressedPose.Resize(jointCount);
+		std::vector<glm::mat4> sourceModelSpace(jointCount), compressedModelSpace(jointCount), boneMatrices(MaxBonesPerModel);
+		std::vector<u32> keyframeCursors(m_Timelines.size(), 0);
 
-		dest.name = src->mName.data;
-		dest.transformation = Model::ConvertAssimpMatrixToGLM(src->mTransformation);
-		dest.childCount = src->mNumChildren;
-		dest.children.reserve(dest.childCount);
+		auto lerpVectors = [](const glm::vec3 &a, const glm::vec3 &b, float amount) { return glm::mix(a, b, amount); };
+		auto nlerpRotations = [](const glm::quat &a, const glm::quat &b, float amount)
+		{
+			glm::quat end = glm::dot(a, b) < 0.0f ? -b : b;
+			return glm::normalize(a * (1.0f - amount) + end * amount);
+		};
 
-		for (unsigned int i = 0; i < src->mNumChildren; i++)
+		float maxError = 0.0f;
+		for (float time : sampleTimes)
 		{
-			AssimpBoneData newData;
-			ReadHierarchyData(newData, src->mChildren[i]);
-			dest.children.push_back(newData);
+			sourcePose = m_Skeleton.GetBindPose();
+			for (const auto &jointTrack : jointTracks)
+			{
+				const AnimationTrackData &trackData = *jointTrack.second;
+				sourcePose.Translations[jointTrack.first] = SampleSourceKeys(trackData.Positions, &KeyPosition::position, time, lerpVectors);
+				sourcePose.Rotations[jointTrack.first] = glm::normalize(SampleSourceKeys(trackData.Rotations, &KeyRotation::orientation, time, nlerpRotations));
+				sourcePose.Scales[jointTrack.first] = SampleSourceKeys(trackData.Scales, &KeyScale::scale, time, lerpVectors);
+			}
+			SamplePose(time, keyframeCursors.data(), compressedPose);
+
+			m_Skeleton.ComputeBoneMatrices(sourcePose, m_GlobalInverseTransform, sourceModelSpace.data(), boneMatrices.data());
+			m_Skeleton.ComputeBoneMatrices(compressedPose, m_GlobalInverseTransform, compressedModelSpace.data(), boneMatrices.data());
+			for (u32 i = 0; i < jointCount; i++)
+			{
+				maxError = glm::max(maxError, glm::length(glm::vec3(sourceModelSpace[i][3]) - glm::vec3(compressedModelSpace[i][3])));
+			}
 		}
+		return maxError;
 	}
 }
@@ -2,61 +2,121 @@
 #ifndef ANIMATIONCLIP_H
 #define ANIMATIONCLIP_H
 
-#ifndef BONE_H
-#include <Arcane/Animation/Bone.h>
+#ifndef SKELETON_H
+#include <Arcane/Animation/Skeleton.h>
 #endif
 
-#ifndef MODEL_H
-#include <Arcane/Graphics/Mesh/Model.h>
-#endif
-
-#ifndef AI_ANIM_H_INC
-#include "assimp/anim.h"
+#ifndef ANIMATIONCOMPRESSION_H
+#include <Arcane/Animation/AnimationCompression.h>
 #endif
 
 struct aiNode;
+struct aiAnimation;
 
 namespace Arcane
 {
 	class Model;
 
-	struct AssimpBoneData
+	struct KeyPosition
+	{
+		glm::vec3 position;
+		float timestamp;
+	};
+
+	struct KeyRotation
 	{
-		glm::mat4 transformation;
-		std::string name;
-		int childCount;
-		std::vector<AssimpBoneData> children;
+		glm::quat orientation;
+		float timestamp;
+	};
+
+	struct KeyScale
+	{
+		glm::vec3 scale;
+		float timestamp;
+	};
+
+	// Keyframes of one animated joint as they come out of the importer, they are compressed into the clip's tracks and not kept around
+	struct AnimationTrackData
+	{
+		std::string JointName;
+		std::vector<KeyPosition> Positions;
+		std::vector<KeyRotation> Rotations;
+		std::vector<KeyScale> Scales;
+	};
+
+	struct AnimationCompressionStats
+	{
+		u32 SourceKeyCount, KeyCount; // Position, rotation and scale keys before and after keyframe reduction
+		size_t SourceBytes; // What the keys took up as imported (full vec3/quat plus a timestamp each)
+		size_t CompressedBytes; // Everything the clip needs to be sampled, other than the skeleton
+		float MaxJointError; // Furthest any joint ended up from where the imported keys put it in model space, over every source key time
 	};
 
 	class AnimationClip
 	{
 	public:
-		AnimationClip(const std::string &animationPath, int animationIndex, Model *model);
+		AnimationClip(const std::string &animationPath, int animationIndex, Model *model, const AnimationCompressionSettings &compressionSettings = AnimationCompressionSettings());
+		AnimationClip(Skeleton &&skeleton, const std::vector<AnimationTrackData> &tracks, float duration, float ticksPerSecond, const AnimationCompressionSettings &compressionSettings = AnimationCompressionSettings());
 		~AnimationClip();
 
-		Bone* FindBone(const std::string &name);
+		// Writes every joint's local transform at the given time (in ticks) into outPose. keyframeCursors needs an entry per timeline, they remember where the
+		// keys were found last time since playback mostly moves forward and the next sample usually starts at the same key. Start them at 0
+		void SamplePose(float time, u32 *keyframeCursors, AnimationPose &outPose) const;
 
-		inline float GetDuration() { return m_ClipDuration; }
-		inline float GetTicksPerSecond() { return m_TicksPerSecond; }
-		inline const AssimpBoneData* GetRootBone() const { return &m_RootNode; }
-		inline auto* GetBoneDataMap() { return m_Model->GetBoneDataMap(); }
-		inline const auto& GetGlobalInverseTransform() const { return m_Model->GetGlobalInverseTransform(); }
+		inline float GetDuration() const { return m_ClipDuration; }
+		inline float GetTicksPerSecond() const { return m_TicksPerSecond; }
+		inline const Skeleton& GetSkeleton() const { return m_Skeleton; }
+		inline u32 GetTrackCount() const { return static_cast<u32>(m_Tracks.size()); }
+		inline u32 GetTimelineCount() const { return static_cast<u32>(m_Timelines.size()); }
+		inline const glm::mat4& GetGlobalInverseTransform() const { return m_GlobalInverseTransform; }
+		inline const AnimationCompressionStats& GetCompressionStats() const { return m_CompressionStats; }
 #if !ARC_FINAL
 		std::string GetAnimationName() { return m_AnimationName; }
 #endif
 	private:
-		void ReadMissingBones(aiAnimation *assimpAnimation);
-		void ReadHierarchyData(AssimpBoneData &dest, const aiNode *src);
+		// Timestamps are stored apart from the key values and shared between every channel with identical ones. Exported clips are usually sampled at a fixed
+		// rate for every joint, so without keyframe reduction the key search only has to run once per timeline instead of once per channel. Reduced channels
+		// mostly end up with their own timeline, other than the ones that were reduced to a single key
+		struct AnimationTimeline
+		{
+			u32 FirstTimestamp, KeyCount;
+		};
+
+		// Values of each channel are stored back to back in the clip's key arrays. Positions and scales are quantized relative to the range the channel covers
+		struct AnimationTrack
+		{
+			u32 JointIndex;
+			u32 FirstPositionKey, PositionTimeline;
+			u32 FirstRotationKey, RotationTimeline;
+			u32 FirstScaleKey, ScaleTimeline;
+			QuantizationRange PositionRange, ScaleRange;
+		};
+
+		void ReadMissingBones(aiAnimation *assimpAnimation, Model *model);
+		void ReadHierarchyData(const aiNode *node, int parentIndex, Model *model);
+		void BakeTracks(const std::vector<AnimationTrackData> &tracks, const AnimationCompressionSettings &compressionSettings);
+		u32 AddTimeline(const std::vector<float> &timestamps, std::map<std::vector<float>, u32> &timelineLookup);
+		float MeasureMaxJointError(const std::vector<AnimationTrackData> &tracks);
 	private:
 		float m_ClipDuration;
 		float m_TicksPerSecond;
-		std::vector<Bone> m_Bones;
-		AssimpBoneData m_RootNode;
+		glm::mat4 m_GlobalInverseTransform;
+
+		Skeleton m_Skeleton;
+		std::vector<AnimationTrack> m_Tracks;
+		std::vector<u32> m_UntrackedJoints; // Joints that stay in their bind pose
+
+		std::vector<AnimationTimeline> m_Timelines;
+		std::vector<float> m_Timestamps;
+		std::vector<QuantizedVector> m_PositionKeys;
+		std::vector<QuantizedRotation> m_RotationKeys;
+		std::vector<QuantizedVector> m_ScaleKeys;
+
+		AnimationCompressionStats m_CompressionStats = {};
 
 #if !ARC_FINAL
 		std::string m_AnimationName;
 #endif
-		Model *m_Model;
 	};
 }
 #endif
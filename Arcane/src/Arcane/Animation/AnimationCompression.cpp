@@ -0,0 +1,166 @@
+#include "arcpch.h"
+#include "AnimationCompression.h"
+
+namespace Arcane
+{
+	QuantizationRange ComputeQuantizationRange(const glm::vec3 *values, size_t count)
+	{
+		glm::vec3 minValue(std::numeric_limits<float>::max()), maxValue(std::numeric_limits<float>::lowest());
+		for (size_t i = 0; i < count; i++)
+		{
+			minValue = glm::min(minValue, values[i]);
+			maxValue = glm::max(maxValue, values[i]);
+		}
+		return QuantizationRange{ minValue, (maxValue - minValue) / 65535.0f };
+	}
+
+	QuantizedVector QuantizeVector(const glm::vec3 &value, const QuantizationRange &range)
+	{
+		// Components that never change have a step of 0, every key of them is stored as 0
+		glm::vec3 normalized(0.0f);
+		for (int i = 0; i < 3; i++)
+		{
+			if (range.Step[i] > 0.0f)
+				normalized[i] = glm::clamp(std::round((value[i] - range.Min[i]) / range.Step[i]), 0.0f, 65535.0f);
+		}
+		return QuantizedVector{ static_cast<u16>(normalized.x), static_cast<u16>(normalized.y), static_cast<u16>(normalized.z) };
+	}
+
+	QuantizedRotation QuantizeRotation(const glm::quat &rotation)
+	{
+		float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+		u32 droppedComponent = 0;
+		for (u32 i = 1; i < 4; i++)
+		{
+			if (std::abs(components[i]) > std::abs(components[droppedComponent]))
+				droppedComponent = i;
+		}
+
+		// q and -q are the same rotation, flipping it so the dropped component is positive means its sign doesn't have to be stored
+		float sign = components[droppedComponent] < 0.0f ? -1.0f : 1.0f;
+		u16 stored[3];
+		for (u32 i = 0, j = 0; i < 4; i++)
+		{
+			if (i == droppedComponent)
+				continue;
+
+			float normalized = (components[i] * sign + 0.70710678f) / 1.41421356f;
+			stored[j++] = static_cast<u16>(glm::clamp(std::round(normalized * 32767.0f), 0.0f, 32767.0f));
+		}
+
+		return QuantizedRotation{ static_cast<u16>(stored[0] | ((droppedComponent >> 1) << 15)), static_cast<u16>(stored[1] | ((droppedComponent & 1) << 15)), stored[2] };
+	}
+
+	// Shared by both reductions, errorAt(first, last, key) returns how far off interpolating between the two kept keys is at key
+	template<typename ErrorFunction>
+	static void ReduceKeys(size_t count, float maxError, ErrorFunction errorAt, std::vector<u32> &outKeptKeys)
+	{
+		outKeptKeys.clear();
+		if (count <= 2)
+		{
+			for (u32 i = 0; i < count; i++)
+				outKeptKeys.push_back(i);
+			return;
+		}
+
+		std::vector<bool> isKept(count, false);
+		isKept[0] = isKept[count - 1] = true;
+
+		// Explicit stack instead of recursion, long mocap clips can have thousands of keys in a channel
+		std::vector<std::pair<u32, u32>> segments;
+		segments.push_back({ 0, static_cast<u32>(count - 1) });
+		while (!segments.empty())
+		{
+			std::pair<u32, u32> segment = segments.back();
+			segments.pop_back();
+
+			float worstError = maxError;
+			u32 worstKey = 0;
+			for (u32 key = segment.first + 1; key < segment.second; key++)
+			{
+				float error = errorAt(segment.first, segment.second, key);
+				if (error > worstError)
+				{
+					worstError = error;
+					worstKey = key;
+				}
+			}
+
+			if (worstKey != 0)
+			{
+				isKept[worstKey] = true;
+				segments.push_back({ segment.first, worstKey });
+				segments.push_back({ worstKey, segment.second });
+			}
+		}
+
+		for (u32 i = 0; i < count; i++)
+		{
+			if (isKept[i])
+				outKeptKeys.push_back(i);
+		}
+	}
+
+	static inline float GetInterpolationAmount(const float *timestamps, u32 first, u32 last, u32 key)
+	{
+		float length = timestamps[last] - timestamps[first];
+		return length > 0.0f ? (timestamps[key] - timestamps[first]) / length : 0.0f;
+	}
+
+	static inline float GetAngleBetween(const glm::quat &a, const glm::quat &b)
+	{
+		// acos of the dot product can't resolve angles this small in floats (anything under ~0.0005 radians comes out as 0), the length of the difference's
+		// vector part can
+		glm::quat difference = glm::conjugate(a) * b;
+		return 2.0f * std::atan2(glm::length(glm::vec3(difference.x, difference.y, difference.z)), std::abs(difference.w));
+	}
+
+	void ReduceVectorKeys(const float *timestamps, const glm::vec3 *values, size_t count, const QuantizationRange &range, float maxError, std::vector<u32> &outKeptKeys)
+	{
+		std::vector<glm::vec3> quantizedValues(count);
+		bool isConstant = true;
+		for (size_t i = 0; i < count; i++)
+		{
+			quantizedValues[i] = DequantizeVector(QuantizeVector(values[i], range), range);
+			isConstant &= glm::length(quantizedValues[0] - values[i]) <= maxError;
+		}
+
+		if (isConstant)
+		{
+			outKeptKeys.assign(1, 0);
+			return;
+		}
+
+		ReduceKeys(count, maxError, [&](u32 first, u32 last, u32 key)
+		{
+			glm::vec3 interpolated = glm::mix(quantizedValues[first], quantizedValues[last], GetInterpolationAmount(timestamps, first, last, key));
+			return glm::length(interpolated - values[key]);
+		}, outKeptKeys);
+	}
+
+	void ReduceRotationKeys(const float *timestamps, const glm::quat *values, size_t count, float maxError, std::vector<u32> &outKeptKeys)
+	{
+		std::vector<glm::quat> quantizedValues(count);
+		bool isConstant = true;
+		for (size_t i = 0; i < count; i++)
+		{
+			quantizedValues[i] = DequantizeRotation(QuantizeRotation(values[i]));
+			isConstant &= GetAngleBetween(quantizedValues[0], values[i]) <= maxError;
+		}
+
+		if (isConstant)
+		{
+			outKeptKeys.assign(1, 0);
+			return;
+		}
+
+		// Same nlerp the sampler does, including bringing the second key into the first one's hemisphere
+		ReduceKeys(count, maxError, [&](u32 first, u32 last, u32 key)
+		{
+			float amount = GetInterpolationAmount(timestamps, first, last, key);
+			glm::quat end = glm::dot(quantizedValues[first], quantizedValues[last]) < 0.0f ? -quantizedValues[last] : quantizedValues[last];
+			glm::quat interpolated = glm::normalize(quantizedValues[first] * (1.0f - amount) + end * amount);
+			return GetAngleBetween(interpolated, values[key]);
+		}, outKeptKeys);
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef ANIMATIONCOMPRESSION_H
+#define ANIMATIONCOMPRESSION_H
+
+namespace Arcane
+{
+	// Error allowed per channel when keys are removed, in the joint's local space. Errors add up down the hierarchy, the clip reports the worst model space error it ended up with
+	struct AnimationCompressionSettings
+	{
+		bool ReduceKeyframes = USE_ANIMATION_KEYFRAME_REDUCTION;
+		float MaxTranslationError = ANIMATION_COMPRESSION_MAX_TRANSLATION_ERROR;
+		float MaxRotationError = ANIMATION_COMPRESSION_MAX_ROTATION_ERROR; // Radians
+		float MaxScaleError = ANIMATION_COMPRESSION_MAX_SCALE_ERROR;
+	};
+
+	// 16 bits per component relative to the range of the track the key belongs to
+	struct QuantizedVector
+	{
+		u16 X, Y, Z;
+	};
+
+	// Smallest three: the largest component is dropped (it can be rebuilt since the quaternion is unit length) and the other three are stored in 15 bits each.
+	// The top bits of X and Y hold which component was dropped (0 to 3 for x, y, z, w)
+	struct QuantizedRotation
+	{
+		u16 X, Y, Z;
+	};
+
+	// Range of a track's values, a quantized value q turns back into Min + q * Step
+	struct QuantizationRange
+	{
+		glm::vec3 Min;
+		glm::vec3 Step;
+	};
+
+	QuantizationRange ComputeQuantizationRange(const glm::vec3 *values, size_t count);
+	QuantizedVector QuantizeVector(const glm::vec3 &value, const QuantizationRange &range);
+	QuantizedRotation QuantizeRotation(const glm::quat &rotation);
+
+	inline glm::vec3 DequantizeVector(const QuantizedVector &value, const QuantizationRange &range)
+	{
+		return range.Min + glm::vec3(value.X, value.Y, value.Z) * range.Step;
+	}
+
+	inline glm::quat DequantizeRotation(const QuantizedRotation &rotation)
+	{
+		// The three stored components are in [-1/sqrt(2), 1/sqrt(2)] since anything bigger would have been the largest one
+		const float scale = 1.41421356f / 32767.0f, offset = -0.70710678f;
+		float a = (rotation.X & 0x7FFF) * scale + offset;
+		float b = (rotation.Y & 0x7FFF) * scale + offset;
+		float c = (rotation.Z & 0x7FFF) * scale + offset;
+		float largest = std::sqrt(glm::max(0.0f, 1.0f - a * a - b * b - c * c));
+
+		// The stored components keep their x, y, z, w order with the dropped one skipped. Which one was dropped changes from key to key, so they are put back in
+		// place with a lookup instead of a branch that would mispredict
+		static const u8 s_ComponentOrder[4][4] = { { 3, 0, 1, 2 }, { 0, 3, 1, 2 }, { 0, 1, 3, 2 }, { 0, 1, 2, 3 } };
+		const u8 *order = s_ComponentOrder[((rotation.X >> 15) << 1) | (rotation.Y >> 15)];
+		const float values[4] = { a, b, c, largest };
+		return glm::quat(values[order[3]], values[order[0]], values[order[1]], values[order[2]]);
+	}
+
+	// Douglas-Peucker style keyframe reduction. Starting from the first and last key, the key that linear interpolation (nlerp for rotations) between the kept keys
+	// reproduces worst is kept until every key is within maxError. The interpolation uses the quantized values, so the error includes the quantization. Writes the
+	// indices of the keys to keep in order, a channel that never moves further than maxError from its first key is reduced to only that key
+	void ReduceVectorKeys(const float *timestamps, const glm::vec3 *values, size_t count, const QuantizationRange &range, float maxError, std::vector<u32> &outKeptKeys);
+	void ReduceRotationKeys(const float *timestamps, const glm::quat *values, size_t count, float maxError, std::vector<u32> &outKeptKeys);
+}
+#endif
@@ -4,8 +4,8 @@
 
 namespace Arcane
 {
-	constexpr int MaxBonesPerModel = 100; // Also will need to be adjusted in the appropriate skinned shaders
-	constexpr int MaxBonesPerVertex = 4; // Also will need to be adjusted in the appropriate skinned shaders
+	constexpr int MaxBonesPerModel = 100; // Injected into the shaders as MAX_BONES
+	constexpr int MaxBonesPerVertex = 4; // Injected into the shaders as MAX_BONES_PER_VERTEX, the skinning include still reads exactly four
 
 	// Data structure used for loading bone data from assimp and storing into our vertex buffers
 	struct VertexBoneData
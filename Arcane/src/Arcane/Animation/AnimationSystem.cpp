@@ -0,0 +1,94 @@
+#include "arcpch.h"
+#include "AnimationSystem.h"
+
+#include <Arcane/Animation/PoseAnimator.h>
+
+namespace Arcane
+{
+	AnimationSystem::AnimationSystem() : m_JobSystem(JobSystem::GetInstance()), m_Deterministic(USE_DETERMINISTIC_ANIMATION_UPDATE)
+	{}
+
+	AnimationSystem::~AnimationSystem()
+	{
+		// Jobs still running would write into animators that are about to be destroyed
+		EndUpdate();
+	}
+
+	void AnimationSystem::BeginUpdate(PoseAnimator *const *animators, size_t animatorCount, float deltaTime)
+	{
+		ARC_ASSERT(!m_PendingUpdate, "BeginUpdate was called again before the last update was ended");
+
+		auto begin = std::chrono::steady_clock::now();
+		size_t jobCount = (animatorCount + ANIMATION_ANIMATORS_PER_JOB - 1) / ANIMATION_ANIMATORS_PER_JOB;
+		if (m_MaxJobCount > 0)
+			jobCount = glm::min(jobCount, static_cast<size_t>(m_MaxJobCount));
+
+		if (m_Deterministic || jobCount <= 1)
+		{
+			for (size_t i = 0; i < animatorCount; i++)
+			{
+				animators[i]->UpdateAnimation(deltaTime);
+			}
+			jobCount = 0;
+		}
+		else
+		{
+			// Spread the remainder over the first chunks so no job ends up with much more work than the others
+			std::shared_ptr<AnimationUpdate> update = std::make_shared<AnimationUpdate>();
+			size_t chunkSize = animatorCount / jobCount, remainder = animatorCount % jobCount;
+			size_t first = 0;
+			update->Chunks.reserve(jobCount);
+			for (size_t job = 0; job < jobCount; job++)
+			{
+				size_t last = first + chunkSize + (job < remainder ? 1 : 0);
+				update->Chunks.emplace_back(first, last);
+				first = last;
+			}
+			update->Animators = animators;
+			update->DeltaTime = deltaTime;
+
+			// Jobs claim chunks instead of owning one, so the chunks a worker hasn't picked up yet can be run by EndUpdate. A job that only gets to run after
+			// every chunk was claimed finds nothing left and only touches the update it holds on to
+			for (size_t job = 0; job < jobCount; job++)
+			{
+				m_JobSystem.Submit([update]() { RunChunks(*update); }, JobPriority::High);
+			}
+			m_PendingUpdate = std::move(update);
+		}
+
+		m_Stats.AnimatorCount = static_cast<u32>(animatorCount);
+		m_Stats.JobCount = static_cast<u32>(jobCount);
+		m_Stats.KickMS = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		m_Stats.WaitMS = 0.0f;
+	}
+
+	void AnimationSystem::EndUpdate()
+	{
+		if (!m_PendingUpdate)
+			return;
+
+		// This thread runs whatever chunks are still unclaimed instead of idling, then waits on the chunks rather than the jobs. JobSystem::Wait would pick up any
+		// queued job and a job can sit behind an unrelated long one (asset IO etc), either way the frame would stall on work that isn't animation
+		auto begin = std::chrono::steady_clock::now();
+		AnimationUpdate &update = *m_PendingUpdate;
+		RunChunks(update);
+		while (update.CompletedChunks.load(std::memory_order_acquire) < update.Chunks.size())
+		{
+			std::this_thread::yield();
+		}
+		m_PendingUpdate.reset();
+		m_Stats.WaitMS = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	void AnimationSystem::RunChunks(AnimationUpdate &update)
+	{
+		for (size_t chunk = update.NextChunk.fetch_add(1, std::memory_order_relaxed); chunk < update.Chunks.size(); chunk = update.NextChunk.fetch_add(1, std::memory_order_relaxed))
+		{
+			for (size_t i = update.Chunks[chunk].first; i < update.Chunks[chunk].second; i++)
+			{
+				update.Animators[i]->UpdateAnimation(update.DeltaTime);
+			}
+			update.CompletedChunks.fetch_add(1, std::memory_order_release);
+		}
+	}
+}
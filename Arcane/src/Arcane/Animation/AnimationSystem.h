@@ -0,0 +1,68 @@
+#pragma once
+#ifndef ANIMATIONSYSTEM_H
+#define ANIMATIONSYSTEM_H
+
+#ifndef JOBSYSTEM_H
+#include <Arcane/Core/Threads/JobSystem.h>
+#endif
+
+namespace Arcane
+{
+	class PoseAnimator;
+
+	struct AnimationSystemStats
+	{
+		u32 AnimatorCount;
+		u32 JobCount;
+		float KickMS; // Time the calling thread spent submitting the jobs (or doing all of the work when the update is deterministic)
+		float WaitMS; // Time the calling thread spent blocked at the sync point, it helps with the remaining jobs during this time
+	};
+
+	// Updates a batch of animators on the job system. They are split into chunks that run as separate jobs, each animator only touches its own clip cursors and
+	// bone palette so the chunks don't need to synchronize with each other. The palettes are only safe to read (by the renderer etc) after EndUpdate returns
+	class AnimationSystem
+	{
+	public:
+		AnimationSystem();
+		~AnimationSystem();
+
+		// Kicks off the update and returns right away, the animators array has to stay alive and unchanged until EndUpdate
+		void BeginUpdate(PoseAnimator *const *animators, size_t animatorCount, float deltaTime);
+
+		// Sync point, blocks until every animator from BeginUpdate is done. The calling thread helps with this update's chunks but never runs other jobs
+		void EndUpdate();
+
+		inline void Update(PoseAnimator *const *animators, size_t animatorCount, float deltaTime) { BeginUpdate(animators, animatorCount, deltaTime); EndUpdate(); }
+
+		// Deterministic updates run on the calling thread in the order the animators were given
+		inline bool IsDeterministic() const { return m_Deterministic; }
+		inline void SetDeterministic(bool deterministic) { m_Deterministic = deterministic; }
+
+		// Caps how many jobs an update is split into (0 means no cap), which also caps how many cores can work on it at once
+		inline void SetMaxJobCount(u32 maxJobCount) { m_MaxJobCount = maxJobCount; }
+
+		inline const AnimationSystemStats& GetStats() const { return m_Stats; }
+	private:
+		// Shared with the jobs, which can outlive the update (and the system) when they only get to run after EndUpdate has returned
+		struct AnimationUpdate
+		{
+			std::vector<std::pair<size_t, size_t>> Chunks; // [first, last) animator ranges
+			std::atomic<size_t> NextChunk = 0;
+			std::atomic<size_t> CompletedChunks = 0;
+			PoseAnimator *const *Animators = nullptr;
+			float DeltaTime = 0.0f;
+		};
+
+		// Claims and runs chunks until there are none left, called by the jobs and by EndUpdate
+		static void RunChunks(AnimationUpdate &update);
+	private:
+		JobSystem &m_JobSystem;
+		std::shared_ptr<AnimationUpdate> m_PendingUpdate;
+
+		bool m_Deterministic;
+		u32 m_MaxJobCount = 0;
+
+		AnimationSystemStats m_Stats = {};
+	};
+}
+#endif
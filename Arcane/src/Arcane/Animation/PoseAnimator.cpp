@@ -1,67 +1,231 @@
 #include "arcpch.h"
 #include "PoseAnimator.h"
 
-#include <Arcane/Animation/AnimationClip.h>
 #include <Arcane/Animation/AnimationData.h>
 
 namespace Arcane
 {
-	PoseAnimator::PoseAnimator() 
-		: m_CurrentAnimationClip(nullptr), m_CurrentTime(0.0f), m_FinalBoneMatrices(100, glm::mat4(1.0f))
-	{}
+	// Cross-fading again while a fade is still going stacks another playback on the layer, past this many the oldest is dropped
+	static const size_t s_MaxPlaybacksPerLayer = 4;
+
+	// The local poses and model space transforms only live for the duration of an update, sharing them keeps them in cache across every animator updated on a thread
+	static thread_local AnimationPose s_LocalPose, s_LayerPose, s_PlaybackPose;
+	static thread_local std::vector<glm::mat4> s_ModelSpaceTransforms;
+
+	PoseAnimator::PoseAnimator()
+		: m_FinalBoneMatrices(MaxBonesPerModel, glm::mat4(1.0f))
+	{
+		m_Layers.push_back(AnimationLayer{ AnimationLayerBlendMode::Override, 1.0f, BoneMask(), {} });
+	}
+
+	static inline float GetFadeWeight(float fadeElapsed, float fadeDuration)
+	{
+		return fadeDuration > 0.0f ? glm::min(fadeElapsed / fadeDuration, 1.0f) : 1.0f;
+	}
 
 	void PoseAnimator::UpdateAnimation(float deltaTime)
 	{
-		// Play animation clip
-		if (m_CurrentAnimationClip)
+		const Skeleton *skeleton = GetSkeleton();
+		if (!skeleton)
+			return;
+
+		for (AnimationLayer &layer : m_Layers)
 		{
-			m_CurrentTime += m_CurrentAnimationClip->GetTicksPerSecond() * deltaTime;
-			if (m_PlayClipIndefinitely)
+			for (AnimationPlayback &playback : layer.Playbacks)
+			{
+				AdvancePlayback(playback, deltaTime);
+			}
+
+			// Once a playback has fully faded in nothing under it can be seen anymore
+			for (size_t i = layer.Playbacks.size(); i-- > 1;)
 			{
-				m_CurrentTime = fmod(m_CurrentTime, m_CurrentAnimationClip->GetDuration());
+				if (GetFadeWeight(layer.Playbacks[i].FadeElapsed, layer.Playbacks[i].FadeDuration) >= 1.0f)
+				{
+					layer.Playbacks.erase(layer.Playbacks.begin(), layer.Playbacks.begin() + i);
+					break;
+				}
 			}
+		}
+
+		// Blend every layer's local pose together, then walk the flattened skeleton once to build the bone matrices
+		s_LocalPose.Resize(skeleton->GetJointCount());
+		s_ModelSpaceTransforms.resize(skeleton->GetJointCount());
+		EvaluateLayer(m_Layers[0], s_LocalPose);
+		for (size_t i = 1; i < m_Layers.size(); i++)
+		{
+			AnimationLayer &layer = m_Layers[i];
+			if (layer.Playbacks.empty() || layer.Weight <= 0.0f)
+				continue;
 
-			CalculateBoneTransform(m_CurrentAnimationClip->GetRootBone(), glm::mat4(1.0f));
+			s_LayerPose.Resize(skeleton->GetJointCount());
+			EvaluateLayer(layer, s_LayerPose);
+			if (layer.BlendMode == AnimationLayerBlendMode::Additive)
+				ApplyAdditivePose(s_LocalPose, s_LayerPose, layer.Weight, layer.Mask.GetJointWeights());
+			else
+				BlendPoses(s_LocalPose, s_LayerPose, layer.Weight, layer.Mask.GetJointWeights(), s_LocalPose);
 		}
+
+		const AnimationPlayback &basePlayback = m_Layers[0].Playbacks.back();
+		const glm::mat4 &rootTransform = basePlayback.Clip ? basePlayback.Clip->GetGlobalInverseTransform() : basePlayback.BlendTree->GetGlobalInverseTransform();
+		skeleton->ComputeBoneMatrices(s_LocalPose, rootTransform, s_ModelSpaceTransforms.data(), m_FinalBoneMatrices.data());
 	}
 
-	void PoseAnimator::SetAnimationClip(AnimationClip *clip)
+	void PoseAnimator::AdvancePlayback(AnimationPlayback &playback, float deltaTime)
 	{
-		m_CurrentAnimationClip = clip;
-		m_CurrentTime = 0.0f;
+		playback.FadeElapsed += deltaTime;
+		if (playback.Clip)
+		{
+			playback.Time += playback.Clip->GetTicksPerSecond() * deltaTime;
+			if (m_PlayClipIndefinitely)
+			{
+				playback.Time = fmod(playback.Time, playback.Clip->GetDuration());
+			}
+			return;
+		}
+
+		// Blend trees play in normalized time, the length of a cycle changes with the parameters so the clips being blended stay in step
+		playback.ClipWeights.resize(playback.BlendTree->GetClipCount());
+		playback.BlendTree->ComputeClipWeights(playback.Parameters.data(), playback.ClipWeights.data());
+		float duration = playback.BlendTree->GetDuration(playback.ClipWeights.data());
+		if (duration > 0.0f)
+			playback.Time += deltaTime / duration;
+		playback.Time = m_PlayClipIndefinitely ? playback.Time - std::floor(playback.Time) : glm::min(playback.Time, 1.0f);
 	}
 
-	void PoseAnimator::CalculateBoneTransform(const AssimpBoneData *node, glm::mat4 parentTransform)
+	void PoseAnimator::SamplePlayback(AnimationPlayback &playback, AnimationPose &outPose)
 	{
-		const std::string &nodeName = node->name;
-		glm::mat4 nodeTransformation = node->transformation;
+		if (playback.Clip)
+			playback.Clip->SamplePose(playback.Time, playback.KeyframeCursors.data(), outPose);
+		else
+			playback.BlendTree->Evaluate(playback.Time, playback.ClipWeights.data(), playback.KeyframeCursors.data(), outPose);
+	}
 
-		// Get the current bone engaged in the animation
-		Bone *bone = m_CurrentAnimationClip->FindBone(nodeName);
-		if (bone)
+	void PoseAnimator::EvaluateLayer(AnimationLayer &layer, AnimationPose &outPose)
+	{
+		// The common case of a single clip playing samples straight into the output, each fade on top costs another sample and a lerp per joint. Additive
+		// playbacks are turned into differences before they are faded, so a fade blends between the two offsets
+		bool isAdditive = layer.BlendMode == AnimationLayerBlendMode::Additive;
+		SamplePlayback(layer.Playbacks[0], outPose);
+		if (isAdditive)
+			MakeAdditivePose(outPose, layer.Playbacks[0].AdditiveReferencePose);
+		for (size_t i = 1; i < layer.Playbacks.size(); i++)
 		{
-			// Update the bones local transform with the current keyframe(s) data when we supply it the current animation time (will blend between the keyframes)
-			bone->Update(m_CurrentTime);
-			nodeTransformation = bone->GetLocalTransform();
+			AnimationPlayback &playback = layer.Playbacks[i];
+			s_PlaybackPose.Resize(outPose.GetJointCount());
+			SamplePlayback(playback, s_PlaybackPose);
+			if (isAdditive)
+				MakeAdditivePose(s_PlaybackPose, playback.AdditiveReferencePose);
+			BlendPoses(outPose, s_PlaybackPose, GetFadeWeight(playback.FadeElapsed, playback.FadeDuration), nullptr, outPose);
 		}
+	}
 
-		// Calculate the total transformation given its parent
-		glm::mat4 globalTransformation = parentTransform * nodeTransformation;
+	void PoseAnimator::SetAnimationClip(AnimationClip *clip)
+	{
+		m_Layers[0].Playbacks.clear();
+		if (clip)
+			CrossFade(clip, 0.0f, 0);
+	}
+
+	void PoseAnimator::CrossFade(AnimationClip *clip, float fadeDuration, u32 layerIndex)
+	{
+		ARC_ASSERT(clip, "Cross-fading to a clip requires a clip");
 
-		// We need to apply the inverse bind pose to our globalTransformation. This is necessary because the model starts in bind pose
-		// and you need to animate a vertex, you need to transform it to the bone's local coordinate system, calculate the transformation and move it back into world space in the shader
-		auto boneDataMap = m_CurrentAnimationClip->GetBoneDataMap();
-		if (boneDataMap->find(nodeName) != boneDataMap->end())
+		AnimationPlayback playback;
+		playback.Clip = clip;
+		playback.KeyframeCursors.assign(clip->GetTimelineCount(), 0);
+		Play(std::move(playback), fadeDuration, layerIndex);
+	}
+
+	void PoseAnimator::CrossFade(const AnimationBlendTree *blendTree, float fadeDuration, u32 layerIndex)
+	{
+		ARC_ASSERT(blendTree && blendTree->GetClipCount() > 0, "Cross-fading to a blend tree requires a tree with clips");
+
+		AnimationPlayback playback;
+		playback.BlendTree = blendTree;
+		playback.KeyframeCursors.assign(blendTree->GetKeyframeCursorCount(), 0);
+		playback.ClipWeights.assign(blendTree->GetClipCount(), 0.0f);
+
+		// Going from a tree to itself (ie. into a different state that reuses the locomotion) shouldn't reset the parameters the game has been setting
+		const std::vector<AnimationPlayback> &playbacks = m_Layers[layerIndex].Playbacks;
+		if (!playbacks.empty() && playbacks.back().BlendTree == blendTree)
+		{
+			playback.Parameters = playbacks.back().Parameters;
+		}
+		else
 		{
-			int index = (*boneDataMap)[nodeName].boneID;
-			ARC_ASSERT(index < MaxBonesPerModel, "We exceeded the MaxBonesPerModel limit");
-			glm::mat4 inverseBindPose = (*boneDataMap)[nodeName].inverseBindPose;
-			m_FinalBoneMatrices[index] = m_CurrentAnimationClip->GetGlobalInverseTransform() * globalTransformation * inverseBindPose;
+			for (u32 i = 0; i < blendTree->GetParameterCount(); i++)
+				playback.Parameters.push_back(blendTree->GetParameterDefault(i));
 		}
+		blendTree->ComputeClipWeights(playback.Parameters.data(), playback.ClipWeights.data());
+		Play(std::move(playback), fadeDuration, layerIndex);
+	}
 
-		for (int i = 0; i < node->childCount; i++)
+	void PoseAnimator::Play(AnimationPlayback &&playback, float fadeDuration, u32 layerIndex)
+	{
+		ARC_ASSERT(layerIndex < m_Layers.size(), "Animation layer doesn't exist");
+		const Skeleton &skeleton = playback.Clip ? playback.Clip->GetSkeleton() : playback.BlendTree->GetSkeleton();
+		ARC_ASSERT(!GetSkeleton() || GetSkeleton()->GetJointCount() == skeleton.GetJointCount(), "Everything an animator plays has to be made for the same skeleton");
+
+		AnimationLayer &layer = m_Layers[layerIndex];
+		if (layer.BlendMode == AnimationLayerBlendMode::Additive)
 		{
-			CalculateBoneTransform(&node->children[i], globalTransformation);
+			// The first frame is what the rest of the animation is relative to, the cursors are reset after so playback still starts from the first key
+			playback.AdditiveReferencePose.Resize(skeleton.GetJointCount());
+			SamplePlayback(playback, playback.AdditiveReferencePose);
+			std::fill(playback.KeyframeCursors.begin(), playback.KeyframeCursors.end(), 0);
 		}
+
+		// Nothing to fade from cuts straight to it
+		playback.FadeDuration = layer.Playbacks.empty() ? 0.0f : fadeDuration;
+		playback.FadeElapsed = 0.0f;
+		if (playback.FadeDuration <= 0.0f)
+			layer.Playbacks.clear();
+		else if (layer.Playbacks.size() >= s_MaxPlaybacksPerLayer)
+			layer.Playbacks.erase(layer.Playbacks.begin());
+		layer.Playbacks.push_back(std::move(playback));
+	}
+
+	void PoseAnimator::SetBlendParameter(u32 parameter, float value, u32 layerIndex)
+	{
+		ARC_ASSERT(layerIndex < m_Layers.size(), "Animation layer doesn't exist");
+		std::vector<AnimationPlayback> &playbacks = m_Layers[layerIndex].Playbacks;
+		if (playbacks.empty() || !playbacks.back().BlendTree)
+			return;
+
+		ARC_ASSERT(parameter < playbacks.back().Parameters.size(), "Blend tree doesn't have this parameter");
+		playbacks.back().Parameters[parameter] = value;
+	}
+
+	u32 PoseAnimator::AddLayer(AnimationLayerBlendMode blendMode, float weight, BoneMask mask)
+	{
+		m_Layers.push_back(AnimationLayer{ blendMode, weight, std::move(mask), {} });
+		return GetLayerCount() - 1;
+	}
+
+	void PoseAnimator::SetLayerWeight(u32 layerIndex, float weight)
+	{
+		ARC_ASSERT(layerIndex < m_Layers.size(), "Animation layer doesn't exist");
+		m_Layers[layerIndex].Weight = glm::clamp(weight, 0.0f, 1.0f);
+	}
+
+	void PoseAnimator::SetLayerMask(u32 layerIndex, BoneMask mask)
+	{
+		ARC_ASSERT(layerIndex < m_Layers.size(), "Animation layer doesn't exist");
+		m_Layers[layerIndex].Mask = std::move(mask);
+	}
+
+	AnimationClip* PoseAnimator::GetCurrentAnimationClip()
+	{
+		const std::vector<AnimationPlayback> &playbacks = m_Layers[0].Playbacks;
+		return playbacks.empty() ? nullptr : playbacks.back().Clip;
+	}
+
+	const Skeleton* PoseAnimator::GetSkeleton() const
+	{
+		// The base layer decides the skeleton, the other layers were checked against it when they started playing
+		const std::vector<AnimationPlayback> &playbacks = m_Layers[0].Playbacks;
+		if (playbacks.empty())
+			return nullptr;
+		return playbacks.back().Clip ? &playbacks.back().Clip->GetSkeleton() : &playbacks.back().BlendTree->GetSkeleton();
 	}
 }
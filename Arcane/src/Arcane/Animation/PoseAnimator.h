@@ -2,27 +2,84 @@
 #ifndef POSEANIMATOR_H
 #define POSEANIMATOR_H
 
+#ifndef ANIMATIONCLIP_H
+#include <Arcane/Animation/AnimationClip.h>
+#endif
+
+#ifndef ANIMATIONBLENDTREE_H
+#include <Arcane/Animation/AnimationBlendTree.h>
+#endif
+
+#ifndef POSEBLENDING_H
+#include <Arcane/Animation/PoseBlending.h>
+#endif
+
 namespace Arcane
 {
-	class AnimationClip;
-	struct AssimpBoneData;
+	enum class AnimationLayerBlendMode
+	{
+		Override, // Replaces the layers below it by the layer's weight
+		Additive  // Adds the difference from the first frame of what it plays on top of the layers below it (ie. breathing or leaning on top of locomotion)
+	};
 
+	// Plays clips or blend trees on a stack of layers, everything is blended in local space before the bone matrices are built once at the end. Layer 0 is the
+	// base layer and always exists. Playing something new can cross-fade from what was playing, the old playback keeps running until it has faded out
 	class PoseAnimator
 	{
 	public:
 		PoseAnimator();
 
 		void UpdateAnimation(float deltaTime);
+
+		// Plays the clip on the base layer from the start, cutting off anything that was playing
 		void SetAnimationClip(AnimationClip *clip);
 
-		inline AnimationClip* GetCurrentAnimationClip() { return m_CurrentAnimationClip; }
+		// Fades from whatever the layer is playing to the clip or blend tree over fadeDuration seconds (0 cuts straight to it)
+		void CrossFade(AnimationClip *clip, float fadeDuration, u32 layerIndex = 0);
+		void CrossFade(const AnimationBlendTree *blendTree, float fadeDuration, u32 layerIndex = 0);
+
+		// Sets a parameter of the blend tree most recently played on the layer, trees still fading out keep the values they had
+		void SetBlendParameter(u32 parameter, float value, u32 layerIndex = 0);
+
+		// Layers are evaluated in the order they were added, on top of the base layer
+		u32 AddLayer(AnimationLayerBlendMode blendMode, float weight = 1.0f, BoneMask mask = BoneMask());
+		void SetLayerWeight(u32 layerIndex, float weight);
+		void SetLayerMask(u32 layerIndex, BoneMask mask);
+		inline u32 GetLayerCount() const { return static_cast<u32>(m_Layers.size()); }
+
+		// The clip most recently played on the base layer, null when it is playing a blend tree
+		AnimationClip* GetCurrentAnimationClip();
 		inline const std::vector<glm::mat4>& GetFinalBoneMatrices() const { return m_FinalBoneMatrices; }
 	private:
-		void CalculateBoneTransform(const AssimpBoneData *node, glm::mat4 parentTransform);
+		struct AnimationPlayback
+		{
+			AnimationClip *Clip = nullptr;
+			const AnimationBlendTree *BlendTree = nullptr;
+			float Time = 0.0f; // Ticks into the clip, or normalized time through the blend tree
+			float FadeDuration = 0.0f, FadeElapsed = 0.0f;
+
+			std::vector<u32> KeyframeCursors; // One per timeline of the clip, or GetKeyframeCursorCount of the blend tree
+			std::vector<float> Parameters;
+			std::vector<float> ClipWeights; // Worked out from the parameters when the playback is advanced
+			AnimationPose AdditiveReferencePose; // Only filled on additive layers
+		};
+
+		struct AnimationLayer
+		{
+			AnimationLayerBlendMode BlendMode;
+			float Weight;
+			BoneMask Mask;
+			std::vector<AnimationPlayback> Playbacks; // Oldest first, every one after the first is fading in on top of the ones before it
+		};
+
+		void Play(AnimationPlayback &&playback, float fadeDuration, u32 layerIndex);
+		void AdvancePlayback(AnimationPlayback &playback, float deltaTime);
+		void SamplePlayback(AnimationPlayback &playback, AnimationPose &outPose);
+		void EvaluateLayer(AnimationLayer &layer, AnimationPose &outPose);
+		const Skeleton* GetSkeleton() const;
 	private:
 		std::vector<glm::mat4> m_FinalBoneMatrices;
-		AnimationClip *m_CurrentAnimationClip;
-		float m_CurrentTime;
+		std::vector<AnimationLayer> m_Layers;
 
 		bool m_PlayClipIndefinitely = true;
 	};
@@ -0,0 +1,167 @@
+#include "arcpch.h"
+#include "PoseBlending.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define ARC_POSE_BLENDING_SSE 1
+#include <xmmintrin.h>
+#else
+#define ARC_POSE_BLENDING_SSE 0
+#endif
+
+namespace Arcane
+{
+	BoneMask BoneMask::FromJoint(const Skeleton &skeleton, const std::string &jointName, float weight)
+	{
+		BoneMask mask;
+		mask.m_JointWeights.assign(skeleton.GetJointCount(), 0.0f);
+		mask.SetJointHierarchyWeight(skeleton, jointName, weight);
+		return mask;
+	}
+
+	void BoneMask::SetJointHierarchyWeight(const Skeleton &skeleton, const std::string &jointName, float weight)
+	{
+		if (m_JointWeights.empty())
+			m_JointWeights.assign(skeleton.GetJointCount(), 1.0f);
+		ARC_ASSERT(m_JointWeights.size() == skeleton.GetJointCount(), "Bone mask was not made for this skeleton");
+
+		int rootJoint = skeleton.FindJoint(jointName);
+		if (rootJoint < 0)
+		{
+			ARC_LOG_WARN("Bone mask couldn't find joint {0}", jointName);
+			return;
+		}
+
+		// Parents always come before their children, so a single pass finds the whole hierarchy below the joint
+		std::vector<bool> isInHierarchy(skeleton.GetJointCount(), false);
+		isInHierarchy[rootJoint] = true;
+		m_JointWeights[rootJoint] = weight;
+		for (u32 i = rootJoint + 1; i < skeleton.GetJointCount(); i++)
+		{
+			int parentIndex = skeleton.GetParentIndex(i);
+			if (parentIndex >= 0 && isInHierarchy[parentIndex])
+			{
+				isInHierarchy[i] = true;
+				m_JointWeights[i] = weight;
+			}
+		}
+	}
+
+	// Normalized lerp that takes the short way around, out can be a or b
+	static inline void NlerpRotation(const glm::quat &a, const glm::quat &b, float weight, glm::quat &out)
+	{
+#if ARC_POSE_BLENDING_SSE
+		__m128 qa = _mm_loadu_ps(&a[0]), qb = _mm_loadu_ps(&b[0]);
+		__m128 product = _mm_mul_ps(qa, qb);
+		product = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+		product = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		// Flip b into a's hemisphere by toggling its sign bits when the dot product is negative
+		__m128 signMask = _mm_and_ps(product, _mm_set1_ps(-0.0f));
+		qb = _mm_xor_ps(qb, signMask);
+
+		__m128 result = _mm_add_ps(qa, _mm_mul_ps(_mm_sub_ps(qb, qa), _mm_set1_ps(weight)));
+		__m128 lengthSquared = _mm_mul_ps(result, result);
+		lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(2, 3, 0, 1)));
+		lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		// Estimated reciprocal square root with a Newton-Raphson step, accurate to about 1e-7 which is plenty for a rotation that gets renormalized every blend
+		__m128 inverseLength = _mm_rsqrt_ps(lengthSquared);
+		__m128 halfLengthSquared = _mm_mul_ps(lengthSquared, _mm_set1_ps(0.5f));
+		inverseLength = _mm_mul_ps(inverseLength, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfLengthSquared, _mm_mul_ps(inverseLength, inverseLength))));
+		_mm_storeu_ps(&out[0], _mm_mul_ps(result, inverseLength));
+#else
+		glm::quat target = glm::dot(a, b) < 0.0f ? -b : b;
+		out = glm::normalize(a * (1.0f - weight) + target * weight);
+#endif
+	}
+
+	// Componentwise lerp over count floats, out can be a or b
+	static inline void LerpFloats(const float *a, const float *b, float weight, size_t count, float *out)
+	{
+		size_t i = 0;
+#if ARC_POSE_BLENDING_SSE
+		__m128 weights = _mm_set1_ps(weight);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 va = _mm_loadu_ps(a + i), vb = _mm_loadu_ps(b + i);
+			_mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), weights)));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			out[i] = a[i] + (b[i] - a[i]) * weight;
+		}
+	}
+
+	void BlendPoses(const AnimationPose &a, const AnimationPose &b, float weight, const float *jointWeights, AnimationPose &outPose)
+	{
+		ARC_ASSERT(a.GetJointCount() == b.GetJointCount() && a.GetJointCount() == outPose.GetJointCount(), "Poses being blended need to be from the same skeleton");
+
+		size_t jointCount = a.GetJointCount();
+		if (jointCount == 0)
+			return;
+
+		if (!jointWeights)
+		{
+			// The translations and scales are lerped componentwise, so the vec3 arrays can be treated as flat float arrays and done four floats at a time
+			LerpFloats(&a.Translations[0][0], &b.Translations[0][0], weight, jointCount * 3, &outPose.Translations[0][0]);
+			LerpFloats(&a.Scales[0][0], &b.Scales[0][0], weight, jointCount * 3, &outPose.Scales[0][0]);
+			for (size_t i = 0; i < jointCount; i++)
+			{
+				NlerpRotation(a.Rotations[i], b.Rotations[i], weight, outPose.Rotations[i]);
+			}
+			return;
+		}
+
+		for (size_t i = 0; i < jointCount; i++)
+		{
+			float jointWeight = weight * jointWeights[i];
+			if (jointWeight <= 0.0f)
+			{
+				if (&outPose != &a)
+				{
+					outPose.Translations[i] = a.Translations[i];
+					outPose.Rotations[i] = a.Rotations[i];
+					outPose.Scales[i] = a.Scales[i];
+				}
+				continue;
+			}
+
+			outPose.Translations[i] = glm::mix(a.Translations[i], b.Translations[i], jointWeight);
+			outPose.Scales[i] = glm::mix(a.Scales[i], b.Scales[i], jointWeight);
+			NlerpRotation(a.Rotations[i], b.Rotations[i], jointWeight, outPose.Rotations[i]);
+		}
+	}
+
+	void MakeAdditivePose(AnimationPose &pose, const AnimationPose &referencePose)
+	{
+		ARC_ASSERT(pose.GetJointCount() == referencePose.GetJointCount(), "Additive reference pose needs to be from the same skeleton");
+
+		for (size_t i = 0; i < pose.GetJointCount(); i++)
+		{
+			pose.Translations[i] -= referencePose.Translations[i];
+			pose.Rotations[i] = glm::normalize(glm::conjugate(referencePose.Rotations[i]) * pose.Rotations[i]);
+			pose.Scales[i] /= referencePose.Scales[i];
+		}
+	}
+
+	void ApplyAdditivePose(AnimationPose &basePose, const AnimationPose &additivePose, float weight, const float *jointWeights)
+	{
+		ARC_ASSERT(basePose.GetJointCount() == additivePose.GetJointCount(), "Additive pose needs to be from the same skeleton");
+
+		const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::quat scaledRotation;
+		for (size_t i = 0; i < basePose.GetJointCount(); i++)
+		{
+			float jointWeight = jointWeights ? weight * jointWeights[i] : weight;
+			if (jointWeight <= 0.0f)
+				continue;
+
+			// Scaling the difference by the weight means lerping it towards no change, which is the identity for rotations and one for scales
+			basePose.Translations[i] += additivePose.Translations[i] * jointWeight;
+			NlerpRotation(identity, additivePose.Rotations[i], jointWeight, scaledRotation);
+			basePose.Rotations[i] = basePose.Rotations[i] * scaledRotation;
+			basePose.Scales[i] *= glm::mix(glm::vec3(1.0f), additivePose.Scales[i], jointWeight);
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef POSEBLENDING_H
+#define POSEBLENDING_H
+
+#ifndef SKELETON_H
+#include <Arcane/Animation/Skeleton.h>
+#endif
+
+namespace Arcane
+{
+	// How much each joint takes from a layer (0 to 1). An empty mask lets every joint through at full weight
+	class BoneMask
+	{
+	public:
+		BoneMask() = default;
+
+		// Masks in the named joint and everything below it, useful for upper body layers (ie. everything under the spine)
+		static BoneMask FromJoint(const Skeleton &skeleton, const std::string &jointName, float weight = 1.0f);
+
+		// Adds the named joint and everything below it to the mask with the given weight, the rest of the mask is left alone
+		void SetJointHierarchyWeight(const Skeleton &skeleton, const std::string &jointName, float weight);
+
+		inline bool IsEmpty() const { return m_JointWeights.empty(); }
+		inline const float* GetJointWeights() const { return m_JointWeights.empty() ? nullptr : m_JointWeights.data(); }
+	private:
+		std::vector<float> m_JointWeights;
+	};
+
+	// All of these work on local space poses, so blending only costs a lerp (or nlerp for the rotations) per joint and nothing has to be decomposed from matrices.
+	// jointWeights is optional (from a BoneMask), when given each joint's weight is scaled by it
+
+	// outPose = lerp(a, b, weight), outPose can be a or b
+	void BlendPoses(const AnimationPose &a, const AnimationPose &b, float weight, const float *jointWeights, AnimationPose &outPose);
+
+	// Turns pose into the difference from referencePose, so it can be layered on top of other poses with ApplyAdditivePose
+	void MakeAdditivePose(AnimationPose &pose, const AnimationPose &referencePose);
+
+	// Layers an additive pose (from MakeAdditivePose) on top of basePose, a weight of 0 leaves it untouched
+	void ApplyAdditivePose(AnimationPose &basePose, const AnimationPose &additivePose, float weight, const float *jointWeights);
+}
+#endif
@@ -0,0 +1,110 @@
+#include "arcpch.h"
+#include "Skeleton.h"
+
+#include <Arcane/Animation/AnimationData.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define ARC_ANIMATION_SSE 1
+#include <xmmintrin.h>
+#else
+#define ARC_ANIMATION_SSE 0
+#endif
+
+namespace Arcane
+{
+	// Builds translation * rotation * scale directly from the components instead of multiplying three matrices together
+	static inline void ComposeTransform(const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale, glm::mat4 &outTransform)
+	{
+		float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+		float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+		float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+		outTransform[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * scale.x, 2.0f * (xy + wz) * scale.x, 2.0f * (xz - wy) * scale.x, 0.0f);
+		outTransform[1] = glm::vec4(2.0f * (xy - wz) * scale.y, (1.0f - 2.0f * (xx + zz)) * scale.y, 2.0f * (yz + wx) * scale.y, 0.0f);
+		outTransform[2] = glm::vec4(2.0f * (xz + wy) * scale.z, 2.0f * (yz - wx) * scale.z, (1.0f - 2.0f * (xx + yy)) * scale.z, 0.0f);
+		outTransform[3] = glm::vec4(translation, 1.0f);
+	}
+
+	// outResult = a * b for transforms whose bottom row is (0, 0, 0, 1), which every joint, bind pose, and root transform is. outResult can't be either of the inputs
+	static inline void MultiplyAffineTransforms(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &outResult)
+	{
+#if ARC_ANIMATION_SSE
+		// Each column of the result is a's columns weighted by the matching column of b, the weight of a's translation is only ever 0 or 1
+		__m128 a0 = _mm_loadu_ps(&a[0][0]), a1 = _mm_loadu_ps(&a[1][0]), a2 = _mm_loadu_ps(&a[2][0]), a3 = _mm_loadu_ps(&a[3][0]);
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 result = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+			result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+			result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+			if (column == 3)
+				result = _mm_add_ps(result, a3);
+			_mm_storeu_ps(&outResult[column][0], result);
+		}
+#else
+		outResult = a * b;
+#endif
+	}
+
+	void AnimationPose::Resize(size_t jointCount)
+	{
+		Translations.resize(jointCount, glm::vec3(0.0f));
+		Rotations.resize(jointCount, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		Scales.resize(jointCount, glm::vec3(1.0f));
+	}
+
+	u32 Skeleton::AddJoint(const std::string &name, int parentIndex, const glm::mat4 &localBindTransform, int boneID, const glm::mat4 &inverseBindPose)
+	{
+		ARC_ASSERT(parentIndex < static_cast<int>(GetJointCount()), "A joint's parent has to be added before it");
+		ARC_ASSERT(boneID < MaxBonesPerModel, "We exceeded the MaxBonesPerModel limit");
+
+		m_JointNames.push_back(name);
+		m_ParentIndices.push_back(parentIndex);
+		m_BoneIDs.push_back(boneID);
+		m_InverseBindPoses.push_back(inverseBindPose);
+
+		// Node transforms from assimp don't have any shear, so they can be split into TRS like the keyframes are. A mirrored basis keeps its rotation by flipping the x scale
+		glm::vec3 scale(glm::length(glm::vec3(localBindTransform[0])), glm::length(glm::vec3(localBindTransform[1])), glm::length(glm::vec3(localBindTransform[2])));
+		if (glm::determinant(glm::mat3(localBindTransform)) < 0.0f)
+			scale.x = -scale.x;
+		glm::mat3 rotation(glm::vec3(localBindTransform[0]) / scale.x, glm::vec3(localBindTransform[1]) / scale.y, glm::vec3(localBindTransform[2]) / scale.z);
+
+		m_BindPose.Translations.push_back(glm::vec3(localBindTransform[3]));
+		m_BindPose.Rotations.push_back(glm::normalize(glm::quat_cast(rotation)));
+		m_BindPose.Scales.push_back(scale);
+
+		return GetJointCount() - 1;
+	}
+
+	int Skeleton::FindJoint(const std::string &name) const
+	{
+		for (u32 i = 0; i < GetJointCount(); i++)
+		{
+			if (m_JointNames[i] == name)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	void Skeleton::ComputeBoneMatrices(const AnimationPose &pose, const glm::mat4 &rootTransform, glm::mat4 *scratchModelSpace, glm::mat4 *outBoneMatrices) const
+	{
+		ARC_ASSERT(pose.GetJointCount() == GetJointCount(), "Pose was not made for this skeleton");
+
+		// Parents always come first, so their model space transform is ready by the time a child needs it
+		glm::mat4 localTransform;
+		u32 jointCount = GetJointCount();
+		for (u32 i = 0; i < jointCount; i++)
+		{
+			ComposeTransform(pose.Translations[i], pose.Rotations[i], pose.Scales[i], localTransform);
+
+			int parentIndex = m_ParentIndices[i];
+			MultiplyAffineTransforms(parentIndex >= 0 ? scratchModelSpace[parentIndex] : rootTransform, localTransform, scratchModelSpace[i]);
+
+			// The inverse bind pose moves a vertex into the bone's space before the animated transform moves it back out
+			int boneID = m_BoneIDs[i];
+			if (boneID >= 0)
+			{
+				MultiplyAffineTransforms(scratchModelSpace[i], m_InverseBindPoses[i], outBoneMatrices[boneID]);
+			}
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef SKELETON_H
+#define SKELETON_H
+
+namespace Arcane
+{
+	// Local space transforms of every joint in a skeleton, stored as separate arrays so sampling and blending can run over one component at a time
+	struct AnimationPose
+	{
+		std::vector<glm::vec3> Translations;
+		std::vector<glm::quat> Rotations;
+		std::vector<glm::vec3> Scales;
+
+		void Resize(size_t jointCount);
+		inline size_t GetJointCount() const { return Rotations.size(); }
+	};
+
+	// The node hierarchy an animation clip was authored against, flattened so every joint comes after its parent. That way the model space transforms
+	// can be built with a single pass over the arrays instead of recursing through the nodes
+	class Skeleton
+	{
+	public:
+		Skeleton() = default;
+
+		// Has to be called in hierarchy order, the parent has to already be added. Joints that don't deform the mesh have a bone ID of -1
+		u32 AddJoint(const std::string &name, int parentIndex, const glm::mat4 &localBindTransform, int boneID, const glm::mat4 &inverseBindPose);
+
+		// Linear search, only meant to be used while loading
+		int FindJoint(const std::string &name) const;
+
+		// Composes the pose's local transforms into model space and writes each bone's skinning matrix into outBoneMatrices (indexed by bone ID). rootTransform is
+		// applied above the root joint, scratchModelSpace has to hold a transform per joint
+		void ComputeBoneMatrices(const AnimationPose &pose, const glm::mat4 &rootTransform, glm::mat4 *scratchModelSpace, glm::mat4 *outBoneMatrices) const;
+
+		inline u32 GetJointCount() const { return static_cast<u32>(m_ParentIndices.size()); }
+		inline const std::string& GetJointName(u32 jointIndex) const { return m_JointNames[jointIndex]; }
+		inline int GetParentIndex(u32 jointIndex) const { return m_ParentIndices[jointIndex]; }
+		inline int GetBoneID(u32 jointIndex) const { return m_BoneIDs[jointIndex]; }
+		inline const AnimationPose& GetBindPose() const { return m_BindPose; }
+	private:
+		std::vector<std::string> m_JointNames;
+		std::vector<int> m_ParentIndices; // -1 for the root
+		std::vector<int> m_BoneIDs;
+		std::vector<glm::mat4> m_InverseBindPoses;
+		AnimationPose m_BindPose; // Used for the joints a clip doesn't animate
+	};
+}
+#endif
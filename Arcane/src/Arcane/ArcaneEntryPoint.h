@@ -8,12 +8,17 @@
 #include <arcpch.h>
 #include <Arcane/Core/Application.h>
 #include <Arcane/RenderdocManager.h>
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
 
 extern Arcane::Application* Arcane::CreateApplication(int argc, char **argv);
 bool g_ApplicationRunning = true;
 
 int main(int argc, char **argv)
 {
+	// Cache maintenance commands (--ddc-warm, --ddc-prune) run headless and exit without creating the application
+	if (Arcane::DerivedDataCache::RunCommandLine(argc, argv))
+		return 0;
+
 #if USE_RENDERDOC
 	// Load in renderdoc api
 	RENDERDOCMANAGER;
@@ -8,7 +8,9 @@
 #include <Arcane/Util/Loaders/AssetManager.h>
 #include <Arcane/Util/Loaders/ShaderLoader.h>
 #include <Arcane/Util/Loaders/TextureLoader.h>
+#include <Arcane/Util/Loaders/TextureStreamer.h>
 #include <Arcane/Util/Time.h>
+#include <Arcane/Util/Timer.h>
 #include <Arcane/Core/Layer.h>
 #include <Arcane/ImGui/ImGuiLayer.h>
 #include <Arcane/RenderdocManager.h>
@@ -35,15 +37,33 @@ namespace Arcane
 
 		// Prepare the engine
 		ARC_LOG_INFO("Initializing Arcane Engine...");
+		Timer startupTimer, stepTimer;
 		m_Window = new Window(this, specification);
 		m_Window->Init();
+		m_StartupTimings.Window = stepTimer.Elapsed();
+
+		stepTimer.Reset();
 		m_AssetManager = &Arcane::AssetManager::GetInstance(); // Need to initialize the asset manager early so we can load resources and have our worker threads instantiated
 		Arcane::ShaderLoader::SetShaderFilepath("../Arcane/src/Arcane/shaders/");
+		Arcane::ShaderLoader::Init();
 		Renderer::Init(); // Must be loaded before textures get created since they query for the max anistropy from the renderer
+		m_StartupTimings.Renderer = stepTimer.Elapsed();
+
+		stepTimer.Reset();
 		Arcane::TextureLoader::InitializeDefaultTextures();
+		m_AssetManager->InitUploadStaging(static_cast<size_t>(UPLOAD_STAGING_BUFFER_SIZE_MB) * 1024 * 1024);
+		m_StartupTimings.Textures = stepTimer.Elapsed();
+
+		stepTimer.Reset();
 		m_ActiveScene = new Scene(m_Window);
+		m_StartupTimings.Scene = stepTimer.Elapsed();
+
+		// The passes load nearly every shader, their compiles are only submitted here and keep going while the assets load
+		stepTimer.Reset();
 		m_MasterRenderPass = new MasterRenderPass(m_ActiveScene);
+		m_StartupTimings.RenderPasses = stepTimer.Elapsed();
 		m_InputManager = &InputManager::GetInstance();
+		m_StartupTimings.Total = startupTimer.Elapsed();
 	}
 
 	Application::~Application()
@@ -58,6 +78,7 @@ namespace Arcane
 		GPUTimerManager::Shutdown();
 #endif
 
+		m_AssetManager->ShutdownUploadStaging();
 		Renderer::Shutdown();
 
 		delete m_Window;
@@ -67,19 +88,39 @@ namespace Arcane
 
 	void Application::InternalInit()
 	{
+		Timer startupTimer, stepTimer;
+
 		// This will call OnAttach for any layers in the layer stack. This is where the editor layer can load up assets before runtime
 		OnInit();
 
 		// Make sure all assets load before booting for first time
 		while (Arcane::AssetManager::GetInstance().AssetsInFlight())
 		{
-			m_AssetManager->Update(100000, 100000, 100000);
+			m_AssetManager->Update(std::numeric_limits<u64>::max(), std::numeric_limits<double>::max());
 		}
+		m_StartupTimings.Assets = stepTimer.Elapsed();
+
+		// Anything that hasn't finished compiling by now gets waited on here rather than during the first frame
+		stepTimer.Reset();
+		ShaderLoader::FinishPendingShaders();
+		m_StartupTimings.ShaderWait = stepTimer.Elapsed();
 
+		stepTimer.Reset();
 		m_ActiveScene->Init();
+		m_StartupTimings.SceneInit = stepTimer.Elapsed();
 
 		// Initialize the master render pass
+		stepTimer.Reset();
 		m_MasterRenderPass->Init();
+		m_StartupTimings.RenderPassInit = stepTimer.Elapsed();
+		m_StartupTimings.Total += startupTimer.Elapsed();
+
+		const ShaderLoaderStats &shaderStats = ShaderLoader::GetStats();
+		ARC_LOG_INFO("Startup took {0:.1f}ms - Window:{1:.1f}ms Renderer:{2:.1f}ms Textures:{3:.1f}ms Scene:{4:.1f}ms RenderPasses:{5:.1f}ms Assets:{6:.1f}ms ShaderWait:{7:.1f}ms SceneInit:{8:.1f}ms RenderPassInit:{9:.1f}ms",
+			m_StartupTimings.Total * 1000.0, m_StartupTimings.Window * 1000.0, m_StartupTimings.Renderer * 1000.0, m_StartupTimings.Textures * 1000.0, m_StartupTimings.Scene * 1000.0, m_StartupTimings.RenderPasses * 1000.0,
+			m_StartupTimings.Assets * 1000.0, m_StartupTimings.ShaderWait * 1000.0, m_StartupTimings.SceneInit * 1000.0, m_StartupTimings.RenderPassInit * 1000.0);
+		ARC_LOG_INFO("Shaders - Programs:{0} Files:{1} Permutations:{2} Binary Cache Hits:{3} Stored:{4} Submit:{5:.1f}ms Wait:{6:.1f}ms (includes lazy waits)",
+			shaderStats.ProgramsLoaded, shaderStats.ShaderFiles, shaderStats.Permutations, shaderStats.BinaryCacheHits, shaderStats.BinaryCacheStores, shaderStats.SubmitTime * 1000.0, shaderStats.WaitTime * 1000.0);
 
 #ifdef ARC_DEV_BUILD
 		GPUTimerManager::Startup();
@@ -119,7 +160,8 @@ namespace Arcane
 				m_Window->Bind();
 				m_Window->ClearAll();
 
-				m_AssetManager->Update(TEXTURE_LOADS_PER_FRAME, CUBEMAP_FACES_PER_FRAME, MODELS_PER_FRAME);
+				m_AssetManager->Update(static_cast<u64>(UPLOAD_BUDGET_MB_PER_FRAME) * 1024 * 1024, UPLOAD_BUDGET_MS_PER_FRAME);
+				TextureStreamer::GetInstance().Update(m_ActiveScene);
 				m_ActiveScene->OnUpdate((float)deltaTime.GetDeltaTime());
 
 				for (Layer *layer : m_LayerStack)
@@ -69,6 +69,14 @@ namespace Arcane
 
 		bool OnWindowClose(WindowCloseEvent &event);
 	private:
+		// Seconds spent in each step of getting to the first frame, logged once InternalInit is done
+		struct StartupTimings
+		{
+			double Window, Renderer, Textures, Scene, RenderPasses;
+			double Assets, ShaderWait, SceneInit, RenderPassInit, Total;
+		};
+		StartupTimings m_StartupTimings = {};
+
 		ApplicationSpecification m_Specification;
 
 		Window *m_Window;
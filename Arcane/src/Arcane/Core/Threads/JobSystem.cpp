@@ -0,0 +1,272 @@
+#include "arcpch.h"
+#include "JobSystem.h"
+
+namespace Arcane
+{
+	// Index of the worker owned by the current thread, -1 for threads that aren't workers (main thread etc)
+	static thread_local int s_WorkerIndex = -1;
+
+	JobSystem::JobSystem() : m_Running(true), m_QueuedJobCount(0), m_NextSubmitQueue(0), m_UnfinishedJobCount(0)
+	{
+		ResetStats();
+
+		// Leave a core for the main thread since it is busy submitting GL work
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		unsigned int workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		ARC_LOG_INFO("Spawning {0} worker threads for the job system", workerCount);
+
+		m_Queues.reserve(workerCount);
+		for (unsigned int i = 0; i < workerCount; i++)
+		{
+			m_Queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		m_Workers.reserve(workerCount);
+		for (unsigned int i = 0; i < workerCount; i++)
+		{
+			m_Workers.push_back(std::thread(&JobSystem::WorkerThread, this, i));
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ParkMutex);
+			m_Running = false;
+		}
+		m_ParkCondition.notify_all();
+
+		for (std::thread &worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	JobSystem& JobSystem::GetInstance()
+	{
+		static JobSystem jobSystem;
+		return jobSystem;
+	}
+
+	JobHandle JobSystem::Submit(std::function<void()> task, JobPriority priority)
+	{
+		return Submit(std::move(task), {}, priority);
+	}
+
+	JobHandle JobSystem::Submit(std::function<void()> task, const std::vector<JobHandle> &dependencies, JobPriority priority)
+	{
+		std::shared_ptr<Job> job = std::make_shared<Job>();
+		job->Task = std::move(task);
+		job->Priority = priority;
+		++m_JobsSubmitted;
+		m_UnfinishedJobCount.fetch_add(1, std::memory_order_relaxed);
+
+		// Register the job with any dependency that hasn't finished yet, the dependency will release it when it completes
+		for (const JobHandle &dependency : dependencies)
+		{
+			if (!dependency.m_Job)
+				continue;
+
+			std::lock_guard<std::mutex> lock(dependency.m_Job->ContinuationMutex);
+			if (!dependency.m_Job->Finished.load(std::memory_order_acquire))
+			{
+				job->PendingDependencies.fetch_add(1, std::memory_order_relaxed);
+				dependency.m_Job->Continuations.push_back(job);
+			}
+		}
+
+		// Release the submission reference, if nothing else is pending the job can run right away
+		if (job->PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Enqueue(job);
+		}
+
+		return JobHandle(job);
+	}
+
+	void JobSystem::Wait(const JobHandle &handle)
+	{
+		while (!handle.IsFinished())
+		{
+			std::shared_ptr<Job> job = FetchJob(s_WorkerIndex >= 0 ? s_WorkerIndex : 0);
+			if (job)
+			{
+				Execute(job);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::WaitForIdle()
+	{
+		while (m_UnfinishedJobCount.load(std::memory_order_acquire) > 0)
+		{
+			std::shared_ptr<Job> job = FetchJob(s_WorkerIndex >= 0 ? s_WorkerIndex : 0);
+			if (job)
+			{
+				Execute(job);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	JobSystemStats JobSystem::GetStats() const
+	{
+		JobSystemStats stats;
+		stats.WorkerCount = GetWorkerCount();
+		stats.QueueDepth = m_QueuedJobCount.load(std::memory_order_relaxed);
+		stats.MaxQueueDepth = m_MaxQueueDepth.load(std::memory_order_relaxed);
+		stats.JobsSubmitted = m_JobsSubmitted.load(std::memory_order_relaxed);
+		stats.JobsExecuted = m_JobsExecuted.load(std::memory_order_relaxed);
+		stats.StealCount = m_StealCount.load(std::memory_order_relaxed);
+		stats.AverageLatencyMS = stats.JobsExecuted > 0 ? (float)((double)m_TotalLatencyMicroseconds.load(std::memory_order_relaxed) / (double)stats.JobsExecuted / 1000.0) : 0.0f;
+		stats.MaxLatencyMS = (float)((double)m_MaxLatencyMicroseconds.load(std::memory_order_relaxed) / 1000.0);
+		for (int i = 0; i < JobLatencyBucketCount; i++)
+		{
+			stats.LatencyHistogram[i] = m_LatencyHistogram[i].load(std::memory_order_relaxed);
+		}
+
+		return stats;
+	}
+
+	void JobSystem::ResetStats()
+	{
+		m_MaxQueueDepth = 0;
+		m_JobsSubmitted = 0;
+		m_JobsExecuted = 0;
+		m_StealCount = 0;
+		m_TotalLatencyMicroseconds = 0;
+		m_MaxLatencyMicroseconds = 0;
+		for (int i = 0; i < JobLatencyBucketCount; i++)
+		{
+			m_LatencyHistogram[i] = 0;
+		}
+	}
+
+	void JobSystem::WorkerThread(unsigned int workerIndex)
+	{
+		s_WorkerIndex = static_cast<int>(workerIndex);
+
+		while (m_Running)
+		{
+			std::shared_ptr<Job> job = FetchJob(workerIndex);
+			if (job)
+			{
+				Execute(job);
+				continue;
+			}
+
+			// Nothing to run or steal, park until a job gets queued
+			std::unique_lock<std::mutex> lock(m_ParkMutex);
+			m_ParkCondition.wait(lock, [this]() { return m_QueuedJobCount.load(std::memory_order_acquire) > 0 || !m_Running; });
+		}
+	}
+
+	void JobSystem::Enqueue(const std::shared_ptr<Job> &job)
+	{
+		job->ReadyTime = std::chrono::steady_clock::now();
+
+		// Workers keep the jobs they spawn local (better cache behaviour), everyone else round robins across the workers
+		unsigned int queueIndex = s_WorkerIndex >= 0 ? static_cast<unsigned int>(s_WorkerIndex) : m_NextSubmitQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned int>(m_Queues.size());
+		WorkerQueue &queue = *m_Queues[queueIndex];
+
+		// Count the job before it becomes visible so a thief can never decrement the count below zero
+		unsigned int queueDepth = m_QueuedJobCount.fetch_add(1, std::memory_order_acq_rel) + 1;
+		unsigned int maxQueueDepth = m_MaxQueueDepth.load(std::memory_order_relaxed);
+		while (queueDepth > maxQueueDepth && !m_MaxQueueDepth.compare_exchange_weak(maxQueueDepth, queueDepth, std::memory_order_relaxed)) {}
+
+		{
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			queue.Jobs[(int)job->Priority].push_back(job);
+		}
+
+		// Taking the park mutex guarantees a worker is either before its predicate check or already waiting, so the wake up can't get lost
+		{
+			std::lock_guard<std::mutex> lock(m_ParkMutex);
+		}
+		m_ParkCondition.notify_one();
+	}
+
+	std::shared_ptr<Job> JobSystem::FetchJob(unsigned int workerIndex)
+	{
+		if (m_QueuedJobCount.load(std::memory_order_acquire) == 0)
+			return nullptr;
+
+		unsigned int queueCount = static_cast<unsigned int>(m_Queues.size());
+		for (int priority = 0; priority < (int)JobPriority::Count; priority++)
+		{
+			// Pop from the back of our own deque first (most recently pushed, likely still in cache)
+			{
+				WorkerQueue &queue = *m_Queues[workerIndex];
+				std::lock_guard<std::mutex> lock(queue.Mutex);
+				if (!queue.Jobs[priority].empty())
+				{
+					std::shared_ptr<Job> job = std::move(queue.Jobs[priority].back());
+					queue.Jobs[priority].pop_back();
+					m_QueuedJobCount.fetch_sub(1, std::memory_order_acq_rel);
+					return job;
+				}
+			}
+
+			// Then try and steal the oldest job from another worker at the same priority
+			for (unsigned int offset = 1; offset < queueCount; offset++)
+			{
+				WorkerQueue &victim = *m_Queues[(workerIndex + offset) % queueCount];
+				std::lock_guard<std::mutex> lock(victim.Mutex);
+				if (!victim.Jobs[priority].empty())
+				{
+					std::shared_ptr<Job> job = std::move(victim.Jobs[priority].front());
+					victim.Jobs[priority].pop_front();
+					m_QueuedJobCount.fetch_sub(1, std::memory_order_acq_rel);
+					m_StealCount.fetch_add(1, std::memory_order_relaxed);
+					return job;
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	void JobSystem::Execute(const std::shared_ptr<Job> &job)
+	{
+		// Record how long the job was ready before it got picked up
+		u64 latency = static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - job->ReadyTime).count());
+		int bucket = 0;
+		while (bucket < JobLatencyBucketCount - 1 && (1ull << bucket) <= latency)
+		{
+			bucket++;
+		}
+		m_LatencyHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+		m_TotalLatencyMicroseconds.fetch_add(latency, std::memory_order_relaxed);
+		u64 maxLatency = m_MaxLatencyMicroseconds.load(std::memory_order_relaxed);
+		while (latency > maxLatency && !m_MaxLatencyMicroseconds.compare_exchange_weak(maxLatency, latency, std::memory_order_relaxed)) {}
+
+		if (job->Task)
+			job->Task();
+		m_JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+
+		// Mark the job as finished and release anything that was waiting on it
+		std::vector<std::shared_ptr<Job>> continuations;
+		{
+			std::lock_guard<std::mutex> lock(job->ContinuationMutex);
+			job->Finished.store(true, std::memory_order_release);
+			continuations.swap(job->Continuations);
+		}
+		for (std::shared_ptr<Job> &continuation : continuations)
+		{
+			if (continuation->PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Enqueue(continuation);
+			}
+		}
+
+		// Continuations are counted by their own submission, so they are already accounted for before this job stops being unfinished
+		m_UnfinishedJobCount.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#ifndef SINGLETON_H
+#include <Arcane/Util/Singleton.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace Arcane
+{
+	enum class JobPriority
+	{
+		High = 0,
+		Normal,
+		Low,
+		Count
+	};
+
+	static constexpr int JobLatencyBucketCount = 20; // Bucket i holds latencies in the range [2^(i-1), 2^i) microseconds, the last bucket holds everything above
+
+	struct Job
+	{
+		std::function<void()> Task;
+		JobPriority Priority = JobPriority::Normal;
+
+		// Starts at 1 while the job is being submitted so it can't become ready before all of its dependencies are registered
+		std::atomic<int> PendingDependencies = 1;
+
+		// Jobs waiting on this one to finish. Guarded by the mutex since a dependency can finish while a new job is registering itself
+		std::mutex ContinuationMutex;
+		std::vector<std::shared_ptr<Job>> Continuations;
+		std::atomic<bool> Finished = false;
+
+		std::chrono::steady_clock::time_point ReadyTime;
+	};
+
+	// Lightweight handle that can be stored by the submitter to wait on a job or to use it as a dependency for other jobs
+	class JobHandle
+	{
+		friend class JobSystem;
+	public:
+		JobHandle() = default;
+
+		inline bool IsValid() const { return m_Job != nullptr; }
+		inline bool IsFinished() const { return !m_Job || m_Job->Finished.load(std::memory_order_acquire); }
+	private:
+		JobHandle(const std::shared_ptr<Job> &job) : m_Job(job) {}
+	private:
+		std::shared_ptr<Job> m_Job;
+	};
+
+	struct JobSystemStats
+	{
+		unsigned int WorkerCount;
+		unsigned int QueueDepth;
+		unsigned int MaxQueueDepth;
+		u64 JobsSubmitted;
+		u64 JobsExecuted;
+		u64 StealCount;
+		float AverageLatencyMS; // Time a job spent ready in a queue before a worker picked it up
+		float MaxLatencyMS;
+		unsigned int LatencyHistogram[JobLatencyBucketCount];
+	};
+
+	// General purpose job system for the engine. Every worker owns a deque per priority, it pushes and pops its own work from the back and
+	// steals from the front of other workers' deques when it runs dry. Idle workers park on a condition variable instead of spinning
+	class JobSystem : public Singleton
+	{
+	public:
+		JobSystem();
+		~JobSystem();
+
+		static JobSystem& GetInstance();
+
+		JobHandle Submit(std::function<void()> task, JobPriority priority = JobPriority::Normal);
+		JobHandle Submit(std::function<void()> task, const std::vector<JobHandle> &dependencies, JobPriority priority = JobPriority::Normal);
+
+		// Blocks until the job is finished, the calling thread will help execute queued jobs while it is waiting
+		void Wait(const JobHandle &handle);
+
+		// Blocks until every submitted job (including jobs they spawn) has finished, the calling thread helps out like Wait does
+		void WaitForIdle();
+
+		inline unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+
+		JobSystemStats GetStats() const;
+		void ResetStats();
+	private:
+		struct WorkerQueue
+		{
+			std::mutex Mutex;
+			std::deque<std::shared_ptr<Job>> Jobs[(int)JobPriority::Count];
+		};
+
+		void WorkerThread(unsigned int workerIndex);
+
+		void Enqueue(const std::shared_ptr<Job> &job);
+		std::shared_ptr<Job> FetchJob(unsigned int workerIndex);
+		void Execute(const std::shared_ptr<Job> &job);
+	private:
+		std::vector<std::thread> m_Workers;
+		std::vector<std::unique_ptr<WorkerQueue>> m_Queues;
+		std::atomic<bool> m_Running;
+
+		// Workers sleep on this condition variable when there are no queued jobs
+		std::mutex m_ParkMutex;
+		std::condition_variable m_ParkCondition;
+		std::atomic<unsigned int> m_QueuedJobCount;
+		std::atomic<unsigned int> m_NextSubmitQueue; // Round robins submissions from non-worker threads across the worker deques
+		std::atomic<unsigned int> m_UnfinishedJobCount; // Submitted jobs that haven't finished executing yet, including ones waiting on dependencies
+
+		// Stats
+		std::atomic<unsigned int> m_MaxQueueDepth;
+		std::atomic<u64> m_JobsSubmitted;
+		std::atomic<u64> m_JobsExecuted;
+		std::atomic<u64> m_StealCount;
+		std::atomic<u64> m_TotalLatencyMicroseconds;
+		std::atomic<u64> m_MaxLatencyMicroseconds;
+		std::atomic<unsigned int> m_LatencyHistogram[JobLatencyBucketCount];
+	};
+}
+#endif
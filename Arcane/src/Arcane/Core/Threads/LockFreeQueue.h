@@ -0,0 +1,408 @@
+#pragma once
+#ifndef LOCKFREEQUEUE_H
+#define LOCKFREEQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace Arcane
+{
+	enum class QueueMode
+	{
+		MPMC, // Any number of producer and consumer threads
+		SPSC  // Exactly one producer thread and one consumer thread
+	};
+
+	static constexpr size_t QueueCacheLineSize = 64;
+
+	// Bounded lock-free ring buffer that mirrors the ThreadSafeQueue interface. The capacity is rounded up to a power of two and Push will yield while the queue is full
+	// MPMC uses a sequence number per cell (Vyukov style) so producers and consumers only contend on their own position counter
+	template<typename T, QueueMode Mode = QueueMode::MPMC>
+	class LockFreeQueue
+	{
+	public:
+		explicit LockFreeQueue(size_t capacity = 1024) : m_Capacity(RoundUpToPowerOfTwo(capacity)), m_Mask(m_Capacity - 1)
+		{
+			m_Cells = new Cell[m_Capacity];
+			for (size_t i = 0; i < m_Capacity; i++)
+			{
+				m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+			m_EnqueuePos.store(0, std::memory_order_relaxed);
+			m_DequeuePos.store(0, std::memory_order_relaxed);
+		}
+
+		~LockFreeQueue()
+		{
+			T val;
+			while (TryPop(val)) {}
+			delete[] m_Cells;
+		}
+
+		LockFreeQueue(const LockFreeQueue &copy) = delete;
+		LockFreeQueue& operator=(const LockFreeQueue &copy) = delete;
+
+		bool TryPush(T &&val)
+		{
+			size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell &cell = m_Cells[pos & m_Mask];
+				size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+				intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+				if (difference == 0)
+				{
+					if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						new (&cell.Storage) T(std::move(val));
+						cell.Sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0)
+				{
+					return false; // Full
+				}
+				else
+				{
+					pos = m_EnqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void Push(T val)
+		{
+			while (!TryPush(std::move(val)))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		// Claims a contiguous range of slots with a single atomic operation, returns how many items were pushed (can be less than count if the queue is near full)
+		size_t PushBatch(T *vals, size_t count)
+		{
+			size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+			size_t claimed;
+			do
+			{
+				// A stale position can trail the consumers, the compare exchange will fail and reload it in that case
+				size_t dequeuePos = m_DequeuePos.load(std::memory_order_acquire);
+				size_t used = pos > dequeuePos ? pos - dequeuePos : 0;
+				size_t space = used < m_Capacity ? m_Capacity - used : 0;
+				claimed = count < space ? count : space;
+				if (claimed == 0)
+					return 0;
+			} while (!m_EnqueuePos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed));
+
+			for (size_t i = 0; i < claimed; i++)
+			{
+				// The slot has been claimed by a consumer already, wait for it to finish moving the old value out
+				Cell &cell = m_Cells[(pos + i) & m_Mask];
+				while (cell.Sequence.load(std::memory_order_acquire) != pos + i)
+				{
+					std::this_thread::yield();
+				}
+				new (&cell.Storage) T(std::move(vals[i]));
+				cell.Sequence.store(pos + i + 1, std::memory_order_release);
+			}
+
+			return claimed;
+		}
+
+		bool TryPop(T &val)
+		{
+			size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell &cell = m_Cells[pos & m_Mask];
+				size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+				intptr_t difference = (intptr_t)sequence - (intptr_t)(pos + 1);
+				if (difference == 0)
+				{
+					if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						T *stored = reinterpret_cast<T*>(&cell.Storage);
+						val = std::move(*stored);
+						stored->~T();
+						cell.Sequence.store(pos + m_Capacity, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0)
+				{
+					return false; // Empty
+				}
+				else
+				{
+					pos = m_DequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		std::shared_ptr<T> TryPop()
+		{
+			T val;
+			if (!TryPop(val))
+				return std::shared_ptr<T>();
+
+			return std::make_shared<T>(std::move(val));
+		}
+
+		// Claims up to maxCount items with a single atomic operation, returns how many items were written to outVals
+		size_t TryPopBatch(T *outVals, size_t maxCount)
+		{
+			size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+			size_t claimed;
+			do
+			{
+				size_t available = m_EnqueuePos.load(std::memory_order_acquire) - pos;
+				claimed = maxCount < available ? maxCount : available;
+				if (claimed == 0)
+					return 0;
+			} while (!m_DequeuePos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed));
+
+			for (size_t i = 0; i < claimed; i++)
+			{
+				// The slot has been claimed by a producer already, wait for it to finish publishing the value
+				Cell &cell = m_Cells[(pos + i) & m_Mask];
+				while (cell.Sequence.load(std::memory_order_acquire) != pos + i + 1)
+				{
+					std::this_thread::yield();
+				}
+				T *stored = reinterpret_cast<T*>(&cell.Storage);
+				outVals[i] = std::move(*stored);
+				stored->~T();
+				cell.Sequence.store(pos + i + m_Capacity, std::memory_order_release);
+			}
+
+			return claimed;
+		}
+
+		void WaitAndPop(T &val)
+		{
+			while (!TryPop(val))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		T WaitAndPop()
+		{
+			T val;
+			WaitAndPop(val);
+			return val;
+		}
+
+		// Empty and Size are only snapshots since other threads can be pushing and popping at the same time
+		bool Empty() const
+		{
+			return Size() == 0;
+		}
+
+		unsigned int Size() const
+		{
+			size_t dequeuePos = m_DequeuePos.load(std::memory_order_acquire);
+			size_t enqueuePos = m_EnqueuePos.load(std::memory_order_acquire);
+			return enqueuePos > dequeuePos ? static_cast<unsigned int>(enqueuePos - dequeuePos) : 0;
+		}
+
+		inline size_t Capacity() const { return m_Capacity; }
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> Sequence;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+		};
+
+		static size_t RoundUpToPowerOfTwo(size_t value)
+		{
+			size_t result = 2;
+			while (result < value)
+				result <<= 1;
+			return result;
+		}
+	private:
+		const size_t m_Capacity;
+		const size_t m_Mask;
+		Cell *m_Cells;
+
+		// Keep the producer and consumer positions on their own cache lines so they don't false share
+		alignas(QueueCacheLineSize) std::atomic<size_t> m_EnqueuePos;
+		alignas(QueueCacheLineSize) std::atomic<size_t> m_DequeuePos;
+	};
+
+	// Single producer single consumer specialization. No compare and swap needed, each side owns its index and caches the other side's index to avoid touching its cache line
+	template<typename T>
+	class LockFreeQueue<T, QueueMode::SPSC>
+	{
+	public:
+		explicit LockFreeQueue(size_t capacity = 1024) : m_Capacity(RoundUpToPowerOfTwo(capacity)), m_Mask(m_Capacity - 1)
+		{
+			m_Slots = new Slot[m_Capacity];
+			m_Head.store(0, std::memory_order_relaxed);
+			m_Tail.store(0, std::memory_order_relaxed);
+			m_CachedHead = 0;
+			m_CachedTail = 0;
+		}
+
+		~LockFreeQueue()
+		{
+			T val;
+			while (TryPop(val)) {}
+			delete[] m_Slots;
+		}
+
+		LockFreeQueue(const LockFreeQueue &copy) = delete;
+		LockFreeQueue& operator=(const LockFreeQueue &copy) = delete;
+
+		bool TryPush(T &&val)
+		{
+			size_t tail = m_Tail.load(std::memory_order_relaxed);
+			if (tail - m_CachedHead == m_Capacity)
+			{
+				m_CachedHead = m_Head.load(std::memory_order_acquire);
+				if (tail - m_CachedHead == m_Capacity)
+					return false; // Full
+			}
+
+			new (&m_Slots[tail & m_Mask].Storage) T(std::move(val));
+			m_Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		void Push(T val)
+		{
+			while (!TryPush(std::move(val)))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		size_t PushBatch(T *vals, size_t count)
+		{
+			size_t tail = m_Tail.load(std::memory_order_relaxed);
+			if (m_Capacity - (tail - m_CachedHead) < count)
+			{
+				m_CachedHead = m_Head.load(std::memory_order_acquire);
+			}
+			size_t space = m_Capacity - (tail - m_CachedHead);
+			size_t pushCount = count < space ? count : space;
+
+			for (size_t i = 0; i < pushCount; i++)
+			{
+				new (&m_Slots[(tail + i) & m_Mask].Storage) T(std::move(vals[i]));
+			}
+			m_Tail.store(tail + pushCount, std::memory_order_release);
+
+			return pushCount;
+		}
+
+		bool TryPop(T &val)
+		{
+			size_t head = m_Head.load(std::memory_order_relaxed);
+			if (head == m_CachedTail)
+			{
+				m_CachedTail = m_Tail.load(std::memory_order_acquire);
+				if (head == m_CachedTail)
+					return false; // Empty
+			}
+
+			T *stored = reinterpret_cast<T*>(&m_Slots[head & m_Mask].Storage);
+			val = std::move(*stored);
+			stored->~T();
+			m_Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		std::shared_ptr<T> TryPop()
+		{
+			T val;
+			if (!TryPop(val))
+				return std::shared_ptr<T>();
+
+			return std::make_shared<T>(std::move(val));
+		}
+
+		size_t TryPopBatch(T *outVals, size_t maxCount)
+		{
+			size_t head = m_Head.load(std::memory_order_relaxed);
+			if (m_CachedTail - head < maxCount)
+			{
+				m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			}
+			size_t available = m_CachedTail - head;
+			size_t popCount = maxCount < available ? maxCount : available;
+
+			for (size_t i = 0; i < popCount; i++)
+			{
+				T *stored = reinterpret_cast<T*>(&m_Slots[(head + i) & m_Mask].Storage);
+				outVals[i] = std::move(*stored);
+				stored->~T();
+			}
+			m_Head.store(head + popCount, std::memory_order_release);
+
+			return popCount;
+		}
+
+		void WaitAndPop(T &val)
+		{
+			while (!TryPop(val))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		T WaitAndPop()
+		{
+			T val;
+			WaitAndPop(val);
+			return val;
+		}
+
+		bool Empty() const
+		{
+			return Size() == 0;
+		}
+
+		unsigned int Size() const
+		{
+			size_t head = m_Head.load(std::memory_order_acquire);
+			size_t tail = m_Tail.load(std::memory_order_acquire);
+			return tail > head ? static_cast<unsigned int>(tail - head) : 0;
+		}
+
+		inline size_t Capacity() const { return m_Capacity; }
+	private:
+		struct Slot
+		{
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+		};
+
+		static size_t RoundUpToPowerOfTwo(size_t value)
+		{
+			size_t result = 2;
+			while (result < value)
+				result <<= 1;
+			return result;
+		}
+	private:
+		const size_t m_Capacity;
+		const size_t m_Mask;
+		Slot *m_Slots;
+
+		// Consumer owned
+		alignas(QueueCacheLineSize) std::atomic<size_t> m_Head;
+		size_t m_CachedTail;
+
+		// Producer owned
+		alignas(QueueCacheLineSize) std::atomic<size_t> m_Tail;
+		size_t m_CachedHead;
+	};
+
+	template<typename T>
+	using SPSCQueue = LockFreeQueue<T, QueueMode::SPSC>;
+}
+#endif
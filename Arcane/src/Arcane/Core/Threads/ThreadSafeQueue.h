@@ -18,25 +18,37 @@ namespace Arcane
 		void Push(T val)
 		{
 			std::lock_guard<std::mutex> lock(m_mutex);
-			m_dataQueue.push(val);
+			m_dataQueue.push(std::move(val));
 			m_dataCondVar.notify_one();
 		}
 
+		size_t PushBatch(T *vals, size_t count)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (size_t i = 0; i < count; i++)
+			{
+				m_dataQueue.push(std::move(vals[i]));
+			}
+			m_dataCondVar.notify_all();
+
+			return count;
+		}
+
 		void WaitAndPop(T& val)
 		{
 			std::unique_lock<std::mutex> lock(m_mutex);
-			m_dataCondVar.wait([&m_dataQueue]() { return !m_dataQueue.empty(); });
+			m_dataCondVar.wait(lock, [this]() { return !m_dataQueue.empty(); });
 
-			val = m_dataQueue.front();
+			val = std::move(m_dataQueue.front());
 			m_dataQueue.pop();
 		}
 
 		T WaitAndPop()
 		{
 			std::unique_lock<std::mutex> lock(m_mutex);
-			m_dataCondVar.wait([&m_dataQueue]() { return !m_dataQueue.empty(); });
+			m_dataCondVar.wait(lock, [this]() { return !m_dataQueue.empty(); });
 
-			T val = m_dataQueue.front();
+			T val = std::move(m_dataQueue.front());
 			m_dataQueue.pop();
 
 			return val;
@@ -50,13 +62,13 @@ namespace Arcane
 				return false;
 			}
 
-			val = m_dataQueue.front();
+			val = std::move(m_dataQueue.front());
 			m_dataQueue.pop();
 
 			return true;
 		}
 
-		T TryPop()
+		std::shared_ptr<T> TryPop()
 		{
 			std::lock_guard<std::mutex> lock(m_mutex);
 			if (m_dataQueue.empty())
@@ -64,11 +76,24 @@ namespace Arcane
 				return std::shared_ptr<T>();
 			}
 
-			T val = m_dataQueue.front();
+			std::shared_ptr<T> val = std::make_shared<T>(std::move(m_dataQueue.front()));
 			m_dataQueue.pop();
 			return val;
 		}
 
+		size_t TryPopBatch(T *outVals, size_t maxCount)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			size_t popCount = 0;
+			while (popCount < maxCount && !m_dataQueue.empty())
+			{
+				outVals[popCount++] = std::move(m_dataQueue.front());
+				m_dataQueue.pop();
+			}
+
+			return popCount;
+		}
+
 		bool Empty()
 		{
 			std::lock_guard<std::mutex> lock(m_mutex);
@@ -13,11 +13,52 @@
 
 // Render Settings
 #define FORWARD_RENDER 0
-
-// Streaming Settings
-#define TEXTURE_LOADS_PER_FRAME 2
-#define CUBEMAP_FACES_PER_FRAME 2
-#define MODELS_PER_FRAME 1
+#define USE_FRUSTUM_CULLING 1 // Models are tested against each view's frustum (camera, shadow casters, cubemap faces) before they are queued
+#define DYNAMIC_BVH_FAT_MARGIN 0.5f // Leaves of moving meshes are grown by this much (world units) on each side, movement that stays inside it doesn't touch the tree
+#define USE_DRAW_CALL_SORTING 1 // Mesh queues are sorted by state before they are flushed so redundant binds can be skipped, can be toggled at runtime in the renderer stats
+#define USE_INSTANCED_RENDERING 1 // Runs of the same mesh and material left next to each other by the sort are drawn with one instanced draw call
+#define USE_GPU_SKINNING 1 // Animated meshes are skinned once a frame by a compute shader and every pass draws the result as static geometry, can be toggled at runtime in the renderer stats
+#define USE_SINGLE_PASS_POINT_SHADOWS 1 // Point light shadow cubemaps are drawn in one layered pass, each model only goes to the faces its bounds touch, can be toggled at runtime in the renderer stats
+
+// Clustered Lighting Settings (point and spot lights are binned into a grid of froxels over each view by a compute shader, lit pixels only loop over the lights of their cluster)
+#define LIGHT_CLUSTER_GRID_X 16
+#define LIGHT_CLUSTER_GRID_Y 9 // X * Y is the work group size of the binning shader, so it has to stay within the GL minimum of 1024
+#define LIGHT_CLUSTER_GRID_Z 24 // Depth slices are spaced exponentially from the near plane to LIGHT_CLUSTER_FAR_PLANE, everything past it shares the last slice
+#define LIGHT_CLUSTER_FAR_PLANE 500.0f
+#define LIGHT_CLUSTER_MAX_LIGHTS 256 // Per cluster, point lights are binned first and anything past this is dropped
+
+// Animation Settings (animators are updated in chunks on the job system and every animator only writes its own bone palette, so the results don't depend on the scheduling)
+#define ANIMATION_ANIMATORS_PER_JOB 32
+#define USE_DETERMINISTIC_ANIMATION_UPDATE 0 // Updates every animator on the calling thread in entity order, useful when testing or stepping through a frame
+
+// Animation Compression Settings (keys are quantized when a clip is loaded, translations and scales to 16 bits per component and rotations to 48 bits with smallest three)
+#define USE_ANIMATION_KEYFRAME_REDUCTION 1 // Keys that interpolating their neighbours reproduces within the errors below are removed, see AnimationCompressionSettings
+#define ANIMATION_COMPRESSION_MAX_TRANSLATION_ERROR 0.0005f
+#define ANIMATION_COMPRESSION_MAX_ROTATION_ERROR 0.0005f // Radians
+#define ANIMATION_COMPRESSION_MAX_SCALE_ERROR 0.0001f
+
+// Streaming Settings (finished async loads are uploaded within a per frame budget, workers copy the decoded data into a persistently mapped staging buffer)
+#define UPLOAD_BUDGET_MB_PER_FRAME 8
+#define UPLOAD_BUDGET_MS_PER_FRAME 2.0
+#define UPLOAD_STAGING_BUFFER_SIZE_MB 64 // 0 disables staging, uploads then read straight from client memory
+
+// Derived Data Cache Settings (decoded textures and cooked models are cached on disk, keyed by the source file's contents and the settings used to process it)
+#define USE_DERIVED_DATA_CACHE 1
+#define DERIVED_DATA_CACHE_DIRECTORY "DerivedDataCache"
+#define DERIVED_DATA_CACHE_MAX_SIZE_MB 4096 // Least recently used entries are evicted once the cache grows past this
+
+// Shader Settings (every program is submitted to the driver up-front and only waited on the first time it is used)
+#define USE_SHADER_PARALLEL_COMPILE 1 // Lets the driver compile on its own threads when it has GL_KHR_parallel_shader_compile (or the ARB version)
+#define USE_SHADER_PROGRAM_BINARY_CACHE 1 // Linked program binaries are kept in the derived data cache keyed by their source and the driver, requires USE_DERIVED_DATA_CACHE
+
+// Texture Compression Settings (textures loaded from files are block compressed along with their mips when they are cooked, see TextureSettings::Compression)
+#define USE_TEXTURE_COMPRESSION 1
+
+// Texture Streaming Settings (async loaded textures with cooked mips start with only their smallest mips resident, the rest are streamed in and out based on their on-screen size)
+#define USE_TEXTURE_STREAMING 1
+#define TEXTURE_STREAMING_BUDGET_MB 512 // Video memory the streamed textures are allowed to take up, textures that aren't streamed don't count against it
+#define TEXTURE_STREAMING_MIN_RESIDENT_SIZE 64 // Mips this size and under are always resident
+#define TEXTURE_STREAMING_MAX_LOADS_IN_FLIGHT 8
 
 // AA Settings
 #define MSAA_SAMPLE_AMOUNT 4 // Only used in forward rendering & for water
@@ -61,6 +102,25 @@
 #define SHADOWMAP_FAR_PLANE_DEFAULT 200.0f
 #define SHADOWMAP_BIAS_DEFAULT 0.007f
 
+// Directional Light Cascaded Shadow Options (ShadowResolution is the resolution of each cascade, they all live in one depth texture array)
+#define SHADOW_CASCADE_MAX_COUNT 4 // The shaders pick a cascade from a vec4 of split depths, so this can't go above 4
+#define SHADOW_CASCADE_COUNT_DEFAULT 4
+#define SHADOW_CASCADE_SPLIT_LAMBDA_DEFAULT 0.8f // Blends the split distances between uniform (0) and logarithmic (1), log puts more resolution close to the camera
+#define SHADOW_CASCADE_DISTANCE_DEFAULT 200.0f // How far from the camera the cascades reach, capped by the camera's far plane
+#define SHADOW_CASCADE_CASTER_DISTANCE 100.0f // How far towards the light each cascade's depth range is pulled back, so casters outside of the view can still cast into it
+
+// Spot Light Shadow Atlas Options (ShadowResolution becomes the largest tile a light can be given, the atlas is allocated once and never resized)
+#define SHADOW_ATLAS_RESOLUTION 4096 // Has to be a power of two so the quad-tree can split it down to any tile size
+#define SHADOW_ATLAS_MIN_TILE_SIZE 128 // Lights are never given a smaller tile, if the budget can't fit them at this size the least important ones lose their shadow instead
+#define SHADOW_ATLAS_MAX_LIGHTS 16 // Size of the shadow caster array in the ShadowUniforms block, the budget can't go over it
+#define SHADOW_ATLAS_LIGHT_BUDGET_DEFAULT 8 // How many spot lights get a tile each frame, the most important ones are picked first
+
+// Shadow Caching Options (static casters are rendered into a cache that is copied into the shadow map each frame before the dynamic casters are drawn on top)
+#define USE_STATIC_SHADOW_CACHING 1 // A light's cache is re-rendered when the light moves or a static model is added, removed or moved, can be toggled at runtime in the renderer stats
+#define SHADOW_CASCADE_FULL_RATE_COUNT 2 // Cascades past these keep last frame's shadow map (dynamic casters included) unless it is their turn to update
+#define SHADOW_ATLAS_FULL_RATE_IMPORTANCE 0.1f // Spot lights with a lower importance than this update at the reduced rate too
+#define SHADOW_DISTANT_UPDATE_INTERVAL 4 // Reduced rate shadow maps are updated once every this many frames, they take turns so the cost is spread out
+
 // SSAO Options
 #define SSAO_KERNEL_SIZE 32 // Maximum amount is restricted by the shader. Only supports a maximum of 64
 
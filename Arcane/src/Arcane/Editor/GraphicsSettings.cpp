@@ -41,6 +41,17 @@ namespace Arcane
 					ImGui::SliderFloat("Sample Radius", &postProcessPass->GetSsaoSampleRadiusRef(), 0.1f, 10.0f);
 					ImGui::SliderFloat("Intensity", &postProcessPass->GetSsaoStrengthRef(), 0.1f, 10.0f);
 				}
+				if (ImGui::CollapsingHeader("Shadows", ImGuiTreeNodeFlags_DefaultOpen))
+				{
+					LightManager *lightManager = scene->GetLightManager();
+					const ShadowAtlas &shadowAtlas = lightManager->GetSpotLightShadowAtlas();
+					u64 atlasArea = static_cast<u64>(shadowAtlas.GetResolution()) * shadowAtlas.GetResolution();
+
+					ImGui::SliderInt("Spot Light Shadow Budget", &lightManager->GetShadowAtlasBudgetRef(), 0, SHADOW_ATLAS_MAX_LIGHTS);
+					if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+						ImGui::SetTooltip("How many spot lights can have a shadow at once. The lights covering the most of the screen are given a tile in the shadow atlas first.");
+					ImGui::Text("Shadow Atlas: %u tiles (%.1f%% used)", static_cast<unsigned int>(lightManager->GetSpotLightShadowTiles().size()), 100.0 * (double)shadowAtlas.GetAllocatedArea() / (double)atlasArea);
+				}
 				ImGui::EndTabItem();
 			}
 			if (ImGui::BeginTabItem("Post Processing"))
@@ -207,17 +207,27 @@ namespace Arcane
 							lightComponent.ShadowResolution = static_cast<ShadowQuality>(shadowChoice);
 							DrawFloatControl("Shadow Bias", lightComponent.ShadowBias, 0.0001f, 0.0f, 1.0f, "%.4f");
 							
-							bool nearModified = DrawFloatControl("Near Plane", lightComponent.ShadowNearPlane, 0.01f, 0.0f, 100.0f);
-							bool farModified = DrawFloatControl("Far Plane", lightComponent.ShadowFarPlane, 1.0f, 0.01f, 10000.0f);
-							if (nearModified)
+							if (lightComponent.Type == LightType::LightType_Directional)
 							{
-								if (lightComponent.ShadowNearPlane > lightComponent.ShadowFarPlane)
-									lightComponent.ShadowFarPlane = lightComponent.ShadowNearPlane;
+								// Shadow quality is the resolution of each cascade
+								ImGui::SliderInt("Cascade Count", &lightComponent.ShadowCascadeCount, 1, SHADOW_CASCADE_MAX_COUNT);
+								ImGui::SliderFloat("Cascade Split Lambda", &lightComponent.ShadowCascadeSplitLambda, 0.0f, 1.0f, "%.2f");
+								DrawFloatControl("Shadow Distance", lightComponent.ShadowCascadeDistance, 1.0f, 1.0f, 10000.0f);
 							}
-							else if (farModified)
+							else
 							{
-								if (lightComponent.ShadowFarPlane < lightComponent.ShadowNearPlane)
-									lightComponent.ShadowNearPlane = lightComponent.ShadowFarPlane;
+								bool nearModified = DrawFloatControl("Near Plane", lightComponent.ShadowNearPlane, 0.01f, 0.0f, 100.0f);
+								bool farModified = DrawFloatControl("Far Plane", lightComponent.ShadowFarPlane, 1.0f, 0.01f, 10000.0f);
+								if (nearModified)
+								{
+									if (lightComponent.ShadowNearPlane > lightComponent.ShadowFarPlane)
+										lightComponent.ShadowFarPlane = lightComponent.ShadowNearPlane;
+								}
+								else if (farModified)
+								{
+									if (lightComponent.ShadowFarPlane < lightComponent.ShadowNearPlane)
+										lightComponent.ShadowNearPlane = lightComponent.ShadowFarPlane;
+								}
 							}
 						}
 					}
@@ -347,6 +357,13 @@ namespace Arcane
 							ImGui::Text("Animation Name: %s", clip->GetAnimationName());
 						}
 #endif
+						if (clip)
+						{
+							const AnimationCompressionStats &compressionStats = clip->GetCompressionStats();
+							ImGui::Text("Keys: %u (%u imported)", compressionStats.KeyCount, compressionStats.SourceKeyCount);
+							ImGui::Text("Memory: %.1fKB (%.1fKB imported)", compressionStats.CompressedBytes / 1024.0, compressionStats.SourceBytes / 1024.0);
+							ImGui::Text("Max Joint Error: %f", compressionStats.MaxJointError);
+						}
 					}
 				}
 			}
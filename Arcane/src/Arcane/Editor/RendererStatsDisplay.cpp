@@ -3,6 +3,9 @@
 
 #include <Arcane/Vendor/Imgui/imgui.h>
 #include <Arcane/Graphics/Renderer/Renderer.h>
+#include <Arcane/Core/Threads/JobSystem.h>
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
+#include <Arcane/Util/Loaders/AssetManager.h>
 
 #ifdef ARC_DEV_BUILD
 #include <Arcane/Platform/OpenGL/GPUTimerManager.h>
@@ -24,6 +27,98 @@ namespace Arcane
 			ImGui::Text("Total Draw Call Count: %u", rendererStats.DrawCallCount);
 			ImGui::Text("Mesh Draw Call Count: %u", rendererStats.MeshesDrawnCount);
 			ImGui::Text("Quads Draw Call Count: %u", rendererStats.QuadsDrawnCount);
+			unsigned int meshesTested = rendererStats.MeshesSubmittedCount + rendererStats.MeshesCulledCount;
+			ImGui::Text("Meshes Submitted: %u  Culled: %u (%.1f%%)", rendererStats.MeshesSubmittedCount, rendererStats.MeshesCulledCount,
+				meshesTested > 0 ? 100.0f * static_cast<float>(rendererStats.MeshesCulledCount) / static_cast<float>(meshesTested) : 0.0f);
+			ImGui::Text("Binds - Material: %u  Texture: %u  VAO: %u", rendererStats.MaterialBindCount, rendererStats.TextureBindCount, rendererStats.VertexArrayBindCount);
+			ImGui::Text("Mesh Submit Time: %.3f ms", rendererStats.MeshSubmitTimeMS);
+			ImGui::Text("Instanced Draw Calls: %u (%u instances)", rendererStats.InstancedDrawCallCount, rendererStats.InstancesDrawnCount);
+			ImGui::Text("Uniform Uploads: %u  Skipped: %u", rendererStats.UniformUploadCount, rendererStats.UniformUploadsSkippedCount);
+			ImGui::Text("GPU Skinned Models: %u  Meshes: %u  Vertices: %u (%u dispatches)", rendererStats.SkinnedModelCount, rendererStats.SkinnedMeshCount, rendererStats.SkinnedVertexCount, rendererStats.SkinningDispatchCount);
+			ImGui::Text("Shadow Cascade Draw Calls:");
+			for (int i = 0; i < SHADOW_CASCADE_MAX_COUNT; i++)
+			{
+				ImGui::SameLine();
+				ImGui::Text("%u", rendererStats.ShadowCascadeDrawCallCount[i]);
+			}
+			ImGui::Text("Point Shadow Draw Calls: %u  Submit Time: %.3f ms", rendererStats.PointShadowDrawCallCount, rendererStats.PointShadowSubmitTimeMS);
+			bool drawCallSorting = Renderer::GetDrawCallSortingEnabled();
+			if (ImGui::Checkbox("Sort Draw Calls", &drawCallSorting))
+			{
+				Renderer::SetDrawCallSortingEnabled(drawCallSorting);
+			}
+			ImGui::SameLine();
+			bool instancing = Renderer::GetInstancingEnabled();
+			if (ImGui::Checkbox("Instanced Rendering", &instancing))
+			{
+				Renderer::SetInstancingEnabled(instancing);
+			}
+			ImGui::SameLine();
+			bool gpuSkinning = Renderer::GetGPUSkinningEnabled();
+			if (ImGui::Checkbox("GPU Skinning", &gpuSkinning))
+			{
+				Renderer::SetGPUSkinningEnabled(gpuSkinning);
+			}
+			ImGui::SameLine();
+			bool singlePassPointShadows = Renderer::GetSinglePassPointShadowsEnabled();
+			if (ImGui::Checkbox("Single Pass Point Shadows", &singlePassPointShadows))
+			{
+				Renderer::SetSinglePassPointShadowsEnabled(singlePassPointShadows);
+			}
+			ImGui::SameLine();
+			bool shadowCaching = Renderer::GetShadowCachingEnabled();
+			if (ImGui::Checkbox("Static Shadow Caching", &shadowCaching))
+			{
+				Renderer::SetShadowCachingEnabled(shadowCaching);
+			}
+			ImGui::Separator();
+			if (ImGui::CollapsingHeader("Job System"))
+			{
+				JobSystem &jobSystem = JobSystem::GetInstance();
+				JobSystemStats jobStats = jobSystem.GetStats();
+
+				ImGui::Text("Workers: %u", jobStats.WorkerCount);
+				ImGui::Text("Queue Depth: %u (Max %u)", jobStats.QueueDepth, jobStats.MaxQueueDepth);
+				ImGui::Text("Jobs Executed: %llu / %llu", jobStats.JobsExecuted, jobStats.JobsSubmitted);
+				ImGui::Text("Steals: %llu", jobStats.StealCount);
+				ImGui::Text("Queue Latency: %.3f ms avg, %.3f ms max", jobStats.AverageLatencyMS, jobStats.MaxLatencyMS);
+
+				// Bucket i counts jobs that waited less than 2^i microseconds
+				float histogram[JobLatencyBucketCount];
+				for (int i = 0; i < JobLatencyBucketCount; i++)
+				{
+					histogram[i] = static_cast<float>(jobStats.LatencyHistogram[i]);
+				}
+				ImGui::PlotHistogram("Latency (log2 us)", histogram, JobLatencyBucketCount, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+				if (ImGui::Button("Reset Job Stats"))
+				{
+					jobSystem.ResetStats();
+				}
+			}
+			if (ImGui::CollapsingHeader("Derived Data Cache"))
+			{
+				DerivedDataCache &derivedDataCache = DerivedDataCache::GetInstance();
+				DerivedDataCacheStats cacheStats = derivedDataCache.GetStats();
+				u64 lookups = cacheStats.Hits + cacheStats.Misses;
+
+				ImGui::Text("Hits: %llu  Misses: %llu (%.1f%% hit rate)", cacheStats.Hits, cacheStats.Misses, lookups > 0 ? 100.0 * (double)cacheStats.Hits / (double)lookups : 0.0);
+				ImGui::Text("Stores: %llu  Evictions: %llu", cacheStats.Stores, cacheStats.Evictions);
+				ImGui::Text("Entries: %u (%.1f / %.1f MB)", cacheStats.EntryCount, (double)cacheStats.TotalSize / (1024.0 * 1024.0), (double)cacheStats.MaxSize / (1024.0 * 1024.0));
+				if (ImGui::Button("Reset Cache Stats"))
+				{
+					derivedDataCache.ResetStats();
+				}
+			}
+			if (ImGui::CollapsingHeader("Asset Uploads"))
+			{
+				const AssetUploadStats &uploadStats = AssetManager::GetInstance().GetUploadStats();
+
+				ImGui::Text("Uploaded: %.2f MB in %.3f ms (%d uploads)", (double)uploadStats.BytesUploaded / (1024.0 * 1024.0), uploadStats.UploadTimeMS, uploadStats.UploadCount);
+				ImGui::Text("Pending Uploads: %d", uploadStats.PendingUploads);
+				ImGui::Text("Measured Throughput: %.1f MB/ms", uploadStats.MeasuredBytesPerMS / (1024.0 * 1024.0));
+				ImGui::Text("Staging Buffer: %.1f / %.1f MB", (double)uploadStats.StagingUsed / (1024.0 * 1024.0), (double)uploadStats.StagingSize / (1024.0 * 1024.0));
+				ImGui::Text("Staging Fallbacks: %llu", uploadStats.StagingFallbacks);
+			}
 			ImGui::Separator();
 #ifdef ARC_DEV_BUILD
 			float frametime = 1000.0f / ImGui::GetIO().Framerate;
@@ -0,0 +1,63 @@
+#include "arcpch.h"
+#include "TextureStreamingPanel.h"
+
+#include <Arcane/Vendor/Imgui/imgui.h>
+#include <Arcane/Util/Loaders/TextureStreamer.h>
+
+namespace Arcane
+{
+	TextureStreamingPanel::TextureStreamingPanel()
+	{
+
+	}
+
+	void TextureStreamingPanel::OnImGuiRender()
+	{
+		TextureStreamer &textureStreamer = TextureStreamer::GetInstance();
+		TextureStreamerStats streamerStats = textureStreamer.GetStats();
+		const double bytesToMB = 1.0 / (1024.0 * 1024.0);
+
+		ImGui::Begin("Texture Streaming");
+		{
+			int budgetMB = static_cast<int>(streamerStats.BudgetBytes / (1024 * 1024));
+			if (ImGui::DragInt("Budget (MB)", &budgetMB, 1.0f, 1, 16384))
+			{
+				textureStreamer.SetBudget(static_cast<u64>(budgetMB) * 1024 * 1024);
+			}
+
+			char overlay[64];
+			snprintf(overlay, sizeof(overlay), "%.1f / %.1f MB", (double)streamerStats.ResidentBytes * bytesToMB, (double)streamerStats.BudgetBytes * bytesToMB);
+			ImGui::ProgressBar(streamerStats.BudgetBytes > 0 ? (float)((double)streamerStats.ResidentBytes / (double)streamerStats.BudgetBytes) : 0.0f, ImVec2(-1.0f, 0.0f), overlay);
+			ImGui::Text("Wanted: %.1f MB (before the budget is applied)", (double)streamerStats.WantedBytes * bytesToMB);
+			ImGui::Text("Streamed Textures: %u  Loads In Flight: %u", streamerStats.StreamedTextureCount, streamerStats.LoadsInFlight);
+			ImGui::Text("Mips Streamed In: %llu  Mips Evicted: %llu", streamerStats.MipsStreamedIn, streamerStats.MipsEvicted);
+			ImGui::Separator();
+
+			ImGui::BeginChild("Streamed Textures");
+			{
+				ImGui::Columns(5, "StreamedTextureColumns");
+				ImGui::Text("Texture"); ImGui::NextColumn();
+				ImGui::Text("Size"); ImGui::NextColumn();
+				ImGui::Text("Resident Mip (Wanted)"); ImGui::NextColumn();
+				ImGui::Text("Resident"); ImGui::NextColumn();
+				ImGui::Text("Screen Size"); ImGui::NextColumn();
+				ImGui::Separator();
+
+				for (const StreamedTexture &streamedTexture : textureStreamer.GetStreamedTextures())
+				{
+					const Texture *texture = streamedTexture.AssetTexture;
+					int residentMip = texture->GetFirstResidentMip();
+
+					ImGui::TextUnformatted(streamedTexture.Path.c_str()); ImGui::NextColumn();
+					ImGui::Text("%ux%u", glm::max(1u, texture->GetWidth() >> residentMip), glm::max(1u, texture->GetHeight() >> residentMip)); ImGui::NextColumn();
+					ImGui::Text("%d (%d)%s", residentMip, streamedTexture.WantedMip, streamedTexture.LoadInFlight ? " Loading" : ""); ImGui::NextColumn();
+					ImGui::Text("%.2f MB", (double)texture->GetResidentMemorySize() * bytesToMB); ImGui::NextColumn();
+					ImGui::Text("%.0f px", streamedTexture.ScreenSize); ImGui::NextColumn();
+				}
+				ImGui::Columns(1);
+			}
+			ImGui::EndChild();
+		}
+		ImGui::End();
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+#ifndef TEXTURESTREAMINGPANEL_H
+#define TEXTURESTREAMINGPANEL_H
+
+namespace Arcane
+{
+	class TextureStreamingPanel
+	{
+	public:
+		TextureStreamingPanel();
+
+		void OnImGuiRender();
+	};
+}
+#endif
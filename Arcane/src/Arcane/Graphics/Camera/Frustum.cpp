@@ -0,0 +1,170 @@
+#include "arcpch.h"
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define ARC_FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#else
+#define ARC_FRUSTUM_SSE 0
+#endif
+
+namespace Arcane
+{
+	void CullingBoundsList::Clear()
+	{
+		CenterX.clear(); CenterY.clear(); CenterZ.clear();
+		ExtentX.clear(); ExtentY.clear(); ExtentZ.clear();
+		Radius.clear();
+	}
+
+	void CullingBoundsList::Add(const glm::vec3 &center, const glm::vec3 &extents, float radius)
+	{
+		CenterX.push_back(center.x); CenterY.push_back(center.y); CenterZ.push_back(center.z);
+		ExtentX.push_back(extents.x); ExtentY.push_back(extents.y); ExtentZ.push_back(extents.z);
+		Radius.push_back(radius);
+	}
+
+	Frustum::Frustum()
+	{
+		SetFromViewProjection(glm::mat4(1.0f));
+	}
+
+	Frustum::Frustum(const glm::mat4 &viewProjection)
+	{
+		SetFromViewProjection(viewProjection);
+	}
+
+	void Frustum::SetFromViewProjection(const glm::mat4 &viewProjection)
+	{
+		// Gribb/Hartmann plane extraction, glm is column major so the rows are gathered from each column
+		glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+		m_Planes[0] = row3 + row0;
+		m_Planes[1] = row3 - row0;
+		m_Planes[2] = row3 + row1;
+		m_Planes[3] = row3 - row1;
+		m_Planes[4] = row3 + row2;
+		m_Planes[5] = row3 - row2;
+
+		for (int i = 0; i < 6; i++)
+		{
+			float length = glm::length(glm::vec3(m_Planes[i]));
+			if (length > 0.0f)
+				m_Planes[i] /= length;
+		}
+	}
+
+	bool Frustum::IntersectsSphere(const glm::vec3 &center, float radius) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (glm::dot(glm::vec3(m_Planes[i]), center) + m_Planes[i].w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::IntersectsAABB(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const
+	{
+		glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		glm::vec3 extents = (boundsMax - boundsMin) * 0.5f;
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 normal(m_Planes[i]);
+			if (glm::dot(normal, center) + m_Planes[i].w < -glm::dot(glm::abs(normal), extents))
+				return false;
+		}
+		return true;
+	}
+
+	FrustumTestResult Frustum::ClassifyAABB(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const
+	{
+		glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		glm::vec3 extents = (boundsMax - boundsMin) * 0.5f;
+		FrustumTestResult result = FrustumTestResult::Inside;
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 normal(m_Planes[i]);
+			float distance = glm::dot(normal, center) + m_Planes[i].w;
+			float radius = glm::dot(glm::abs(normal), extents);
+			if (distance < -radius)
+				return FrustumTestResult::Outside;
+			if (distance < radius)
+				result = FrustumTestResult::Intersecting;
+		}
+		return result;
+	}
+
+	size_t Frustum::Cull(const CullingBoundsList &bounds, std::vector<u8> &outVisible) const
+	{
+		size_t count = bounds.Size();
+		outVisible.resize(count);
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+#if ARC_FRUSTUM_SSE
+		__m128 planeX[6], planeY[6], planeZ[6], planeW[6], planeAbsX[6], planeAbsY[6], planeAbsZ[6];
+		for (int p = 0; p < 6; p++)
+		{
+			planeX[p] = _mm_set1_ps(m_Planes[p].x);
+			planeY[p] = _mm_set1_ps(m_Planes[p].y);
+			planeZ[p] = _mm_set1_ps(m_Planes[p].z);
+			planeW[p] = _mm_set1_ps(m_Planes[p].w);
+			planeAbsX[p] = _mm_set1_ps(glm::abs(m_Planes[p].x));
+			planeAbsY[p] = _mm_set1_ps(glm::abs(m_Planes[p].y));
+			planeAbsZ[p] = _mm_set1_ps(glm::abs(m_Planes[p].z));
+		}
+		const __m128 zero = _mm_setzero_ps();
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 centerX = _mm_loadu_ps(&bounds.CenterX[i]), centerY = _mm_loadu_ps(&bounds.CenterY[i]), centerZ = _mm_loadu_ps(&bounds.CenterZ[i]);
+			__m128 extentX = _mm_loadu_ps(&bounds.ExtentX[i]), extentY = _mm_loadu_ps(&bounds.ExtentY[i]), extentZ = _mm_loadu_ps(&bounds.ExtentZ[i]);
+			__m128 radius = _mm_loadu_ps(&bounds.Radius[i]);
+
+			// An entry is outside once its signed distance to any plane is below the negated radius, the box's radius is its extents projected onto the plane's normal
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (int p = 0; p < 6; p++)
+			{
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)), _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+				__m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeAbsX[p], extentX), _mm_mul_ps(planeAbsY[p], extentY)), _mm_mul_ps(planeAbsZ[p], extentZ));
+				__m128 planeRadius = _mm_min_ps(boxRadius, radius);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, planeRadius), zero));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				u8 visible = static_cast<u8>((mask >> lane) & 1);
+				outVisible[i + lane] = visible;
+				visibleCount += visible;
+			}
+		}
+#endif
+
+		// Whatever doesn't fill a full group of four (or everything without SSE)
+		for (; i < count; i++)
+		{
+			glm::vec3 center(bounds.CenterX[i], bounds.CenterY[i], bounds.CenterZ[i]);
+			glm::vec3 extents(bounds.ExtentX[i], bounds.ExtentY[i], bounds.ExtentZ[i]);
+			u8 visible = 1;
+			for (int p = 0; p < 6; p++)
+			{
+				glm::vec3 normal(m_Planes[p]);
+				float planeRadius = glm::min(glm::dot(glm::abs(normal), extents), bounds.Radius[i]);
+				if (glm::dot(normal, center) + m_Planes[p].w + planeRadius < 0.0f)
+				{
+					visible = 0;
+					break;
+				}
+			}
+			outVisible[i] = visible;
+			visibleCount += visible;
+		}
+
+		return visibleCount;
+	}
+}
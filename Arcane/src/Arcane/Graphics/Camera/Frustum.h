@@ -0,0 +1,48 @@
+#pragma once
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+namespace Arcane
+{
+	// Structure of arrays of world space bounds so the frustum can test four of them at a time. Each entry is an AABB given by its centre and
+	// half extents along with a bounding sphere sharing that centre, whichever of the two is tighter against a plane is the one that gets used
+	struct CullingBoundsList
+	{
+		std::vector<float> CenterX, CenterY, CenterZ;
+		std::vector<float> ExtentX, ExtentY, ExtentZ;
+		std::vector<float> Radius;
+
+		void Clear();
+		void Add(const glm::vec3 &center, const glm::vec3 &extents, float radius);
+		inline size_t Size() const { return Radius.size(); }
+	};
+
+	enum class FrustumTestResult
+	{
+		Outside,
+		Intersecting,
+		Inside
+	};
+
+	class Frustum
+	{
+	public:
+		Frustum();
+		Frustum(const glm::mat4 &viewProjection);
+
+		// Extracts the six planes from a view projection matrix, they are normalized so the distances can be compared against radii
+		void SetFromViewProjection(const glm::mat4 &viewProjection);
+
+		bool IntersectsSphere(const glm::vec3 &center, float radius) const;
+		bool IntersectsAABB(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const;
+		FrustumTestResult ClassifyAABB(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const;
+
+		// Writes 1 for every entry that is at least partially inside the frustum and 0 for the ones that are fully outside of it. Returns the visible count
+		size_t Cull(const CullingBoundsList &bounds, std::vector<u8> &outVisible) const;
+
+		inline const glm::vec4& GetPlane(int index) const { return m_Planes[index]; }
+	private:
+		glm::vec4 m_Planes[6]; // Left, Right, Bottom, Top, Near, Far. xyz is the normal pointing inside the frustum, w is the distance
+	};
+}
+#endif
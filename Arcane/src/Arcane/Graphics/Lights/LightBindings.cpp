@@ -2,36 +2,35 @@
 #include "LightBindings.h"
 
 #include <Arcane/Scene/Components.h>
-#include <Arcane/Graphics/Shader.h>
 
 namespace Arcane
 {
-	void LightBindings::BindDirectionalLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, Shader *shader, int currentLightIndex)
+	void LightBindings::SetDirectionalLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, LightUniformData &lightData, int currentLightIndex)
 	{
 		ARC_ASSERT(currentLightIndex < MaxDirLights, "Exceeded Directional Light Count");
-		shader->SetUniform(("dirLights[" + std::to_string(currentLightIndex) + "].direction").c_str(), transformComponent.GetForward());
-		shader->SetUniform(("dirLights[" + std::to_string(currentLightIndex) + "].intensity").c_str(), lightComponent.Intensity);
-		shader->SetUniform(("dirLights[" + std::to_string(currentLightIndex) + "].lightColour").c_str(), lightComponent.LightColour);
+		DirLightUniformData &light = lightData.DirLights[currentLightIndex];
+		light.Direction = transformComponent.GetForward();
+		light.Intensity = lightComponent.Intensity;
+		light.LightColour = lightComponent.LightColour;
 	}
 
-	void LightBindings::BindPointLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, Shader *shader, int currentLightIndex)
+	void LightBindings::SetPointLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, PointLightUniformData &light)
 	{
-		ARC_ASSERT(currentLightIndex < MaxPointLights, "Exceeded Point Light Count");
-		shader->SetUniform(("pointLights[" + std::to_string(currentLightIndex) + "].position").c_str(), transformComponent.Translation);
-		shader->SetUniform(("pointLights[" + std::to_string(currentLightIndex) + "].intensity").c_str(), lightComponent.Intensity);
-		shader->SetUniform(("pointLights[" + std::to_string(currentLightIndex) + "].lightColour").c_str(), lightComponent.LightColour);
-		shader->SetUniform(("pointLights[" + std::to_string(currentLightIndex) + "].attenuationRadius").c_str(), lightComponent.AttenuationRange);
+		light.Position = transformComponent.Translation;
+		light.Intensity = lightComponent.Intensity;
+		light.LightColour = lightComponent.LightColour;
+		light.AttenuationRadius = lightComponent.AttenuationRange;
 	}
 
-	void LightBindings::BindSpotLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, Shader *shader, int currentLightIndex)
+	void LightBindings::SetSpotLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, SpotLightUniformData &light)
 	{
-		ARC_ASSERT(currentLightIndex < MaxSpotLights, "Exceeded Spot Light Count");
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].position").c_str(), transformComponent.Translation);
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].direction").c_str(), transformComponent.GetForward());
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].intensity").c_str(), lightComponent.Intensity);
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].lightColour").c_str(), lightComponent.LightColour);
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].attenuationRadius").c_str(), lightComponent.AttenuationRange);
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].cutOff").c_str(), lightComponent.InnerCutOff);
-		shader->SetUniform(("spotLights[" + std::to_string(currentLightIndex) + "].outerCutOff").c_str(), lightComponent.OuterCutOff);
+		light.Position = transformComponent.Translation;
+		light.Direction = transformComponent.GetForward();
+		light.Intensity = lightComponent.Intensity;
+		light.LightColour = lightComponent.LightColour;
+		light.AttenuationRadius = lightComponent.AttenuationRange;
+		light.CutOff = lightComponent.InnerCutOff;
+		light.OuterCutOff = lightComponent.OuterCutOff;
+		light.ShadowIndex = -1; // Filled in by the light manager, it knows which lights have a shadow this frame
 	}
 }
@@ -4,20 +4,58 @@
 
 namespace Arcane
 {
-	class Shader;
 	struct TransformComponent;
 	struct LightComponent;
 
+	// Mirrors of the light structs in the light shaders, the padding is what std140 inserts so these can be uploaded as is. Point and spot lights live in std430
+	// storage buffers instead of the LightUniforms block, which lays out these structs the same way
+	struct DirLightUniformData
+	{
+		glm::vec3 Direction;
+		float Intensity;
+		glm::vec3 LightColour;
+		float Padding;
+	};
+
+	struct PointLightUniformData
+	{
+		glm::vec3 Position;
+		float Intensity;
+		glm::vec3 LightColour;
+		float AttenuationRadius;
+	};
+
+	struct SpotLightUniformData
+	{
+		glm::vec3 Position;
+		float Intensity;
+		glm::vec3 Direction;
+		float AttenuationRadius;
+		glm::vec3 LightColour;
+		float CutOff;
+		float OuterCutOff;
+		int ShadowIndex; // Index into the ShadowUniforms block's spot light shadows, -1 if the light wasn't given a tile in the shadow atlas
+		float Padding[2];
+	};
+
 	class LightBindings
 	{
 	public:
-		static void BindDirectionalLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, Shader *shader, int currentLightIndex);
-		static void BindPointLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, Shader *shader, int currentLightIndex);
-		static void BindSpotLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, Shader *shader, int currentLightIndex);
-
+		// Directional lights reach every pixel so there is no point culling them, they stay in the uniform block. Point and spot lights have no limit
 		const static int MaxDirLights = 3;
-		const static int MaxPointLights = 6;
-		const static int MaxSpotLights = 6;
+
+		struct LightUniformData
+		{
+			glm::ivec4 NumDirPointSpotLights;
+			DirLightUniformData DirLights[MaxDirLights];
+		};
+
+		static void SetDirectionalLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, LightUniformData &lightData, int currentLightIndex);
+		static void SetPointLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, PointLightUniformData &light);
+		static void SetSpotLight(const TransformComponent &transformComponent, const LightComponent &lightComponent, SpotLightUniformData &light);
 	};
+
+	static_assert(sizeof(DirLightUniformData) == 32 && sizeof(PointLightUniformData) == 32 && sizeof(SpotLightUniformData) == 64, "Light uniform data no longer matches the std140 layout");
+	static_assert(sizeof(LightBindings::LightUniformData) == 16 + 32 * LightBindings::MaxDirLights, "Light uniform data no longer matches the std140 layout");
 }
 #endif
@@ -0,0 +1,83 @@
+#include "arcpch.h"
+#include "LightClusters.h"
+
+#include <Arcane/Graphics/Shader.h>
+#include <Arcane/Graphics/Camera/ICamera.h>
+#include <Arcane/Graphics/Lights/LightBindings.h>
+#include <Arcane/Graphics/Renderer/GLCache.h>
+#include <Arcane/Platform/OpenGL/ShaderStorageBuffer.h>
+#include <Arcane/Platform/OpenGL/UniformBuffer.h>
+#include <Arcane/Util/Loaders/ShaderLoader.h>
+
+namespace Arcane
+{
+	static constexpr u32 s_ClusterCount = LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y * LIGHT_CLUSTER_GRID_Z;
+	static_assert(LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y <= 1024, "A depth slice of clusters has to fit in one work group of the binning shader");
+
+	LightClusters::LightClusters() : m_GLCache(GLCache::GetInstance())
+	{
+		m_BinningShader = ShaderLoader::LoadShader("Compute/Light_Clustering.glsl");
+
+		m_PointLightBuffer = new ShaderStorageBuffer(ShaderStorageBufferBindingPointLights);
+		m_SpotLightBuffer = new ShaderStorageBuffer(ShaderStorageBufferBindingSpotLights);
+		m_ClusterUniformBuffer = new UniformBuffer(sizeof(LightClusterUniformData), UniformBufferBindingLightClusters);
+
+		// Every cluster gets a fixed size slice of the index list, which saves the binning shader a prefix sum over the counts for a few MB of video memory
+		m_ClusterLightCountBuffer = new ShaderStorageBuffer(ShaderStorageBufferBindingLightClusterCounts);
+		m_ClusterLightCountBuffer->Reserve(s_ClusterCount * sizeof(glm::uvec2));
+		m_ClusterLightIndexBuffer = new ShaderStorageBuffer(ShaderStorageBufferBindingLightClusterIndices);
+		m_ClusterLightIndexBuffer->Reserve(static_cast<size_t>(s_ClusterCount) * LIGHT_CLUSTER_MAX_LIGHTS * sizeof(u32));
+	}
+
+	LightClusters::~LightClusters()
+	{
+		delete m_PointLightBuffer;
+		delete m_SpotLightBuffer;
+		delete m_ClusterLightCountBuffer;
+		delete m_ClusterLightIndexBuffer;
+		delete m_ClusterUniformBuffer;
+	}
+
+	void LightClusters::SetLights(const std::vector<PointLightUniformData> &pointLights, const std::vector<SpotLightUniformData> &spotLights)
+	{
+		m_LightsChanged |= m_PointLightBuffer->SetData(pointLights.data(), pointLights.size() * sizeof(PointLightUniformData));
+		m_LightsChanged |= m_SpotLightBuffer->SetData(spotLights.data(), spotLights.size() * sizeof(SpotLightUniformData));
+		m_PointLightCount = static_cast<u32>(pointLights.size());
+		m_SpotLightCount = static_cast<u32>(spotLights.size());
+	}
+
+	void LightClusters::Build(ICamera *camera)
+	{
+		// The water reflection moves the camera it is given around instead of using its own, so the matrices are what identify the view
+		glm::mat4 view = camera->GetViewMatrix();
+		glm::mat4 projection = camera->GetProjectionMatrix();
+		if (!m_LightsChanged && view == m_BuiltView && projection == m_BuiltProjection)
+			return;
+
+		m_LightsChanged = false;
+		m_BuiltView = view;
+		m_BuiltProjection = projection;
+
+		// Exponentially spaced slices keep the clusters close to cube shaped at every depth. Past LIGHT_CLUSTER_FAR_PLANE there is rarely much lit by local lights,
+		// so the last slice is stretched to the far plane instead of spending slices out there
+		LightClusterUniformData clusterData;
+		clusterData.NearPlane = camera->GetNearPlane();
+		clusterData.FarPlane = camera->GetFarPlane();
+		float slicedFarPlane = glm::max(glm::min(LIGHT_CLUSTER_FAR_PLANE, clusterData.FarPlane), clusterData.NearPlane * 2.0f);
+		float logDepthRange = std::log(slicedFarPlane / clusterData.NearPlane);
+		clusterData.DepthSliceScale = LIGHT_CLUSTER_GRID_Z / logDepthRange;
+		clusterData.DepthSliceBias = -LIGHT_CLUSTER_GRID_Z * std::log(clusterData.NearPlane) / logDepthRange;
+		m_ClusterUniformBuffer->SetData(&clusterData, sizeof(clusterData));
+
+		// One work group per depth slice, it still runs with no lights so every cluster's counts get cleared
+		m_GLCache->SetShader(m_BinningShader);
+		m_BinningShader->SetUniform("clusterView", view);
+		m_BinningShader->SetUniform("clusterProjectionInverse", glm::inverse(projection));
+		m_BinningShader->SetUniform("pointLightCount", static_cast<int>(m_PointLightCount));
+		m_BinningShader->SetUniform("spotLightCount", static_cast<int>(m_SpotLightCount));
+		glDispatchCompute(1, 1, LIGHT_CLUSTER_GRID_Z);
+
+		// The lit shaders read the cluster lists as storage buffers
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
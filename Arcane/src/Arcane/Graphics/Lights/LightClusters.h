@@ -0,0 +1,60 @@
+#pragma once
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+/*
+	Clustered light culling. Each view is split into a grid of froxels, LIGHT_CLUSTER_GRID_X by LIGHT_CLUSTER_GRID_Y tiles on screen and LIGHT_CLUSTER_GRID_Z depth
+	slices. A compute shader tests the bounding sphere of every point and spot light against the view space bounds of every cluster and writes out the indices of
+	the lights touching it, so lit shaders only loop over the lights of the cluster a pixel falls in instead of every light in the scene. The lights and the
+	cluster lists stay bound at fixed storage buffer bindings, the same way the shared uniform blocks do
+*/
+
+namespace Arcane
+{
+	class Shader;
+	class ICamera;
+	class GLCache;
+	class UniformBuffer;
+	class ShaderStorageBuffer;
+	struct PointLightUniformData;
+	struct SpotLightUniformData;
+
+	// std140 mirror of the LightClusterUniforms block
+	struct LightClusterUniformData
+	{
+		float DepthSliceScale; // A view space depth d falls in slice log(d) * scale + bias
+		float DepthSliceBias;
+		float NearPlane;
+		float FarPlane; // Where the last slice ends, it covers everything from LIGHT_CLUSTER_FAR_PLANE to the camera's far plane
+	};
+	static_assert(sizeof(LightClusterUniformData) == 16, "Light cluster uniform data no longer matches the std140 layout");
+
+	class LightClusters
+	{
+	public:
+		LightClusters();
+		~LightClusters();
+
+		// The lights are only re-uploaded when they changed since the last call
+		void SetLights(const std::vector<PointLightUniformData> &pointLights, const std::vector<SpotLightUniformData> &spotLights);
+
+		// Bins the lights into the camera's clusters. Skipped when neither the lights nor the camera changed since the last build, so the passes drawing the same
+		// view one after the other only pay for it once
+		void Build(ICamera *camera);
+
+		inline u32 GetPointLightCount() const { return m_PointLightCount; }
+		inline u32 GetSpotLightCount() const { return m_SpotLightCount; }
+	private:
+		GLCache *m_GLCache;
+		Shader *m_BinningShader;
+
+		ShaderStorageBuffer *m_PointLightBuffer, *m_SpotLightBuffer;
+		ShaderStorageBuffer *m_ClusterLightCountBuffer, *m_ClusterLightIndexBuffer;
+		UniformBuffer *m_ClusterUniformBuffer;
+
+		u32 m_PointLightCount = 0, m_SpotLightCount = 0;
+		bool m_LightsChanged = true;
+		glm::mat4 m_BuiltView, m_BuiltProjection;
+	};
+}
+#endif
@@ -2,43 +2,54 @@
 #include "LightManager.h"
 
 #include <Arcane/Graphics/Lights/LightBindings.h>
+#include <Arcane/Graphics/Lights/LightClusters.h>
 #include <Arcane/Graphics/Shader.h>
 #include <Arcane/Graphics/Texture/Cubemap.h>
+#include <Arcane/Graphics/Texture/Texture.h>
 #include <Arcane/Scene/Components.h>
 #include <Arcane/Scene/Scene.h>
 #include <Arcane/Graphics/Camera/ICamera.h>
+#include <Arcane/Graphics/Camera/Frustum.h>
+#include <Arcane/Graphics/Renderer/Renderpass/RenderPassType.h>
+#include <Arcane/Platform/OpenGL/UniformBuffer.h>
 
 namespace Arcane
 {
-	LightManager::LightManager(Scene *scene) : m_Scene(scene), m_DirectionalLightShadowFramebuffer(nullptr), m_SpotLightShadowFramebuffer(nullptr), m_PointLightShadowCubemap(nullptr),
-		m_ClosestDirectionalLightShadowCaster(nullptr), m_ClosestSpotLightShadowCaster(nullptr), m_ClosestPointLightShadowCaster(nullptr)
+	LightManager::LightManager(Scene *scene) : m_Scene(scene), m_LightUniformBuffer(nullptr), m_ShadowUniformBuffer(nullptr), m_LightClusters(nullptr),
+		m_ClosestDirectionalLightShadowCaster(nullptr), m_DirectionalLightShadowCascades(nullptr), m_SpotLightShadowAtlas(SHADOW_ATLAS_RESOLUTION), m_SpotLightShadowAtlasFramebuffer(nullptr),
+		m_ClosestPointLightShadowCaster(nullptr), m_PointLightShadowCubemap(nullptr)
 	{
 
 	}
 
 	LightManager::~LightManager()
 	{
-		delete m_DirectionalLightShadowFramebuffer;
-		delete m_SpotLightShadowFramebuffer;
+		delete m_DirectionalLightShadowCascades;
+		delete m_SpotLightShadowAtlasFramebuffer;
 		delete m_PointLightShadowCubemap;
+		delete m_LightUniformBuffer;
+		delete m_ShadowUniformBuffer;
+		delete m_LightClusters;
 	}
 
 	void LightManager::Init()
 	{
+		m_LightUniformBuffer = new UniformBuffer(sizeof(LightBindings::LightUniformData), UniformBufferBindingLights);
+		m_ShadowUniformBuffer = new UniformBuffer(sizeof(ShadowUniformData), UniformBufferBindingShadows);
+		m_LightClusters = new LightClusters();
+
+		// The atlas is the only spot light shadow target and is never reallocated, a light's ShadowResolution only caps the tile it can be given
+		m_SpotLightShadowAtlasFramebuffer = new Framebuffer(SHADOW_ATLAS_RESOLUTION, SHADOW_ATLAS_RESOLUTION, false);
+		m_SpotLightShadowAtlasFramebuffer->AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
+
 		FindClosestDirectionalLightShadowCaster();
-		FindClosestSpotLightShadowCaster();
+		AssignSpotLightShadowTiles();
 		FindClosestPointLightShadowCaster();
 
 		// Default framebuffers if a shadow isn't found. Hopefully save an allocation when we find one
-		if (!m_DirectionalLightShadowFramebuffer)
-		{
-			m_DirectionalLightShadowFramebuffer = new Framebuffer(SHADOWMAP_RESOLUTION_X_DEFAULT, SHADOWMAP_RESOLUTION_Y_DEFAULT, false);
-			m_DirectionalLightShadowFramebuffer->AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
-		}
-		if (!m_SpotLightShadowFramebuffer)
+		if (!m_DirectionalLightShadowCascades)
 		{
-			m_SpotLightShadowFramebuffer = new Framebuffer(SHADOWMAP_RESOLUTION_X_DEFAULT, SHADOWMAP_RESOLUTION_Y_DEFAULT, false);
-			m_SpotLightShadowFramebuffer->AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
+			ReallocateDepthCascades(&m_DirectionalLightShadowCascades, glm::uvec2(SHADOWMAP_RESOLUTION_X_DEFAULT, SHADOWMAP_RESOLUTION_Y_DEFAULT), SHADOW_CASCADE_COUNT_DEFAULT);
 		}
 		if (!m_PointLightShadowCubemap)
 		{
@@ -51,11 +62,10 @@ namespace Arcane
 	{
 		// Reset our pointers since it is possible no shadow caster exists anymore
 		m_ClosestDirectionalLightShadowCaster = nullptr;
-		m_ClosestSpotLightShadowCaster = nullptr;
 		m_ClosestPointLightShadowCaster = nullptr;
 		
 		FindClosestDirectionalLightShadowCaster();
-		FindClosestSpotLightShadowCaster();
+		AssignSpotLightShadowTiles();
 		FindClosestPointLightShadowCaster();
 	}
 
@@ -92,23 +102,38 @@ namespace Arcane
 		if (m_ClosestDirectionalLightShadowCaster)
 		{
 			// TODO:
-			// Ideally we won't be re-allocating everytime we encounter a different sized shadow map. This NEEDS to be solved if we ever allow multiple directional light shadow casters
+			// Ideally we won't be re-allocating everytime we encounter a different sized shadow map or cascade count. This NEEDS to be solved if we ever allow multiple directional light shadow casters
 			// Just allocate the biggest and only render to a portion with glViewPort, and make sure when we sample the shadowmap we account for the smaller size as well
 			glm::uvec2 requiredShadowResolution = GetShadowQualityResolution(m_ClosestDirectionalLightShadowCaster->ShadowResolution);
-			if (!m_DirectionalLightShadowFramebuffer || m_DirectionalLightShadowFramebuffer->GetWidth() != requiredShadowResolution.x || m_DirectionalLightShadowFramebuffer->GetHeight() != requiredShadowResolution.y)
+			int requiredCascadeCount = GetDirectionalLightShadowCasterCascadeCount();
+			if (!m_DirectionalLightShadowCascades || m_DirectionalLightShadowCascades->GetWidth() != requiredShadowResolution.x || m_DirectionalLightShadowCascades->GetHeight() != requiredShadowResolution.y ||
+				m_DirectionalLightShadowCascades->GetLayerCount() != static_cast<unsigned int>(requiredCascadeCount))
 			{
-				ReallocateDepthTarget(&m_DirectionalLightShadowFramebuffer, requiredShadowResolution);
+				ReallocateDepthCascades(&m_DirectionalLightShadowCascades, requiredShadowResolution, requiredCascadeCount);
 			}
 		}
 	}
 
+	static unsigned int RoundUpToPowerOfTwo(unsigned int value)
+	{
+		unsigned int powerOfTwo = 1;
+		while (powerOfTwo < value)
+			powerOfTwo <<= 1;
+		return powerOfTwo;
+	}
+
 	// TODO: Should use camera component's position
-	void LightManager::FindClosestSpotLightShadowCaster()
+	void LightManager::AssignSpotLightShadowTiles()
 	{
-		float closestDistance2 = std::numeric_limits<float>::max();
+		m_SpotLightShadowTiles.clear();
+		m_SpotLightShadowAtlas.Clear();
+
+		ICamera *camera = m_Scene->GetCamera();
+		glm::mat4 projection = camera->GetProjectionMatrix();
+		Frustum cameraFrustum(projection * camera->GetViewMatrix());
 		int currentSpotLightIndex = -1;
 
-		// Prioritize the closest spot light to the camera as our spotlight shadow caster
+		// Every shadow casting spot light that can reach the view is a candidate
 		auto group = m_Scene->m_Registry.group<LightComponent>(entt::get<TransformComponent>);
 		for (auto entity : group)
 		{
@@ -122,27 +147,63 @@ namespace Arcane
 			if (!lightComponent.CastShadows)
 				continue;
 
-			float currentDistance2 = glm::distance2(m_Scene->GetCamera()->GetPosition(), transformComponent.Translation);
-			if (currentDistance2 < closestDistance2)
-			{
-				closestDistance2 = currentDistance2;
-				m_ClosestSpotLightShadowCaster = &lightComponent;
-				m_ClosestSpotLightShadowCasterTransform = &transformComponent;
-				m_ClosestSpotLightIndex = currentSpotLightIndex;
-			}
+			// Nothing the light touches is on screen, so its shadow can't be either
+			float range = lightComponent.AttenuationRange;
+			if (!cameraFrustum.IntersectsSphere(transformComponent.Translation, range))
+				continue;
+
+			// Importance is the fraction of the screen's height the light's reach could cover, which already falls off with distance. A light the camera is in covers everything
+			float distance = glm::distance(camera->GetPosition(), transformComponent.Translation);
+			float screenCoverage = distance > range ? glm::min(range * projection[1][1] / distance, 1.0f) : 1.0f;
+
+			// A tile doesn't need many more texels than the light covers on screen, and never more than the light asked for
+			unsigned int requestedSize = GetShadowQualityResolution(lightComponent.ShadowResolution).x;
+			unsigned int coverageSize = RoundUpToPowerOfTwo(static_cast<unsigned int>(screenCoverage * SHADOW_ATLAS_RESOLUTION));
+
+			ShadowAtlasTile tile;
+			tile.Light = &lightComponent;
+			tile.Transform = &transformComponent;
+			tile.LightIndex = currentSpotLightIndex;
+			tile.Importance = screenCoverage;
+			tile.Size = glm::clamp(coverageSize, static_cast<unsigned int>(SHADOW_ATLAS_MIN_TILE_SIZE), glm::max(requestedSize, static_cast<unsigned int>(SHADOW_ATLAS_MIN_TILE_SIZE)));
+			m_SpotLightShadowTiles.push_back(tile);
 		}
 
-		if (m_ClosestSpotLightShadowCaster)
+		// Most important first, then only keep as many as the budget allows
+		std::stable_sort(m_SpotLightShadowTiles.begin(), m_SpotLightShadowTiles.end(), [](const ShadowAtlasTile &a, const ShadowAtlasTile &b) { return a.Importance > b.Importance; });
+		size_t budget = static_cast<size_t>(glm::clamp(m_ShadowAtlasBudget, 0, SHADOW_ATLAS_MAX_LIGHTS));
+		if (m_SpotLightShadowTiles.size() > budget)
+			m_SpotLightShadowTiles.resize(budget);
+
+		// Shrink the least important tiles until everything fits in the atlas, once they are all as small as they go the least important lights lose their shadow
+		u64 atlasArea = static_cast<u64>(SHADOW_ATLAS_RESOLUTION) * SHADOW_ATLAS_RESOLUTION;
+		u64 requiredArea = 0;
+		for (const ShadowAtlasTile &tile : m_SpotLightShadowTiles)
 		{
-			// TODO:
-			// Ideally we won't be re-allocating everytime we encounter a different sized shadow map. This NEEDS to be solved if we ever allow multiple spot light shadow casters
-			// Just allocate the biggest and only render to a portion with glViewPort, and make sure when we sample the shadowmap we account for the smaller size as well
-			glm::uvec2 requiredShadowResolution = GetShadowQualityResolution(m_ClosestSpotLightShadowCaster->ShadowResolution);
-			if (!m_SpotLightShadowFramebuffer || m_SpotLightShadowFramebuffer->GetWidth() != requiredShadowResolution.x || m_SpotLightShadowFramebuffer->GetHeight() != requiredShadowResolution.y)
+			requiredArea += static_cast<u64>(tile.Size) * tile.Size;
+		}
+		while (requiredArea > atlasArea)
+		{
+			auto shrinkable = std::find_if(m_SpotLightShadowTiles.rbegin(), m_SpotLightShadowTiles.rend(), [](const ShadowAtlasTile &tile) { return tile.Size > SHADOW_ATLAS_MIN_TILE_SIZE; });
+			if (shrinkable != m_SpotLightShadowTiles.rend())
 			{
-				ReallocateDepthTarget(&m_SpotLightShadowFramebuffer, requiredShadowResolution);
+				requiredArea -= static_cast<u64>(shrinkable->Size) * shrinkable->Size * 3 / 4;
+				shrinkable->Size /= 2;
+			}
+			else
+			{
+				requiredArea -= static_cast<u64>(m_SpotLightShadowTiles.back().Size) * m_SpotLightShadowTiles.back().Size;
+				m_SpotLightShadowTiles.pop_back();
 			}
 		}
+
+		// Pack the largest tiles first, with power of two sizes that guarantees the quad-tree finds room for all of them
+		std::stable_sort(m_SpotLightShadowTiles.begin(), m_SpotLightShadowTiles.end(), [](const ShadowAtlasTile &a, const ShadowAtlasTile &b) { return a.Size > b.Size; });
+		for (ShadowAtlasTile &tile : m_SpotLightShadowTiles)
+		{
+			bool allocated = m_SpotLightShadowAtlas.Allocate(tile.Size, tile.Offset);
+			ARC_ASSERT(allocated, "Shadow atlas ran out of room even though the tiles fit");
+		}
 	}
 
 	// TODO: Should use camera component's position
@@ -187,15 +248,12 @@ namespace Arcane
 		}
 	}
 
-	void LightManager::ReallocateDepthTarget(Framebuffer **framebuffer, glm::uvec2 newResolution)
+	void LightManager::ReallocateDepthCascades(Texture **texture, glm::uvec2 newResolution, int newCascadeCount)
 	{
-		if (*framebuffer) // TODO: Can this ever be garbage data or nullptr? If it is just a nullptr this isn't needed. Ehh this function is temporary until this is improved anyways
-		{
-			delete *framebuffer;
-		}
+		delete *texture;
 
-		*framebuffer = new Framebuffer(newResolution.x, newResolution.y, false);
-		(*framebuffer)->AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
+		*texture = new Texture();
+		GenerateShadowCascadeTexture(**texture, newResolution, newCascadeCount);
 	}
 
 	void LightManager::ReallocateDepthCubemap(Cubemap** cubemap, glm::uvec2 newResolution)
@@ -205,30 +263,26 @@ namespace Arcane
 			delete *cubemap;
 		}
 
-		CubemapSettings depthCubemapSettings;
-		depthCubemapSettings.TextureFormat = GL_DEPTH_COMPONENT;
-		depthCubemapSettings.TextureMinificationFilterMode = GL_LINEAR;
-		depthCubemapSettings.TextureMagnificationFilterMode = GL_LINEAR;
-		*cubemap = new Cubemap(depthCubemapSettings);
-		for (int i = 0; i < 6; i++)
-		{
-			(*cubemap)->GenerateCubemapFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, newResolution.x, newResolution.y, GL_DEPTH_COMPONENT, nullptr);
-		}
+		*cubemap = CreateShadowCubemap(newResolution);
 	}
 
-	void LightManager::BindLightingUniforms(Shader *shader)
+	void LightManager::BindLightingUniforms(ICamera *camera)
 	{
-		BindLights(shader, false);
+		BindLights(false, camera);
 	}
 
-	void LightManager::BindStaticLightingUniforms(Shader *shader)
+	void LightManager::BindStaticLightingUniforms(ICamera *camera)
 	{
-		BindLights(shader, true);
+		BindLights(true, camera);
 	}
 
-	void LightManager::BindLights(Shader *shader, bool bindOnlyStatic)
+	void LightManager::BindLights(bool bindOnlyStatic, ICamera *camera)
 	{
-		int numDirLights = 0, numPointLights = 0, numSpotLights = 0;
+		// Zeroed so unused slots and padding compare equal between frames
+		LightBindings::LightUniformData lightData = {};
+		int numDirLights = 0;
+		m_PointLightData.clear();
+		m_SpotLightData.clear();
 
 		auto group = m_Scene->m_Registry.group<LightComponent>(entt::get<TransformComponent>);
 		for (auto entity : group)
@@ -238,27 +292,76 @@ namespace Arcane
 			if (bindOnlyStatic && !lightComponent.IsStatic)
 				continue;
 
+			// The index of a light within its type has to match the one the shadow caster search came up with, which counts every light of that type in the same order
 			switch (lightComponent.Type)
 			{
 			case LightType::LightType_Directional:
 				ARC_ASSERT(numDirLights < LightBindings::MaxDirLights, "Directional light limit hit");
-				LightBindings::BindDirectionalLight(transformComponent, lightComponent, shader, numDirLights++);
+				if (numDirLights < LightBindings::MaxDirLights)
+					LightBindings::SetDirectionalLight(transformComponent, lightComponent, lightData, numDirLights);
+				numDirLights++;
 				break;
 			case LightType::LightType_Point:
-				ARC_ASSERT(numPointLights < LightBindings::MaxPointLights, "Point light limit hit");
-				LightBindings::BindPointLight(transformComponent, lightComponent, shader, numPointLights++);
+				m_PointLightData.emplace_back();
+				LightBindings::SetPointLight(transformComponent, lightComponent, m_PointLightData.back());
 				break;
 			case LightType::LightType_Spot:
-				ARC_ASSERT(numSpotLights < LightBindings::MaxSpotLights, "Spot light limit hit");
-				LightBindings::BindSpotLight(transformComponent, lightComponent, shader, numSpotLights++);
+				m_SpotLightData.emplace_back();
+				LightBindings::SetSpotLight(transformComponent, lightComponent, m_SpotLightData.back());
+
+				// Point the light at its tile in the shadow atlas if it was given one, the tiles are matched by component so static only binds find theirs too
+				for (size_t i = 0; i < m_SpotLightShadowTiles.size(); i++)
+				{
+					if (m_SpotLightShadowTiles[i].Light == &lightComponent)
+					{
+						m_SpotLightData.back().ShadowIndex = static_cast<int>(i);
+						break;
+					}
+				}
 				break;
 			}
 		}
 
 		numDirLights = std::min<int>(numDirLights, LightBindings::MaxDirLights);
-		numPointLights = std::min<int>(numPointLights, LightBindings::MaxPointLights);
-		numSpotLights = std::min<int>(numSpotLights, LightBindings::MaxSpotLights);
-		shader->SetUniform("numDirPointSpotLights", glm::ivec4(numDirLights, numPointLights, numSpotLights, 0));
+		lightData.NumDirPointSpotLights = glm::ivec4(numDirLights, static_cast<int>(m_PointLightData.size()), static_cast<int>(m_SpotLightData.size()), 0);
+
+		m_LightUniformBuffer->SetData(&lightData, sizeof(lightData));
+		m_LightClusters->SetLights(m_PointLightData, m_SpotLightData);
+		m_LightClusters->Build(camera);
+	}
+
+	void LightManager::BindShadowUniforms(const ShadowmapPassOutput &shadowmapData)
+	{
+		ShadowUniformData shadowData = {};
+
+		bool hasDirShadowMap = shadowmapData.hasDirectionalLightShadows;
+
+		shadowData.DirLightShadowData.LightShadowIndex = hasDirShadowMap ? GetDirectionalLightShadowCasterIndex() : -1;
+		shadowData.PointLightShadowIndex = shadowmapData.hasPointLightShadows ? GetPointLightShadowCasterIndex() : -1;
+
+		if (hasDirShadowMap)
+		{
+			for (int i = 0; i < shadowmapData.directionalLightCascadeCount; i++)
+			{
+				shadowData.DirLightShadowData.CascadeViewProjectionMatrices[i] = shadowmapData.directionalLightCascadeViewProjMatrices[i];
+			}
+			shadowData.DirLightShadowData.CascadeSplitDepths = shadowmapData.directionalLightCascadeSplitDepths;
+			shadowData.DirLightShadowData.CascadeCount = shadowmapData.directionalLightCascadeCount;
+			shadowData.DirLightShadowData.ShadowBias = shadowmapData.directionalShadowmapBias;
+		}
+		for (int i = 0; i < shadowmapData.spotLightShadowCount; i++)
+		{
+			shadowData.SpotLightShadowData[i].LightSpaceViewProjectionMatrix = shadowmapData.spotLightViewProjMatrices[i];
+			shadowData.SpotLightShadowData[i].AtlasRect = shadowmapData.spotLightShadowAtlasRects[i];
+			shadowData.SpotLightShadowData[i].ShadowBias = shadowmapData.spotLightShadowmapBiases[i];
+		}
+		if (shadowmapData.hasPointLightShadows)
+		{
+			shadowData.PointLightShadowBias = shadowmapData.pointLightShadowmapBias;
+			shadowData.PointLightFarPlane = shadowmapData.pointLightFarPlane;
+		}
+
+		m_ShadowUniformBuffer->SetData(&shadowData, sizeof(shadowData));
 	}
 
 	glm::uvec2 LightManager::GetShadowQualityResolution(ShadowQuality quality)
@@ -286,126 +389,102 @@ namespace Arcane
 		}
 	}
 
-	// Getters
-	glm::vec3 LightManager::GetDirectionalLightShadowCasterLightDir()
-	{
-		if (!m_ClosestDirectionalLightShadowCaster)
-		{
-			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get light direction");
-			return glm::vec3(0.0f, -1.0f, 0.0f);
-		}
-
-		return m_ClosestDirectionalLightShadowCasterTransform->GetForward();
-	}
-
-	glm::vec2 LightManager::GetDirectionalLightShadowCasterNearFarPlane()
+	void LightManager::GenerateShadowCascadeTexture(Texture &texture, glm::uvec2 resolution, int cascadeCount)
 	{
-		if (!m_ClosestDirectionalLightShadowCaster)
-		{
-			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get near/far plane");
-			return glm::vec2(SHADOWMAP_NEAR_PLANE_DEFAULT, SHADOWMAP_FAR_PLANE_DEFAULT);
-		}
-
-		return glm::vec2(m_ClosestDirectionalLightShadowCaster->ShadowNearPlane, m_ClosestDirectionalLightShadowCaster->ShadowFarPlane);
+		// Same settings a shadowmap framebuffer's depth texture gets, the border keeps anything outside of a cascade unshadowed
+		TextureSettings depthSettings;
+		depthSettings.TextureFormat = GL_DEPTH_COMPONENT;
+		depthSettings.TextureWrapSMode = GL_CLAMP_TO_BORDER;
+		depthSettings.TextureWrapTMode = GL_CLAMP_TO_BORDER;
+		depthSettings.TextureMinificationFilterMode = GL_LINEAR;
+		depthSettings.TextureMagnificationFilterMode = GL_LINEAR;
+		depthSettings.TextureAnisotropyLevel = 1.0f;
+		depthSettings.HasBorder = true;
+		depthSettings.BorderColour = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+		depthSettings.HasMips = false;
+		texture.SetTextureSettings(depthSettings);
+		texture.Generate2DArrayTexture(resolution.x, resolution.y, cascadeCount, GL_DEPTH_COMPONENT, GL_FLOAT);
 	}
 
-	float LightManager::GetDirectionalLightShadowCasterBias()
+	Cubemap* LightManager::CreateShadowCubemap(glm::uvec2 resolution)
 	{
-		if (!m_ClosestDirectionalLightShadowCaster)
+		CubemapSettings depthCubemapSettings;
+		depthCubemapSettings.TextureFormat = GL_DEPTH_COMPONENT;
+		depthCubemapSettings.TextureMinificationFilterMode = GL_LINEAR;
+		depthCubemapSettings.TextureMagnificationFilterMode = GL_LINEAR;
+		Cubemap *cubemap = new Cubemap(depthCubemapSettings);
+		for (int i = 0; i < 6; i++)
 		{
-			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get bias");
-			return SHADOWMAP_BIAS_DEFAULT;
+			cubemap->GenerateCubemapFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, resolution.x, resolution.y, GL_DEPTH_COMPONENT, nullptr);
 		}
-
-		return m_ClosestDirectionalLightShadowCaster->ShadowBias;
+		return cubemap;
 	}
 
-	int LightManager::GetDirectionalLightShadowCasterIndex()
+	// Getters
+	glm::vec3 LightManager::GetDirectionalLightShadowCasterLightDir()
 	{
 		if (!m_ClosestDirectionalLightShadowCaster)
 		{
-			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get index");
-			return -1;
-		}
-
-		return m_ClosestDirectionalLightIndex;
-	}
-
-	glm::vec3 LightManager::GetSpotLightShadowCasterLightDir()
-	{
-		if (!m_ClosestSpotLightShadowCaster)
-		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get light direction");
+			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get light direction");
 			return glm::vec3(0.0f, -1.0f, 0.0f);
 		}
 
-		return m_ClosestSpotLightShadowCasterTransform->GetForward();
-	}
-
-	glm::vec3 LightManager::GetSpotLightShadowCasterLightPosition()
-	{
-		if (!m_ClosestSpotLightShadowCaster)
-		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get light position");
-			return glm::vec3(0.0f, 0.0f, 0.0f);
-		}
-
-		return m_ClosestSpotLightShadowCasterTransform->Translation;
+		return m_ClosestDirectionalLightShadowCasterTransform->GetForward();
 	}
 
-	float LightManager::GetSpotLightShadowCasterOuterCutOffAngle()
+	int LightManager::GetDirectionalLightShadowCasterCascadeCount()
 	{
-		if (!m_ClosestSpotLightShadowCaster)
+		if (!m_ClosestDirectionalLightShadowCaster)
 		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get outer cutoff angle");
-			return 0.0f;
+			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get cascade count");
+			return SHADOW_CASCADE_COUNT_DEFAULT;
 		}
 
-		return glm::acos(m_ClosestSpotLightShadowCaster->OuterCutOff);
+		return glm::clamp(m_ClosestDirectionalLightShadowCaster->ShadowCascadeCount, 1, SHADOW_CASCADE_MAX_COUNT);
 	}
 
-	float LightManager::GetSpotLightShadowCasterAttenuationRange()
+	float LightManager::GetDirectionalLightShadowCasterCascadeSplitLambda()
 	{
-		if (!m_ClosestSpotLightShadowCaster)
+		if (!m_ClosestDirectionalLightShadowCaster)
 		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get attenuation range");
-			return 0.0f;
+			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get cascade split lambda");
+			return SHADOW_CASCADE_SPLIT_LAMBDA_DEFAULT;
 		}
 
-		return m_ClosestSpotLightShadowCaster->AttenuationRange;
+		return m_ClosestDirectionalLightShadowCaster->ShadowCascadeSplitLambda;
 	}
 
-	glm::vec2 LightManager::GetSpotLightShadowCasterNearFarPlane()
+	float LightManager::GetDirectionalLightShadowCasterCascadeDistance()
 	{
-		if (!m_ClosestSpotLightShadowCaster)
+		if (!m_ClosestDirectionalLightShadowCaster)
 		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get near/far plane");
-			return glm::vec2(SHADOWMAP_NEAR_PLANE_DEFAULT, SHADOWMAP_FAR_PLANE_DEFAULT);
+			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get cascade distance");
+			return SHADOW_CASCADE_DISTANCE_DEFAULT;
 		}
 
-		return glm::vec2(m_ClosestSpotLightShadowCaster->ShadowNearPlane, m_ClosestSpotLightShadowCaster->ShadowFarPlane);
+		return m_ClosestDirectionalLightShadowCaster->ShadowCascadeDistance;
 	}
 
-	float LightManager::GetSpotLightShadowCasterBias()
+	float LightManager::GetDirectionalLightShadowCasterBias()
 	{
-		if (!m_ClosestSpotLightShadowCaster)
+		if (!m_ClosestDirectionalLightShadowCaster)
 		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get bias");
+			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get bias");
 			return SHADOWMAP_BIAS_DEFAULT;
 		}
 
-		return m_ClosestSpotLightShadowCaster->ShadowBias;
+		return m_ClosestDirectionalLightShadowCaster->ShadowBias;
 	}
 
-	int LightManager::GetSpotLightShadowCasterIndex()
+	int LightManager::GetDirectionalLightShadowCasterIndex()
 	{
-		if (!m_ClosestSpotLightShadowCaster)
+		if (!m_ClosestDirectionalLightShadowCaster)
 		{
-			ARC_ASSERT(false, "Spotlight shadow caster does not exist in current scene - could not get index");
+			ARC_ASSERT(false, "Directional shadow caster does not exist in current scene - could not get index");
 			return -1;
 		}
 
-		return m_ClosestSpotLightIndex;
+		return m_ClosestDirectionalLightIndex;
 	}
 
 	glm::vec3 LightManager::GetPointLightShadowCasterLightPosition()
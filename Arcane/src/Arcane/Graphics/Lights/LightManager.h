@@ -2,14 +2,27 @@
 #ifndef LIGHTMANAGER_H
 #define LIGHTMANAGER_H
 
+#ifndef LIGHTBINDINGS_H
+#include <Arcane/Graphics/Lights/LightBindings.h>
+#endif
+
+#ifndef SHADOWATLAS_H
+#include <Arcane/Graphics/Lights/ShadowAtlas.h>
+#endif
+
 namespace Arcane
 {
 	class Framebuffer;
+	class Texture;
 	class Cubemap;
 	struct LightComponent;
 	struct TransformComponent;
 	class Scene;
 	class Shader;
+	class UniformBuffer;
+	class LightClusters;
+	class ICamera;
+	struct ShadowmapPassOutput;
 
 	enum class LightType : int
 	{
@@ -29,6 +42,37 @@ namespace Arcane
 		ShadowQualitySize
 	};
 
+	// std140 mirror of the ShadowUniforms block
+	struct ShadowUniformData
+	{
+		// One per tile in the spot light shadow atlas, spot lights find theirs through the shadow index in their light data
+		struct AtlasShadowCaster
+		{
+			glm::mat4 LightSpaceViewProjectionMatrix;
+			glm::vec4 AtlasRect; // xy is the tile's offset and zw its scale in the atlas's texture coordinates
+			float ShadowBias;
+			float Padding[3];
+		};
+
+		struct CascadedShadowCaster
+		{
+			glm::mat4 CascadeViewProjectionMatrices[SHADOW_CASCADE_MAX_COUNT];
+			glm::vec4 CascadeSplitDepths;
+			float ShadowBias;
+			int LightShadowIndex;
+			int CascadeCount;
+			float Padding;
+		};
+
+		CascadedShadowCaster DirLightShadowData;
+		AtlasShadowCaster SpotLightShadowData[SHADOW_ATLAS_MAX_LIGHTS];
+		float PointLightFarPlane;
+		float PointLightShadowBias;
+		int PointLightShadowIndex;
+		float Padding;
+	};
+	static_assert(sizeof(ShadowUniformData) == 304 + 96 * SHADOW_ATLAS_MAX_LIGHTS, "Shadow uniform data no longer matches the std140 layout");
+
 	class LightManager
 	{
 	public:
@@ -38,32 +82,38 @@ namespace Arcane
 		void Init();
 		void Update();
 
-		void BindLightingUniforms(Shader *shader);
-		void BindStaticLightingUniforms(Shader *shader);
+		// Fill the LightUniforms and ShadowUniforms blocks and the light storage buffers, shared by every lit shader. The buffers are only written when their contents
+		// change. Binding the lights also bins the point and spot lights into the camera's clusters, which is skipped if the lights and camera are the same as last time
+		void BindLightingUniforms(ICamera *camera);
+		void BindStaticLightingUniforms(ICamera *camera);
+		void BindShadowUniforms(const ShadowmapPassOutput &shadowmapData);
+
+		inline const LightClusters* GetLightClusters() const { return m_LightClusters; }
 
 		static glm::uvec2 GetShadowQualityResolution(ShadowQuality quality);
+		static void GenerateShadowCascadeTexture(Texture &texture, glm::uvec2 resolution, int cascadeCount); // Depth texture array with a layer per cascade
+		static Cubemap* CreateShadowCubemap(glm::uvec2 resolution); // Depth cubemap for a point light, the caller owns it
 
 		// Getters for directional light shadow caster
 		inline bool HasDirectionalLightShadowCaster() const { return m_ClosestDirectionalLightShadowCaster != nullptr; }
-		Framebuffer* GetDirectionalLightShadowCasterFramebuffer() { return m_DirectionalLightShadowFramebuffer; }
+		inline const LightComponent* GetDirectionalLightShadowCaster() const { return m_ClosestDirectionalLightShadowCaster; }
+		Texture* GetDirectionalLightShadowCasterCascades() { return m_DirectionalLightShadowCascades; }
 		glm::vec3 GetDirectionalLightShadowCasterLightDir();
-		glm::vec2 GetDirectionalLightShadowCasterNearFarPlane();
+		int GetDirectionalLightShadowCasterCascadeCount();
+		float GetDirectionalLightShadowCasterCascadeSplitLambda();
+		float GetDirectionalLightShadowCasterCascadeDistance();
 		float GetDirectionalLightShadowCasterBias();
 		int GetDirectionalLightShadowCasterIndex();
 
-		// Getters for spot light shadow caster
-		inline bool HasSpotLightShadowCaster() const { return m_ClosestSpotLightShadowCaster != nullptr; }
-		Framebuffer* GetSpotLightShadowCasterFramebuffer() { return m_SpotLightShadowFramebuffer; }
-		glm::vec3 GetSpotLightShadowCasterLightDir();
-		glm::vec3 GetSpotLightShadowCasterLightPosition();
-		float GetSpotLightShadowCasterOuterCutOffAngle(); // Returns outer cutoff angle in radians
-		float GetSpotLightShadowCasterAttenuationRange();
-		glm::vec2 GetSpotLightShadowCasterNearFarPlane();
-		float GetSpotLightShadowCasterBias();
-		int GetSpotLightShadowCasterIndex();
+		// Getters for the spot light shadow atlas, the tiles are ordered by their shadow index and are re-assigned every update
+		Framebuffer* GetSpotLightShadowAtlasFramebuffer() { return m_SpotLightShadowAtlasFramebuffer; }
+		inline const ShadowAtlas& GetSpotLightShadowAtlas() const { return m_SpotLightShadowAtlas; }
+		inline const std::vector<ShadowAtlasTile>& GetSpotLightShadowTiles() const { return m_SpotLightShadowTiles; }
+		inline int& GetShadowAtlasBudgetRef() { return m_ShadowAtlasBudget; } // How many spot lights can be given a tile, capped at SHADOW_ATLAS_MAX_LIGHTS
 
 		// Getters for point light shadow caster
 		inline bool HasPointlightShadowCaster() const { return m_ClosestPointLightShadowCaster != nullptr; }
+		inline const LightComponent* GetPointLightShadowCaster() const { return m_ClosestPointLightShadowCaster; }
 		Cubemap* GetPointLightShadowCasterCubemap() { return m_PointLightShadowCubemap; }
 		glm::vec3 GetPointLightShadowCasterLightPosition();
 		glm::vec2 GetPointLightShadowCasterNearFarPlane();
@@ -71,25 +121,31 @@ namespace Arcane
 		int GetPointLightShadowCasterIndex();
 	private:
 		void FindClosestDirectionalLightShadowCaster();
-		void FindClosestSpotLightShadowCaster();
+		void AssignSpotLightShadowTiles();
 		void FindClosestPointLightShadowCaster();
-		void BindLights(Shader *shader, bool bindOnlyStatic);
-		void ReallocateDepthTarget(Framebuffer **framebuffer, glm::uvec2 newResolution);
+		void BindLights(bool bindOnlyStatic, ICamera *camera);
+		void ReallocateDepthCascades(Texture **texture, glm::uvec2 newResolution, int newCascadeCount);
 		void ReallocateDepthCubemap(Cubemap** cubemap, glm::uvec2 newResolution);
 	private:
 		Scene *m_Scene;
 
-		// Directional Light Shadows (keeps track of closest one so passes can use these framebuffers for the shadows)
+		UniformBuffer *m_LightUniformBuffer;
+		UniformBuffer *m_ShadowUniformBuffer;
+		LightClusters *m_LightClusters;
+		std::vector<PointLightUniformData> m_PointLightData;
+		std::vector<SpotLightUniformData> m_SpotLightData;
+
+		// Directional Light Shadows (keeps track of closest one so passes can use its cascades for the shadows)
 		LightComponent *m_ClosestDirectionalLightShadowCaster;
 		TransformComponent *m_ClosestDirectionalLightShadowCasterTransform;
 		int m_ClosestDirectionalLightIndex = 0;
-		Framebuffer *m_DirectionalLightShadowFramebuffer;
+		Texture *m_DirectionalLightShadowCascades;
 
-		// Spot Light Shadows (keeps track of closest one so passes can use these framebuffers for the shadows)
-		LightComponent *m_ClosestSpotLightShadowCaster;
-		TransformComponent *m_ClosestSpotLightShadowCasterTransform;
-		int m_ClosestSpotLightIndex = 0;
-		Framebuffer *m_SpotLightShadowFramebuffer;
+		// Spot Light Shadows (every shadow casting spot light competes for a tile in the atlas, the most important ones within the budget get one)
+		ShadowAtlas m_SpotLightShadowAtlas;
+		std::vector<ShadowAtlasTile> m_SpotLightShadowTiles;
+		Framebuffer *m_SpotLightShadowAtlasFramebuffer;
+		int m_ShadowAtlasBudget = SHADOW_ATLAS_LIGHT_BUDGET_DEFAULT;
 
 		// Point Light Shadows (keeps track of closest one so passes can use these framebuffers for the shadows)
 		LightComponent* m_ClosestPointLightShadowCaster;
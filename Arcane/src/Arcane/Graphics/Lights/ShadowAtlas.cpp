@@ -0,0 +1,73 @@
+#include "arcpch.h"
+#include "ShadowAtlas.h"
+
+namespace Arcane
+{
+	static bool IsPowerOfTwo(unsigned int value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
+	ShadowAtlas::ShadowAtlas(unsigned int resolution) : m_Resolution(resolution)
+	{
+		ARC_ASSERT(IsPowerOfTwo(resolution), "Shadow atlas resolution has to be a power of two");
+		Clear();
+	}
+
+	void ShadowAtlas::Clear()
+	{
+		m_Nodes.clear();
+		m_Nodes.push_back({ glm::uvec2(0), m_Resolution, -1, false });
+		m_AllocatedArea = 0;
+	}
+
+	bool ShadowAtlas::Allocate(unsigned int size, glm::uvec2 &outOffset)
+	{
+		ARC_ASSERT(IsPowerOfTwo(size) && size <= m_Resolution, "Shadow atlas tiles have to be a power of two that fits in the atlas");
+		if (!AllocateFromNode(0, size, outOffset))
+			return false;
+
+		m_AllocatedArea += static_cast<u64>(size) * size;
+		return true;
+	}
+
+	bool ShadowAtlas::AllocateFromNode(int nodeIndex, unsigned int size, glm::uvec2 &outOffset)
+	{
+		// Nodes are copied out since splitting grows the vector
+		Node node = m_Nodes[nodeIndex];
+		if (node.IsAllocated || node.Size < size)
+			return false;
+
+		if (node.FirstChild == -1)
+		{
+			if (node.Size == size)
+			{
+				m_Nodes[nodeIndex].IsAllocated = true;
+				outOffset = node.Offset;
+				return true;
+			}
+
+			// Split into four quadrants and keep going down
+			unsigned int halfSize = node.Size / 2;
+			node.FirstChild = static_cast<int>(m_Nodes.size());
+			m_Nodes[nodeIndex].FirstChild = node.FirstChild;
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				m_Nodes.push_back({ node.Offset + glm::uvec2((i & 1) * halfSize, (i >> 1) * halfSize), halfSize, -1, false });
+			}
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			if (AllocateFromNode(node.FirstChild + i, size, outOffset))
+				return true;
+		}
+		return false;
+	}
+
+	glm::vec4 ShadowAtlas::GetUVRect(const ShadowAtlasTile &tile) const
+	{
+		float resolution = static_cast<float>(m_Resolution);
+		return glm::vec4(glm::vec2(tile.Offset) / resolution, glm::vec2(static_cast<float>(tile.Size) / resolution));
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef SHADOWATLAS_H
+#define SHADOWATLAS_H
+
+/*
+	Spot light shadows all live in one large depth texture. Every frame the light manager ranks the shadow casting spot lights, gives the most important ones a
+	square tile sized by how much of the screen they can cover, and packs the tiles into the atlas with a quad-tree. Tiles are always a power of two and are
+	allocated largest first, which means a tile never has to straddle two partially used quadrants, so as long as the total area fits every tile does. The atlas
+	texture is never resized, lights changing quality only changes which tiles they get
+*/
+
+namespace Arcane
+{
+	struct LightComponent;
+	struct TransformComponent;
+
+	struct ShadowAtlasTile
+	{
+		LightComponent *Light = nullptr;
+		TransformComponent *Transform = nullptr;
+		int LightIndex = -1; // Index of the light in the spot light storage buffer
+		float Importance = 0.0f;
+
+		unsigned int Size = 0; // In texels, always a power of two
+		glm::uvec2 Offset = glm::uvec2(0); // In texels from the bottom left of the atlas
+	};
+
+	class ShadowAtlas
+	{
+	public:
+		ShadowAtlas(unsigned int resolution);
+
+		// Frees every tile, the atlas is re-packed from scratch each frame
+		void Clear();
+
+		// Finds room for a size x size tile, size has to be a power of two no bigger than the atlas. Returns false if there is no free node big enough
+		bool Allocate(unsigned int size, glm::uvec2 &outOffset);
+
+		// Where the tile lives in the atlas's texture coordinates, xy is the offset and zw is the scale. These stay correct for an atlas texture of any resolution
+		glm::vec4 GetUVRect(const ShadowAtlasTile &tile) const;
+
+		inline unsigned int GetResolution() const { return m_Resolution; }
+		inline u64 GetAllocatedArea() const { return m_AllocatedArea; }
+	private:
+		bool AllocateFromNode(int nodeIndex, unsigned int size, glm::uvec2 &outOffset);
+	private:
+		struct Node
+		{
+			glm::uvec2 Offset;
+			unsigned int Size;
+			int FirstChild; // The four quadrants are stored next to each other, -1 if the node hasn't been split
+			bool IsAllocated;
+		};
+
+		unsigned int m_Resolution;
+		std::vector<Node> m_Nodes;
+		u64 m_AllocatedArea = 0;
+	};
+}
+#endif
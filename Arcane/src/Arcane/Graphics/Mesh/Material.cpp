@@ -4,6 +4,7 @@
 #include <Arcane/Graphics/Shader.h>
 #include <Arcane/Graphics/texture/Texture.h>
 #include <Arcane/Util/Loaders/AssetManager.h>
+#include <Arcane/Graphics/Renderer/GLCache.h>
 
 namespace Arcane
 {
@@ -48,13 +49,14 @@ namespace Arcane
 		// Texture unit 4 is reserved for the prefilterMap used for indirect specular IBL
 		// Texture unit 5 is reserved for the brdfLUT used for indirect specular IBL
 		int currentTextureUnit = 6;
+		GLCache *glCache = GLCache::GetInstance();
 
 		shader->SetUniform("material.albedoColour", m_AlbedoColour);
 		if (m_AlbedoMap && m_AlbedoMap->IsGenerated())
 		{
 			shader->SetUniform("material.texture_albedo", currentTextureUnit);
 			shader->SetUniform("material.hasAlbedoTexture", true);
-			m_AlbedoMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_AlbedoMap);
 		}
 		else
 		{
@@ -64,18 +66,18 @@ namespace Arcane
 		shader->SetUniform("material.texture_normal", currentTextureUnit);
 		if (m_NormalMap && m_NormalMap->IsGenerated())
 		{
-			m_NormalMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_NormalMap);
 		}
 		else
 		{
-			AssetManager::GetInstance().GetDefaultNormalTexture()->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, AssetManager::GetInstance().GetDefaultNormalTexture());
 		}
 
 		if (m_MetallicMap && m_MetallicMap->IsGenerated())
 		{
 			shader->SetUniform("material.texture_metallic", currentTextureUnit);
 			shader->SetUniform("material.hasMetallicTexture", true);
-			m_MetallicMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_MetallicMap);
 		}
 		else
 		{
@@ -87,7 +89,7 @@ namespace Arcane
 		{
 			shader->SetUniform("material.texture_roughness", currentTextureUnit);
 			shader->SetUniform("material.hasRoughnessTexture", true);
-			m_RoughnessMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_RoughnessMap);
 		}
 		else
 		{
@@ -98,11 +100,11 @@ namespace Arcane
 		shader->SetUniform("material.texture_ao", currentTextureUnit);
 		if (m_AmbientOcclusionMap && m_AmbientOcclusionMap->IsGenerated())
 		{
-			m_AmbientOcclusionMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_AmbientOcclusionMap);
 		}
 		else
 		{
-			AssetManager::GetInstance().GetDefaultAOTexture()->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, AssetManager::GetInstance().GetDefaultAOTexture());
 		}
 
 		if (m_DisplacementMap && m_DisplacementMap->IsGenerated())
@@ -111,7 +113,7 @@ namespace Arcane
 			shader->SetUniform("minMaxDisplacementSteps", glm::vec2(m_ParallaxMinSteps, m_ParallaxMaxSteps));
 			shader->SetUniform("parallaxStrength", m_ParallaxStrength);
 			shader->SetUniform("material.texture_displacement", currentTextureUnit);
-			m_DisplacementMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_DisplacementMap);
 		}
 		else
 		{
@@ -124,7 +126,7 @@ namespace Arcane
 			shader->SetUniform("material.emissionIntensity", m_EmissionIntensity);
 			shader->SetUniform("material.hasEmissionTexture", true);
 			shader->SetUniform("material.texture_emission", currentTextureUnit);
-			m_EmissionMap->Bind(currentTextureUnit++);
+			glCache->BindTexture(currentTextureUnit++, m_EmissionMap);
 		}
 		else if (m_EmissionColour.r != 0.0f || m_EmissionColour.g != 0.0f || m_EmissionColour.b != 0.0f)
 		{
@@ -11,7 +11,7 @@ namespace Arcane
 	public:
 		Material() = default;
 
-		// Assumes the shader is already bound
+		// Assumes the shader is already bound. Textures go through the GLCache, so invalidate its texture bindings first if anything else could have bound over them
 		void BindMaterialInformation(Shader *shader) const;
 
 		void SetAlbedoMap(Texture *texture);
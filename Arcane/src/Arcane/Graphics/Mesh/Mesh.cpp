@@ -21,15 +21,53 @@ namespace Arcane
 	void Mesh::Draw() const
 	{
 		glBindVertexArray(m_VAO);
-		if (m_Indices.size() > 0) {
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
-			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_Indices.size()), GL_UNSIGNED_INT, 0);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		DrawBound();
+		glBindVertexArray(0);
+	}
+
+	void Mesh::DrawBound() const
+	{
+		// The index buffer was bound while the VAO was when the GPU data was generated, so it is part of the VAO's state already
+		if (m_IndexCount > 0) {
+			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_IndexCount), GL_UNSIGNED_INT, 0);
 		}
 		else {
-			glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_Positions.size()));
+			glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_VertexCount));
 		}
-		glBindVertexArray(0);
+	}
+
+	void Mesh::DrawInstancedBound(unsigned int instanceCount, unsigned int firstInstance) const
+	{
+		// The base instance offsets where the per instance attributes are read from, so every batch can share one instance buffer upload
+		if (m_IndexCount > 0) {
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(m_IndexCount), GL_UNSIGNED_INT, 0, static_cast<GLsizei>(instanceCount), firstInstance);
+		}
+		else {
+			glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, static_cast<GLsizei>(m_VertexCount), static_cast<GLsizei>(instanceCount), firstInstance);
+		}
+	}
+
+	void Mesh::SetupInstanceAttributes(unsigned int instanceBufferID) const
+	{
+		if (m_InstanceBufferID == instanceBufferID)
+			return;
+		m_InstanceBufferID = instanceBufferID;
+
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBufferID);
+		GLsizei stride = static_cast<GLsizei>(sizeof(MeshInstanceData));
+		for (int column = 0; column < 4; column++)
+		{
+			glEnableVertexAttribArray(7 + column);
+			glVertexAttribPointer(7 + column, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offsetof(MeshInstanceData, Model) + column * sizeof(glm::vec4)));
+			glVertexAttribDivisor(7 + column, 1);
+		}
+		for (int column = 0; column < 3; column++)
+		{
+			glEnableVertexAttribArray(11 + column);
+			glVertexAttribPointer(11 + column, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offsetof(MeshInstanceData, NormalMatrix) + column * sizeof(glm::vec3)));
+			glVertexAttribDivisor(11 + column, 1);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void Mesh::LoadData(bool interleaved)
@@ -56,21 +94,51 @@ namespace Arcane
 #endif
 
 		m_IsInterleaved = interleaved;
+		m_VertexCount = static_cast<unsigned int>(m_Positions.size());
+		m_IndexCount = static_cast<unsigned int>(m_Indices.size());
 
-		// Compute the component count
+		// Compute the component count and which attributes the buffer contains
 		m_BufferComponentCount = 0;
+		m_VertexAttributes = 0;
 		if (m_Positions.size() > 0)
+		{
 			m_BufferComponentCount += 3;
+			m_VertexAttributes |= VertexAttributePosition;
+		}
 		if (m_Normals.size() > 0)
+		{
 			m_BufferComponentCount += 3;
+			m_VertexAttributes |= VertexAttributeNormal;
+		}
 		if (m_UVs.size() > 0)
+		{
 			m_BufferComponentCount += 2;
+			m_VertexAttributes |= VertexAttributeUV;
+		}
 		if (m_Tangents.size() > 0)
+		{
 			m_BufferComponentCount += 3;
+			m_VertexAttributes |= VertexAttributeTangent;
+		}
 		if (m_Bitangents.size() > 0)
+		{
 			m_BufferComponentCount += 3;
+			m_VertexAttributes |= VertexAttributeBitangent;
+		}
 		if (m_BoneData.size() > 0)
+		{
 			m_BufferComponentCount += (2 * MaxBonesPerVertex);
+			m_VertexAttributes |= VertexAttributeBoneData;
+		}
+
+		// Local space bounds of the mesh
+		m_BoundsMin = m_Positions.size() > 0 ? m_Positions[0] : glm::vec3(0.0f);
+		m_BoundsMax = m_BoundsMin;
+		for (unsigned int i = 1; i < m_Positions.size(); i++)
+		{
+			m_BoundsMin = glm::min(m_BoundsMin, m_Positions[i]);
+			m_BoundsMax = glm::max(m_BoundsMax, m_Positions[i]);
+		}
 
 		// Pre-process the mesh data in the format that was specified
 		m_BufferData.reserve((3 * m_Positions.size()) + (3 * m_Normals.size()) + (2 * m_UVs.size()) + (3 * m_Tangents.size()) + (3 * m_Bitangents.size()) + (m_BoneData.size() * 2 * MaxBonesPerVertex));
@@ -174,12 +242,41 @@ namespace Arcane
 		// Load data into the index buffer and vertex buffer
 		glBindVertexArray(m_VAO);
 		glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-		glBufferData(GL_ARRAY_BUFFER, m_BufferData.size() * sizeof(float), &m_BufferData[0], GL_STATIC_DRAW);
-		if (m_Indices.size() > 0)
+		bool isStaged = m_StagingAllocation.IsValid();
+		if (isStaged)
+		{
+			// A worker already put the data in the staging buffer, so the buffers get filled with copies on the GPU instead of reading client memory
+			size_t vertexDataSize = static_cast<size_t>(m_VertexCount) * m_BufferComponentCount * sizeof(float);
+			glBindBuffer(GL_COPY_READ_BUFFER, m_StagingAllocation.Owner->GetBufferID());
+			glBufferData(GL_ARRAY_BUFFER, vertexDataSize, nullptr, GL_STATIC_DRAW);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, m_StagingAllocation.Offset, 0, vertexDataSize);
+			if (m_IndexCount > 0)
+			{
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_IndexCount * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ELEMENT_ARRAY_BUFFER, m_StagingAllocation.Offset + m_StagedIndexDataOffset, 0, m_IndexCount * sizeof(unsigned int));
+			}
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+			m_StagingAllocation.Owner->Release(m_StagingAllocation);
+			m_StagingAllocation = StagingAllocation();
+		}
+		else if (m_MappedVertexData)
+		{
+			// Cooked data is already in the final interleaved layout, hand the mapped pages straight to the driver
+			glBufferData(GL_ARRAY_BUFFER, static_cast<size_t>(m_VertexCount) * m_BufferComponentCount * sizeof(float), m_MappedVertexData, GL_STATIC_DRAW);
+		}
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, m_BufferData.size() * sizeof(float), &m_BufferData[0], GL_STATIC_DRAW);
+		}
+		if (m_IndexCount > 0 && !isStaged)
 		{
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(unsigned int), &m_Indices[0], GL_STATIC_DRAW);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_IndexCount * sizeof(unsigned int), m_MappedIndexData ? m_MappedIndexData : &m_Indices[0], GL_STATIC_DRAW);
 		}
+		m_MappedVertexData = nullptr;
+		m_MappedIndexData = nullptr;
 
 		// Setup the format for the VAO
 		if (m_IsInterleaved)
@@ -190,31 +287,31 @@ namespace Arcane
 			glEnableVertexAttribArray(0);
 			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), (void*)offset);
 			offset += 3 * sizeof(float);
-			if (m_Normals.size() > 0)
+			if (m_VertexAttributes & VertexAttributeNormal)
 			{
 				glEnableVertexAttribArray(1);
 				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), (void*)offset);
 				offset += 3 * sizeof(float);
 			}
-			if (m_UVs.size() > 0)
+			if (m_VertexAttributes & VertexAttributeUV)
 			{
 				glEnableVertexAttribArray(2);
 				glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), (void*)offset);
 				offset += 2 * sizeof(float);
 			}
-			if (m_Tangents.size() > 0)
+			if (m_VertexAttributes & VertexAttributeTangent)
 			{
 				glEnableVertexAttribArray(3);
 				glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), (void*)offset);
 				offset += 3 * sizeof(float);
 			}
-			if (m_Bitangents.size() > 0)
+			if (m_VertexAttributes & VertexAttributeBitangent)
 			{
 				glEnableVertexAttribArray(4);
 				glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), (void*)offset);
 				offset += 3 * sizeof(float);
 			}
-			if (m_BoneData.size() > 0)
+			if (m_VertexAttributes & VertexAttributeBoneData)
 			{
 				glEnableVertexAttribArray(5);
 				glVertexAttribIPointer(5, 4, GL_INT, static_cast<GLsizei>(stride), (void*)offset);
@@ -231,43 +328,110 @@ namespace Arcane
 
 			glEnableVertexAttribArray(0);
 			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)offset);
-			offset += m_Positions.size() * 3 * sizeof(float);
-			if (m_Normals.size() > 0)
+			offset += m_VertexCount * 3 * sizeof(float);
+			if (m_VertexAttributes & VertexAttributeNormal)
 			{
 				glEnableVertexAttribArray(1);
 				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)offset);
-				offset += m_Normals.size() * 3 * sizeof(float);
+				offset += m_VertexCount * 3 * sizeof(float);
 			}
-			if (m_UVs.size() > 0)
+			if (m_VertexAttributes & VertexAttributeUV)
 			{
 				glEnableVertexAttribArray(2);
 				glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void*)offset);
-				offset += m_UVs.size() * 2 * sizeof(float);
+				offset += m_VertexCount * 2 * sizeof(float);
 			}
-			if (m_Tangents.size() > 0)
+			if (m_VertexAttributes & VertexAttributeTangent)
 			{
 				glEnableVertexAttribArray(3);
 				glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, (void*)offset);
-				offset += m_Tangents.size() * 3 * sizeof(float);
+				offset += m_VertexCount * 3 * sizeof(float);
 			}
-			if (m_Bitangents.size() > 0)
+			if (m_VertexAttributes & VertexAttributeBitangent)
 			{
 				glEnableVertexAttribArray(4);
 				glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 0, (void*)offset);
-				offset += m_Bitangents.size() * 3 * sizeof(float);
+				offset += m_VertexCount * 3 * sizeof(float);
 			}
-			if (m_BoneData.size() > 0)
+			if (m_VertexAttributes & VertexAttributeBoneData)
 			{
 				glEnableVertexAttribArray(5);
 				glVertexAttribIPointer(5, 4, GL_INT, 0, (void*)offset);
-				offset += m_BoneData.size() * 4 * sizeof(int);
+				offset += m_VertexCount * 4 * sizeof(int);
 
 				glEnableVertexAttribArray(6);
 				glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 0, (void*)offset);
-				offset += m_BoneData.size() * 4 * sizeof(float);
+				offset += m_VertexCount * 4 * sizeof(float);
 			}
 		}
 
 		glBindVertexArray(0);
 	}
+
+	static u32 GetAttributeComponentCount(u32 attribute)
+	{
+		switch (attribute)
+		{
+		case VertexAttributePosition:
+		case VertexAttributeNormal:
+		case VertexAttributeTangent:
+		case VertexAttributeBitangent:
+			return 3;
+		case VertexAttributeUV:
+			return 2;
+		case VertexAttributeBoneData:
+			return 2 * MaxBonesPerVertex;
+		}
+		return 0;
+	}
+
+	void Mesh::GetAttributeLayout(VertexAttribute attribute, u32 &outOffset, u32 &outStride) const
+	{
+		// Attributes are stored in the order of the enum, either next to each other for every vertex or one after another as whole blocks
+		outOffset = 0;
+		for (u32 previous = VertexAttributePosition; previous < static_cast<u32>(attribute); previous <<= 1)
+		{
+			if (m_VertexAttributes & previous)
+				outOffset += GetAttributeComponentCount(previous) * (m_IsInterleaved ? 1 : m_VertexCount);
+		}
+
+		if (m_IsInterleaved)
+			outStride = m_BufferComponentCount;
+		else
+			outStride = attribute == VertexAttributeBoneData ? MaxBonesPerVertex : GetAttributeComponentCount(attribute);
+	}
+
+	void Mesh::GetBoneWeightLayout(u32 &outOffset, u32 &outStride) const
+	{
+		GetAttributeLayout(VertexAttributeBoneData, outOffset, outStride);
+		outOffset += MaxBonesPerVertex * (m_IsInterleaved ? 1 : m_VertexCount);
+	}
+
+	bool Mesh::StageGpuData(StagingRingBuffer &stagingBuffer)
+	{
+		if (m_VertexCount == 0 || m_StagingAllocation.IsValid())
+			return false;
+
+		// Vertices first, then the indices on a 16 byte boundary, all in one allocation so the mesh only needs a single release
+		size_t vertexDataSize = static_cast<size_t>(m_VertexCount) * m_BufferComponentCount * sizeof(float);
+		size_t indexDataSize = static_cast<size_t>(m_IndexCount) * sizeof(unsigned int);
+		size_t indexDataOffset = (vertexDataSize + 15) & ~static_cast<size_t>(15);
+
+		StagingAllocation allocation = stagingBuffer.Allocate(indexDataOffset + indexDataSize);
+		if (!allocation.IsValid())
+			return false;
+
+		memcpy(allocation.Data, m_MappedVertexData ? m_MappedVertexData : static_cast<const void*>(m_BufferData.data()), vertexDataSize);
+		if (indexDataSize > 0)
+			memcpy(allocation.Data + indexDataOffset, m_MappedIndexData ? m_MappedIndexData : m_Indices.data(), indexDataSize);
+
+		m_StagingAllocation = allocation;
+		m_StagedIndexDataOffset = indexDataOffset;
+		return true;
+	}
+
+	size_t Mesh::GetGpuDataSize() const
+	{
+		return (static_cast<size_t>(m_VertexCount) * m_BufferComponentCount * sizeof(float)) + (static_cast<size_t>(m_IndexCount) * sizeof(unsigned int));
+	}
 }
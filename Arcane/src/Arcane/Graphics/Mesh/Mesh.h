@@ -10,12 +10,35 @@
 #include <Arcane/Animation/AnimationData.h>
 #endif
 
+#ifndef STAGINGRINGBUFFER_H
+#include <Arcane/Platform/OpenGL/StagingRingBuffer.h>
+#endif
+
 namespace Arcane
 {
+	// Attributes a mesh has in its vertex buffer, in the order they are laid out in an interleaved vertex
+	enum VertexAttribute
+	{
+		VertexAttributePosition = BIT(0),
+		VertexAttributeNormal = BIT(1),
+		VertexAttributeUV = BIT(2),
+		VertexAttributeTangent = BIT(3),
+		VertexAttributeBitangent = BIT(4),
+		VertexAttributeBoneData = BIT(5)
+	};
+
+	// Streamed per instance for instanced draws. The model matrix is read from attribute locations 7 to 10 and the normal matrix from 11 to 13
+	struct MeshInstanceData
+	{
+		glm::mat4 Model;
+		glm::mat3 NormalMatrix;
+	};
+
 	class Mesh
 	{
 		friend class Model;
 		friend class AssetManager;
+		friend class ModelCooker;
 
 		// This works great for loading in different types of data into our vertex buffers. This will no longer be a valid strategy if we ever add a data type that isn't the same size
 		// When that happens we should rework how we are loading in data anyways, since it will be a nice memory and speed optimization anyways. For now, this will do!
@@ -35,9 +58,32 @@ namespace Arcane
 		void LoadData(bool interleaved = true);
 		void GenerateGpuData(); // Commits all of the buffers and their attributes to the GPU driver
 
+		// Copies the vertex and index data into the staging buffer so GenerateGpuData can upload it with GPU side copies. Safe to call from worker threads, returns false if the staging buffer is full
+		bool StageGpuData(StagingRingBuffer &stagingBuffer);
+		size_t GetGpuDataSize() const;
+
 		void Draw() const;
+		void DrawBound() const; // Assumes this mesh's VAO is already bound, lets consecutive draws of the same mesh skip rebinding it
+		void DrawInstancedBound(unsigned int instanceCount, unsigned int firstInstance) const; // Reads MeshInstanceData starting at firstInstance in the instance buffer
+
+		// Points the per instance attributes of this mesh's VAO at the instance buffer, assumes the VAO is bound. Only does work the first time for a given buffer
+		void SetupInstanceAttributes(unsigned int instanceBufferID) const;
+
+		inline unsigned int GetVAO() const { return m_VAO; }
+		inline unsigned int GetVBO() const { return m_VBO; }
+		inline unsigned int GetIBO() const { return m_IBO; }
+		inline unsigned int GetVertexCount() const { return m_VertexCount; }
+		inline u32 GetVertexAttributes() const { return m_VertexAttributes; }
+
+		// Where an attribute is in the vertex buffer, the offset of the first vertex's value and the distance between vertices are both in floats.
+		// The bone weights are stored right after the bone IDs and have their own layout
+		void GetAttributeLayout(VertexAttribute attribute, u32 &outOffset, u32 &outStride) const;
+		void GetBoneWeightLayout(u32 &outOffset, u32 &outStride) const;
 
 		inline Material& GetMaterial() { return m_Material; }
+		inline const Material& GetMaterial() const { return m_Material; }
+		inline const glm::vec3& GetBoundsMin() const { return m_BoundsMin; }
+		inline const glm::vec3& GetBoundsMax() const { return m_BoundsMax; }
 	protected:
 		unsigned int m_VAO, m_VBO, m_IBO;
 		Material m_Material;
@@ -54,6 +100,22 @@ namespace Arcane
 		std::vector<BufferData> m_BufferData;
 		bool m_IsInterleaved;
 		unsigned int m_BufferComponentCount;
+
+		// Filled out by LoadData (or a cooked model) so the GPU upload and draws don't need the CPU side vectors
+		u32 m_VertexAttributes = 0;
+		unsigned int m_VertexCount = 0;
+		unsigned int m_IndexCount = 0;
+		glm::vec3 m_BoundsMin = glm::vec3(0.0f), m_BoundsMax = glm::vec3(0.0f);
+		mutable unsigned int m_InstanceBufferID = 0; // Instance buffer the VAO's per instance attributes point at, 0 if they haven't been set up
+
+		// When a mesh comes from a cooked model these point straight into the memory mapped file and are uploaded instead of m_BufferData and m_Indices
+		// They are only valid until GenerateGpuData is called, since the owning model unmaps the file afterwards
+		const void *m_MappedVertexData = nullptr;
+		const unsigned int *m_MappedIndexData = nullptr;
+
+		// Vertex data followed by the index data (at m_StagedIndexDataOffset), set when the mesh was staged and released once GenerateGpuData has issued the copies
+		StagingAllocation m_StagingAllocation;
+		size_t m_StagedIndexDataOffset = 0;
 	};
 }
 #endif
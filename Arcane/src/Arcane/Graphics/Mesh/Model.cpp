@@ -2,7 +2,11 @@
 #include "Model.h"
 
 #include <Arcane/Graphics/Shader.h>
+#include <Arcane/Graphics/Renderer/GLCache.h>
 #include <Arcane/Util/Loaders/AssetManager.h>
+#include <Arcane/Util/Loaders/ModelCooker.h>
+#include <Arcane/Util/MemoryMappedFile.h>
+#include <Arcane/Util/Timer.h>
 #include <Arcane/Animation/AnimationData.h>
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -10,23 +14,36 @@
 
 namespace Arcane
 {
-	Model::Model() : m_BoneCount(0)
+	// Part of the cooked model's cache key, changing these produces different data so old cooks are simply missed
+	static constexpr unsigned int s_ModelImportFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
+	Model::Model() : m_BoneCount(0), m_BoundsMin(0.0f), m_BoundsMax(0.0f), m_BoundingSphereCenter(0.0f), m_BoundingSphereRadius(0.0f), m_HasBounds(false)
 	{
 		m_Meshes.resize(0);
 	}
 
-	Model::Model(const Mesh &mesh) : m_BoneCount(0)
+	Model::Model(const Mesh &mesh) : m_BoneCount(0), m_BoundsMin(0.0f), m_BoundsMax(0.0f), m_BoundingSphereCenter(0.0f), m_BoundingSphereRadius(0.0f), m_HasBounds(false)
 	{
 		m_Meshes.push_back(mesh);
+		ExpandBounds(mesh, true);
+		m_HasBounds = true;
 	}
 
-	Model::Model(const std::vector<Mesh> &meshes) : m_BoneCount(0)
+	Model::Model(const std::vector<Mesh> &meshes) : m_BoneCount(0), m_BoundsMin(0.0f), m_BoundsMax(0.0f), m_BoundingSphereCenter(0.0f), m_BoundingSphereRadius(0.0f), m_HasBounds(false)
 	{
 		m_Meshes = meshes;
+		for (size_t i = 0; i < m_Meshes.size(); i++)
+		{
+			ExpandBounds(m_Meshes[i], i == 0);
+		}
+		m_HasBounds = true;
 	}
 
 	void Model::Draw(Shader *shader, RenderPassType pass) const
 	{
+		if (pass == MaterialRequired) {
+			GLCache::GetInstance()->InvalidateTextureBindings();
+		}
 		for (unsigned int i = 0; i < m_Meshes.size(); ++i) {
 			// Avoid binding material information when it isn't needed
 			if (pass == MaterialRequired) {
@@ -36,10 +53,24 @@ namespace Arcane
 		}
 	}
 
-	void Model::LoadModel(const std::string &path)
+	void Model::LoadModel(const std::string &path, bool derivedDataOnly)
 	{
+		Timer loadTimer;
+		m_DerivedDataOnly = derivedDataOnly;
+		m_Directory = path.substr(0, path.find_last_of('/'));
+		m_Name = path.substr(path.find_last_of("/\\") + 1);
+
+#if USE_DERIVED_DATA_CACHE
+		// Prefer the cooked version of the model, it skips the import entirely and is just a memory map
+		if (ModelCooker::LoadCookedModel(path, s_ModelImportFlags, *this))
+		{
+			ARC_LOG_INFO("Loaded cooked model {0} in {1}ms", m_Name, loadTimer.Elapsed() * 1000.0);
+			return;
+		}
+#endif
+
 		Assimp::Importer import;
-		const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+		const aiScene *scene = import.ReadFile(path, s_ModelImportFlags);
 
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 		{
@@ -47,10 +78,13 @@ namespace Arcane
 			return;
 		}
 
-		m_Directory = path.substr(0, path.find_last_of('/'));
-		m_Name = path.substr(path.find_last_of("/\\") + 1);
-
 		ProcessNode(scene->mRootNode, scene);
+		ARC_LOG_INFO("Imported model {0} in {1}ms", m_Name, loadTimer.Elapsed() * 1000.0);
+
+#if USE_DERIVED_DATA_CACHE
+		ModelCooker::CookModel(path, s_ModelImportFlags, *this);
+#endif
+		m_MaterialTexturePaths.clear();
 	}
 
 	void Model::GenerateGpuData()
@@ -59,6 +93,23 @@ namespace Arcane
 		{
 			m_Meshes[i].GenerateGpuData();
 		}
+
+		// The driver has its own copy of the data now
+		m_CookedFile.reset();
+
+		// Bounds were computed on the loading thread, this runs on the main thread once the load is done so it is safe for the renderer to start using them
+		m_HasBounds = true;
+	}
+
+	size_t Model::StageGpuData(StagingRingBuffer &stagingBuffer)
+	{
+		size_t uploadSize = 0;
+		for (int i = 0; i < m_Meshes.size(); i++)
+		{
+			m_Meshes[i].StageGpuData(stagingBuffer);
+			uploadSize += m_Meshes[i].GetGpuDataSize();
+		}
+		return uploadSize;
 	}
 
 	void Model::ProcessNode(aiNode *node, const aiScene *scene)
@@ -217,43 +268,83 @@ namespace Arcane
 
 		Mesh newMesh(std::move(positions), std::move(uvs), std::move(normals), std::move(tangents), std::move(bitangents), std::move(boneWeights), std::move(indices));
 		newMesh.LoadData();
+		ExpandBounds(newMesh, m_Meshes.empty());
 
 		// Process Materials (textures in this case)
+		std::array<std::string, 4> texturePaths;
 		if (mesh->mMaterialIndex >= 0)
 		{
 			aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
 
 			// Attempt to load the materials if they can be found. However PBR materials will need to be manually configured since Assimp doesn't support them
-			// Only colour data for the renderer is considered sRGB, all other type of non-colour texture data shouldn't be corrected by the hardware
-			newMesh.m_Material.SetAlbedoMap(LoadMaterialTexture(material, aiTextureType_DIFFUSE, true));
-			newMesh.m_Material.SetNormalMap(LoadMaterialTexture(material, aiTextureType_NORMALS, false));
-			newMesh.m_Material.SetAmbientOcclusionMap(LoadMaterialTexture(material, aiTextureType_AMBIENT, false));
-			newMesh.m_Material.SetDisplacementMap(LoadMaterialTexture(material, aiTextureType_DISPLACEMENT, false));
+			texturePaths[0] = GetMaterialTexturePath(material, aiTextureType_DIFFUSE);
+			texturePaths[1] = GetMaterialTexturePath(material, aiTextureType_NORMALS);
+			texturePaths[2] = GetMaterialTexturePath(material, aiTextureType_AMBIENT);
+			texturePaths[3] = GetMaterialTexturePath(material, aiTextureType_DISPLACEMENT);
+			LoadMaterialTextures(newMesh, texturePaths);
+		}
+		m_MaterialTexturePaths.push_back(std::move(texturePaths));
+
+		m_Meshes.emplace_back(std::move(newMesh));
+	}
+
+	void Model::ExpandBounds(const Mesh &mesh, bool isFirstMesh)
+	{
+		if (isFirstMesh)
+		{
+			m_BoundsMin = mesh.GetBoundsMin();
+			m_BoundsMax = mesh.GetBoundsMax();
+		}
+		else
+		{
+			m_BoundsMin = glm::min(m_BoundsMin, mesh.GetBoundsMin());
+			m_BoundsMax = glm::max(m_BoundsMax, mesh.GetBoundsMax());
 		}
 
-		m_Meshes.emplace_back(newMesh);
+		m_BoundingSphereCenter = (m_BoundsMin + m_BoundsMax) * 0.5f;
+		m_BoundingSphereRadius = glm::length(m_BoundsMax - m_BoundingSphereCenter);
 	}
 
-	Texture* Model::LoadMaterialTexture(aiMaterial *mat, aiTextureType type, bool isSRGB)
+	std::string Model::GetMaterialTexturePath(aiMaterial *mat, aiTextureType type)
 	{
 		// Log material constraints are being violated (1 texture per type for the standard shader)
 		if (mat->GetTextureCount(type) > 1)
 			ARC_LOG_WARN("Mesh's default material contains more than 1 texture for the same type, which isn't currently supported by the standard shaders");
 
-		// Load the texture of a certain type, assuming there is one
 		if (mat->GetTextureCount(type) > 0)
 		{
 			aiString str;
 			mat->GetTexture(type, 0, &str); // Grab only the first texture (standard shader only supports one texture of each type, it doesn't know how you want to do special blending)
 
 			// Assumption made: material stuff is located in the same directory as the model object
-			std::string fileToSearch = (m_Directory + "/" + std::string(str.C_Str())).c_str();
+			return m_Directory + "/" + std::string(str.C_Str());
+		}
+
+		return std::string();
+	}
+
+	void Model::LoadMaterialTextures(Mesh &mesh, const std::array<std::string, 4> &texturePaths)
+	{
+		// Only colour data for the renderer is considered sRGB, all other type of non-colour texture data shouldn't be corrected by the hardware
+		TextureSettings srgbTextureSettings;
+		srgbTextureSettings.IsSRGB = true;
+		TextureSettings linearTextureSettings;
+		linearTextureSettings.IsSRGB = false;
 
-			TextureSettings textureSettings;
-			textureSettings.IsSRGB = isSRGB;
-			return AssetManager::GetInstance().Load2DTextureAsync(fileToSearch, &textureSettings);
+		if (m_DerivedDataOnly)
+		{
+			for (size_t i = 0; i < texturePaths.size(); i++)
+			{
+				if (!texturePaths[i].empty())
+					TextureLoader::WarmTextureData(texturePaths[i], i == 0 ? srgbTextureSettings : linearTextureSettings);
+			}
+			return;
 		}
 
-		return nullptr;
+		AssetManager &assetManager = AssetManager::GetInstance();
+		mesh.m_Material.SetAlbedoMap(texturePaths[0].empty() ? nullptr : assetManager.Load2DTextureAsync(texturePaths[0], &srgbTextureSettings));
+		mesh.m_Material.SetNormalMap(texturePaths[1].empty() ? nullptr : assetManager.Load2DTextureAsync(texturePaths[1], &linearTextureSettings));
+		mesh.m_Material.SetAmbientOcclusionMap(texturePaths[2].empty() ? nullptr : assetManager.Load2DTextureAsync(texturePaths[2], &linearTextureSettings));
+		mesh.m_Material.SetDisplacementMap(texturePaths[3].empty() ? nullptr : assetManager.Load2DTextureAsync(texturePaths[3], &linearTextureSettings));
 	}
 }
@@ -21,9 +21,11 @@ struct aiMesh;
 namespace Arcane
 {
 	class Shader;
+	class MemoryMappedFile;
 
 	class Model {
 		friend class AssetManager;
+		friend class ModelCooker;
 	public:
 		Model();
 		Model(const Mesh &mesh);
@@ -41,25 +43,51 @@ namespace Arcane
 
 		inline const auto& GetGlobalInverseTransform() const { return m_GlobalInverseTransform; }
 
+		// Local space bounds of every mesh in the model. Async loads only publish them once their GPU data is generated, until then the model has no bounds and shouldn't be culled
+		inline bool HasBounds() const { return m_HasBounds; }
+		inline const glm::vec3& GetBoundsMin() const { return m_BoundsMin; }
+		inline const glm::vec3& GetBoundsMax() const { return m_BoundsMax; }
+		inline const glm::vec3& GetBoundingSphereCenter() const { return m_BoundingSphereCenter; }
+		inline float GetBoundingSphereRadius() const { return m_BoundingSphereRadius; }
+
 		static inline glm::mat4 ConvertAssimpMatrixToGLM(const aiMatrix4x4& aiMat)
 		{
 			return glm::transpose(glm::make_mat4(&aiMat.a1));
 		}
 	private:
-		void LoadModel(const std::string &path);
+		// With derivedDataOnly the material textures are only processed into the derived data cache instead of being loaded through the asset manager,
+		// which keeps the asset manager's caches out of it so models can be warmed from any thread
+		void LoadModel(const std::string &path, bool derivedDataOnly = false);
 		void GenerateGpuData();
 
+		// Stages every mesh it can and returns the number of bytes GenerateGpuData will upload
+		size_t StageGpuData(StagingRingBuffer &stagingBuffer);
+
 		void ProcessNode(aiNode *node, const aiScene *scene);
 		void ProcessMesh(aiMesh *mesh, const aiScene *scene);
-		Texture* LoadMaterialTexture(aiMaterial *mat, aiTextureType type, bool isSRGB);
+		void ExpandBounds(const Mesh &mesh, bool isFirstMesh);
+		std::string GetMaterialTexturePath(aiMaterial *mat, aiTextureType type);
+		void LoadMaterialTextures(Mesh &mesh, const std::array<std::string, 4> &texturePaths);
 	private:
 		std::vector<Mesh> m_Meshes;
 		std::unordered_map<std::string, BoneData> m_BoneDataMap;
 		glm::mat4 m_GlobalInverseTransform; // Used by animation for bone related data to move it back to the origin
 		int m_BoneCount;
 
+		glm::vec3 m_BoundsMin, m_BoundsMax;
+		glm::vec3 m_BoundingSphereCenter; // Centre of the AABB, so the sphere and the box can be tested together
+		float m_BoundingSphereRadius;
+		bool m_HasBounds;
+
 		std::string m_Directory;
 		std::string m_Name;
+		bool m_DerivedDataOnly = false;
+
+		// Texture paths of each mesh's material (albedo, normal, ao, displacement), only kept around so an imported model can be cooked
+		std::vector<std::array<std::string, 4>> m_MaterialTexturePaths;
+
+		// Cooked models have their meshes pointing into this mapping, it is released once the GPU data has been generated
+		std::shared_ptr<MemoryMappedFile> m_CookedFile;
 	};
 }
 #endif
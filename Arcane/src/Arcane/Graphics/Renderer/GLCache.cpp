@@ -2,10 +2,11 @@
 #include "GLCache.h"
 
 #include <Arcane/Graphics/Shader.h>
+#include <Arcane/Graphics/Texture/Texture.h>
 
 namespace Arcane
 {
-	GLCache::GLCache() : m_ActiveShaderID(0) {
+	GLCache::GLCache() : m_ActiveShaderID(0), m_TextureBindCount(0) {
 		// Initialize cache values to ensure garbage data doesn't mess with my GL state
 		m_DepthTest = false;
 		m_StencilTest = false;
@@ -24,6 +25,7 @@ namespace Arcane
 		m_BlueMask = GL_TRUE;
 		m_AlphaMask = GL_TRUE;
 		m_LineThickness = -1.0f;
+		InvalidateTextureBindings();
 	}
 
 	GLCache::~GLCache() {
@@ -197,4 +199,25 @@ namespace Arcane
 			glUseProgram(shaderID);
 		}
 	}
+
+	void GLCache::BindTexture(int unit, const Texture *texture) {
+		if (unit >= GLCacheTextureUnitCount) {
+			texture->Bind(unit);
+			m_TextureBindCount++;
+			return;
+		}
+
+		if (m_BoundTextureIDs[unit] != texture->GetTextureId()) {
+			m_BoundTextureIDs[unit] = texture->GetTextureId();
+			texture->Bind(unit);
+			m_TextureBindCount++;
+		}
+	}
+
+	void GLCache::InvalidateTextureBindings() {
+		// Zero is never a generated texture name, so every unit will miss on its next bind
+		for (int i = 0; i < GLCacheTextureUnitCount; i++) {
+			m_BoundTextureIDs[i] = 0;
+		}
+	}
 }
@@ -9,6 +9,9 @@
 namespace Arcane
 {
 	class Shader;
+	class Texture;
+
+	static constexpr int GLCacheTextureUnitCount = 32;
 
 	class GLCache : Singleton {
 	public:
@@ -38,6 +41,14 @@ namespace Arcane
 		void SetShader(Shader *shader);
 		void SetShader(unsigned int shaderID);
 
+		// Only skips the bind if the same texture was bound to the unit through the cache since the last invalidate. Textures bound any other way aren't
+		// tracked, so invalidate before a stretch of cached binds
+		void BindTexture(int unit, const Texture *texture);
+		void InvalidateTextureBindings();
+
+		inline unsigned int GetTextureBindCount() const { return m_TextureBindCount; }
+		inline void ResetTextureBindCount() { m_TextureBindCount = 0; }
+
 		inline bool GetUsesClipPlane() { return m_UsesClipPlane; }
 		inline const glm::vec4& GetActiveClipPlane() { return m_ActiveClipPlane; }
 	private:
@@ -78,6 +89,8 @@ namespace Arcane
 
 		// Active binds
 		unsigned int m_ActiveShaderID;
+		unsigned int m_BoundTextureIDs[GLCacheTextureUnitCount];
+		unsigned int m_TextureBindCount;
 	};
 }
 #endif
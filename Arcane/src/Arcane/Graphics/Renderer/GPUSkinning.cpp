@@ -0,0 +1,322 @@
+#include "arcpch.h"
+#include "GPUSkinning.h"
+
+#include <Arcane/Graphics/Shader.h>
+#include <Arcane/Graphics/Mesh/Model.h>
+#include <Arcane/Graphics/Renderer/GLCache.h>
+#include <Arcane/Animation/PoseAnimator.h>
+#include <Arcane/Util/Loaders/ShaderLoader.h>
+
+namespace Arcane
+{
+	GLCache* GPUSkinning::s_GLCache = nullptr;
+	Shader* GPUSkinning::s_SkinningShader = nullptr;
+	std::unordered_map<const PoseAnimator*, SkinnedModel> GPUSkinning::s_SkinnedModels;
+	std::vector<SkinnedModel*> GPUSkinning::s_PendingModels;
+	std::vector<SkinnedModel*> GPUSkinning::s_SkinnedModelsThisFrame;
+	u64 GPUSkinning::s_FrameIndex = 0;
+	unsigned int GPUSkinning::s_OutputBufferID = 0;
+	size_t GPUSkinning::s_OutputBufferCapacity = 0;
+	size_t GPUSkinning::s_OutputVertexCount = 0;
+	unsigned int GPUSkinning::s_BonePaletteBufferID = 0;
+	unsigned int GPUSkinning::s_InstanceBufferID = 0;
+	size_t GPUSkinning::s_BonePaletteBufferCapacity = 0;
+	size_t GPUSkinning::s_InstanceBufferCapacity = 0;
+	std::vector<glm::mat4> GPUSkinning::s_BonePaletteData;
+	std::vector<glm::uvec2> GPUSkinning::s_InstanceData;
+	std::vector<GPUSkinning::SkinningJob> GPUSkinning::s_Jobs;
+	GPUSkinningStats GPUSkinning::s_Stats = {};
+
+	static constexpr u32 s_SkinningGroupSize = 64; // Has to match local_size_x in the skinning compute shader
+	static constexpr u64 s_MaxIdleFrames = 120; // Animators that haven't been requested for this long have their VAOs released
+
+	// Storage buffer binding points used by the skinning compute shader
+	enum SkinningBufferBinding
+	{
+		SkinningBufferBindingSourceVertices = 0,
+		SkinningBufferBindingBonePalettes = 1,
+		SkinningBufferBindingInstances = 2,
+		SkinningBufferBindingSkinnedVertices = 3
+	};
+
+	void GPUSkinning::Init()
+	{
+		s_GLCache = GLCache::GetInstance();
+		s_SkinningShader = ShaderLoader::LoadShader("Compute/Mesh_Skinning.glsl");
+
+		glGenBuffers(1, &s_OutputBufferID);
+		glGenBuffers(1, &s_BonePaletteBufferID);
+		glGenBuffers(1, &s_InstanceBufferID);
+	}
+
+	void GPUSkinning::Shutdown()
+	{
+		for (auto &entry : s_SkinnedModels)
+		{
+			DestroyMeshVAOs(entry.second);
+		}
+		s_SkinnedModels.clear();
+
+		glDeleteBuffers(1, &s_OutputBufferID);
+		glDeleteBuffers(1, &s_BonePaletteBufferID);
+		glDeleteBuffers(1, &s_InstanceBufferID);
+	}
+
+	void GPUSkinning::BeginFrame()
+	{
+		s_FrameIndex++;
+		s_OutputVertexCount = 0;
+		s_PendingModels.clear();
+		s_Stats = {};
+
+		for (SkinnedModel *skinnedModel : s_SkinnedModelsThisFrame)
+		{
+			skinnedModel->m_IsSkinned = false;
+		}
+		s_SkinnedModelsThisFrame.clear();
+
+		// Animators are only known by their address, so the ones that stopped being requested (destroyed or no longer visible for a while) get dropped
+		for (auto iter = s_SkinnedModels.begin(); iter != s_SkinnedModels.end();)
+		{
+			if (iter->second.m_LastRequestedFrame + s_MaxIdleFrames < s_FrameIndex)
+			{
+				DestroyMeshVAOs(iter->second);
+				iter = s_SkinnedModels.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	const SkinnedModel* GPUSkinning::RequestSkinning(PoseAnimator *animator, Model *model)
+	{
+		// Models that are still loading don't have their vertex buffers yet
+		if (!model->HasBounds())
+			return nullptr;
+
+		SkinnedModel &skinnedModel = s_SkinnedModels[animator];
+		if (skinnedModel.m_Model != model)
+		{
+			DestroyMeshVAOs(skinnedModel);
+			skinnedModel.m_Animator = animator;
+			skinnedModel.m_Model = model;
+			CreateMeshVAOs(skinnedModel);
+		}
+
+		skinnedModel.m_LastRequestedFrame = s_FrameIndex;
+		if (!skinnedModel.m_IsSkinned && !skinnedModel.m_IsPending)
+		{
+			skinnedModel.m_IsPending = true;
+			s_PendingModels.push_back(&skinnedModel);
+		}
+		return &skinnedModel;
+	}
+
+	void GPUSkinning::DispatchPendingSkinning()
+	{
+		if (s_PendingModels.empty())
+			return;
+
+		// Gather the palettes and give every mesh its spot in the output
+		s_BonePaletteData.clear();
+		s_Jobs.clear();
+		size_t outputVertexCount = s_OutputVertexCount;
+		for (SkinnedModel *skinnedModel : s_PendingModels)
+		{
+			const std::vector<glm::mat4> &boneMatrices = skinnedModel->m_Animator->GetFinalBoneMatrices();
+			u32 paletteOffset = static_cast<u32>(s_BonePaletteData.size());
+			s_BonePaletteData.insert(s_BonePaletteData.end(), boneMatrices.begin(), boneMatrices.end());
+
+			std::vector<Mesh> &meshes = skinnedModel->m_Model->GetMeshes();
+			for (u32 meshIndex = 0; meshIndex < static_cast<u32>(meshes.size()); meshIndex++)
+			{
+				skinnedModel->m_MeshOutputOffsets[meshIndex] = static_cast<u32>(outputVertexCount);
+				outputVertexCount += meshes[meshIndex].GetVertexCount();
+				s_Jobs.push_back(SkinningJob{ &meshes[meshIndex], skinnedModel, meshIndex, paletteOffset });
+			}
+
+			skinnedModel->m_IsPending = false;
+			skinnedModel->m_IsSkinned = true;
+			s_Stats.SkinnedModelCount++;
+		}
+		ReserveOutputBuffer(outputVertexCount);
+		s_Stats.SkinnedVertexCount += static_cast<unsigned int>(outputVertexCount - s_OutputVertexCount);
+		s_OutputVertexCount = outputVertexCount;
+
+		// Every animator using the same model skins the same source meshes, grouping the jobs by mesh lets each group go out as one dispatch
+		std::stable_sort(s_Jobs.begin(), s_Jobs.end(), [](const SkinningJob &a, const SkinningJob &b) { return a.SourceMesh < b.SourceMesh; });
+		s_InstanceData.clear();
+		for (const SkinningJob &job : s_Jobs)
+		{
+			s_InstanceData.push_back(glm::uvec2(job.PaletteOffset, job.Output->m_MeshOutputOffsets[job.MeshIndex]));
+		}
+		UploadStreamBuffer(s_BonePaletteBufferID, s_BonePaletteBufferCapacity, s_BonePaletteData.data(), s_BonePaletteData.size() * sizeof(glm::mat4));
+		UploadStreamBuffer(s_InstanceBufferID, s_InstanceBufferCapacity, s_InstanceData.data(), s_InstanceData.size() * sizeof(glm::uvec2));
+
+		s_GLCache->SetShader(s_SkinningShader);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SkinningBufferBindingBonePalettes, s_BonePaletteBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SkinningBufferBindingInstances, s_InstanceBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SkinningBufferBindingSkinnedVertices, s_OutputBufferID);
+
+		size_t runBegin = 0;
+		while (runBegin < s_Jobs.size())
+		{
+			const Mesh *mesh = s_Jobs[runBegin].SourceMesh;
+			size_t runEnd = runBegin + 1;
+			while (runEnd < s_Jobs.size() && s_Jobs[runEnd].SourceMesh == mesh)
+				runEnd++;
+
+			// The source vertex buffer is read as a storage buffer, attributes the mesh doesn't have get a stride of 0
+			auto setAttributeLayout = [mesh](const char *uniformName, VertexAttribute attribute)
+			{
+				u32 offset = 0, stride = 0;
+				if (mesh->GetVertexAttributes() & attribute)
+					mesh->GetAttributeLayout(attribute, offset, stride);
+				s_SkinningShader->SetUniform(uniformName, glm::ivec2(offset, stride));
+			};
+			setAttributeLayout("positionLayout", VertexAttributePosition);
+			setAttributeLayout("normalLayout", VertexAttributeNormal);
+			setAttributeLayout("tangentLayout", VertexAttributeTangent);
+			setAttributeLayout("bitangentLayout", VertexAttributeBitangent);
+			setAttributeLayout("boneIdLayout", VertexAttributeBoneData);
+			u32 weightOffset = 0, weightStride = 0;
+			mesh->GetBoneWeightLayout(weightOffset, weightStride);
+			s_SkinningShader->SetUniform("boneWeightLayout", glm::ivec2(weightOffset, weightStride));
+			s_SkinningShader->SetUniform("vertexCount", static_cast<int>(mesh->GetVertexCount()));
+			s_SkinningShader->SetUniform("firstInstance", static_cast<int>(runBegin));
+
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SkinningBufferBindingSourceVertices, mesh->GetVBO());
+			GLuint groupCount = (mesh->GetVertexCount() + s_SkinningGroupSize - 1) / s_SkinningGroupSize;
+			glDispatchCompute(groupCount, static_cast<GLuint>(runEnd - runBegin), 1);
+			s_Stats.DispatchCount++;
+
+			runBegin = runEnd;
+		}
+		s_Stats.SkinnedMeshCount += static_cast<unsigned int>(s_Jobs.size());
+
+		for (SkinnedModel *skinnedModel : s_PendingModels)
+		{
+			BindOutputBuffer(*skinnedModel);
+			s_SkinnedModelsThisFrame.push_back(skinnedModel);
+		}
+		s_PendingModels.clear();
+
+		// The skinned vertices are read as vertex attributes by the draws that follow
+		glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	}
+
+	void GPUSkinning::CreateMeshVAOs(SkinnedModel &skinnedModel)
+	{
+		std::vector<Mesh> &meshes = skinnedModel.m_Model->GetMeshes();
+		skinnedModel.m_MeshVAOs.resize(meshes.size());
+		skinnedModel.m_MeshOutputOffsets.assign(meshes.size(), 0);
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			const Mesh &mesh = meshes[i];
+			u32 attributes = mesh.GetVertexAttributes();
+
+			// Binding 0 is the skinned vertex buffer, which is re-pointed every frame. Binding 1 is the mesh's own vertex buffer for the UVs since they aren't affected by the bones
+			glGenVertexArrays(1, &skinnedModel.m_MeshVAOs[i]);
+			glBindVertexArray(skinnedModel.m_MeshVAOs[i]);
+
+			glEnableVertexAttribArray(0);
+			glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(SkinnedVertex, Position));
+			glVertexAttribBinding(0, 0);
+			if (attributes & VertexAttributeNormal)
+			{
+				glEnableVertexAttribArray(1);
+				glVertexAttribFormat(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(SkinnedVertex, Normal));
+				glVertexAttribBinding(1, 0);
+			}
+			if (attributes & VertexAttributeTangent)
+			{
+				glEnableVertexAttribArray(3);
+				glVertexAttribFormat(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(SkinnedVertex, Tangent));
+				glVertexAttribBinding(3, 0);
+			}
+			if (attributes & VertexAttributeBitangent)
+			{
+				glEnableVertexAttribArray(4);
+				glVertexAttribFormat(4, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(SkinnedVertex, Bitangent));
+				glVertexAttribBinding(4, 0);
+			}
+			if (attributes & VertexAttributeUV)
+			{
+				u32 offset, stride;
+				mesh.GetAttributeLayout(VertexAttributeUV, offset, stride);
+				glEnableVertexAttribArray(2);
+				glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, 0);
+				glVertexAttribBinding(2, 1);
+				glBindVertexBuffer(1, mesh.GetVBO(), offset * sizeof(float), static_cast<GLsizei>(stride * sizeof(float)));
+			}
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.GetIBO());
+		}
+		glBindVertexArray(0);
+	}
+
+	void GPUSkinning::DestroyMeshVAOs(SkinnedModel &skinnedModel)
+	{
+		if (!skinnedModel.m_MeshVAOs.empty())
+		{
+			glDeleteVertexArrays(static_cast<GLsizei>(skinnedModel.m_MeshVAOs.size()), skinnedModel.m_MeshVAOs.data());
+		}
+		skinnedModel.m_MeshVAOs.clear();
+		skinnedModel.m_MeshOutputOffsets.clear();
+	}
+
+	void GPUSkinning::ReserveOutputBuffer(size_t vertexCount)
+	{
+		if (vertexCount <= s_OutputBufferCapacity)
+			return;
+
+		// Whatever was skinned earlier this frame is still going to be drawn, so it is copied over and those models are pointed at the new buffer
+		size_t newCapacity = glm::max(vertexCount, s_OutputBufferCapacity * 2);
+		GLuint newBufferID;
+		glGenBuffers(1, &newBufferID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+		glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * sizeof(SkinnedVertex), nullptr, GL_DYNAMIC_COPY);
+		if (s_OutputVertexCount > 0)
+		{
+			// The old buffer was written by the skinning compute shader, the copy has to see those writes
+			glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+			glBindBuffer(GL_COPY_READ_BUFFER, s_OutputBufferID);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, s_OutputVertexCount * sizeof(SkinnedVertex));
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		glDeleteBuffers(1, &s_OutputBufferID);
+		s_OutputBufferID = newBufferID;
+		s_OutputBufferCapacity = newCapacity;
+
+		for (SkinnedModel *skinnedModel : s_SkinnedModelsThisFrame)
+		{
+			BindOutputBuffer(*skinnedModel);
+		}
+	}
+
+	void GPUSkinning::BindOutputBuffer(const SkinnedModel &skinnedModel)
+	{
+		for (size_t i = 0; i < skinnedModel.m_MeshVAOs.size(); i++)
+		{
+			glBindVertexArray(skinnedModel.m_MeshVAOs[i]);
+			glBindVertexBuffer(0, s_OutputBufferID, skinnedModel.m_MeshOutputOffsets[i] * sizeof(SkinnedVertex), sizeof(SkinnedVertex));
+		}
+		glBindVertexArray(0);
+	}
+
+	void GPUSkinning::UploadStreamBuffer(unsigned int bufferID, size_t &capacity, const void *data, size_t size)
+	{
+		// Orphaned for every upload like the renderer's instance buffer, earlier dispatches keep reading the storage they were issued with
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+		if (size > capacity)
+		{
+			capacity = glm::max(size, capacity * 2);
+		}
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+}
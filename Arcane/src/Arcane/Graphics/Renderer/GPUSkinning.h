@@ -0,0 +1,108 @@
+#pragma once
+#ifndef GPUSKINNING_H
+#define GPUSKINNING_H
+
+/*
+	Skins animated models with a compute shader once a frame instead of in the vertex shader of every pass that draws them. The first view to queue an animated
+	model requests it, and the renderer dispatches everything requested before it flushes a queue, so models only seen by a shadow caster get skinned as well.
+	Every pass afterwards draws the skinned vertices with the regular static shaders. The bone palettes of a dispatch all live in one storage buffer
+*/
+
+namespace Arcane
+{
+	class Model;
+	class Mesh;
+	class Shader;
+	class GLCache;
+	class PoseAnimator;
+
+	// Layout of one vertex in the skinned vertex buffer, has to match the output of the skinning compute shader
+	struct SkinnedVertex
+	{
+		glm::vec3 Position;
+		u32 Normal; // Signed normalized 10_10_10_2
+		u32 Tangent;
+		u32 Bitangent;
+	};
+	static_assert(sizeof(SkinnedVertex) == 24, "Skinned vertex no longer matches the skinning compute shader's output");
+
+	struct GPUSkinningStats
+	{
+		unsigned int SkinnedModelCount;
+		unsigned int SkinnedMeshCount;
+		unsigned int SkinnedVertexCount;
+		unsigned int DispatchCount;
+	};
+
+	// This frame's skinning output for one animator. Each mesh of its model gets a VAO that reads the skinned attributes from the transient buffer and the rest
+	// from the mesh's own buffers, so it can be drawn like the mesh itself
+	class SkinnedModel
+	{
+		friend class GPUSkinning;
+	public:
+		inline unsigned int GetVAO(size_t meshIndex) const { return m_MeshVAOs[meshIndex]; }
+	private:
+		PoseAnimator *m_Animator = nullptr;
+		Model *m_Model = nullptr;
+		std::vector<unsigned int> m_MeshVAOs;
+		std::vector<u32> m_MeshOutputOffsets; // Where each mesh's vertices start in the skinned vertex buffer this frame
+		u64 m_LastRequestedFrame = 0;
+		bool m_IsPending = false;
+		bool m_IsSkinned = false;
+	};
+
+	class GPUSkinning
+	{
+	public:
+		static void Init();
+		static void Shutdown();
+
+		static void BeginFrame();
+
+		// Returns the model's skinning output for this frame, or nullptr if the model can't be skinned yet (it is still loading). The first request in a frame
+		// schedules the model to be skinned, later requests from other passes reuse the same output
+		static const SkinnedModel* RequestSkinning(PoseAnimator *animator, Model *model);
+
+		// Skins everything requested since the last dispatch, the renderer calls this before it flushes a queue so the output is ready for the draws
+		static void DispatchPendingSkinning();
+
+		inline static const GPUSkinningStats& GetStats() { return s_Stats; }
+	private:
+		struct SkinningJob
+		{
+			const Mesh *SourceMesh;
+			SkinnedModel *Output;
+			u32 MeshIndex;
+			u32 PaletteOffset;
+		};
+
+		static void CreateMeshVAOs(SkinnedModel &skinnedModel);
+		static void DestroyMeshVAOs(SkinnedModel &skinnedModel);
+		static void ReserveOutputBuffer(size_t vertexCount);
+		static void BindOutputBuffer(const SkinnedModel &skinnedModel);
+		static void UploadStreamBuffer(unsigned int bufferID, size_t &capacity, const void *data, size_t size);
+	private:
+		static GLCache *s_GLCache;
+		static Shader *s_SkinningShader;
+
+		static std::unordered_map<const PoseAnimator*, SkinnedModel> s_SkinnedModels;
+		static std::vector<SkinnedModel*> s_PendingModels;
+		static std::vector<SkinnedModel*> s_SkinnedModelsThisFrame;
+		static u64 s_FrameIndex;
+
+		// Transient output, a frame's skinned vertices are allocated back to back and the buffer only grows
+		static unsigned int s_OutputBufferID;
+		static size_t s_OutputBufferCapacity; // In vertices
+		static size_t s_OutputVertexCount;
+
+		// Re-specified for every dispatch, so their contents never need to survive past the dispatch that reads them
+		static unsigned int s_BonePaletteBufferID, s_InstanceBufferID;
+		static size_t s_BonePaletteBufferCapacity, s_InstanceBufferCapacity; // In bytes
+		static std::vector<glm::mat4> s_BonePaletteData;
+		static std::vector<glm::uvec2> s_InstanceData;
+		static std::vector<SkinningJob> s_Jobs;
+
+		static GPUSkinningStats s_Stats;
+	};
+}
+#endif
@@ -0,0 +1,92 @@
+#include "arcpch.h"
+#include "RenderSortKey.h"
+
+namespace Arcane
+{
+	static constexpr u64 s_ShaderBits = 10, s_MaterialBits = 16, s_VertexArrayBits = 16, s_DepthBits = 20;
+
+	u64 RenderSortKey::MakeOpaque(u32 shaderID, const Material *material, u32 vertexArrayID, float depth)
+	{
+		u64 key = static_cast<u64>(RenderSortLayerOpaque);
+		key = (key << s_ShaderBits) | (shaderID & ((1ull << s_ShaderBits) - 1));
+		key = (key << s_MaterialBits) | HashMaterial(material);
+		key = (key << s_VertexArrayBits) | (vertexArrayID & ((1ull << s_VertexArrayBits) - 1));
+		key = (key << s_DepthBits) | QuantizeDepth(depth);
+		return key;
+	}
+
+	u64 RenderSortKey::MakeTransparent(u32 shaderID, const Material *material, u32 vertexArrayID, float depth)
+	{
+		// Inverting the depth sorts furthest first
+		u64 key = static_cast<u64>(RenderSortLayerTransparent);
+		key = (key << s_DepthBits) | (~QuantizeDepth(depth) & ((1ull << s_DepthBits) - 1));
+		key = (key << s_ShaderBits) | (shaderID & ((1ull << s_ShaderBits) - 1));
+		key = (key << s_MaterialBits) | HashMaterial(material);
+		key = (key << s_VertexArrayBits) | (vertexArrayID & ((1ull << s_VertexArrayBits) - 1));
+		return key;
+	}
+
+	void RenderSortKey::RadixSort(std::vector<MeshDrawCommand> &commands, std::vector<MeshDrawCommand> &scratch)
+	{
+		size_t count = commands.size();
+		if (count < 2)
+			return;
+		scratch.resize(count);
+
+		// Build every histogram in one read over the keys
+		u32 histograms[8][256] = {};
+		for (size_t i = 0; i < count; i++)
+		{
+			u64 key = commands[i].SortKey;
+			for (int byte = 0; byte < 8; byte++)
+			{
+				histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+			}
+		}
+
+		MeshDrawCommand *source = commands.data();
+		MeshDrawCommand *destination = scratch.data();
+		for (int byte = 0; byte < 8; byte++)
+		{
+			u32 *histogram = histograms[byte];
+			u32 firstBucket = static_cast<u32>((source[0].SortKey >> (byte * 8)) & 0xFF);
+			if (histogram[firstBucket] == count)
+				continue;
+
+			u32 offset = 0;
+			for (int bucket = 0; bucket < 256; bucket++)
+			{
+				u32 bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				u32 bucket = static_cast<u32>((source[i].SortKey >> (byte * 8)) & 0xFF);
+				destination[histogram[bucket]++] = source[i];
+			}
+			std::swap(source, destination);
+		}
+
+		// An odd number of passes leaves the result in the scratch buffer
+		if (source != commands.data())
+			commands.swap(scratch);
+	}
+
+	u64 RenderSortKey::QuantizeDepth(float depth)
+	{
+		// Positive floats keep their ordering when their bits are compared as integers, so the top bits after the sign make a cheap fixed size depth
+		depth = glm::max(depth, 0.0f);
+		u32 bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		return static_cast<u64>(bits >> (31 - s_DepthBits)) & ((1ull << s_DepthBits) - 1);
+	}
+
+	u64 RenderSortKey::HashMaterial(const Material *material)
+	{
+		// Fibonacci hash of the address, instances of the same model share their mesh's material so they still land next to each other
+		u64 address = static_cast<u64>(reinterpret_cast<uintptr_t>(material));
+		return (address * 11400714819323198485ull) >> (64 - s_MaterialBits);
+	}
+}
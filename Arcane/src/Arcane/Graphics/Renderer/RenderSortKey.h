@@ -0,0 +1,42 @@
+#pragma once
+#ifndef RENDERSORTKEY_H
+#define RENDERSORTKEY_H
+
+namespace Arcane
+{
+	class Mesh;
+	class Material;
+
+	// One per mesh of a queued model, DrawCallIndex points back at the model's entry in the queue it came from
+	struct MeshDrawCommand
+	{
+		u64 SortKey;
+		const Mesh *SubMesh;
+		u32 DrawCallIndex;
+		u32 VertexArrayID; // The mesh's own VAO, or the skinned VAO if its model was skinned on the GPU
+	};
+
+	enum RenderSortLayer
+	{
+		RenderSortLayerOpaque = 0,
+		RenderSortLayerTransparent = 1
+	};
+
+	// Builds 64 bit keys so that sorting a queue by them groups draws sharing the same state. Opaque draws are ordered by
+	// layer | shader (10 bits) | material (16 bits) | VAO (16 bits) | depth (20 bits), front to back within the same state.
+	// Transparent draws must stay back to front so their depth goes right after the layer and the state bits fill in the rest.
+	// The IDs are truncated or hashed to fit, a collision just means two states might not end up next to each other
+	class RenderSortKey
+	{
+	public:
+		static u64 MakeOpaque(u32 shaderID, const Material *material, u32 vertexArrayID, float depth);
+		static u64 MakeTransparent(u32 shaderID, const Material *material, u32 vertexArrayID, float depth);
+
+		// Stable LSD radix sort on the keys, one pass per byte. Bytes that are the same across every key are skipped, which is common since the layer and shader are shared by a whole flush
+		static void RadixSort(std::vector<MeshDrawCommand> &commands, std::vector<MeshDrawCommand> &scratch);
+	private:
+		static u64 QuantizeDepth(float depth);
+		static u64 HashMaterial(const Material *material);
+	};
+}
+#endif
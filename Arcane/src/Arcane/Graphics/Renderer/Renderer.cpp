@@ -8,7 +8,15 @@
 #include <Arcane/Graphics/Mesh/Common/Quad.h>
 #include <Arcane/Graphics/Camera/ICamera.h>
 #include <Arcane/Animation/PoseAnimator.h>
+#include <Arcane/Animation/AnimationData.h>
 #include <Arcane/Graphics/Renderer/DebugDraw3D.h>
+#include <Arcane/Graphics/Renderer/GPUSkinning.h>
+#include <Arcane/Graphics/Lights/LightBindings.h>
+#include <Arcane/Util/Timer.h>
+#include <Arcane/Platform/OpenGL/UniformBuffer.h>
+#include <Arcane/Util/Loaders/ShaderLoader.h>
+
+#include <glm/gtc/matrix_inverse.hpp>
 
 namespace Arcane
 {
@@ -16,14 +24,44 @@ namespace Arcane
 	Cube* Renderer::s_NdcCube = nullptr;
 	RendererData Renderer::s_RendererData = {};
 	GLCache* Renderer::s_GLCache = nullptr;
-	std::deque<MeshDrawCallInfo> Renderer::s_OpaqueMeshDrawCallQueue;
-	std::deque<MeshDrawCallInfo> Renderer::s_OpaqueSkinnedMeshDrawCallQueue;
-	std::deque<MeshDrawCallInfo> Renderer::s_TransparentMeshDrawCallQueue;
-	std::deque<MeshDrawCallInfo> Renderer::s_TransparentSkinnedMeshDrawCallQueue;
+	Renderer::ModelUniformHandles Renderer::s_ModelUniforms;
+	UniformBuffer* Renderer::s_CameraUniformBuffer = nullptr;
+	CameraUniformData Renderer::s_CameraUniformData = {};
+	std::vector<MeshDrawCallInfo> Renderer::s_OpaqueMeshDrawCallQueue;
+	std::vector<MeshDrawCallInfo> Renderer::s_OpaqueSkinnedMeshDrawCallQueue;
+	std::vector<MeshDrawCallInfo> Renderer::s_TransparentMeshDrawCallQueue;
+	std::vector<MeshDrawCallInfo> Renderer::s_TransparentSkinnedMeshDrawCallQueue;
 	std::deque<QuadDrawCallInfo> Renderer::s_QuadDrawCallQueue;
 	unsigned int Renderer::m_CurrentDrawCallCount = 0;
 	unsigned int Renderer::m_CurrentMeshesDrawnCount = 0;
 	unsigned int Renderer::m_CurrentQuadsDrawnCount = 0;
+	unsigned int Renderer::m_CurrentMeshesSubmittedCount = 0;
+	unsigned int Renderer::m_CurrentMeshesCulledCount = 0;
+	unsigned int Renderer::m_CurrentMaterialBindCount = 0;
+	unsigned int Renderer::m_CurrentVertexArrayBindCount = 0;
+	double Renderer::m_CurrentMeshSubmitTime = 0.0;
+	bool Renderer::s_DrawCallSortingEnabled = USE_DRAW_CALL_SORTING;
+	std::vector<MeshDrawCommand> Renderer::s_MeshDrawCommands;
+	std::vector<MeshDrawCommand> Renderer::s_MeshDrawCommandsScratch;
+	bool Renderer::s_InstancingEnabled = USE_INSTANCED_RENDERING;
+	bool Renderer::s_GPUSkinningEnabled = USE_GPU_SKINNING;
+	bool Renderer::s_SinglePassPointShadowsEnabled = USE_SINGLE_PASS_POINT_SHADOWS;
+	bool Renderer::s_ShadowCachingEnabled = USE_STATIC_SHADOW_CACHING;
+	std::vector<Renderer::InstanceBatch> Renderer::s_InstanceBatches;
+	std::vector<MeshInstanceData> Renderer::s_InstanceData;
+	unsigned int Renderer::s_InstanceBufferID = 0;
+	size_t Renderer::s_InstanceBufferCapacity = 0;
+	unsigned int Renderer::m_CurrentInstancedDrawCallCount = 0;
+	unsigned int Renderer::m_CurrentInstancesDrawnCount = 0;
+	unsigned int Renderer::m_CurrentShadowCascadeDrawCallCount[SHADOW_CASCADE_MAX_COUNT] = {};
+	int Renderer::s_CurrentShadowCascade = -1;
+	unsigned int Renderer::s_ShadowCascadeFirstDrawCall = 0;
+	unsigned int Renderer::m_CurrentPointShadowDrawCallCount = 0;
+	double Renderer::m_CurrentPointShadowSubmitTime = 0.0;
+	unsigned int Renderer::s_PointShadowFirstDrawCall = 0;
+	Timer Renderer::s_PointShadowTimer;
+
+	static constexpr u32 s_MinInstanceBatchSize = 2; // Shorter runs are drawn one by one
 
 	void Renderer::Init()
 	{
@@ -34,15 +72,33 @@ namespace Arcane
 
 		s_GLCache = GLCache::GetInstance();
 
+		// Limits the shaders share with the engine, every shader is loaded after this so none of them need to hard code their own copy
+		ShaderLoader::SetGlobalDefine("MAX_DIR_LIGHTS", LightBindings::MaxDirLights);
+		ShaderLoader::SetGlobalDefine("LIGHT_CLUSTER_GRID_X", LIGHT_CLUSTER_GRID_X);
+		ShaderLoader::SetGlobalDefine("LIGHT_CLUSTER_GRID_Y", LIGHT_CLUSTER_GRID_Y);
+		ShaderLoader::SetGlobalDefine("LIGHT_CLUSTER_GRID_Z", LIGHT_CLUSTER_GRID_Z);
+		ShaderLoader::SetGlobalDefine("LIGHT_CLUSTER_MAX_LIGHTS", LIGHT_CLUSTER_MAX_LIGHTS);
+		ShaderLoader::SetGlobalDefine("SHADOW_CASCADE_MAX_COUNT", SHADOW_CASCADE_MAX_COUNT);
+		ShaderLoader::SetGlobalDefine("SHADOW_ATLAS_MAX_LIGHTS", SHADOW_ATLAS_MAX_LIGHTS);
+		ShaderLoader::SetGlobalDefine("MAX_BONES", MaxBonesPerModel);
+		ShaderLoader::SetGlobalDefine("MAX_BONES_PER_VERTEX", MaxBonesPerVertex);
+
 		s_NdcPlane = new Quad();
 		s_NdcCube = new Cube();
 
+		glGenBuffers(1, &s_InstanceBufferID);
+		s_CameraUniformBuffer = new UniformBuffer(sizeof(CameraUniformData), UniformBufferBindingCamera);
+
 		DebugDraw3D::Init();
+		GPUSkinning::Init();
 	}
 
 	void Renderer::Shutdown()
 	{
-
+		GPUSkinning::Shutdown();
+		glDeleteBuffers(1, &s_InstanceBufferID);
+		delete s_CameraUniformBuffer;
+		s_CameraUniformBuffer = nullptr;
 	}
 
 	void Renderer::BeginFrame()
@@ -50,6 +106,19 @@ namespace Arcane
 		m_CurrentDrawCallCount = 0;
 		m_CurrentMeshesDrawnCount = 0;
 		m_CurrentQuadsDrawnCount = 0;
+		m_CurrentMeshesSubmittedCount = 0;
+		m_CurrentMeshesCulledCount = 0;
+		m_CurrentMaterialBindCount = 0;
+		m_CurrentVertexArrayBindCount = 0;
+		m_CurrentMeshSubmitTime = 0.0;
+		m_CurrentInstancedDrawCallCount = 0;
+		m_CurrentInstancesDrawnCount = 0;
+		std::fill(m_CurrentShadowCascadeDrawCallCount, m_CurrentShadowCascadeDrawCallCount + SHADOW_CASCADE_MAX_COUNT, 0);
+		m_CurrentPointShadowDrawCallCount = 0;
+		m_CurrentPointShadowSubmitTime = 0.0;
+		s_GLCache->ResetTextureBindCount();
+		Shader::ResetUniformUploadCounts();
+		GPUSkinning::BeginFrame();
 
 		DebugDraw3D::BeginBatch();
 	}
@@ -59,6 +128,25 @@ namespace Arcane
 		s_RendererData.DrawCallCount = m_CurrentDrawCallCount;
 		s_RendererData.MeshesDrawnCount = m_CurrentMeshesDrawnCount;
 		s_RendererData.QuadsDrawnCount = m_CurrentQuadsDrawnCount;
+		s_RendererData.MeshesSubmittedCount = m_CurrentMeshesSubmittedCount;
+		s_RendererData.MeshesCulledCount = m_CurrentMeshesCulledCount;
+		s_RendererData.MaterialBindCount = m_CurrentMaterialBindCount;
+		s_RendererData.TextureBindCount = s_GLCache->GetTextureBindCount();
+		s_RendererData.VertexArrayBindCount = m_CurrentVertexArrayBindCount;
+		s_RendererData.MeshSubmitTimeMS = static_cast<float>(m_CurrentMeshSubmitTime * 1000.0);
+		s_RendererData.InstancedDrawCallCount = m_CurrentInstancedDrawCallCount;
+		s_RendererData.InstancesDrawnCount = m_CurrentInstancesDrawnCount;
+		s_RendererData.UniformUploadCount = Shader::GetUniformUploadCount();
+		s_RendererData.UniformUploadsSkippedCount = Shader::GetUniformUploadsSkippedCount();
+		std::copy(m_CurrentShadowCascadeDrawCallCount, m_CurrentShadowCascadeDrawCallCount + SHADOW_CASCADE_MAX_COUNT, s_RendererData.ShadowCascadeDrawCallCount);
+		s_RendererData.PointShadowDrawCallCount = m_CurrentPointShadowDrawCallCount;
+		s_RendererData.PointShadowSubmitTimeMS = static_cast<float>(m_CurrentPointShadowSubmitTime * 1000.0);
+
+		const GPUSkinningStats &skinningStats = GPUSkinning::GetStats();
+		s_RendererData.SkinnedModelCount = skinningStats.SkinnedModelCount;
+		s_RendererData.SkinnedMeshCount = skinningStats.SkinnedMeshCount;
+		s_RendererData.SkinnedVertexCount = skinningStats.SkinnedVertexCount;
+		s_RendererData.SkinningDispatchCount = skinningStats.DispatchCount;
 	}
 
 	void Renderer::QueueQuad(const glm::vec3 &position, const glm::vec2 &size, const Texture *texture)
@@ -72,136 +160,94 @@ namespace Arcane
 		s_QuadDrawCallQueue.emplace_back(QuadDrawCallInfo{ texture, transform });
 	}
 
-	void Renderer::QueueMesh(Model *model, const glm::mat4 &transform, PoseAnimator *animator/*= nullptr*/, bool isTransparent/*= false*/, bool cullBackface/*= true*/)
+	void Renderer::QueueMesh(Model *model, const glm::mat4 &transform, PoseAnimator *animator/*= nullptr*/, bool isTransparent/*= false*/, bool cullBackface/*= true*/, u32 layerMask/*= ~0u*/)
 	{
+		m_CurrentMeshesSubmittedCount++;
+
+		// GPU skinned models are drawn like any other static model, they only need the skinned queues while they are still loading
+		if (animator && s_GPUSkinningEnabled)
+		{
+			if (const SkinnedModel *skinnedModel = GPUSkinning::RequestSkinning(animator, model))
+			{
+				std::vector<MeshDrawCallInfo> &drawCallQueue = isTransparent ? s_TransparentMeshDrawCallQueue : s_OpaqueMeshDrawCallQueue;
+				drawCallQueue.emplace_back(MeshDrawCallInfo{ model, nullptr, transform, cullBackface, skinnedModel, layerMask });
+				return;
+			}
+		}
+
 		if (isTransparent)
 		{
 			if (animator)
 			{
-				s_TransparentSkinnedMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, animator, transform, cullBackface });
+				s_TransparentSkinnedMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, animator, transform, cullBackface, nullptr, layerMask });
 			}
 			else
 			{
-				s_TransparentMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, nullptr, transform, cullBackface });
+				s_TransparentMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, nullptr, transform, cullBackface, nullptr, layerMask });
 			}
 		}
 		else
 		{
 			if (animator)
 			{
-				s_OpaqueSkinnedMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, animator, transform, cullBackface });
+				s_OpaqueSkinnedMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, animator, transform, cullBackface, nullptr, layerMask });
 			}
 			else
 			{
-				s_OpaqueMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, nullptr, transform, cullBackface });
+				s_OpaqueMeshDrawCallQueue.emplace_back(MeshDrawCallInfo{ model, nullptr, transform, cullBackface, nullptr, layerMask });
 			}
 		}
 	}
 
-	void Renderer::FlushOpaqueSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *skinnedShader)
+	void Renderer::AddCulledMeshes(unsigned int count)
 	{
-		if (!s_OpaqueSkinnedMeshDrawCallQueue.empty())
-		{
-			s_GLCache->SetShader(skinnedShader);
-			BindModelCameraInfo(camera, skinnedShader);
-			SetupOpaqueRenderState();
-
-			while (!s_OpaqueSkinnedMeshDrawCallQueue.empty())
-			{
-				MeshDrawCallInfo &current = s_OpaqueSkinnedMeshDrawCallQueue.front();
+		m_CurrentMeshesCulledCount += count;
+	}
 
-				s_GLCache->SetFaceCull(current.cullBackface);
-				SetupModelMatrix(skinnedShader, current, renderPassType);
-				SetupBoneMatrices(skinnedShader, current);
-				current.model->Draw(skinnedShader, renderPassType);
-				m_CurrentDrawCallCount++;
-				m_CurrentMeshesDrawnCount++;
+	void Renderer::BeginShadowCascade(int cascade)
+	{
+		ARC_ASSERT(cascade >= 0 && cascade < SHADOW_CASCADE_MAX_COUNT, "Shadow cascade doesn't exist");
+		s_CurrentShadowCascade = cascade;
+		s_ShadowCascadeFirstDrawCall = m_CurrentDrawCallCount;
+	}
 
-				s_OpaqueSkinnedMeshDrawCallQueue.pop_front();
-			}
-		}
+	void Renderer::EndShadowCascade()
+	{
+		ARC_ASSERT(s_CurrentShadowCascade != -1, "EndShadowCascade called without a matching BeginShadowCascade");
+		m_CurrentShadowCascadeDrawCallCount[s_CurrentShadowCascade] += m_CurrentDrawCallCount - s_ShadowCascadeFirstDrawCall;
+		s_CurrentShadowCascade = -1;
 	}
 
-	void Renderer::FlushOpaqueNonSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *shader)
+	void Renderer::BeginPointShadows()
 	{
-		if (!s_OpaqueMeshDrawCallQueue.empty())
-		{
-			s_GLCache->SetShader(shader);
-			BindModelCameraInfo(camera, shader);
-			SetupOpaqueRenderState();
+		s_PointShadowFirstDrawCall = m_CurrentDrawCallCount;
+		s_PointShadowTimer.Reset();
+	}
 
-			while (!s_OpaqueMeshDrawCallQueue.empty())
-			{
-				MeshDrawCallInfo &current = s_OpaqueMeshDrawCallQueue.front();
+	void Renderer::EndPointShadows()
+	{
+		m_CurrentPointShadowDrawCallCount += m_CurrentDrawCallCount - s_PointShadowFirstDrawCall;
+		m_CurrentPointShadowSubmitTime += s_PointShadowTimer.Elapsed();
+	}
 
-				s_GLCache->SetFaceCull(current.cullBackface);
-				SetupModelMatrix(shader, current, renderPassType);
-				current.model->Draw(shader, renderPassType);
-				m_CurrentDrawCallCount++;
-				m_CurrentMeshesDrawnCount++;
+	void Renderer::FlushOpaqueSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *skinnedShader)
+	{
+		FlushMeshes(s_OpaqueSkinnedMeshDrawCallQueue, camera, renderPassType, skinnedShader, nullptr, false);
+	}
 
-				s_OpaqueMeshDrawCallQueue.pop_front();
-			}
-		}
+	void Renderer::FlushOpaqueNonSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *shader, Shader *instancedShader/*= nullptr*/)
+	{
+		FlushMeshes(s_OpaqueMeshDrawCallQueue, camera, renderPassType, shader, instancedShader, false);
 	}
 
 	void Renderer::FlushTransparentSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *skinnedShader)
 	{
-		// Sort from back to front, does not account for rotations, scaling, or animation
-		if (!s_TransparentSkinnedMeshDrawCallQueue.empty())
-		{
-			s_GLCache->SetShader(skinnedShader);
-			BindModelCameraInfo(camera, skinnedShader);
-			SetupTransparentRenderState();
-
-			std::sort(s_TransparentSkinnedMeshDrawCallQueue.begin(), s_TransparentSkinnedMeshDrawCallQueue.end(),
-				[camera](MeshDrawCallInfo &a, MeshDrawCallInfo &b) -> bool
-				{
-					return glm::length2(camera->GetPosition() - glm::vec3(a.transform[3])) > glm::length2(camera->GetPosition() - glm::vec3(b.transform[3])); // transform[3] - Gets the translation part of the matrix
-				});
-			while (!s_TransparentSkinnedMeshDrawCallQueue.empty())
-			{
-				MeshDrawCallInfo &current = s_TransparentSkinnedMeshDrawCallQueue.front();
-
-				s_GLCache->SetFaceCull(current.cullBackface);
-				SetupModelMatrix(skinnedShader, current, renderPassType);
-				SetupBoneMatrices(skinnedShader, current);
-				current.model->Draw(skinnedShader, renderPassType);
-				m_CurrentDrawCallCount++;
-				m_CurrentMeshesDrawnCount++;
-
-				s_TransparentSkinnedMeshDrawCallQueue.pop_front();
-			}
-		}
+		FlushMeshes(s_TransparentSkinnedMeshDrawCallQueue, camera, renderPassType, skinnedShader, nullptr, true);
 	}
 
 	void Renderer::FlushTransparentNonSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *shader)
 	{
-		// Sort from back to front, does not account for rotations or scaling
-		if (!s_TransparentMeshDrawCallQueue.empty())
-		{
-			s_GLCache->SetShader(shader);
-			BindModelCameraInfo(camera, shader);
-			SetupTransparentRenderState();
-
-			std::sort(s_TransparentMeshDrawCallQueue.begin(), s_TransparentMeshDrawCallQueue.end(),
-				[camera](MeshDrawCallInfo &a, MeshDrawCallInfo &b) -> bool
-				{
-					return glm::length2(camera->GetPosition() - glm::vec3(a.transform[3])) > glm::length2(camera->GetPosition() - glm::vec3(b.transform[3])); // transform[3] - Gets the translation part of the matrix
-				});
-			while (!s_TransparentMeshDrawCallQueue.empty())
-			{
-				MeshDrawCallInfo &current = s_TransparentMeshDrawCallQueue.front();
-
-				s_GLCache->SetFaceCull(current.cullBackface);
-				SetupModelMatrix(shader, current, renderPassType);
-				current.model->Draw(shader, renderPassType);
-				m_CurrentDrawCallCount++;
-				m_CurrentMeshesDrawnCount++;
-
-				s_TransparentMeshDrawCallQueue.pop_front();
-			}
-		}
+		FlushMeshes(s_TransparentMeshDrawCallQueue, camera, renderPassType, shader, nullptr, true);
 	}
 
 	void Renderer::FlushQuads(ICamera *camera, Shader *shader)
@@ -246,8 +292,235 @@ namespace Arcane
 		return s_RendererData;
 	}
 
+	void Renderer::FlushMeshes(std::vector<MeshDrawCallInfo> &drawCallQueue, ICamera *camera, RenderPassType renderPassType, Shader *shader, Shader *instancedShader, bool isTransparent)
+	{
+		if (drawCallQueue.empty())
+			return;
+
+		// Whatever was queued for GPU skinning since the last flush has to be skinned before anything draws it
+		GPUSkinning::DispatchPendingSkinning();
+
+		Timer submitTimer;
+		BuildMeshDrawCommands(drawCallQueue, camera, shader, isTransparent);
+		if (s_DrawCallSortingEnabled || isTransparent) // Transparent meshes have to be drawn back to front either way
+		{
+			RenderSortKey::RadixSort(s_MeshDrawCommands, s_MeshDrawCommandsScratch);
+		}
+
+		// Pulls the runs that can be instanced out of the draw commands, skinned meshes never end up in a queue flushed with an instanced shader
+		s_InstanceBatches.clear();
+		s_InstanceData.clear();
+		if (instancedShader && s_InstancingEnabled && s_DrawCallSortingEnabled && !isTransparent)
+		{
+			BuildInstanceBatches(drawCallQueue, renderPassType);
+		}
+
+		// Anything could have been bound to the material's texture units since the last flush
+		s_GLCache->InvalidateTextureBindings();
+
+		if (!s_MeshDrawCommands.empty())
+		{
+			s_GLCache->SetShader(shader);
+			BindModelCameraInfo(camera, shader);
+			if (isTransparent)
+				SetupTransparentRenderState();
+			else
+				SetupOpaqueRenderState();
+
+			DrawMeshCommands(drawCallQueue, renderPassType, shader);
+		}
+
+		if (!s_InstanceBatches.empty())
+		{
+			s_GLCache->SetShader(instancedShader);
+			BindModelCameraInfo(camera, instancedShader);
+			SetupOpaqueRenderState();
+
+			UploadInstanceData();
+			DrawInstanceBatches(renderPassType, instancedShader);
+		}
+		glBindVertexArray(0);
+
+		m_CurrentMeshesDrawnCount += static_cast<unsigned int>(drawCallQueue.size());
+		drawCallQueue.clear();
+		m_CurrentMeshSubmitTime += submitTimer.Elapsed();
+	}
+
+	void Renderer::BuildMeshDrawCommands(const std::vector<MeshDrawCallInfo> &drawCallQueue, ICamera *camera, Shader *shader, bool isTransparent)
+	{
+		// Depth is the squared distance to each model's origin, so it does not account for rotations, scaling, or animation
+		s_MeshDrawCommands.clear();
+		const glm::vec3 &cameraPosition = camera->GetPosition();
+		u32 shaderID = shader->GetShaderID();
+		for (u32 i = 0; i < static_cast<u32>(drawCallQueue.size()); i++)
+		{
+			const MeshDrawCallInfo &drawCall = drawCallQueue[i];
+			float depth = glm::length2(cameraPosition - glm::vec3(drawCall.transform[3])); // transform[3] - Gets the translation part of the matrix
+			const std::vector<Mesh> &meshes = drawCall.model->GetMeshes();
+			for (size_t meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
+			{
+				const Mesh &mesh = meshes[meshIndex];
+				u32 vao = drawCall.skinnedModel ? drawCall.skinnedModel->GetVAO(meshIndex) : mesh.GetVAO();
+				u64 sortKey = isTransparent ? RenderSortKey::MakeTransparent(shaderID, &mesh.GetMaterial(), vao, depth) : RenderSortKey::MakeOpaque(shaderID, &mesh.GetMaterial(), vao, depth);
+				s_MeshDrawCommands.push_back(MeshDrawCommand{ sortKey, &mesh, i, vao });
+			}
+		}
+	}
+
+	void Renderer::BuildInstanceBatches(const std::vector<MeshDrawCallInfo> &drawCallQueue, RenderPassType renderPassType)
+	{
+		// The sort keys put draws with the same material and VAO next to each other, those runs become instanced batches and everything else stays a regular draw.
+		// GPU skinned meshes have a VAO per animator and never form a run
+		size_t remainingCount = 0;
+		size_t runBegin = 0;
+		while (runBegin < s_MeshDrawCommands.size())
+		{
+			const MeshDrawCommand &first = s_MeshDrawCommands[runBegin];
+			bool firstCullBackface = drawCallQueue[first.DrawCallIndex].cullBackface;
+			bool firstIsSkinned = drawCallQueue[first.DrawCallIndex].skinnedModel != nullptr;
+			size_t runEnd = runBegin + 1;
+			while (runEnd < s_MeshDrawCommands.size() && !firstIsSkinned)
+			{
+				const MeshDrawCommand &next = s_MeshDrawCommands[runEnd];
+				if (next.VertexArrayID != first.VertexArrayID || &next.SubMesh->GetMaterial() != &first.SubMesh->GetMaterial() || drawCallQueue[next.DrawCallIndex].cullBackface != firstCullBackface)
+					break;
+				runEnd++;
+			}
+
+			u32 runLength = static_cast<u32>(runEnd - runBegin);
+			if (runLength >= s_MinInstanceBatchSize)
+			{
+				// Layer masks are merged rather than splitting the run, sending an instance to a layer it doesn't touch only costs clipped triangles
+				u32 layerMask = 0;
+				for (size_t i = runBegin; i < runEnd; i++)
+				{
+					// Inverse transpose of the upper 3x3 is all the normal matrix needs, and it is a lot cheaper than inverting the whole transform
+					const MeshDrawCallInfo &drawCall = drawCallQueue[s_MeshDrawCommands[i].DrawCallIndex];
+					glm::mat3 normalMatrix = renderPassType == MaterialRequired ? glm::inverseTranspose(glm::mat3(drawCall.transform)) : glm::mat3(1.0f);
+					s_InstanceData.push_back(MeshInstanceData{ drawCall.transform, normalMatrix });
+					layerMask |= drawCall.layerMask;
+				}
+				s_InstanceBatches.push_back(InstanceBatch{ first.SubMesh, static_cast<u32>(s_InstanceData.size()) - runLength, runLength, firstCullBackface, layerMask });
+			}
+			else
+			{
+				for (size_t i = runBegin; i < runEnd; i++)
+				{
+					s_MeshDrawCommands[remainingCount++] = s_MeshDrawCommands[i];
+				}
+			}
+			runBegin = runEnd;
+		}
+		s_MeshDrawCommands.resize(remainingCount);
+	}
+
+	void Renderer::DrawMeshCommands(std::vector<MeshDrawCallInfo> &drawCallQueue, RenderPassType renderPassType, Shader *shader)
+	{
+		const MeshDrawCallInfo *previousDrawCall = nullptr;
+		const Material *previousMaterial = nullptr;
+		unsigned int previousVAO = 0;
+		for (const MeshDrawCommand &command : s_MeshDrawCommands)
+		{
+			MeshDrawCallInfo &current = drawCallQueue[command.DrawCallIndex];
+			const Mesh *mesh = command.SubMesh;
+
+			// Meshes of the same model share its transform and bones, they only need to be set when the sort moves on to another model
+			if (&current != previousDrawCall)
+			{
+				s_GLCache->SetFaceCull(current.cullBackface);
+				SetupModelMatrix(shader, current, renderPassType);
+				SetupBoneMatrices(shader, current);
+				previousDrawCall = &current;
+			}
+
+			// Avoid binding material information when it isn't needed
+			if (renderPassType == MaterialRequired && (&mesh->GetMaterial() != previousMaterial || !s_DrawCallSortingEnabled))
+			{
+				if (!s_DrawCallSortingEnabled)
+					s_GLCache->InvalidateTextureBindings();
+
+				mesh->GetMaterial().BindMaterialInformation(shader);
+				previousMaterial = &mesh->GetMaterial();
+				m_CurrentMaterialBindCount++;
+			}
+
+			if (command.VertexArrayID != previousVAO || !s_DrawCallSortingEnabled)
+			{
+				glBindVertexArray(command.VertexArrayID);
+				previousVAO = command.VertexArrayID;
+				m_CurrentVertexArrayBindCount++;
+			}
+
+			mesh->DrawBound();
+			m_CurrentDrawCallCount++;
+		}
+	}
+
+	void Renderer::DrawInstanceBatches(RenderPassType renderPassType, Shader *instancedShader)
+	{
+		// Every batch has a different material or VAO from the one before it, otherwise they would have been the same run
+		for (const InstanceBatch &batch : s_InstanceBatches)
+		{
+			const Mesh *mesh = batch.SubMesh;
+
+			s_GLCache->SetFaceCull(batch.CullBackface);
+			instancedShader->SetUniform(GetModelUniformHandles(instancedShader).LayerMask, static_cast<int>(batch.LayerMask));
+			if (renderPassType == MaterialRequired)
+			{
+				mesh->GetMaterial().BindMaterialInformation(instancedShader);
+				m_CurrentMaterialBindCount++;
+			}
+
+			glBindVertexArray(mesh->GetVAO());
+			m_CurrentVertexArrayBindCount++;
+			mesh->SetupInstanceAttributes(s_InstanceBufferID);
+
+			mesh->DrawInstancedBound(batch.InstanceCount, batch.FirstInstance);
+			m_CurrentDrawCallCount++;
+			m_CurrentInstancedDrawCallCount++;
+			m_CurrentInstancesDrawnCount += batch.InstanceCount;
+		}
+	}
+
+	void Renderer::UploadInstanceData()
+	{
+		// Orphaning the storage lets the driver hand back fresh memory instead of waiting on draws from an earlier flush that still read the old contents
+		glBindBuffer(GL_ARRAY_BUFFER, s_InstanceBufferID);
+		if (s_InstanceData.size() > s_InstanceBufferCapacity)
+		{
+			s_InstanceBufferCapacity = glm::max(s_InstanceData.size(), s_InstanceBufferCapacity * 2);
+		}
+		glBufferData(GL_ARRAY_BUFFER, s_InstanceBufferCapacity * sizeof(MeshInstanceData), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, s_InstanceData.size() * sizeof(MeshInstanceData), s_InstanceData.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void Renderer::BindCameraUniforms(ICamera *camera)
+	{
+		glm::mat4 view = camera->GetViewMatrix();
+		glm::mat4 projection = camera->GetProjectionMatrix();
+		glm::vec3 position = camera->GetPosition();
+
+		// The inverses are only worth computing when the camera actually changed
+		if (view != s_CameraUniformData.View || projection != s_CameraUniformData.Projection || position != s_CameraUniformData.ViewPosition)
+		{
+			s_CameraUniformData.View = view;
+			s_CameraUniformData.Projection = projection;
+			s_CameraUniformData.ViewInverse = glm::inverse(view);
+			s_CameraUniformData.ProjectionInverse = glm::inverse(projection);
+			s_CameraUniformData.ViewPosition = position;
+		}
+		s_CameraUniformBuffer->SetData(&s_CameraUniformData, sizeof(CameraUniformData));
+	}
+
 	void Renderer::BindModelCameraInfo(ICamera *camera, Shader *shader)
 	{
+		if (shader->UsesUniformBlock(UniformBufferBindingCamera))
+		{
+			BindCameraUniforms(camera);
+			return;
+		}
+
 		shader->SetUniform("viewPos", camera->GetPosition());
 		shader->SetUniform("view", camera->GetViewMatrix());
 		shader->SetUniform("projection", camera->GetProjectionMatrix());
@@ -259,6 +532,19 @@ namespace Arcane
 		shader->SetUniform("projection", camera->GetProjectionMatrix());
 	}
 
+	const Renderer::ModelUniformHandles& Renderer::GetModelUniformHandles(Shader *shader)
+	{
+		if (s_ModelUniforms.Owner != shader)
+		{
+			s_ModelUniforms.Owner = shader;
+			s_ModelUniforms.Model = shader->GetUniformHandle("model");
+			s_ModelUniforms.NormalMatrix = shader->GetUniformHandle("normalMatrix");
+			s_ModelUniforms.BonesMatrices = shader->GetUniformHandle("bonesMatrices");
+			s_ModelUniforms.LayerMask = shader->GetUniformHandle("layerMask");
+		}
+		return s_ModelUniforms;
+	}
+
 	void Renderer::SetupModelMatrix(Shader *shader, MeshDrawCallInfo &drawCallInfo, RenderPassType pass)
 	{
 #ifdef RENDERER_PARENT_TRANSFORMATIONS
@@ -268,12 +554,14 @@ namespace Arcane
 			model = glm::translate(glm::mat4(1.0f), entity->GetParent()->GetPosition()) * glm::toMat4(entity->GetParent()->GetOrientation()) * translate * rotate * scale; // translate, rotate, scale, are for the local object
 		}
 #endif
-		shader->SetUniform("model", drawCallInfo.transform);
+		const ModelUniformHandles &handles = GetModelUniformHandles(shader);
+		shader->SetUniform(handles.Model, drawCallInfo.transform);
+		shader->SetUniform(handles.LayerMask, static_cast<int>(drawCallInfo.layerMask));
 
 		if (pass == MaterialRequired)
 		{
 			glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(drawCallInfo.transform)));
-			shader->SetUniform("normalMatrix", normalMatrix);
+			shader->SetUniform(handles.NormalMatrix, normalMatrix);
 		}
 	}
 
@@ -294,7 +582,7 @@ namespace Arcane
 		if (drawCallInfo.animator)
 		{
 			const std::vector<glm::mat4> &matrices = drawCallInfo.animator->GetFinalBoneMatrices();
-			shader->SetUniformArray("bonesMatrices", static_cast<int>(matrices.size()), &matrices[0]);
+			shader->SetUniformArray(GetModelUniformHandles(shader).BonesMatrices, static_cast<int>(matrices.size()), &matrices[0]);
 		}
 	}
 
@@ -6,6 +6,18 @@
 #include <Arcane/Graphics/Renderer/Renderpass/RenderPassType.h>
 #endif
 
+#ifndef RENDERSORTKEY_H
+#include <Arcane/Graphics/Renderer/RenderSortKey.h>
+#endif
+
+#ifndef SHADER_H
+#include <Arcane/Graphics/Shader.h>
+#endif
+
+#ifndef TIMER_H
+#include <Arcane/Util/Timer.h>
+#endif
+
 #include <deque>
 
 namespace Arcane
@@ -17,6 +29,10 @@ namespace Arcane
 	class Cube;
 	class Quad;
 	class PoseAnimator;
+	class Mesh;
+	class UniformBuffer;
+	class SkinnedModel;
+	struct MeshInstanceData;
 
 	struct RendererData
 	{
@@ -28,16 +44,57 @@ namespace Arcane
 		unsigned int DrawCallCount;
 		unsigned int MeshesDrawnCount;
 		unsigned int QuadsDrawnCount;
+
+		// Culling Statistics, summed over every view meshes were queued for this frame (camera, shadow casters, cubemap faces)
+		unsigned int MeshesSubmittedCount;
+		unsigned int MeshesCulledCount;
+
+		// State Change Statistics for the mesh queues, toggle draw call sorting to compare against binding everything for every mesh
+		unsigned int MaterialBindCount;
+		unsigned int TextureBindCount;
+		unsigned int VertexArrayBindCount;
+		float MeshSubmitTimeMS; // CPU time spent building, sorting and issuing the mesh queues
+
+		// Instancing Statistics, each instanced draw call counts once towards the draw call count
+		unsigned int InstancedDrawCallCount;
+		unsigned int InstancesDrawnCount;
+
+		// Uniform Statistics, uploads skipped are SetUniform calls whose value matched what the shader already had
+		unsigned int UniformUploadCount;
+		unsigned int UniformUploadsSkippedCount;
+
+		// GPU Skinning Statistics, a model is skinned once a frame no matter how many passes draw it
+		unsigned int SkinnedModelCount;
+		unsigned int SkinnedMeshCount;
+		unsigned int SkinnedVertexCount;
+		unsigned int SkinningDispatchCount;
+
+		// Shadow Statistics, draw calls issued into each directional light shadow cascade (already included in the draw call count)
+		unsigned int ShadowCascadeDrawCallCount[SHADOW_CASCADE_MAX_COUNT];
+		unsigned int PointShadowDrawCallCount; // Every point light shadow cubemap rendered this frame, all six faces
+		float PointShadowSubmitTimeMS; // CPU time spent culling, queueing and flushing the point light shadow cubemaps
+	};
+
+	// std140 mirror of the CameraUniforms block
+	struct CameraUniformData
+	{
+		glm::mat4 View;
+		glm::mat4 Projection;
+		glm::mat4 ViewInverse;
+		glm::mat4 ProjectionInverse;
+		glm::vec3 ViewPosition;
+		float Padding;
 	};
+	static_assert(sizeof(CameraUniformData) == 272, "Camera uniform data no longer matches the std140 layout");
 
-	// TODO: Should eventually have a render ID and we can order drawcalls to avoid changing GPU state (shaders etc)
-	// Some sort of draw call bucketing system
 	struct MeshDrawCallInfo
 	{
 		Model *model = nullptr;
 		PoseAnimator *animator = nullptr;
 		glm::mat4 transform;
 		bool cullBackface;
+		const SkinnedModel *skinnedModel = nullptr; // Set when the model was skinned on the GPU, its meshes are drawn with the skinned VAOs instead of their own
+		u32 layerMask = ~0u; // Layers of a layered render target the model touches (like the faces of a cubemap), only read by shaders with a layerMask uniform
 	};
 	struct QuadDrawCallInfo
 	{
@@ -54,23 +111,73 @@ namespace Arcane
 		static void BeginFrame();
 		static void EndFrame();
 
-		static void QueueMesh(Model *model, const glm::mat4 &transform, PoseAnimator *animator = nullptr, bool isTransparent = false, bool cullBackface = true);
+		static void QueueMesh(Model *model, const glm::mat4 &transform, PoseAnimator *animator = nullptr, bool isTransparent = false, bool cullBackface = true, u32 layerMask = ~0u);
+		static void AddCulledMeshes(unsigned int count); // Meshes that were rejected before they got queued, only used for statistics
+
+		// Draw calls issued between these count towards the directional shadow cascade, only used for statistics
+		static void BeginShadowCascade(int cascade);
+		static void EndShadowCascade();
+
+		// Draw calls and CPU time between these count towards the point light shadows, only used for statistics
+		static void BeginPointShadows();
+		static void EndPointShadows();
 		static void QueueQuad(const glm::vec3 &position, const glm::vec2 &size, const Texture *texture); // TODO: Should use batch rendering to efficiently render quads together
 		static void QueueQuad(const glm::mat4 &transform, const Texture *texture); // TODO: Should use batch rendering to efficiently render quads together
 
 		static void FlushOpaqueSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *skinnedShader);
-		static void FlushOpaqueNonSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *shader);
+		static void FlushOpaqueNonSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *shader, Shader *instancedShader = nullptr); // Runs of the same mesh and material are drawn instanced when an instanced variant of the shader is given
 		static void FlushTransparentSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *skinnedShader);
 		static void FlushTransparentNonSkinnedMeshes(ICamera *camera, RenderPassType renderPassType, Shader *shader);
 		static void FlushQuads(ICamera *camera, Shader *shader);
 
+		// Points the CameraUniforms block at this camera, it is only re-uploaded when the camera differs from the last one bound
+		static void BindCameraUniforms(ICamera *camera);
+
 		static void DrawNdcPlane();
 		static void DrawNdcCube();
 
 		static const RendererData& GetRendererData();
+
+		// Sorted queues are drawn in sort key order and skip material, texture, and VAO binds that are already in place. Unsorted queues are drawn in
+		// submission order and bind everything for every mesh
+		inline static bool GetDrawCallSortingEnabled() { return s_DrawCallSortingEnabled; }
+		inline static void SetDrawCallSortingEnabled(bool enabled) { s_DrawCallSortingEnabled = enabled; }
+
+		// Instancing needs the queues to be sorted, otherwise the runs of the same mesh and material it looks for won't be next to each other
+		inline static bool GetInstancingEnabled() { return s_InstancingEnabled; }
+		inline static void SetInstancingEnabled(bool enabled) { s_InstancingEnabled = enabled; }
+
+		// Animated models queued while this is enabled are skinned by a compute shader and go in the non skinned queues, so the skinned shaders only see
+		// models that are still loading. Only affects models queued after it is changed
+		inline static bool GetGPUSkinningEnabled() { return s_GPUSkinningEnabled; }
+		inline static void SetGPUSkinningEnabled(bool enabled) { s_GPUSkinningEnabled = enabled; }
+
+		// Point light shadow cubemaps are rendered in one layered pass where each model is queued once and only sent to the faces it touches, instead of
+		// culling, queueing and drawing the scene once per face
+		inline static bool GetSinglePassPointShadowsEnabled() { return s_SinglePassPointShadowsEnabled; }
+		inline static void SetSinglePassPointShadowsEnabled(bool enabled) { s_SinglePassPointShadowsEnabled = enabled; }
+
+		// Shadow maps copy their static casters from a cache and only draw the dynamic casters, distant cascades and unimportant spot lights are also
+		// updated at a reduced rate. Probe and custom shadow targets are always drawn in full
+		inline static bool GetShadowCachingEnabled() { return s_ShadowCachingEnabled; }
+		inline static void SetShadowCachingEnabled(bool enabled) { s_ShadowCachingEnabled = enabled; }
 	private:
+		// Uniforms set for every model drawn, resolved again whenever a flush uses a different shader
+		struct ModelUniformHandles
+		{
+			const Shader *Owner = nullptr;
+			UniformHandle Model, NormalMatrix, BonesMatrices, LayerMask;
+		};
+
+		static void FlushMeshes(std::vector<MeshDrawCallInfo> &drawCallQueue, ICamera *camera, RenderPassType renderPassType, Shader *shader, Shader *instancedShader, bool isTransparent);
+		static void BuildMeshDrawCommands(const std::vector<MeshDrawCallInfo> &drawCallQueue, ICamera *camera, Shader *shader, bool isTransparent);
+		static void BuildInstanceBatches(const std::vector<MeshDrawCallInfo> &drawCallQueue, RenderPassType renderPassType);
+		static void DrawMeshCommands(std::vector<MeshDrawCallInfo> &drawCallQueue, RenderPassType renderPassType, Shader *shader);
+		static void DrawInstanceBatches(RenderPassType renderPassType, Shader *instancedShader);
+		static void UploadInstanceData();
 		static void BindModelCameraInfo(ICamera *camera, Shader *shader);
 		static void BindQuadCameraInfo(ICamera *camera, Shader *shader);
+		static const ModelUniformHandles& GetModelUniformHandles(Shader *shader);
 		static void SetupModelMatrix(Shader *shader, MeshDrawCallInfo &drawCallInfo, RenderPassType pass);
 		static void SetupModelMatrix(Shader *shader, QuadDrawCallInfo &drawCallInfo);
 		static void SetupBoneMatrices(Shader *shader, MeshDrawCallInfo &drawCallInfo);
@@ -84,15 +191,55 @@ namespace Arcane
 		static RendererData s_RendererData;
 		static GLCache *s_GLCache;
 
-		static std::deque<MeshDrawCallInfo> s_OpaqueMeshDrawCallQueue;
-		static std::deque<MeshDrawCallInfo> s_OpaqueSkinnedMeshDrawCallQueue;
-		static std::deque<MeshDrawCallInfo> s_TransparentMeshDrawCallQueue;
-		static std::deque<MeshDrawCallInfo> s_TransparentSkinnedMeshDrawCallQueue;
+		static ModelUniformHandles s_ModelUniforms;
+
+		static UniformBuffer *s_CameraUniformBuffer;
+		static CameraUniformData s_CameraUniformData;
+
+		static std::vector<MeshDrawCallInfo> s_OpaqueMeshDrawCallQueue;
+		static std::vector<MeshDrawCallInfo> s_OpaqueSkinnedMeshDrawCallQueue;
+		static std::vector<MeshDrawCallInfo> s_TransparentMeshDrawCallQueue;
+		static std::vector<MeshDrawCallInfo> s_TransparentSkinnedMeshDrawCallQueue;
 		static std::deque<QuadDrawCallInfo> s_QuadDrawCallQueue;
 
+		static bool s_DrawCallSortingEnabled;
+		static std::vector<MeshDrawCommand> s_MeshDrawCommands, s_MeshDrawCommandsScratch; // Kept around so the flushes don't allocate every frame
+
+		static bool s_GPUSkinningEnabled;
+		static bool s_SinglePassPointShadowsEnabled;
+		static bool s_ShadowCachingEnabled;
+
+		struct InstanceBatch
+		{
+			const Mesh *SubMesh;
+			u32 FirstInstance;
+			u32 InstanceCount;
+			bool CullBackface;
+			u32 LayerMask; // Every layer any of the instances touch
+		};
+		static bool s_InstancingEnabled;
+		static std::vector<InstanceBatch> s_InstanceBatches;
+		static std::vector<MeshInstanceData> s_InstanceData;
+		static unsigned int s_InstanceBufferID;
+		static size_t s_InstanceBufferCapacity; // In instances
+
 		static unsigned int m_CurrentDrawCallCount;
 		static unsigned int m_CurrentMeshesDrawnCount;
 		static unsigned int m_CurrentQuadsDrawnCount;
+		static unsigned int m_CurrentMeshesSubmittedCount;
+		static unsigned int m_CurrentMeshesCulledCount;
+		static unsigned int m_CurrentMaterialBindCount;
+		static unsigned int m_CurrentVertexArrayBindCount;
+		static double m_CurrentMeshSubmitTime;
+		static unsigned int m_CurrentInstancedDrawCallCount;
+		static unsigned int m_CurrentInstancesDrawnCount;
+		static unsigned int m_CurrentShadowCascadeDrawCallCount[SHADOW_CASCADE_MAX_COUNT];
+		static int s_CurrentShadowCascade;
+		static unsigned int s_ShadowCascadeFirstDrawCall;
+		static unsigned int m_CurrentPointShadowDrawCallCount;
+		static double m_CurrentPointShadowSubmitTime;
+		static unsigned int s_PointShadowFirstDrawCall;
+		static Timer s_PointShadowTimer;
 	};
 }
 #endif
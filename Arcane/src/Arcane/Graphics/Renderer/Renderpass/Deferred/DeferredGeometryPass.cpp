@@ -4,6 +4,7 @@
 #include <Arcane/Graphics/Window.h>
 #include <Arcane/Graphics/Shader.h>
 #include <Arcane/Graphics/Camera/ICamera.h>
+#include <Arcane/Graphics/Camera/Frustum.h>
 #include <Arcane/Graphics/Renderer/GLCache.h>
 #include <Arcane/Graphics/Renderer/Renderer.h>
 #include <Arcane/Scene/Scene.h>
@@ -15,7 +16,8 @@ namespace Arcane
 	DeferredGeometryPass::DeferredGeometryPass(Scene *scene) : RenderPass(scene), m_AllocatedGBuffer(true)
 	{
 		m_ModelShader = ShaderLoader::LoadShader("deferred/PBR_Model_GeometryPass.glsl");
-		m_SkinnedModelShader = ShaderLoader::LoadShader("deferred/PBR_Skinned_Model_GeometryPass.glsl");
+		m_ModelInstancedShader = ShaderLoader::LoadShader("deferred/PBR_Model_GeometryPass.glsl", ShaderDefines().Enable("INSTANCED"));
+		m_SkinnedModelShader = ShaderLoader::LoadShader("deferred/PBR_Model_GeometryPass.glsl", ShaderDefines().Enable("SKINNED"));
 		m_TerrainShader = ShaderLoader::LoadShader("deferred/PBR_Terrain_GeometryPass.glsl");
 
 		m_GBuffer = new GBuffer(Window::GetRenderResolutionWidth(), Window::GetRenderResolutionHeight());
@@ -24,6 +26,8 @@ namespace Arcane
 	DeferredGeometryPass::DeferredGeometryPass(Scene *scene, GBuffer *customGBuffer) : RenderPass(scene), m_AllocatedGBuffer(false), m_GBuffer(customGBuffer)
 	{
 		m_ModelShader = ShaderLoader::LoadShader("deferred/PBR_Model_GeometryPass.glsl");
+		m_ModelInstancedShader = ShaderLoader::LoadShader("deferred/PBR_Model_GeometryPass.glsl", ShaderDefines().Enable("INSTANCED"));
+		m_SkinnedModelShader = ShaderLoader::LoadShader("deferred/PBR_Model_GeometryPass.glsl", ShaderDefines().Enable("SKINNED"));
 		m_TerrainShader = ShaderLoader::LoadShader("deferred/PBR_Terrain_GeometryPass.glsl");
 	}
 
@@ -48,13 +52,14 @@ namespace Arcane
 		m_GLCache->SetStencilTest(true);
 
 		// Setup model renderer for opaque objects only
+		Frustum cameraFrustum(camera->GetProjectionMatrix() * camera->GetViewMatrix());
 		if (renderOnlyStatic)
 		{
-			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueStaticModels);
+			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueStaticModels, cameraFrustum);
 		}
 		else
 		{
-			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueModels);
+			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueModels, cameraFrustum);
 		}
 
 		// Render opaque objects (use stencil to denote models for the deferred lighting pass)
@@ -64,7 +69,7 @@ namespace Arcane
 		Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_SkinnedModelShader);
 		ARC_POP_RENDER_TAG();
 		ARC_PUSH_RENDER_TAG("Non-Skinned Models");
-		Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_ModelShader);
+		Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_ModelShader, m_ModelInstancedShader);
 		ARC_POP_RENDER_TAG();
 		m_GLCache->SetStencilWriteMask(0x00);
 
@@ -74,8 +79,7 @@ namespace Arcane
 			// Setup terrain information
 			ARC_PUSH_RENDER_TAG("Terrain");
 			m_GLCache->SetShader(m_TerrainShader);
-			m_TerrainShader->SetUniform("view", camera->GetViewMatrix());
-			m_TerrainShader->SetUniform("projection", camera->GetProjectionMatrix());
+			Renderer::BindCameraUniforms(camera);
 
 			// Render the terrain (use stencil to denote the terrain for the deferred lighting pass)
 			m_GLCache->SetStencilWriteMask(0xFF);
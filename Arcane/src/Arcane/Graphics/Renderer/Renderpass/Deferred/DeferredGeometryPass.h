@@ -27,7 +27,7 @@ namespace Arcane
 	private:
 		bool m_AllocatedGBuffer;
 		GBuffer *m_GBuffer;
-		Shader *m_ModelShader, *m_SkinnedModelShader, *m_TerrainShader;
+		Shader *m_ModelShader, *m_ModelInstancedShader, *m_SkinnedModelShader, *m_TerrainShader;
 	};
 }
 #endif
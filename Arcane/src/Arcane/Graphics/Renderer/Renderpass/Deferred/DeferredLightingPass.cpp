@@ -15,7 +15,7 @@ namespace Arcane
 {
 	DeferredLightingPass::DeferredLightingPass(Scene *scene) : RenderPass(scene), m_AllocatedFramebuffer(true)
 	{
-		m_LightingShader = ShaderLoader::LoadShader("deferred/PBR_LightingPass.glsl");
+		Init();
 
 		m_Framebuffer = new Framebuffer(Window::GetRenderResolutionWidth(), Window::GetRenderResolutionHeight(), false);
 		m_Framebuffer->AddColorTexture(FloatingPoint16).AddDepthStencilTexture(NormalizedDepthStencil).CreateFramebuffer();
@@ -23,7 +23,7 @@ namespace Arcane
 
 	DeferredLightingPass::DeferredLightingPass(Scene *scene, Framebuffer *customFramebuffer) : RenderPass(scene), m_AllocatedFramebuffer(false), m_Framebuffer(customFramebuffer)
 	{
-		m_LightingShader = ShaderLoader::LoadShader("deferred/PBR_LightingPass.glsl");
+		Init();
 	}
 
 	DeferredLightingPass::~DeferredLightingPass()
@@ -33,6 +33,12 @@ namespace Arcane
 		}
 	}
 
+	void DeferredLightingPass::Init()
+	{
+		m_LightingShader = ShaderLoader::LoadShader("deferred/PBR_LightingPass.glsl");
+		m_LightingIBLShader = ShaderLoader::LoadShader("deferred/PBR_LightingPass.glsl", ShaderDefines().Enable("USE_IBL"));
+	}
+
 	LightingPassOutput DeferredLightingPass::ExecuteLightingPass(ShadowmapPassOutput &inputShadowmapData, GBuffer *inputGbuffer, PreLightingPassOutput &preLightingOutput, ICamera *camera, bool useIBL)
 	{
 		// Framebuffer setup
@@ -56,40 +62,24 @@ namespace Arcane
 		LightManager *lightManager = m_ActiveScene->GetLightManager();
 		ProbeManager *probeManager = m_ActiveScene->GetProbeManager();
 
-		m_GLCache->SetShader(m_LightingShader);
-		lightManager->BindLightingUniforms(m_LightingShader);
-		m_LightingShader->SetUniform("viewPos", camera->GetPosition());
-		m_LightingShader->SetUniform("viewInverse", glm::inverse(camera->GetViewMatrix()));
-		m_LightingShader->SetUniform("projectionInverse", glm::inverse(camera->GetProjectionMatrix()));
+		lightManager->BindLightingUniforms(camera);
+		Renderer::BindCameraUniforms(camera);
 
-		// Bind GBuffer data
+		// Bind GBuffer data, the texture units are the same for both permutations
 		inputGbuffer->GetAlbedo()->Bind(6);
-		m_LightingShader->SetUniform("albedoTexture", 6);
-
 		inputGbuffer->GetNormal()->Bind(7);
-		m_LightingShader->SetUniform("normalTexture", 7);
-
 		inputGbuffer->GetMaterialInfo()->Bind(8);
-		m_LightingShader->SetUniform("materialInfoTexture", 8);
-
 		preLightingOutput.ssaoTexture->Bind(9);
-		m_LightingShader->SetUniform("ssaoTexture", 9);
-
 		inputGbuffer->GetDepthStencilTexture()->Bind(10);
-		m_LightingShader->SetUniform("depthTexture", 10);
 
 		// Shadowmap code
-		BindShadowmap(m_LightingShader, inputShadowmapData);
+		BindShadowmap(inputShadowmapData);
 
 		// Finally perform the lighting using the GBuffer
 
-		// IBL Bindings
-		glm::vec3 cameraPosition = camera->GetPosition();
-		probeManager->BindProbes(cameraPosition, m_LightingShader); // TODO: Should use camera component
-
-		// Perform lighting on the terrain (turn IBL off)
+		// Perform lighting on the terrain (without IBL)
 		ARC_PUSH_RENDER_TAG("Terrain");
-		m_LightingShader->SetUniform("computeIBL", 0);
+		SetGBufferUniforms(m_LightingShader);
 		m_GLCache->SetStencilFunc(GL_EQUAL, StencilValue::TerrainStencilValue, 0xFF);
 		Renderer::DrawNdcPlane();
 		ARC_POP_RENDER_TAG();
@@ -98,11 +88,15 @@ namespace Arcane
 		ARC_PUSH_RENDER_TAG("Opaque Models");
 		if (useIBL)
 		{
-			m_LightingShader->SetUniform("computeIBL", 1);
+			SetGBufferUniforms(m_LightingIBLShader);
+
+			// IBL Bindings
+			glm::vec3 cameraPosition = camera->GetPosition();
+			probeManager->BindProbes(cameraPosition, m_LightingIBLShader); // TODO: Should use camera component
 		}
 		else
 		{
-			m_LightingShader->SetUniform("computeIBL", 0);
+			SetGBufferUniforms(m_LightingShader);
 		}
 		m_GLCache->SetStencilFunc(GL_EQUAL, StencilValue::ModelStencilValue, 0xFF);
 		Renderer::DrawNdcPlane();
@@ -119,37 +113,23 @@ namespace Arcane
 		return passOutput;
 	}
 
-	void DeferredLightingPass::BindShadowmap(Shader *shader, ShadowmapPassOutput &shadowmapData)
+	void DeferredLightingPass::SetGBufferUniforms(Shader *shader)
 	{
-		LightManager *lightManager = m_ActiveScene->GetLightManager();
-
-		bool hasDirShadowMap = shadowmapData.directionalShadowmapFramebuffer != nullptr;
-		bool hasSpotShadowMap = shadowmapData.spotLightShadowmapFramebuffer != nullptr;
+		m_GLCache->SetShader(shader);
+		shader->SetUniform("albedoTexture", 6);
+		shader->SetUniform("normalTexture", 7);
+		shader->SetUniform("materialInfoTexture", 8);
+		shader->SetUniform("ssaoTexture", 9);
+		shader->SetUniform("depthTexture", 10);
+	}
 
-		shader->SetUniform("dirLightShadowData.lightShadowIndex", hasDirShadowMap ? lightManager->GetDirectionalLightShadowCasterIndex() : -1);
-		shader->SetUniform("spotLightShadowData.lightShadowIndex", hasSpotShadowMap ? lightManager->GetSpotLightShadowCasterIndex() : -1);
-		shader->SetUniform("pointLightShadowData.lightShadowIndex", shadowmapData.hasPointLightShadows ? lightManager->GetPointLightShadowCasterIndex() : -1);
+	void DeferredLightingPass::BindShadowmap(ShadowmapPassOutput &shadowmapData)
+	{
+		// The shadow data itself lives in the ShadowUniforms block, only the maps need binding. Their samplers have fixed units in the shader
+		m_ActiveScene->GetLightManager()->BindShadowUniforms(shadowmapData);
 
-		if (hasDirShadowMap)
-		{
-			shadowmapData.directionalShadowmapFramebuffer->GetDepthStencilTexture()->Bind(0);
-			shader->SetUniform("dirLightShadowmap", 0);
-			shader->SetUniform("dirLightShadowData.lightSpaceViewProjectionMatrix", shadowmapData.directionalLightViewProjMatrix);
-			shader->SetUniform("dirLightShadowData.shadowBias", shadowmapData.directionalShadowmapBias);
-		}
-		if (hasSpotShadowMap)
-		{
-			shadowmapData.spotLightShadowmapFramebuffer->GetDepthStencilTexture()->Bind(1);
-			shader->SetUniform("spotLightShadowmap", 1);
-			shader->SetUniform("spotLightShadowData.lightSpaceViewProjectionMatrix", shadowmapData.spotLightViewProjMatrix);
-			shader->SetUniform("spotLightShadowData.shadowBias", shadowmapData.spotLightShadowmapBias);
-		}
-		if (shadowmapData.hasPointLightShadows)
-		{
-			shader->SetUniform("pointLightShadowData.shadowBias", shadowmapData.pointLightShadowmapBias);
-			shader->SetUniform("pointLightShadowData.farPlane", shadowmapData.pointLightFarPlane);
-		}
-		shader->SetUniform("pointLightShadowCubemap", 2);
+		shadowmapData.directionalShadowmapCascades->Bind(0); // Must be bound even if there is no directional light shadows, same as the point light cubemap
+		shadowmapData.spotLightShadowAtlasFramebuffer->GetDepthStencilTexture()->Bind(1);
 		shadowmapData.pointLightShadowCubemap->Bind(2); // Must be bound even if there is no point light shadows. Thanks OpenGL Driver!
 	}
 }
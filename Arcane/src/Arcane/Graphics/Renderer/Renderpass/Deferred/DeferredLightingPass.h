@@ -24,11 +24,14 @@ namespace Arcane
 
 		LightingPassOutput ExecuteLightingPass(ShadowmapPassOutput &inputShadowmapData, GBuffer *inputGbuffer, PreLightingPassOutput &preLightingOutput, ICamera *camera, bool useIBL);
 	private:
-		void BindShadowmap(Shader *shader, ShadowmapPassOutput &shadowmapData);
+		void Init();
+
+		void BindShadowmap(ShadowmapPassOutput &shadowmapData);
+		void SetGBufferUniforms(Shader *shader);
 	private:
 		bool m_AllocatedFramebuffer;
 		Framebuffer *m_Framebuffer;
-		Shader *m_LightingShader;
+		Shader *m_LightingShader, *m_LightingIBLShader; // The IBL permutation is only used for models when IBL is enabled, terrain is always lit without it
 	};
 }
 #endif
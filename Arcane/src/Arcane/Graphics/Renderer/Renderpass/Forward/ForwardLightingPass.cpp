@@ -5,6 +5,7 @@
 #include <Arcane/Graphics/Shader.h>
 #include <Arcane/Graphics/Skybox.h>
 #include <Arcane/Graphics/Camera/ICamera.h>
+#include <Arcane/Graphics/Camera/Frustum.h>
 #include <Arcane/Graphics/Texture/Cubemap.h>
 #include <Arcane/Graphics/Renderer/GLCache.h>
 #include <Arcane/Graphics/Renderer/Renderer.h>
@@ -36,8 +37,12 @@ namespace Arcane
 
 	void ForwardLightingPass::Init()
 	{
-		m_ModelShader = ShaderLoader::LoadShader("forward/PBR_Model.glsl");
-		m_SkinnedModelShader = ShaderLoader::LoadShader("forward/PBR_Skinned_Model.glsl");
+		for (int useIBL = 0; useIBL < 2; useIBL++)
+		{
+			m_ModelShaders[useIBL] = ShaderLoader::LoadShader("forward/PBR_Model.glsl", ShaderDefines().Enable("USE_IBL", useIBL != 0));
+			m_ModelInstancedShaders[useIBL] = ShaderLoader::LoadShader("forward/PBR_Model.glsl", ShaderDefines().Enable("INSTANCED").Enable("USE_IBL", useIBL != 0));
+			m_SkinnedModelShaders[useIBL] = ShaderLoader::LoadShader("forward/PBR_Model.glsl", ShaderDefines().Enable("SKINNED").Enable("USE_IBL", useIBL != 0));
+		}
 		m_TerrainShader = ShaderLoader::LoadShader("forward/PBR_Terrain.glsl");
 	}
 
@@ -57,10 +62,13 @@ namespace Arcane
 		LightManager *lightManager = m_ActiveScene->GetLightManager();
 		ProbeManager *probeManager = m_ActiveScene->GetProbeManager();
 
-		// Lighting setup
-		auto lightBindFunction = &LightManager::BindLightingUniforms;
+		// Lighting setup, the light, shadow, and camera blocks are shared by every shader below so they only need to be filled once
 		if (renderOnlyStatic)
-			lightBindFunction = &LightManager::BindStaticLightingUniforms;
+			lightManager->BindStaticLightingUniforms(camera);
+		else
+			lightManager->BindLightingUniforms(camera);
+		lightManager->BindShadowUniforms(inputShadowmapData);
+		Renderer::BindCameraUniforms(camera);
 
 		// Render terrain
 		Terrain* terrain = m_ActiveScene->GetTerrain();
@@ -77,91 +85,81 @@ namespace Arcane
 			{
 				m_TerrainShader->SetUniform("usesClipPlane", false);
 			}
-			(lightManager->*lightBindFunction) (m_TerrainShader);
-			m_TerrainShader->SetUniform("viewPos", camera->GetPosition());
-			m_TerrainShader->SetUniform("view", camera->GetViewMatrix());
-			m_TerrainShader->SetUniform("projection", camera->GetProjectionMatrix());
-			BindShadowmap(m_TerrainShader, inputShadowmapData);
+			BindShadowmap(inputShadowmapData);
 			terrain->Draw(m_TerrainShader, MaterialRequired);
 			ARC_POP_RENDER_TAG();
 		}
 
 		// Render opaque objects since we are in the opaque pass
 		// Add meshes to the renderer
+		Frustum cameraFrustum(camera->GetProjectionMatrix() * camera->GetViewMatrix());
 		if (renderOnlyStatic)
 		{
-			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueStaticModels);
+			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueStaticModels, cameraFrustum);
 		}
 		else
 		{
-			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueModels);
+			m_ActiveScene->AddModelsToRenderer(ModelFilterType::OpaqueModels, cameraFrustum);
 		}
 
 		// Bind data to skinned shader and render skinned models
 		ARC_PUSH_RENDER_TAG("Skinned Models");
 		{
-			m_GLCache->SetShader(m_SkinnedModelShader);
+			Shader *skinnedModelShader = m_SkinnedModelShaders[useIBL];
+			m_GLCache->SetShader(skinnedModelShader);
 			if (m_GLCache->GetUsesClipPlane())
 			{
-				m_SkinnedModelShader->SetUniform("usesClipPlane", true);
-				m_SkinnedModelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
+				skinnedModelShader->SetUniform("usesClipPlane", true);
+				skinnedModelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
 			}
 			else
 			{
-				m_SkinnedModelShader->SetUniform("usesClipPlane", false);
+				skinnedModelShader->SetUniform("usesClipPlane", false);
 			}
-			(lightManager->*lightBindFunction) (m_SkinnedModelShader);
 
 			// Shadowmap code
-			BindShadowmap(m_SkinnedModelShader, inputShadowmapData);
+			BindShadowmap(inputShadowmapData);
 
-			// IBL Binding
-			glm::vec3 cameraPosition = camera->GetPosition();
-			probeManager->BindProbes(cameraPosition, m_SkinnedModelShader); // TODO: Should use camera component
+			// IBL Binding, only the IBL permutation samples the probes
 			if (useIBL)
 			{
-				m_SkinnedModelShader->SetUniform("computeIBL", 1);
-			}
-			else
-			{
-				m_SkinnedModelShader->SetUniform("computeIBL", 0);
+				glm::vec3 cameraPosition = camera->GetPosition();
+				probeManager->BindProbes(cameraPosition, skinnedModelShader); // TODO: Should use camera component
 			}
 
-			Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_SkinnedModelShader);
+			Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::MaterialRequired, skinnedModelShader);
 		}
 		ARC_POP_RENDER_TAG();
 
-		// Bind data to non-skinned shader and render non-skinned models
+		// Bind data to non-skinned shaders and render non-skinned models, the instanced variant needs the same data for the runs that get instanced
 		ARC_PUSH_RENDER_TAG("Non-Skinned Models");
 		{
-			m_GLCache->SetShader(m_ModelShader);
-			if (m_GLCache->GetUsesClipPlane())
+			Shader *nonInstancedShader = m_ModelShaders[useIBL], *instancedShader = m_ModelInstancedShaders[useIBL];
+			for (Shader *modelShader : { nonInstancedShader, instancedShader })
 			{
-				m_ModelShader->SetUniform("usesClipPlane", true);
-				m_ModelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
+				m_GLCache->SetShader(modelShader);
+				if (m_GLCache->GetUsesClipPlane())
+				{
+					modelShader->SetUniform("usesClipPlane", true);
+					modelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
+				}
+				else
+				{
+					modelShader->SetUniform("usesClipPlane", false);
+				}
+
+				// Shadowmap code
+				BindShadowmap(inputShadowmapData);
+
+				// IBL Binding, only the IBL permutation samples the probes
+				if (useIBL)
+				{
+					glm::vec3 cameraPosition = camera->GetPosition();
+					probeManager->BindProbes(cameraPosition, modelShader); // TODO: Should use camera component
+				}
 			}
-			else
-			{
-				m_ModelShader->SetUniform("usesClipPlane", false);
-			}
-			(lightManager->*lightBindFunction) (m_ModelShader);
-
-			// Shadowmap code
-			BindShadowmap(m_ModelShader, inputShadowmapData);
 
-			// IBL Binding
-			glm::vec3 cameraPosition = camera->GetPosition();
-			probeManager->BindProbes(cameraPosition, m_ModelShader); // TODO: Should use camera component
-			if (useIBL)
-			{
-				m_ModelShader->SetUniform("computeIBL", 1);
-			}
-			else
-			{
-				m_ModelShader->SetUniform("computeIBL", 0);
-			}
-
-			Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_ModelShader);
+			Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::MaterialRequired, nonInstancedShader, instancedShader);
 		}
 		ARC_POP_RENDER_TAG();
 
@@ -195,87 +193,81 @@ namespace Arcane
 		skybox->Draw(camera);
 		ARC_POP_RENDER_TAG();
 
-		// Lighting setup
-		auto lightBindFunction = &LightManager::BindLightingUniforms;
+		// Lighting setup, the light, shadow, and camera blocks are shared by every shader below so they only need to be filled once
 		if (renderOnlyStatic)
-			lightBindFunction = &LightManager::BindStaticLightingUniforms;
+			lightManager->BindStaticLightingUniforms(camera);
+		else
+			lightManager->BindLightingUniforms(camera);
+		lightManager->BindShadowUniforms(inputShadowmapData);
+		Renderer::BindCameraUniforms(camera);
 
 		// Render transparent objects since we are in the transparent pass
 		// Add meshes to the renderer
+		Frustum cameraFrustum(camera->GetProjectionMatrix() * camera->GetViewMatrix());
 		if (renderOnlyStatic)
 		{
-			m_ActiveScene->AddModelsToRenderer(ModelFilterType::TransparentStaticModels);
+			m_ActiveScene->AddModelsToRenderer(ModelFilterType::TransparentStaticModels, cameraFrustum);
 		}
 		else
 		{
-			m_ActiveScene->AddModelsToRenderer(ModelFilterType::TransparentModels);
+			m_ActiveScene->AddModelsToRenderer(ModelFilterType::TransparentModels, cameraFrustum);
 		}
 
 		// Bind data to skinned shader and render skinned models
 		ARC_PUSH_RENDER_TAG("Skinned Models");
 		{
-			m_GLCache->SetShader(m_SkinnedModelShader);
+			Shader *skinnedModelShader = m_SkinnedModelShaders[useIBL];
+			m_GLCache->SetShader(skinnedModelShader);
 			if (m_GLCache->GetUsesClipPlane())
 			{
-				m_SkinnedModelShader->SetUniform("usesClipPlane", true);
-				m_SkinnedModelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
+				skinnedModelShader->SetUniform("usesClipPlane", true);
+				skinnedModelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
 			}
 			else
 			{
-				m_SkinnedModelShader->SetUniform("usesClipPlane", false);
+				skinnedModelShader->SetUniform("usesClipPlane", false);
 			}
-			(lightManager->*lightBindFunction) (m_SkinnedModelShader);
 
 			// Shadowmap code
-			BindShadowmap(m_SkinnedModelShader, inputShadowmapData);
+			BindShadowmap(inputShadowmapData);
 
-			// IBL Binding
-			glm::vec3 cameraPosition = camera->GetPosition();
-			probeManager->BindProbes(cameraPosition, m_SkinnedModelShader); // TODO: Should use camera component
+			// IBL Binding, only the IBL permutation samples the probes
 			if (useIBL)
 			{
-				m_SkinnedModelShader->SetUniform("computeIBL", 1);
-			}
-			else
-			{
-				m_SkinnedModelShader->SetUniform("computeIBL", 0);
+				glm::vec3 cameraPosition = camera->GetPosition();
+				probeManager->BindProbes(cameraPosition, skinnedModelShader); // TODO: Should use camera component
 			}
 
-			Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_SkinnedModelShader);
+			Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::MaterialRequired, skinnedModelShader);
 		}
 		ARC_POP_RENDER_TAG();
 
 		// Bind data to non-skinned shader and render non-skinned models
 		ARC_PUSH_RENDER_TAG("Non-Skinned Models");
 		{
-			m_GLCache->SetShader(m_ModelShader);
+			Shader *modelShader = m_ModelShaders[useIBL];
+			m_GLCache->SetShader(modelShader);
 			if (m_GLCache->GetUsesClipPlane())
 			{
-				m_ModelShader->SetUniform("usesClipPlane", true);
-				m_ModelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
+				modelShader->SetUniform("usesClipPlane", true);
+				modelShader->SetUniform("clipPlane", m_GLCache->GetActiveClipPlane());
 			}
 			else
 			{
-				m_ModelShader->SetUniform("usesClipPlane", false);
+				modelShader->SetUniform("usesClipPlane", false);
 			}
-			(lightManager->*lightBindFunction) (m_ModelShader);
 
 			// Shadowmap code
-			BindShadowmap(m_ModelShader, inputShadowmapData);
+			BindShadowmap(inputShadowmapData);
 
-			// IBL Binding
-			glm::vec3 cameraPosition = camera->GetPosition();
-			probeManager->BindProbes(cameraPosition, m_ModelShader); // TODO: Should use camera component
+			// IBL Binding, only the IBL permutation samples the probes
 			if (useIBL)
 			{
-				m_ModelShader->SetUniform("computeIBL", 1);
-			}
-			else
-			{
-				m_ModelShader->SetUniform("computeIBL", 0);
+				glm::vec3 cameraPosition = camera->GetPosition();
+				probeManager->BindProbes(cameraPosition, modelShader); // TODO: Should use camera component
 			}
 
-			Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::MaterialRequired, m_ModelShader);
+			Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::MaterialRequired, modelShader);
 		}
 		ARC_POP_RENDER_TAG();
 
@@ -285,37 +277,11 @@ namespace Arcane
 		return passOutput;
 	}
 
-	void ForwardLightingPass::BindShadowmap(Shader *shader, ShadowmapPassOutput &shadowmapData)
+	void ForwardLightingPass::BindShadowmap(ShadowmapPassOutput &shadowmapData)
 	{
-		LightManager *lightManager = m_ActiveScene->GetLightManager();
-
-		bool hasDirShadowMap = shadowmapData.directionalShadowmapFramebuffer != nullptr;
-		bool hasSpotShadowMap = shadowmapData.spotLightShadowmapFramebuffer != nullptr;
-
-		shader->SetUniform("dirLightShadowData.lightShadowIndex", hasDirShadowMap ? lightManager->GetDirectionalLightShadowCasterIndex() : -1);
-		shader->SetUniform("spotLightShadowData.lightShadowIndex", hasSpotShadowMap ? lightManager->GetSpotLightShadowCasterIndex() : -1);
-		shader->SetUniform("pointLightShadowData.lightShadowIndex", shadowmapData.hasPointLightShadows ? lightManager->GetPointLightShadowCasterIndex() : -1);
-
-		if (hasDirShadowMap)
-		{
-			shadowmapData.directionalShadowmapFramebuffer->GetDepthStencilTexture()->Bind(0);
-			shader->SetUniform("dirLightShadowmap", 0);
-			shader->SetUniform("dirLightShadowData.lightSpaceViewProjectionMatrix", shadowmapData.directionalLightViewProjMatrix);
-			shader->SetUniform("dirLightShadowData.shadowBias", shadowmapData.directionalShadowmapBias);
-		}
-		if (hasSpotShadowMap)
-		{
-			shadowmapData.spotLightShadowmapFramebuffer->GetDepthStencilTexture()->Bind(1);
-			shader->SetUniform("spotLightShadowmap", 1);
-			shader->SetUniform("spotLightShadowData.lightSpaceViewProjectionMatrix", shadowmapData.spotLightViewProjMatrix);
-			shader->SetUniform("spotLightShadowData.shadowBias", shadowmapData.spotLightShadowmapBias);
-		}
-		if (shadowmapData.hasPointLightShadows)
-		{
-			shader->SetUniform("pointLightShadowData.shadowBias", shadowmapData.pointLightShadowmapBias);
-			shader->SetUniform("pointLightShadowData.farPlane", shadowmapData.pointLightFarPlane);
-		}
-		shader->SetUniform("pointLightShadowCubemap", 2);
+		// The shadow data itself lives in the ShadowUniforms block, only the maps need binding. Their samplers have fixed units in the shaders
+		shadowmapData.directionalShadowmapCascades->Bind(0); // Must be bound even if there is no directional light shadows, same as the point light cubemap
+		shadowmapData.spotLightShadowAtlasFramebuffer->GetDepthStencilTexture()->Bind(1);
 		shadowmapData.pointLightShadowCubemap->Bind(2); // Must be bound even if there is no point light shadows. Thanks OpenGL Driver!
 	}
 }
@@ -28,11 +28,13 @@ namespace Arcane
 	private:
 		void Init();
 
-		void BindShadowmap(Shader *shader, ShadowmapPassOutput &shadowmapData);
+		void BindShadowmap(ShadowmapPassOutput &shadowmapData);
 	private:
 		bool m_AllocatedFramebuffer;
 		Framebuffer *m_Framebuffer;
-		Shader *m_ModelShader, *m_SkinnedModelShader, *m_TerrainShader;
+		// Model permutations are indexed by whether IBL is used
+		Shader *m_ModelShaders[2], *m_ModelInstancedShaders[2], *m_SkinnedModelShaders[2];
+		Shader *m_TerrainShader;
 	};
 }
 #endif
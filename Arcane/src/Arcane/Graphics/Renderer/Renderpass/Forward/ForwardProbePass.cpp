@@ -16,7 +16,7 @@
 namespace Arcane
 {
 	ForwardProbePass::ForwardProbePass(Scene *scene) : RenderPass(scene),
-		m_SceneCaptureDirLightShadowFramebuffer(IBL_CAPTURE_RESOLUTION, IBL_CAPTURE_RESOLUTION, false), m_SceneCaptureSpotLightShadowFramebuffer(IBL_CAPTURE_RESOLUTION, IBL_CAPTURE_RESOLUTION, false), m_SceneCapturePointLightDepthCubemap(),
+		m_SceneCaptureDirLightShadowCascades(), m_SceneCaptureSpotLightShadowAtlasFramebuffer(IBL_CAPTURE_RESOLUTION * 4, IBL_CAPTURE_RESOLUTION * 4, false), m_SceneCapturePointLightDepthCubemap(),
 		m_SceneCaptureLightingFramebuffer(IBL_CAPTURE_RESOLUTION, IBL_CAPTURE_RESOLUTION, false), m_LightProbeConvolutionFramebuffer(LIGHT_PROBE_RESOLUTION, LIGHT_PROBE_RESOLUTION, false), m_ReflectionProbeSamplingFramebuffer(REFLECTION_PROBE_RESOLUTION, REFLECTION_PROBE_RESOLUTION, false)
 	{
 		m_SceneCaptureSettings.TextureFormat = GL_RGBA16F;
@@ -28,8 +28,9 @@ namespace Arcane
 		depthCubemapSettings.TextureMagnificationFilterMode = GL_LINEAR;
 		m_SceneCapturePointLightDepthCubemap.SetCubemapSettings(depthCubemapSettings);
 
-		m_SceneCaptureDirLightShadowFramebuffer.AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
-		m_SceneCaptureSpotLightShadowFramebuffer.AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
+		LightManager::GenerateShadowCascadeTexture(m_SceneCaptureDirLightShadowCascades, glm::uvec2(IBL_CAPTURE_RESOLUTION, IBL_CAPTURE_RESOLUTION), SHADOW_CASCADE_MAX_COUNT);
+		// Spot light shadows use the light manager's tile layout, the captures are low resolution so the atlas can be too
+		m_SceneCaptureSpotLightShadowAtlasFramebuffer.AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
 		m_SceneCaptureLightingFramebuffer.AddColorTexture(FloatingPoint16).AddDepthStencilRBO(NormalizedDepthOnly).CreateFramebuffer();
 		m_LightProbeConvolutionFramebuffer.AddColorTexture(FloatingPoint16).CreateFramebuffer();
 		m_ReflectionProbeSamplingFramebuffer.AddColorTexture(FloatingPoint16).CreateFramebuffer();
@@ -181,7 +182,7 @@ namespace Arcane
 
 		// Initialize step before rendering to the probe's cubemap
 		m_CubemapCamera.SetPosition(probePosition);
-		ShadowmapPass shadowPass(m_ActiveScene, &m_SceneCaptureDirLightShadowFramebuffer, &m_SceneCaptureSpotLightShadowFramebuffer, &m_SceneCapturePointLightDepthCubemap);
+		ShadowmapPass shadowPass(m_ActiveScene, &m_SceneCaptureDirLightShadowCascades, &m_SceneCaptureSpotLightShadowAtlasFramebuffer, &m_SceneCapturePointLightDepthCubemap);
 		ForwardLightingPass lightingPass(m_ActiveScene, &m_SceneCaptureLightingFramebuffer); // Use our framebuffer when rendering
 
 		// Render the scene to the probe's cubemap
@@ -234,7 +235,7 @@ namespace Arcane
 
 		// Initialize step before rendering to the probe's cubemap
 		m_CubemapCamera.SetPosition(probePosition);
-		ShadowmapPass shadowPass(m_ActiveScene, &m_SceneCaptureDirLightShadowFramebuffer, &m_SceneCaptureSpotLightShadowFramebuffer, &m_SceneCapturePointLightDepthCubemap);
+		ShadowmapPass shadowPass(m_ActiveScene, &m_SceneCaptureDirLightShadowCascades, &m_SceneCaptureSpotLightShadowAtlasFramebuffer, &m_SceneCapturePointLightDepthCubemap);
 		ForwardLightingPass lightingPass(m_ActiveScene, &m_SceneCaptureLightingFramebuffer); // Use our framebuffer when rendering
 
 		// Render the scene to the probe's cubemap
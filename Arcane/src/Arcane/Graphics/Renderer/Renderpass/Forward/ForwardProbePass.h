@@ -37,7 +37,8 @@ namespace Arcane
 		void generateBRDFLUT();
 		void generateFallbackProbes();
 	private:
-		Framebuffer m_SceneCaptureDirLightShadowFramebuffer, m_SceneCaptureSpotLightShadowFramebuffer, m_SceneCaptureLightingFramebuffer, m_LightProbeConvolutionFramebuffer, m_ReflectionProbeSamplingFramebuffer;
+		Texture m_SceneCaptureDirLightShadowCascades;
+		Framebuffer m_SceneCaptureSpotLightShadowAtlasFramebuffer, m_SceneCaptureLightingFramebuffer, m_LightProbeConvolutionFramebuffer, m_ReflectionProbeSamplingFramebuffer;
 		Cubemap m_SceneCapturePointLightDepthCubemap;
 		CubemapCamera m_CubemapCamera;
 		CubemapSettings m_SceneCaptureSettings;
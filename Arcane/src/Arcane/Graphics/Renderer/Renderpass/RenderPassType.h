@@ -27,13 +27,18 @@ namespace Arcane
 
 	struct ShadowmapPassOutput
 	{
-		glm::mat4 directionalLightViewProjMatrix;
-		Framebuffer *directionalShadowmapFramebuffer = nullptr;
+		bool hasDirectionalLightShadows = false; // The cascade array is always output for the same reason as the point light cubemap
+		glm::mat4 directionalLightCascadeViewProjMatrices[SHADOW_CASCADE_MAX_COUNT];
+		glm::vec4 directionalLightCascadeSplitDepths = glm::vec4(0.0f); // View space depth each cascade ends at
+		int directionalLightCascadeCount = 0;
+		Texture *directionalShadowmapCascades = nullptr;
 		float directionalShadowmapBias;
 
-		glm::mat4 spotLightViewProjMatrix;
-		Framebuffer *spotLightShadowmapFramebuffer = nullptr;
-		float spotLightShadowmapBias;
+		Framebuffer *spotLightShadowAtlasFramebuffer = nullptr; // Always output, every spot light shadow is a tile in it
+		int spotLightShadowCount = 0; // One per tile, in the same order as the light manager's tiles so the shadow index in the light data finds the right one
+		glm::mat4 spotLightViewProjMatrices[SHADOW_ATLAS_MAX_LIGHTS];
+		glm::vec4 spotLightShadowAtlasRects[SHADOW_ATLAS_MAX_LIGHTS];
+		float spotLightShadowmapBiases[SHADOW_ATLAS_MAX_LIGHTS];
 
 		bool hasPointLightShadows; // Need to have this since the point light shadow cubemap always needs to be bound even if we never use it (thanks to the OpenGL Driver)
 		Cubemap* pointLightShadowCubemap = nullptr;
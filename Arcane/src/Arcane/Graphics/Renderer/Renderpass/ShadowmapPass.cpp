@@ -2,11 +2,14 @@
 #include "ShadowmapPass.h"
 
 #include <Arcane/Scene/Scene.h>
+#include <Arcane/Scene/Components.h>
 #include <Arcane/Graphics/Camera/ICamera.h>
+#include <Arcane/Graphics/Camera/Frustum.h>
 #include <Arcane/Graphics/Renderer/GLCache.h>
 #include <Arcane/Graphics/Renderer/Renderer.h>
 #include <Arcane/Graphics/Shader.h>
 #include <Arcane/Graphics/Texture/Cubemap.h>
+#include <Arcane/Graphics/Texture/Texture.h>
 #include <Arcane/Util/Loaders/ShaderLoader.h>
 
 namespace Arcane
@@ -16,27 +19,265 @@ namespace Arcane
 		Init();
 	}
 
-	ShadowmapPass::ShadowmapPass(Scene *scene, Framebuffer *customDirectionalLightShadowFramebuffer, Framebuffer *customSpotLightShadowFramebuffer, Cubemap* customPointLightShadowCubemap)
+	ShadowmapPass::ShadowmapPass(Scene *scene, Texture *customDirectionalLightShadowCascades, Framebuffer *customSpotLightShadowAtlasFramebuffer, Cubemap* customPointLightShadowCubemap)
 		: RenderPass(scene), m_EmptyFramebuffer(1, 1, false),
-		m_CustomDirectionalLightShadowFramebuffer(customDirectionalLightShadowFramebuffer), m_CustomSpotLightShadowFramebuffer(customSpotLightShadowFramebuffer), m_CustomPointLightShadowCubemap(customPointLightShadowCubemap)
+		m_CustomDirectionalLightShadowCascades(customDirectionalLightShadowCascades), m_CustomSpotLightShadowAtlasFramebuffer(customSpotLightShadowAtlasFramebuffer), m_CustomPointLightShadowCubemap(customPointLightShadowCubemap)
 	{
 		Init();
 	}
 
 	ShadowmapPass::~ShadowmapPass()
 	{
-
+		delete m_StaticDirectionalShadowCascades;
+		delete m_StaticSpotLightShadowAtlasFramebuffer;
+		delete m_StaticPointLightShadowCubemap;
 	}
 
 	void ShadowmapPass::Init()
 	{
 		m_ShadowmapShader = ShaderLoader::LoadShader("Shadowmap_Generation.glsl");
-		m_ShadowmapSkinnedShader = ShaderLoader::LoadShader("Shadowmap_Generation_Skinned.glsl");
-		m_ShadowmapLinearShader = ShaderLoader::LoadShader("Shadowmap_Generation_Linear.glsl");
-		m_ShadowmapLinearSkinnedShader = ShaderLoader::LoadShader("Shadowmap_Generation_Linear_Skinned.glsl");
+		m_ShadowmapSkinnedShader = ShaderLoader::LoadShader("Shadowmap_Generation.glsl", ShaderDefines().Enable("SKINNED"));
+		m_ShadowmapInstancedShader = ShaderLoader::LoadShader("Shadowmap_Generation.glsl", ShaderDefines().Enable("INSTANCED"));
+		m_ShadowmapLinearShader = ShaderLoader::LoadShader("Shadowmap_Generation.glsl", ShaderDefines().Enable("LINEAR_DEPTH"));
+		m_ShadowmapLinearSkinnedShader = ShaderLoader::LoadShader("Shadowmap_Generation.glsl", ShaderDefines().Enable("LINEAR_DEPTH").Enable("SKINNED"));
+		m_ShadowmapLinearInstancedShader = ShaderLoader::LoadShader("Shadowmap_Generation.glsl", ShaderDefines().Enable("LINEAR_DEPTH").Enable("INSTANCED"));
+		m_ShadowmapCubemapShader = ShaderLoader::LoadShader("Shadowmap_Cubemap_Generation.glsl");
+		m_ShadowmapCubemapSkinnedShader = ShaderLoader::LoadShader("Shadowmap_Cubemap_Generation.glsl", ShaderDefines().Enable("SKINNED"));
+		m_ShadowmapCubemapInstancedShader = ShaderLoader::LoadShader("Shadowmap_Cubemap_Generation.glsl", ShaderDefines().Enable("INSTANCED"));
 		m_EmptyFramebuffer.AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
 	}
 
+	// Practical split scheme, blends logarithmic splits (even texel density on screen) with uniform splits (which don't cram every cascade up against the camera)
+	static void ComputeCascadeSplitDepths(float nearPlane, float farPlane, int cascadeCount, float lambda, float *outSplitDepths)
+	{
+		for (int i = 0; i < cascadeCount; i++)
+		{
+			float fraction = static_cast<float>(i + 1) / static_cast<float>(cascadeCount);
+			float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+			float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+			outSplitDepths[i] = glm::mix(uniformSplit, logSplit, lambda);
+		}
+	}
+
+	// Fits an orthographic projection around the bounding sphere of the camera's frustum between two view depths. A sphere keeps the same size as the camera turns,
+	// and moving its center in whole texels keeps the shadow edges from shimmering as the camera moves
+	static glm::mat4 ComputeCascadeViewProjection(const glm::vec3 *frustumCorners, float cameraNearPlane, float cameraFarPlane, float sliceNear, float sliceFar, const glm::vec3 &lightDir, unsigned int resolution)
+	{
+		// Depth along each edge of the frustum is linear, so the slice's corners are found by sliding along the edges from the near corners to the far corners
+		float nearAmount = (sliceNear - cameraNearPlane) / (cameraFarPlane - cameraNearPlane);
+		float farAmount = (sliceFar - cameraNearPlane) / (cameraFarPlane - cameraNearPlane);
+		glm::vec3 sliceCorners[8];
+		glm::vec3 center(0.0f);
+		for (int i = 0; i < 4; i++)
+		{
+			glm::vec3 edge = frustumCorners[i + 4] - frustumCorners[i];
+			sliceCorners[i] = frustumCorners[i] + edge * nearAmount;
+			sliceCorners[i + 4] = frustumCorners[i] + edge * farAmount;
+			center += sliceCorners[i] + sliceCorners[i + 4];
+		}
+		center /= 8.0f;
+
+		float radius = 0.0f;
+		for (int i = 0; i < 8; i++)
+		{
+			radius = glm::max(radius, glm::length(sliceCorners[i] - center));
+		}
+		radius = std::ceil(radius * 16.0f) / 16.0f; // Rounded up so floating point error can't change the size from frame to frame
+
+		glm::vec3 up = std::abs(lightDir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, up);
+		glm::vec3 lightSpaceCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+		float texelSize = (2.0f * radius) / static_cast<float>(resolution);
+		lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+		lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+
+		// The light looks down -z, the depth range is pulled back towards the light so casters between it and the slice still make it into the cascade
+		float nearPlane = -lightSpaceCenter.z - radius - SHADOW_CASCADE_CASTER_DISTANCE;
+		float farPlane = -lightSpaceCenter.z + radius;
+		glm::mat4 lightProjection = glm::ortho(lightSpaceCenter.x - radius, lightSpaceCenter.x + radius, lightSpaceCenter.y - radius, lightSpaceCenter.y + radius, nearPlane, farPlane);
+		return lightProjection * lightView;
+	}
+
+	// Same light in the same place in the same texture with the same static casters, the view projection is the only thing allowed to differ
+	static bool IsSameShadowTarget(const ShadowCacheKey &cached, const ShadowCacheKey &key)
+	{
+		return cached.Light != nullptr && cached.Light == key.Light && cached.TargetID == key.TargetID && cached.Region == key.Region && cached.StaticGeometryVersion == key.StaticGeometryVersion;
+	}
+
+	static ShadowCacheAction GetShadowCacheAction(const ShadowCacheEntry &entry, const ShadowCacheKey &key, bool canLag)
+	{
+		if (canLag && IsSameShadowTarget(entry.Live, key))
+			return ShadowCacheAction::Keep;
+		if (IsSameShadowTarget(entry.Static, key) && entry.Static.ViewProjection == key.ViewProjection)
+			return ShadowCacheAction::CopyStatic;
+		if (IsSameShadowTarget(entry.Live, key) && entry.Live.ViewProjection == key.ViewProjection)
+			return ShadowCacheAction::RenderStatic;
+		return ShadowCacheAction::RenderDirect;
+	}
+
+	// Targets past the full rate ones are only updated every SHADOW_DISTANT_UPDATE_INTERVAL frames, offset by their index so they take turns
+	static bool CanShadowTargetLag(u64 frameIndex, int index)
+	{
+		return (frameIndex + static_cast<u64>(index)) % SHADOW_DISTANT_UPDATE_INTERVAL != 0;
+	}
+
+	bool ShadowmapPass::FilterIncludesStaticCasters(ModelFilterType filter)
+	{
+		return filter != ModelFilterType::DynamicModels;
+	}
+
+	void ShadowmapPass::RenderShadowCasters(ICamera *camera, const glm::mat4 &lightViewProjMatrix, ModelFilterType filter)
+	{
+		Frustum lightFrustum(lightViewProjMatrix);
+
+		// Setup model renderer
+		m_ActiveScene->AddModelsToRenderer(filter, lightFrustum);
+
+		// Render skinned models
+		{
+			m_GLCache->SetShader(m_ShadowmapSkinnedShader);
+			m_ShadowmapSkinnedShader->SetUniform("lightSpaceViewProjectionMatrix", lightViewProjMatrix);
+			Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+			Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+		}
+
+		// Render non-skinned models
+		{
+			m_GLCache->SetShader(m_ShadowmapInstancedShader);
+			m_ShadowmapInstancedShader->SetUniform("lightSpaceViewProjectionMatrix", lightViewProjMatrix);
+			m_GLCache->SetShader(m_ShadowmapShader);
+			m_ShadowmapShader->SetUniform("lightSpaceViewProjectionMatrix", lightViewProjMatrix);
+			Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapShader, m_ShadowmapInstancedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+			Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+		}
+
+		// Render terrain
+		Terrain* terrain = m_ActiveScene->GetTerrain();
+		if (terrain && FilterIncludesStaticCasters(filter))
+		{
+			m_GLCache->SetShader(m_ShadowmapShader);
+			terrain->Draw(m_ShadowmapShader, RenderPassType::NoMaterialRequired);
+		}
+	}
+
+	void ShadowmapPass::RenderPointShadowCasters(ICamera *camera, Cubemap *shadowCubemap, float farPlane, ModelFilterType filter, bool clearDepth)
+	{
+		if (Renderer::GetSinglePassPointShadowsEnabled())
+		{
+			RenderPointShadowCastersLayered(camera, shadowCubemap, farPlane, filter, clearDepth);
+		}
+		else
+		{
+			RenderPointShadowCastersPerFace(camera, shadowCubemap, farPlane, filter, clearDepth);
+		}
+	}
+
+	void ShadowmapPass::RenderPointShadowCastersPerFace(ICamera *camera, Cubemap *shadowCubemap, float farPlane, ModelFilterType filter, bool clearDepth)
+	{
+		glm::mat4 pointLightProjection = m_CubemapCamera.GetProjectionMatrix();
+		for (int i = 0; i < 6; i++)
+		{
+			// Setup the camera's view
+			m_CubemapCamera.SwitchCameraToFace(i);
+			glm::mat4 pointLightView = m_CubemapCamera.GetViewMatrix();
+			glm::mat4 pointLightViewProjMatrix = pointLightProjection * pointLightView;
+			Frustum pointLightFaceFrustum(pointLightViewProjMatrix);
+
+			m_EmptyFramebuffer.SetDepthAttachment(DepthStencilAttachmentFormat::NormalizedDepthOnly, shadowCubemap->GetCubemapID(), GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+			if (clearDepth)
+				m_EmptyFramebuffer.ClearDepth();
+
+			// Setup model renderer
+			m_ActiveScene->AddModelsToRenderer(filter, pointLightFaceFrustum);
+
+			// Render skinned models
+			{
+				m_GLCache->SetShader(m_ShadowmapLinearSkinnedShader);
+				m_ShadowmapLinearSkinnedShader->SetUniform("lightPos", m_CubemapCamera.GetPosition());
+				m_ShadowmapLinearSkinnedShader->SetUniform("lightFarPlane", farPlane);
+				m_ShadowmapLinearSkinnedShader->SetUniform("lightSpaceViewProjectionMatrix", pointLightViewProjMatrix);
+				Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+				Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+			}
+
+			// Render non-skinned models
+			{
+				m_GLCache->SetShader(m_ShadowmapLinearInstancedShader);
+				m_ShadowmapLinearInstancedShader->SetUniform("lightPos", m_CubemapCamera.GetPosition());
+				m_ShadowmapLinearInstancedShader->SetUniform("lightFarPlane", farPlane);
+				m_ShadowmapLinearInstancedShader->SetUniform("lightSpaceViewProjectionMatrix", pointLightViewProjMatrix);
+				m_GLCache->SetShader(m_ShadowmapLinearShader);
+				m_ShadowmapLinearShader->SetUniform("lightPos", m_CubemapCamera.GetPosition());
+				m_ShadowmapLinearShader->SetUniform("lightFarPlane", farPlane);
+				m_ShadowmapLinearShader->SetUniform("lightSpaceViewProjectionMatrix", pointLightViewProjMatrix);
+				Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearShader, m_ShadowmapLinearInstancedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+				Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+			}
+
+			// Render terrain
+			Terrain* terrain = m_ActiveScene->GetTerrain();
+			if (terrain && FilterIncludesStaticCasters(filter))
+			{
+				m_GLCache->SetShader(m_ShadowmapLinearShader);
+				terrain->Draw(m_ShadowmapLinearShader, RenderPassType::NoMaterialRequired);
+			}
+		}
+		// Reset state
+		m_EmptyFramebuffer.SetDepthAttachment(DepthStencilAttachmentFormat::NormalizedDepthOnly, 0, GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+	}
+
+	void ShadowmapPass::RenderPointShadowCastersLayered(ICamera *camera, Cubemap *shadowCubemap, float farPlane, ModelFilterType filter, bool clearDepth)
+	{
+		// Face index is also the layer of the cubemap the geometry shader writes to
+		glm::mat4 pointLightProjection = m_CubemapCamera.GetProjectionMatrix();
+		glm::mat4 faceViewProjMatrices[6];
+		Frustum faceFrustums[6];
+		for (int i = 0; i < 6; i++)
+		{
+			m_CubemapCamera.SwitchCameraToFace(i);
+			faceViewProjMatrices[i] = pointLightProjection * m_CubemapCamera.GetViewMatrix();
+			faceFrustums[i] = Frustum(faceViewProjMatrices[i]);
+		}
+
+		// Clearing a layered attachment clears every face
+		m_EmptyFramebuffer.SetDepthAttachmentLayered(DepthStencilAttachmentFormat::NormalizedDepthOnly, shadowCubemap->GetCubemapID());
+		if (clearDepth)
+			m_EmptyFramebuffer.ClearDepth();
+
+		// Setup model renderer, the corners of the faces' far planes are sqrt(3) times the far plane away from the light
+		const glm::vec3 &lightPosition = m_CubemapCamera.GetPosition();
+		m_ActiveScene->AddModelsToRendererLayered(filter, faceFrustums, 6, lightPosition, farPlane * std::sqrt(3.0f));
+
+		Shader *cubemapShaders[] = { m_ShadowmapCubemapShader, m_ShadowmapCubemapSkinnedShader, m_ShadowmapCubemapInstancedShader };
+		for (Shader *shader : cubemapShaders)
+		{
+			m_GLCache->SetShader(shader);
+			shader->SetUniform("lightPos", lightPosition);
+			shader->SetUniform("lightFarPlane", farPlane);
+			shader->SetUniformArray("faceViewProjectionMatrices", 6, faceViewProjMatrices);
+		}
+
+		// Render skinned models
+		Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapCubemapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+		Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapCubemapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+
+		// Render non-skinned models
+		Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapCubemapShader, m_ShadowmapCubemapInstancedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+		Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapCubemapShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+
+		// Render terrain, it isn't culled so it goes to every face
+		Terrain* terrain = m_ActiveScene->GetTerrain();
+		if (terrain && FilterIncludesStaticCasters(filter))
+		{
+			m_GLCache->SetShader(m_ShadowmapCubemapShader);
+			m_ShadowmapCubemapShader->SetUniform("layerMask", 0x3F);
+			terrain->Draw(m_ShadowmapCubemapShader, RenderPassType::NoMaterialRequired);
+		}
+
+		// Reset state
+		m_EmptyFramebuffer.SetDepthAttachment(DepthStencilAttachmentFormat::NormalizedDepthOnly, 0, GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+	}
+
 	ShadowmapPassOutput ShadowmapPass::GenerateShadowmaps(ICamera *camera, bool renderOnlyStatic)
 	{
 		// Render pass output
@@ -45,147 +286,237 @@ namespace Arcane
 		LightManager *lightManager = m_ActiveScene->GetLightManager();
 		Framebuffer *shadowFramebuffer;
 
+		// Static casters are cached while neither they nor the light change, the dynamic casters are drawn over a copy of the cache every frame
+		bool useShadowCaching = Renderer::GetShadowCachingEnabled() && !renderOnlyStatic;
+		ModelFilterType uncachedFilter = renderOnlyStatic ? ModelFilterType::StaticModels : ModelFilterType::AllModels;
+		u64 staticGeometryVersion = m_ActiveScene->GetStaticGeometryVersion();
+		m_FrameIndex++;
+
 		// Directional Light Shadow Setup
 		ARC_PUSH_RENDER_TAG("Directional Shadows");
-		if (m_CustomDirectionalLightShadowFramebuffer)
+		Texture *shadowCascades = nullptr;
+		if (m_CustomDirectionalLightShadowCascades)
 		{
-			shadowFramebuffer = m_CustomDirectionalLightShadowFramebuffer;
+			shadowCascades = m_CustomDirectionalLightShadowCascades;
 		}
 		else
 		{
-			shadowFramebuffer = lightManager->GetDirectionalLightShadowCasterFramebuffer();
+			shadowCascades = lightManager->GetDirectionalLightShadowCasterCascades();
 		}
-		glViewport(0, 0, shadowFramebuffer->GetWidth(), shadowFramebuffer->GetHeight());
-		shadowFramebuffer->Bind();
-		shadowFramebuffer->ClearDepth();
 
-		// Directional Light Shadows
+		// Directional Light Shadows, each cascade covers a slice of the camera's frustum and only draws what intersects its own bounds
+		passOutput.hasDirectionalLightShadows = false;
 		if (lightManager->HasDirectionalLightShadowCaster())
 		{
 			// Setup
-			glm::vec2 nearFarPlane = lightManager->GetDirectionalLightShadowCasterNearFarPlane();
+			glm::vec3 lightDir = lightManager->GetDirectionalLightShadowCasterLightDir();
+			int cascadeCount = glm::min(lightManager->GetDirectionalLightShadowCasterCascadeCount(), static_cast<int>(shadowCascades->GetLayerCount()));
+			float cascadeNearPlane = camera->GetNearPlane();
+			float cascadeFarPlane = glm::clamp(lightManager->GetDirectionalLightShadowCasterCascadeDistance(), cascadeNearPlane, camera->GetFarPlane());
+			float splitDepths[SHADOW_CASCADE_MAX_COUNT] = {};
+			ComputeCascadeSplitDepths(cascadeNearPlane, cascadeFarPlane, cascadeCount, lightManager->GetDirectionalLightShadowCasterCascadeSplitLambda(), splitDepths);
+
+			// World space corners of the camera's frustum, near plane first
+			glm::mat4 inverseViewProj = glm::inverse(camera->GetProjectionMatrix() * camera->GetViewMatrix());
+			glm::vec3 frustumCorners[8];
+			for (int i = 0; i < 8; i++)
+			{
+				glm::vec4 corner = inverseViewProj * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+				frustumCorners[i] = glm::vec3(corner) / corner.w;
+			}
 
-			// View + Projection setup
-			glm::vec3 dirLightShadowmapLookAtPos = camera->GetPosition();
-			glm::vec3 dirLightShadowmapEyePos = dirLightShadowmapLookAtPos - (lightManager->GetDirectionalLightShadowCasterLightDir() * 50.0f);
-			glm::mat4 directionalLightProjection = glm::ortho(-40.0f, 40.0f, -40.0f, 40.0f, nearFarPlane.x, nearFarPlane.y);
-			glm::mat4 directionalLightView = glm::lookAt(dirLightShadowmapEyePos, dirLightShadowmapLookAtPos, glm::vec3(0.0f, 1.0f, 0.0f));
-			glm::mat4 directionalLightViewProjMatrix = directionalLightProjection * directionalLightView;
+			// The cache mirrors the live cascades, so it is reallocated along with them
+			bool cacheCascades = useShadowCaching && !m_CustomDirectionalLightShadowCascades;
+			if (cacheCascades && (!m_StaticDirectionalShadowCascades || m_StaticDirectionalShadowCascades->GetWidth() != shadowCascades->GetWidth() ||
+				m_StaticDirectionalShadowCascades->GetHeight() != shadowCascades->GetHeight() || m_StaticDirectionalShadowCascades->GetLayerCount() != shadowCascades->GetLayerCount()))
+			{
+				delete m_StaticDirectionalShadowCascades;
+				m_StaticDirectionalShadowCascades = new Texture();
+				LightManager::GenerateShadowCascadeTexture(*m_StaticDirectionalShadowCascades, glm::uvec2(shadowCascades->GetWidth(), shadowCascades->GetHeight()), static_cast<int>(shadowCascades->GetLayerCount()));
+				std::fill(std::begin(m_DirectionalLightCacheEntries), std::end(m_DirectionalLightCacheEntries), ShadowCacheEntry());
+			}
 
 			m_GLCache->SetDepthTest(true);
 			m_GLCache->SetBlend(false);
 			m_GLCache->SetFaceCull(false); // For one sided objects - TODO: This will get overwritten by the renderer anyways
 
-			// Setup model renderer
-			if (renderOnlyStatic)
+			m_EmptyFramebuffer.Bind();
+			glViewport(0, 0, shadowCascades->GetWidth(), shadowCascades->GetHeight());
+			float sliceNear = cascadeNearPlane;
+			for (int i = 0; i < cascadeCount; i++)
 			{
-				m_ActiveScene->AddModelsToRenderer(ModelFilterType::StaticModels);
-			}
-			else
-			{
-				m_ActiveScene->AddModelsToRenderer(ModelFilterType::AllModels);
-			}
-
-			// Render skinned models
-			{
-				m_GLCache->SetShader(m_ShadowmapSkinnedShader);
-				m_ShadowmapSkinnedShader->SetUniform("lightSpaceViewProjectionMatrix", directionalLightViewProjMatrix);
-				Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-				Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-			}
+				glm::mat4 cascadeViewProjMatrix = ComputeCascadeViewProjection(frustumCorners, camera->GetNearPlane(), camera->GetFarPlane(), sliceNear, splitDepths[i], lightDir, shadowCascades->GetWidth());
+				sliceNear = splitDepths[i];
 
-			// Render non-skinned models
-			{
-				m_GLCache->SetShader(m_ShadowmapShader);
-				m_ShadowmapShader->SetUniform("lightSpaceViewProjectionMatrix", directionalLightViewProjMatrix);
-				Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-				Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-			}
+				Renderer::BeginShadowCascade(i);
+				ShadowCacheEntry &cacheEntry = m_DirectionalLightCacheEntries[i];
+				if (cacheCascades)
+				{
+					ShadowCacheKey cacheKey = { lightManager->GetDirectionalLightShadowCaster(), shadowCascades->GetTextureId(), glm::uvec4(0, 0, shadowCascades->GetWidth(), shadowCascades->GetHeight()), cascadeViewProjMatrix, staticGeometryVersion };
+					bool canLag = i >= SHADOW_CASCADE_FULL_RATE_COUNT && CanShadowTargetLag(m_FrameIndex, i);
+					ShadowCacheAction action = GetShadowCacheAction(cacheEntry, cacheKey, canLag);
+					if (action == ShadowCacheAction::Keep)
+					{
+						// Left as it was, it has to be sampled with the view projection it was rendered with
+						cascadeViewProjMatrix = cacheEntry.Live.ViewProjection;
+					}
+					else if (action == ShadowCacheAction::RenderDirect)
+					{
+						m_EmptyFramebuffer.SetDepthAttachmentLayer(DepthStencilAttachmentFormat::NormalizedDepthOnly, shadowCascades->GetTextureId(), i);
+						m_EmptyFramebuffer.ClearDepth();
+						RenderShadowCasters(camera, cascadeViewProjMatrix, ModelFilterType::AllModels);
+						cacheEntry.Live = cacheKey;
+					}
+					else
+					{
+						if (action == ShadowCacheAction::RenderStatic)
+						{
+							m_EmptyFramebuffer.SetDepthAttachmentLayer(DepthStencilAttachmentFormat::NormalizedDepthOnly, m_StaticDirectionalShadowCascades->GetTextureId(), i);
+							m_EmptyFramebuffer.ClearDepth();
+							RenderShadowCasters(camera, cascadeViewProjMatrix, ModelFilterType::StaticModels);
+							cacheEntry.Static = cacheKey;
+						}
+						glCopyImageSubData(m_StaticDirectionalShadowCascades->GetTextureId(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, shadowCascades->GetTextureId(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+							shadowCascades->GetWidth(), shadowCascades->GetHeight(), 1);
+
+						m_EmptyFramebuffer.SetDepthAttachmentLayer(DepthStencilAttachmentFormat::NormalizedDepthOnly, shadowCascades->GetTextureId(), i);
+						RenderShadowCasters(camera, cascadeViewProjMatrix, ModelFilterType::DynamicModels);
+						cacheEntry.Live = cacheKey;
+					}
+				}
+				else
+				{
+					m_EmptyFramebuffer.SetDepthAttachmentLayer(DepthStencilAttachmentFormat::NormalizedDepthOnly, shadowCascades->GetTextureId(), i);
+					m_EmptyFramebuffer.ClearDepth();
+					RenderShadowCasters(camera, cascadeViewProjMatrix, uncachedFilter);
+					cacheEntry = ShadowCacheEntry();
+				}
+				Renderer::EndShadowCascade();
 
-			// Render terrain
-			Terrain* terrain = m_ActiveScene->GetTerrain();
-			if (terrain)
-			{
-				terrain->Draw(m_ShadowmapShader, RenderPassType::NoMaterialRequired);
+				passOutput.directionalLightCascadeViewProjMatrices[i] = cascadeViewProjMatrix;
+				passOutput.directionalLightCascadeSplitDepths[i] = splitDepths[i];
 			}
+			// Reset state
+			m_EmptyFramebuffer.SetDepthAttachmentLayer(DepthStencilAttachmentFormat::NormalizedDepthOnly, 0, 0);
 
 			// Update output
-			passOutput.directionalLightViewProjMatrix = directionalLightViewProjMatrix;
+			passOutput.hasDirectionalLightShadows = true;
+			passOutput.directionalLightCascadeCount = cascadeCount;
 			passOutput.directionalShadowmapBias = lightManager->GetDirectionalLightShadowCasterBias();
-			passOutput.directionalShadowmapFramebuffer = shadowFramebuffer;
 		}
+		passOutput.directionalShadowmapCascades = shadowCascades; // Has to be bound even if it isn't used, the shaders sample it as an array
 		ARC_POP_RENDER_TAG();
 
 		// Spot Light Shadow Setup
 		ARC_PUSH_RENDER_TAG("Spotlight Shadows");
-		if (m_CustomSpotLightShadowFramebuffer)
+		if (m_CustomSpotLightShadowAtlasFramebuffer)
 		{
-			shadowFramebuffer = m_CustomSpotLightShadowFramebuffer;
+			shadowFramebuffer = m_CustomSpotLightShadowAtlasFramebuffer;
 		}
 		else
 		{
-			shadowFramebuffer = lightManager->GetSpotLightShadowCasterFramebuffer();
+			shadowFramebuffer = lightManager->GetSpotLightShadowAtlasFramebuffer();
 		}
-		glViewport(0, 0, shadowFramebuffer->GetWidth(), shadowFramebuffer->GetHeight());
-		shadowFramebuffer->Bind();
-		shadowFramebuffer->ClearDepth();
 
-		// Spot Light Shadows
-		if (lightManager->HasSpotLightShadowCaster())
+		// With caching every tile is either left alone or has the cache copied over it, so only the uncached atlas needs clearing
+		bool cacheSpotLights = useShadowCaching && !m_CustomSpotLightShadowAtlasFramebuffer;
+		if (cacheSpotLights && !m_StaticSpotLightShadowAtlasFramebuffer)
 		{
-			// Setup
-			glm::vec2 nearFarPlane = lightManager->GetSpotLightShadowCasterNearFarPlane();
+			m_StaticSpotLightShadowAtlasFramebuffer = new Framebuffer(shadowFramebuffer->GetWidth(), shadowFramebuffer->GetHeight(), false);
+			m_StaticSpotLightShadowAtlasFramebuffer->AddDepthStencilTexture(NormalizedDepthOnly, true).CreateFramebuffer();
+		}
+		shadowFramebuffer->Bind();
+		if (!cacheSpotLights)
+		{
+			shadowFramebuffer->ClearDepth();
+		}
+		m_SpotLightCacheEntries.swap(m_SpotLightCacheEntriesScratch);
+		m_SpotLightCacheEntries.clear();
+
+		// Spot Light Shadows, each light renders into its own tile of the atlas. Tiles are placed in atlas texture coordinates so a custom atlas of any resolution works
+		const std::vector<ShadowAtlasTile> &spotLightTiles = lightManager->GetSpotLightShadowTiles();
+		const ShadowAtlas &spotLightShadowAtlas = lightManager->GetSpotLightShadowAtlas();
+		m_GLCache->SetDepthTest(true);
+		m_GLCache->SetBlend(false);
+		m_GLCache->SetFaceCull(false); // For one sided objects - TODO: This will get overwritten by the renderer anyways
+		for (size_t i = 0; i < spotLightTiles.size(); i++)
+		{
+			const ShadowAtlasTile &tile = spotLightTiles[i];
+			glm::vec4 atlasRect = spotLightShadowAtlas.GetUVRect(tile);
+			glm::uvec4 tileRegion(static_cast<unsigned int>(atlasRect.x * shadowFramebuffer->GetWidth()), static_cast<unsigned int>(atlasRect.y * shadowFramebuffer->GetHeight()),
+				static_cast<unsigned int>(atlasRect.z * shadowFramebuffer->GetWidth()), static_cast<unsigned int>(atlasRect.w * shadowFramebuffer->GetHeight()));
+			glViewport(tileRegion.x, tileRegion.y, tileRegion.z, tileRegion.w);
 
 			// View + Projection setup
-			float outerAngleRadians = lightManager->GetSpotLightShadowCasterOuterCutOffAngle();
-			float radius = lightManager->GetSpotLightShadowCasterAttenuationRange() * glm::tan(outerAngleRadians); // Need to get spotlight's radius given it's range and angle so we can use it for the projection bounds
-			glm::mat4 spotLightProjection = glm::ortho(-radius, radius, -radius, radius, nearFarPlane.x, nearFarPlane.y);
-			glm::vec3 spotLightPos = lightManager->GetSpotLightShadowCasterLightPosition();
-			glm::mat4 spotLightView = glm::lookAt(spotLightPos, spotLightPos + lightManager->GetSpotLightShadowCasterLightDir(), glm::vec3(0.0f, 1.0f, 0.0f));
+			float outerAngleRadians = glm::acos(tile.Light->OuterCutOff);
+			float radius = tile.Light->AttenuationRange * glm::tan(outerAngleRadians); // Need to get spotlight's radius given it's range and angle so we can use it for the projection bounds
+			glm::mat4 spotLightProjection = glm::ortho(-radius, radius, -radius, radius, tile.Light->ShadowNearPlane, tile.Light->ShadowFarPlane);
+			glm::vec3 spotLightPos = tile.Transform->Translation;
+			glm::mat4 spotLightView = glm::lookAt(spotLightPos, spotLightPos + tile.Transform->GetForward(), glm::vec3(0.0f, 1.0f, 0.0f));
 			glm::mat4 spotLightViewProjMatrix = spotLightProjection * spotLightView;
 
-			m_GLCache->SetDepthTest(true);
-			m_GLCache->SetBlend(false);
-			m_GLCache->SetFaceCull(false); // For one sided objects - TODO: This will get overwritten by the renderer anyways
-
-			// Setup model renderer
-			if (renderOnlyStatic)
-			{
-				m_ActiveScene->AddModelsToRenderer(ModelFilterType::StaticModels);
-			}
-			else
-			{
-				m_ActiveScene->AddModelsToRenderer(ModelFilterType::AllModels);
-			}
-
-			// Render skinned models
+			if (cacheSpotLights)
 			{
-				m_GLCache->SetShader(m_ShadowmapSkinnedShader);
-				m_ShadowmapSkinnedShader->SetUniform("lightSpaceViewProjectionMatrix", spotLightViewProjMatrix);
-				Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-				Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-			}
+				// Entries follow the lights from frame to frame, a light's tile can move around the atlas as its importance changes
+				ShadowCacheEntry cacheEntry;
+				auto previousEntry = std::find_if(m_SpotLightCacheEntriesScratch.begin(), m_SpotLightCacheEntriesScratch.end(), [&tile](const ShadowCacheEntry &entry) { return entry.Live.Light == tile.Light; });
+				if (previousEntry != m_SpotLightCacheEntriesScratch.end())
+				{
+					cacheEntry = *previousEntry;
+				}
 
-			// Render non-skinned models
-			{
-				m_GLCache->SetShader(m_ShadowmapShader);
-				m_ShadowmapShader->SetUniform("lightSpaceViewProjectionMatrix", spotLightViewProjMatrix);
-				Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-				Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+				Texture *liveAtlas = shadowFramebuffer->GetDepthStencilTexture();
+				Texture *staticAtlas = m_StaticSpotLightShadowAtlasFramebuffer->GetDepthStencilTexture();
+				ShadowCacheKey cacheKey = { tile.Light, liveAtlas->GetTextureId(), tileRegion, spotLightViewProjMatrix, staticGeometryVersion };
+				bool canLag = tile.Importance < SHADOW_ATLAS_FULL_RATE_IMPORTANCE && CanShadowTargetLag(m_FrameIndex, tile.LightIndex);
+				ShadowCacheAction action = GetShadowCacheAction(cacheEntry, cacheKey, canLag);
+				if (action == ShadowCacheAction::Keep)
+				{
+					spotLightViewProjMatrix = cacheEntry.Live.ViewProjection;
+				}
+				else if (action == ShadowCacheAction::RenderDirect)
+				{
+					// GLCache doesn't track the scissor test, it is only ever enabled around the tile clears
+					glEnable(GL_SCISSOR_TEST);
+					glScissor(tileRegion.x, tileRegion.y, tileRegion.z, tileRegion.w);
+					shadowFramebuffer->ClearDepth();
+					glDisable(GL_SCISSOR_TEST);
+					RenderShadowCasters(camera, spotLightViewProjMatrix, ModelFilterType::AllModels);
+					cacheEntry.Live = cacheKey;
+				}
+				else
+				{
+					if (action == ShadowCacheAction::RenderStatic)
+					{
+						m_StaticSpotLightShadowAtlasFramebuffer->Bind();
+						glEnable(GL_SCISSOR_TEST);
+						glScissor(tileRegion.x, tileRegion.y, tileRegion.z, tileRegion.w);
+						m_StaticSpotLightShadowAtlasFramebuffer->ClearDepth();
+						glDisable(GL_SCISSOR_TEST);
+						RenderShadowCasters(camera, spotLightViewProjMatrix, ModelFilterType::StaticModels);
+						cacheEntry.Static = cacheKey;
+					}
+					glCopyImageSubData(staticAtlas->GetTextureId(), GL_TEXTURE_2D, 0, tileRegion.x, tileRegion.y, 0, liveAtlas->GetTextureId(), GL_TEXTURE_2D, 0, tileRegion.x, tileRegion.y, 0,
+						tileRegion.z, tileRegion.w, 1);
+
+					shadowFramebuffer->Bind();
+					RenderShadowCasters(camera, spotLightViewProjMatrix, ModelFilterType::DynamicModels);
+					cacheEntry.Live = cacheKey;
+				}
+				m_SpotLightCacheEntries.push_back(cacheEntry);
 			}
-
-			// Render terrain
-			Terrain* terrain = m_ActiveScene->GetTerrain();
-			if (terrain)
+			else
 			{
-				terrain->Draw(m_ShadowmapShader, RenderPassType::NoMaterialRequired);
+				RenderShadowCasters(camera, spotLightViewProjMatrix, uncachedFilter);
 			}
 
 			// Update output
-			passOutput.spotLightViewProjMatrix = spotLightViewProjMatrix;
-			passOutput.spotLightShadowmapBias = lightManager->GetSpotLightShadowCasterBias();
-			passOutput.spotLightShadowmapFramebuffer = shadowFramebuffer;
+			passOutput.spotLightViewProjMatrices[i] = spotLightViewProjMatrix;
+			passOutput.spotLightShadowAtlasRects[i] = atlasRect;
+			passOutput.spotLightShadowmapBiases[i] = tile.Light->ShadowBias;
 		}
+		passOutput.spotLightShadowCount = static_cast<int>(spotLightTiles.size());
+		passOutput.spotLightShadowAtlasFramebuffer = shadowFramebuffer;
 		ARC_POP_RENDER_TAG();
 
 		// Point Light Shadow Setup
@@ -206,69 +537,58 @@ namespace Arcane
 		if (lightManager->HasPointlightShadowCaster())
 		{
 			// Setup
-			Terrain* terrain = m_ActiveScene->GetTerrain();
 			glm::vec2 nearFarPlane = lightManager->GetPointLightShadowCasterNearFarPlane();
 
 			// Camera Setup
 			m_CubemapCamera.SetPosition(lightManager->GetPointLightShadowCasterLightPosition());
 			m_CubemapCamera.SetNearFarPlane(nearFarPlane.x, nearFarPlane.y);
-			glm::mat4 pointLightProjection = m_CubemapCamera.GetProjectionMatrix();
 
 			m_GLCache->SetDepthTest(true);
 			m_GLCache->SetBlend(false);
 			m_GLCache->SetFaceCull(false); // For one sided objects - TODO: This will get overwritten by the renderer anyways
 
-			// Render the scene to the probe's cubemap
+			// Render the scene to the light's cubemap
 			glViewport(0, 0, pointLightShadowCubemap->GetFaceWidth(), pointLightShadowCubemap->GetFaceHeight());
-			for (int i = 0; i < 6; i++)
+			Renderer::BeginPointShadows();
+			bool cachePointLight = useShadowCaching && !m_CustomPointLightShadowCubemap;
+			if (cachePointLight)
 			{
-				// Setup the camera's view
-				m_CubemapCamera.SwitchCameraToFace(i);
-				glm::mat4 pointLightView = m_CubemapCamera.GetViewMatrix();
-				glm::mat4 pointLightViewProjMatrix = pointLightProjection * pointLightView;
-
-				m_EmptyFramebuffer.SetDepthAttachment(DepthStencilAttachmentFormat::NormalizedDepthOnly, pointLightShadowCubemap->GetCubemapID(), GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
-				m_EmptyFramebuffer.ClearDepth();
-
-				// Setup model renderer
-				if (renderOnlyStatic)
-				{
-					m_ActiveScene->AddModelsToRenderer(ModelFilterType::StaticModels);
-				}
-				else
+				if (!m_StaticPointLightShadowCubemap || m_StaticPointLightShadowCubemap->GetFaceWidth() != pointLightShadowCubemap->GetFaceWidth() || m_StaticPointLightShadowCubemap->GetFaceHeight() != pointLightShadowCubemap->GetFaceHeight())
 				{
-					m_ActiveScene->AddModelsToRenderer(ModelFilterType::AllModels);
+					delete m_StaticPointLightShadowCubemap;
+					m_StaticPointLightShadowCubemap = LightManager::CreateShadowCubemap(glm::uvec2(pointLightShadowCubemap->GetFaceWidth(), pointLightShadowCubemap->GetFaceHeight()));
+					m_PointLightCacheEntry = ShadowCacheEntry();
 				}
 
-				// Render skinned models
+				// Every face shares the projection and the light's position, so together they stand in for all six view projections
+				glm::mat4 pointLightViewProjMatrix = glm::translate(m_CubemapCamera.GetProjectionMatrix(), -m_CubemapCamera.GetPosition());
+				glm::uvec4 faceRegion(0, 0, pointLightShadowCubemap->GetFaceWidth(), pointLightShadowCubemap->GetFaceHeight());
+				ShadowCacheKey cacheKey = { lightManager->GetPointLightShadowCaster(), pointLightShadowCubemap->GetCubemapID(), faceRegion, pointLightViewProjMatrix, staticGeometryVersion };
+				ShadowCacheAction action = GetShadowCacheAction(m_PointLightCacheEntry, cacheKey, false);
+				if (action == ShadowCacheAction::RenderDirect)
 				{
-					m_GLCache->SetShader(m_ShadowmapLinearSkinnedShader);
-					m_ShadowmapLinearSkinnedShader->SetUniform("lightPos", m_CubemapCamera.GetPosition());
-					m_ShadowmapLinearSkinnedShader->SetUniform("lightFarPlane", nearFarPlane.y);
-					m_ShadowmapLinearSkinnedShader->SetUniform("lightSpaceViewProjectionMatrix", pointLightViewProjMatrix);
-					Renderer::FlushOpaqueSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-					Renderer::FlushTransparentSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearSkinnedShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
+					RenderPointShadowCasters(camera, pointLightShadowCubemap, nearFarPlane.y, ModelFilterType::AllModels, true);
 				}
-
-				// Render non-skinned models
-				{
-					m_GLCache->SetShader(m_ShadowmapLinearShader);
-					m_ShadowmapLinearShader->SetUniform("lightPos", m_CubemapCamera.GetPosition());
-					m_ShadowmapLinearShader->SetUniform("lightFarPlane", nearFarPlane.y);
-					m_ShadowmapLinearShader->SetUniform("lightSpaceViewProjectionMatrix", pointLightViewProjMatrix);
-					Renderer::FlushOpaqueNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-					Renderer::FlushTransparentNonSkinnedMeshes(camera, RenderPassType::NoMaterialRequired, m_ShadowmapLinearShader); // TODO: This should not use the camera's position for sorting we are rendering shadow maps for lights
-				}
-
-				// Render terrain
-				Terrain* terrain = m_ActiveScene->GetTerrain();
-				if (terrain)
+				else
 				{
-					terrain->Draw(m_ShadowmapLinearShader, RenderPassType::NoMaterialRequired);
+					if (action == ShadowCacheAction::RenderStatic)
+					{
+						RenderPointShadowCasters(camera, m_StaticPointLightShadowCubemap, nearFarPlane.y, ModelFilterType::StaticModels, true);
+						m_PointLightCacheEntry.Static = cacheKey;
+					}
+					glCopyImageSubData(m_StaticPointLightShadowCubemap->GetCubemapID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0, pointLightShadowCubemap->GetCubemapID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0,
+						faceRegion.z, faceRegion.w, 6);
+
+					RenderPointShadowCasters(camera, pointLightShadowCubemap, nearFarPlane.y, ModelFilterType::DynamicModels, false);
 				}
+				m_PointLightCacheEntry.Live = cacheKey;
 			}
-			// Reset state
-			m_EmptyFramebuffer.SetDepthAttachment(DepthStencilAttachmentFormat::NormalizedDepthOnly, 0, GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+			else
+			{
+				RenderPointShadowCasters(camera, pointLightShadowCubemap, nearFarPlane.y, uncachedFilter, true);
+				m_PointLightCacheEntry = ShadowCacheEntry();
+			}
+			Renderer::EndPointShadows();
 
 			// Update output
 			passOutput.hasPointLightShadows = true;
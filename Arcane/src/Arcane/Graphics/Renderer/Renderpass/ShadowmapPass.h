@@ -17,29 +17,77 @@
 namespace Arcane
 {
 	class Cubemap;
+	class Texture;
 	class ICamera;
 	class Scene;
 	class Shader;
 	class Framebuffer;
+	struct LightComponent;
+	enum class ModelFilterType;
+
+	// What a shadow target (a cascade, an atlas tile, or a point light's cubemap) was last rendered with
+	struct ShadowCacheKey
+	{
+		const void *Light = nullptr; // nullptr when the target holds nothing worth keeping
+		unsigned int TargetID = 0; // The live texture, the light manager reallocating it throws away what was rendered
+		glm::uvec4 Region = glm::uvec4(0); // Offset and size in texels
+		glm::mat4 ViewProjection = glm::mat4(1.0f);
+		u64 StaticGeometryVersion = 0;
+	};
+
+	// The static cache holds only the static casters and can be copied over the live target for as long as its key matches. The live target holds everything,
+	// targets updated at a reduced frequency are left alone while the light and static casters are the same even if the view projection has moved on.
+	// The cache is only filled once a view projection has held for a frame, targets that follow a moving camera would otherwise refill it every frame
+	struct ShadowCacheEntry
+	{
+		ShadowCacheKey Static;
+		ShadowCacheKey Live;
+	};
+
+	enum class ShadowCacheAction
+	{
+		Keep, // Live target is reused as is, along with the view projection it was rendered with
+		CopyStatic, // Cached static depth is copied in and the dynamic casters are drawn on top
+		RenderStatic, // Static casters are rendered into the cache first
+		RenderDirect // The view projection is still changing, every caster is drawn straight into the live target and the cache is left alone
+	};
 
 	class ShadowmapPass : public RenderPass {
 	public:
 		ShadowmapPass(Scene *scene);
-		ShadowmapPass(Scene *scene, Framebuffer *customDirectionalLightShadowFramebuffer, Framebuffer *customSpotLightShadowFramebuffer, Cubemap *customPointLightShadowCubemap);
+		ShadowmapPass(Scene *scene, Texture *customDirectionalLightShadowCascades, Framebuffer *customSpotLightShadowAtlasFramebuffer, Cubemap *customPointLightShadowCubemap);
 		virtual ~ShadowmapPass() override;
 
 		ShadowmapPassOutput GenerateShadowmaps(ICamera *camera, bool renderOnlyStatic);
 	private:
 		void Init();
+		void RenderShadowCasters(ICamera *camera, const glm::mat4 &lightViewProjMatrix, ModelFilterType filter); // Culls to the light's frustum and draws everything with the non linear depth shaders
+		void RenderPointShadowCasters(ICamera *camera, Cubemap *shadowCubemap, float farPlane, ModelFilterType filter, bool clearDepth);
+		void RenderPointShadowCastersPerFace(ICamera *camera, Cubemap *shadowCubemap, float farPlane, ModelFilterType filter, bool clearDepth); // Culls, queues and draws the scene once for each face
+		void RenderPointShadowCastersLayered(ICamera *camera, Cubemap *shadowCubemap, float farPlane, ModelFilterType filter, bool clearDepth); // Queues every model once and draws all the faces in one pass
+
+		// Terrain counts as a static caster, so it is only drawn with filters that let static models through
+		static bool FilterIncludesStaticCasters(ModelFilterType filter);
 	private:
-		Shader *m_ShadowmapShader, *m_ShadowmapSkinnedShader, *m_ShadowmapLinearShader, *m_ShadowmapLinearSkinnedShader;
+		Shader *m_ShadowmapShader, *m_ShadowmapSkinnedShader, *m_ShadowmapInstancedShader, *m_ShadowmapLinearShader, *m_ShadowmapLinearSkinnedShader, *m_ShadowmapLinearInstancedShader;
+		Shader *m_ShadowmapCubemapShader, *m_ShadowmapCubemapSkinnedShader, *m_ShadowmapCubemapInstancedShader;
 		CubemapCamera m_CubemapCamera;
-		Framebuffer m_EmptyFramebuffer; // Used for attaching to when rendering (like cubemap faces)
+		Framebuffer m_EmptyFramebuffer; // Used for attaching to when rendering (like cubemap faces and cascades)
 
 		// Option to use custom shadow framebuffers/cubemaps. Most will go through the light manager and request the specified resolutions for normal rendering
-		Framebuffer *m_CustomDirectionalLightShadowFramebuffer = nullptr;
-		Framebuffer *m_CustomSpotLightShadowFramebuffer = nullptr;
+		Texture *m_CustomDirectionalLightShadowCascades = nullptr;
+		Framebuffer *m_CustomSpotLightShadowAtlasFramebuffer = nullptr;
 		Cubemap *m_CustomPointLightShadowCubemap = nullptr;
+
+		// Static shadow caches, only used with the light manager's targets since the custom ones are for one off captures that only draw static casters anyway.
+		// They are allocated the first time they are needed and follow the size of the live targets
+		Texture *m_StaticDirectionalShadowCascades = nullptr;
+		Framebuffer *m_StaticSpotLightShadowAtlasFramebuffer = nullptr;
+		Cubemap *m_StaticPointLightShadowCubemap = nullptr;
+		ShadowCacheEntry m_DirectionalLightCacheEntries[SHADOW_CASCADE_MAX_COUNT];
+		std::vector<ShadowCacheEntry> m_SpotLightCacheEntries, m_SpotLightCacheEntriesScratch; // One per atlas tile, lights without a tile this frame lose theirs since another tile may overwrite it
+		ShadowCacheEntry m_PointLightCacheEntry;
+		u64 m_FrameIndex = 0; // Staggers the targets that update at a reduced frequency
 	};
 }
 #endif
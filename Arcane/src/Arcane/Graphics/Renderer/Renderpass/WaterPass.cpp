@@ -133,6 +133,7 @@ namespace Arcane
 
 			// Finally render the water geometry and shade it
 			ARC_PUSH_RENDER_TAG("Water");
+			lightManager->BindLightingUniforms(camera); // Before the water shader is bound, rebuilding the light clusters binds the clustering compute shader
 			m_GLCache->SetShader(m_WaterShader);
 			inputFramebuffer->Bind();
 			glViewport(0, 0, inputFramebuffer->GetWidth(), inputFramebuffer->GetHeight());
@@ -157,14 +158,9 @@ namespace Arcane
 			waterComponent.MoveTimer = static_cast<float>(m_EffectsTimer.Elapsed() * waterComponent.WaveSpeed);
 			waterComponent.MoveTimer = static_cast<float>(std::fmod((double)waterComponent.MoveTimer, 1.0));
 
-			lightManager->BindLightingUniforms(m_WaterShader);
-			m_WaterShader->SetUniform("view", camera->GetViewMatrix());
-			m_WaterShader->SetUniform("projection", camera->GetProjectionMatrix());
-			m_WaterShader->SetUniform("viewInverse", glm::inverse(camera->GetViewMatrix()));
-			m_WaterShader->SetUniform("projectionInverse", glm::inverse(camera->GetProjectionMatrix()));
+			Renderer::BindCameraUniforms(camera);
 			m_WaterShader->SetUniform("clearWater", waterComponent.ClearWater);
 			m_WaterShader->SetUniform("shouldShine", waterComponent.EnableShine);
-			m_WaterShader->SetUniform("viewPos", camera->GetPosition());
 			m_WaterShader->SetUniform("waterAlbedo", waterComponent.WaterAlbedo);
 			m_WaterShader->SetUniform("albedoPower", waterComponent.AlbedoPower);
 			m_WaterShader->SetUniform("model", model);
@@ -2,21 +2,45 @@
 #include "Shader.h"
 
 #include <Arcane/Util/Loaders/ShaderLoader.h>
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
 #include <Arcane/Util/FileUtils.h>
+#include <Arcane/Util/Timer.h>
 
 namespace Arcane
 {
-	Shader::Shader(const std::string &path) : m_ShaderFilePath(path) {
+	static constexpr u32 ProgramBinaryMagic = 0x50435241; // "ARCP"
+	static constexpr u32 ProgramBinaryVersion = 1;
+
+	struct ProgramBinaryHeader
+	{
+		u32 Magic;
+		GLenum BinaryFormat;
+		u64 CacheKey;
+		u64 BinarySize;
+	};
+
+	u32 Shader::s_UniformUploadCount = 0;
+	u32 Shader::s_UniformUploadsSkippedCount = 0;
+
+	Shader::Shader(const std::string &path, const ShaderDefines &defines) : m_ShaderFilePath(path), m_DebugName(path) {
+		if (!defines.IsEmpty()) {
+			m_DebugName += " [" + defines.ToString() + "]";
+		}
+
 		std::string shaderBinary = FileUtils::ReadFile(m_ShaderFilePath);
-		auto shaderSources = PreProcessShaderBinary(shaderBinary);
+		auto shaderSources = PreProcessShaderBinary(shaderBinary, defines);
 		Compile(shaderSources);
 	}
 
 	Shader::~Shader() {
+		for (GLuint stage : m_PendingStages) {
+			glDeleteShader(stage);
+		}
 		glDeleteProgram(m_ShaderID);
 	}
 
 	void Shader::Enable() const {
+		WaitForCompile();
 		glUseProgram(m_ShaderID);
 	}
 
@@ -24,88 +48,282 @@ namespace Arcane
 		glUseProgram(0);
 	}
 
-	void Shader::SetUniform(const char* name, float value) {
-		glUniform1f(GetUniformLocation(name), value);
+	void Shader::SetUniform(UniformHandle handle, float value) {
+		if (ShouldUpload(handle, &value, sizeof(value))) {
+			glUniform1f(handle.Location, value);
+		}
 	}
 
-	void Shader::SetUniform(const char* name, int value) {
-		glUniform1i(GetUniformLocation(name), value);
+	void Shader::SetUniform(UniformHandle handle, int value) {
+		if (ShouldUpload(handle, &value, sizeof(value))) {
+			glUniform1i(handle.Location, value);
+		}
 	}
 
-	void Shader::SetUniform(const char* name, const glm::vec2& vector) {
-		glUniform2f(GetUniformLocation(name), vector.x, vector.y);
+	void Shader::SetUniform(UniformHandle handle, const glm::vec2& vector) {
+		if (ShouldUpload(handle, &vector, sizeof(vector))) {
+			glUniform2f(handle.Location, vector.x, vector.y);
+		}
 	}
 
-	void Shader::SetUniform(const char *name, const glm::ivec2& vector) {
-		glUniform2i(GetUniformLocation(name), vector.x, vector.y);
+	void Shader::SetUniform(UniformHandle handle, const glm::ivec2& vector) {
+		if (ShouldUpload(handle, &vector, sizeof(vector))) {
+			glUniform2i(handle.Location, vector.x, vector.y);
+		}
 	}
 
-	void Shader::SetUniform(const char* name, const glm::vec3& vector) {
-		glUniform3f(GetUniformLocation(name), vector.x, vector.y, vector.z);
+	void Shader::SetUniform(UniformHandle handle, const glm::vec3& vector) {
+		if (ShouldUpload(handle, &vector, sizeof(vector))) {
+			glUniform3f(handle.Location, vector.x, vector.y, vector.z);
+		}
 	}
 
-	void Shader::SetUniform(const char *name, const glm::ivec3& vector) {
-		glUniform3i(GetUniformLocation(name), vector.x, vector.y, vector.z);
+	void Shader::SetUniform(UniformHandle handle, const glm::ivec3& vector) {
+		if (ShouldUpload(handle, &vector, sizeof(vector))) {
+			glUniform3i(handle.Location, vector.x, vector.y, vector.z);
+		}
 	}
 
-	void Shader::SetUniform(const char* name, const glm::vec4& vector) {
-		glUniform4f(GetUniformLocation(name), vector.x, vector.y, vector.z, vector.w);
+	void Shader::SetUniform(UniformHandle handle, const glm::vec4& vector) {
+		if (ShouldUpload(handle, &vector, sizeof(vector))) {
+			glUniform4f(handle.Location, vector.x, vector.y, vector.z, vector.w);
+		}
 	}
 
-	void Shader::SetUniform(const char* name, const glm::ivec4& vector) {
-		glUniform4i(GetUniformLocation(name), vector.x, vector.y, vector.z, vector.w);
+	void Shader::SetUniform(UniformHandle handle, const glm::ivec4& vector) {
+		if (ShouldUpload(handle, &vector, sizeof(vector))) {
+			glUniform4i(handle.Location, vector.x, vector.y, vector.z, vector.w);
+		}
 	}
 
-	void Shader::SetUniform(const char* name, const glm::mat3& matrix) {
-		glUniformMatrix3fv(glGetUniformLocation(m_ShaderID, name), 1, GL_FALSE, glm::value_ptr(matrix));
+	void Shader::SetUniform(UniformHandle handle, const glm::mat3& matrix) {
+		if (ShouldUpload(handle, &matrix, sizeof(matrix))) {
+			glUniformMatrix3fv(handle.Location, 1, GL_FALSE, glm::value_ptr(matrix));
+		}
 	}
 
-	void Shader::SetUniform(const char* name, const glm::mat4& matrix) {
-		glUniformMatrix4fv(glGetUniformLocation(m_ShaderID, name), 1, GL_FALSE, glm::value_ptr(matrix));
+	void Shader::SetUniform(UniformHandle handle, const glm::mat4& matrix) {
+		if (ShouldUpload(handle, &matrix, sizeof(matrix))) {
+			glUniformMatrix4fv(handle.Location, 1, GL_FALSE, glm::value_ptr(matrix));
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const float *value) {
-		glUniform1fv(glGetUniformLocation(m_ShaderID, name), arraySize, value);
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const float *value) {
+		if (ShouldUpload(handle, value, sizeof(float) * arraySize)) {
+			glUniform1fv(handle.Location, arraySize, value);
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const int *value) {
-		glUniform1iv(glGetUniformLocation(m_ShaderID, name), arraySize, value);
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const int *value) {
+		if (ShouldUpload(handle, value, sizeof(int) * arraySize)) {
+			glUniform1iv(handle.Location, arraySize, value);
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::vec2 *value) {
-		glUniform2fv(glGetUniformLocation(m_ShaderID, name), arraySize, glm::value_ptr(*value));
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::vec2 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::vec2) * arraySize)) {
+			glUniform2fv(handle.Location, arraySize, glm::value_ptr(*value));
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::ivec2 *value) {
-		glUniform2iv(glGetUniformLocation(m_ShaderID, name), arraySize, glm::value_ptr(*value));
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::ivec2 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::ivec2) * arraySize)) {
+			glUniform2iv(handle.Location, arraySize, glm::value_ptr(*value));
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::vec3 *value) {
-		glUniform3fv(glGetUniformLocation(m_ShaderID, name), arraySize, glm::value_ptr(*value));
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::vec3 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::vec3) * arraySize)) {
+			glUniform3fv(handle.Location, arraySize, glm::value_ptr(*value));
+		}
+	}
+
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::ivec3 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::ivec3) * arraySize)) {
+			glUniform3iv(handle.Location, arraySize, glm::value_ptr(*value));
+		}
+	}
+
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::vec4 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::vec4) * arraySize)) {
+			glUniform4fv(handle.Location, arraySize, glm::value_ptr(*value));
+		}
+	}
+
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::ivec4 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::ivec4) * arraySize)) {
+			glUniform4iv(handle.Location, arraySize, glm::value_ptr(*value));
+		}
+	}
+
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::mat3 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::mat3) * arraySize)) {
+			glUniformMatrix3fv(handle.Location, arraySize, GL_FALSE, glm::value_ptr(*value));
+		}
+	}
+
+	void Shader::SetUniformArray(UniformHandle handle, int arraySize, const glm::mat4 *value) {
+		if (ShouldUpload(handle, value, sizeof(glm::mat4) * arraySize)) {
+			glUniformMatrix4fv(handle.Location, arraySize, GL_FALSE, glm::value_ptr(*value));
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::ivec3 *value) {
-		glUniform3iv(glGetUniformLocation(m_ShaderID, name), arraySize, glm::value_ptr(*value));
+	UniformHandle Shader::GetUniformHandle(const char *name) const {
+		WaitForCompile();
+
+		UniformHandle handle;
+		if (m_UniformLookup.empty()) {
+			return handle;
+		}
+
+		u64 hash = HashUniformName(name);
+		size_t mask = m_UniformLookup.size() - 1;
+		for (size_t slot = hash & mask; m_UniformLookup[slot] != -1; slot = (slot + 1) & mask) {
+			const ReflectedUniform &uniform = m_Uniforms[m_UniformLookup[slot]];
+			if (uniform.NameHash == hash && uniform.Name == name) {
+				handle.Location = uniform.Location;
+				handle.Index = m_UniformLookup[slot];
+				break;
+			}
+		}
+		return handle;
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::vec4 *value) {
-		glUniform4fv(glGetUniformLocation(m_ShaderID, name), arraySize, glm::value_ptr(*value));
+	bool Shader::ShouldUpload(UniformHandle handle, const void *value, size_t size) {
+		if (!handle.IsValid()) {
+			return false;
+		}
+
+		// Values that don't fit what was reflected (a partial array, or a type the table doesn't know the size of) are always uploaded
+		ReflectedUniform &uniform = m_Uniforms[handle.Index];
+		if (size > uniform.ValueSize) {
+			s_UniformUploadCount++;
+			return true;
+		}
+
+		u8 *cachedValue = m_UniformValues.data() + uniform.ValueOffset;
+		if (uniform.HasValue && std::memcmp(cachedValue, value, size) == 0) {
+			s_UniformUploadsSkippedCount++;
+			return false;
+		}
+
+		std::memcpy(cachedValue, value, size);
+		uniform.HasValue = true;
+		s_UniformUploadCount++;
+		return true;
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::ivec4 *value) {
-		glUniform4iv(glGetUniformLocation(m_ShaderID, name), arraySize, glm::value_ptr(*value));
+	void Shader::ReflectUniforms() {
+		m_Uniforms.clear();
+		m_UniformLookup.clear();
+		m_UniformValues.clear();
+
+		GLint uniformCount = 0, maxNameLength = 0;
+		glGetProgramInterfaceiv(m_ShaderID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+		glGetProgramInterfaceiv(m_ShaderID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+
+		std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+		const GLenum properties[] = { GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE };
+		for (GLint i = 0; i < uniformCount; i++) {
+			GLint values[4];
+			glGetProgramResourceiv(m_ShaderID, GL_UNIFORM, i, 4, properties, 4, nullptr, values);
+			if (values[0] != -1 || values[1] == -1) {
+				continue; // Lives in a uniform block, those are filled through their buffers
+			}
+
+			glGetProgramResourceName(m_ShaderID, GL_UNIFORM, i, static_cast<GLsizei>(nameBuffer.size()), nullptr, nameBuffer.data());
+			std::string name(nameBuffer.data());
+			int location = values[1];
+			u32 elementSize = GetUniformTypeSize(static_cast<GLenum>(values[2]));
+			u32 arraySize = static_cast<u32>(std::max(values[3], 1));
+			u32 valueOffset = static_cast<u32>(m_UniformValues.size());
+			m_UniformValues.resize(m_UniformValues.size() + elementSize * arraySize);
+
+			// Arrays are reported as "name[0]", they can be set through the bare name or any of their elements
+			size_t arraySuffix = name.rfind("[0]");
+			if (arraySuffix != std::string::npos && arraySuffix + 3 == name.size()) {
+				std::string baseName = name.substr(0, arraySuffix);
+				AddReflectedUniform(baseName, location, valueOffset, elementSize * arraySize);
+				for (u32 element = 0; element < arraySize; element++) {
+					AddReflectedUniform(baseName + "[" + std::to_string(element) + "]", location + element, valueOffset + elementSize * element, elementSize * (arraySize - element));
+				}
+			}
+			else {
+				AddReflectedUniform(name, location, valueOffset, elementSize);
+			}
+		}
+
+		// Open addressed with linear probing, kept at most half full
+		size_t tableSize = 16;
+		while (tableSize < m_Uniforms.size() * 2) {
+			tableSize *= 2;
+		}
+		m_UniformLookup.assign(tableSize, -1);
+		for (int i = 0; i < static_cast<int>(m_Uniforms.size()); i++) {
+			size_t slot = m_Uniforms[i].NameHash & (tableSize - 1);
+			while (m_UniformLookup[slot] != -1) {
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			m_UniformLookup[slot] = i;
+		}
+
+		// Blocks, only the shared ones the engine fills are tracked
+		m_UniformBlockMask = 0;
+		GLint blockCount = 0, maxBlockNameLength = 0;
+		glGetProgramInterfaceiv(m_ShaderID, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blockCount);
+		glGetProgramInterfaceiv(m_ShaderID, GL_UNIFORM_BLOCK, GL_MAX_NAME_LENGTH, &maxBlockNameLength);
+		nameBuffer.resize(std::max(maxBlockNameLength, 1));
+		for (GLint i = 0; i < blockCount; i++) {
+			glGetProgramResourceName(m_ShaderID, GL_UNIFORM_BLOCK, i, static_cast<GLsizei>(nameBuffer.size()), nullptr, nameBuffer.data());
+			for (int binding = 0; binding < UniformBufferBindingCount; binding++) {
+				if (strcmp(nameBuffer.data(), UniformBuffer::GetBlockName(static_cast<UniformBufferBinding>(binding))) == 0) {
+					m_UniformBlockMask |= 1u << binding;
+				}
+			}
+		}
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::mat3 *value) {
-		glUniformMatrix3fv(glGetUniformLocation(m_ShaderID, name), arraySize, GL_FALSE, glm::value_ptr(*value));
+	void Shader::AddReflectedUniform(const std::string &name, int location, u32 valueOffset, u32 valueSize) {
+		ReflectedUniform uniform;
+		uniform.Name = name;
+		uniform.NameHash = HashUniformName(name.c_str());
+		uniform.Location = location;
+		uniform.ValueOffset = valueOffset;
+		uniform.ValueSize = valueSize;
+		uniform.HasValue = false;
+		m_Uniforms.push_back(uniform);
 	}
 
-	void Shader::SetUniformArray(const char *name, int arraySize, const glm::mat4 *value) {
-		glUniformMatrix4fv(glGetUniformLocation(m_ShaderID, name), arraySize, GL_FALSE, glm::value_ptr(*value));
+	u64 Shader::HashUniformName(const char *name) {
+		// FNV-1a
+		u64 hash = 14695981039346656037ull;
+		for (; *name; name++) {
+			hash ^= static_cast<u8>(*name);
+			hash *= 1099511628211ull;
+		}
+		return hash;
 	}
 
-	int Shader::GetUniformLocation(const char* name) {
-		return glGetUniformLocation(m_ShaderID, name);
+	u32 Shader::GetUniformTypeSize(GLenum type) {
+		switch (type) {
+		case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+			return 4;
+		case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+			return 8;
+		case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+			return 12;
+		case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2:
+			return 16;
+		case GL_FLOAT_MAT3:
+			return 36;
+		case GL_FLOAT_MAT4:
+			return 64;
+		case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_MULTISAMPLE:
+		case GL_SAMPLER_CUBE_MAP_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_SHADOW: case GL_IMAGE_2D: case GL_IMAGE_3D: case GL_IMAGE_2D_ARRAY:
+			return 4;
+		default:
+			return 0; // Unknown to the table, always uploaded
+		}
 	}
 
 	GLenum Shader::ShaderTypeFromString(const std::string &type) {
@@ -132,7 +350,7 @@ namespace Arcane
 		return 0;
 	}
 
-	std::unordered_map<GLenum, std::string> Shader::PreProcessShaderBinary(std::string &source) {
+	std::unordered_map<GLenum, std::string> Shader::PreProcessShaderBinary(std::string &source, const ShaderDefines &defines) {
 		std::unordered_map<GLenum, std::string> shaderSources;
 
 		const char *shaderTypeToken = "#shader-type";
@@ -150,49 +368,272 @@ namespace Arcane
 			shaderSources[ShaderTypeFromString(shaderType)] = source.substr(nextLinePos, pos - (nextLinePos == std::string::npos ? source.size() - 1 : nextLinePos));
 		}
 
+		// The engine's defines come first so a permutation can override them
+		ShaderDefines stageDefines = ShaderLoader::s_GlobalDefines;
+		stageDefines.Merge(defines);
+		std::string defineBlock = stageDefines.GetSourceBlock();
+
+		// Each stage is its own compile unit, so each gets its own copy of whatever it includes
+		std::string directory = std::filesystem::path(m_ShaderFilePath).parent_path().string() + "/";
+		for (auto &item : shaderSources) {
+			std::unordered_set<std::string> includedFiles;
+			ResolveIncludes(item.second, directory, includedFiles, 0);
+			InjectDefines(item.second, defineBlock);
+		}
+
 		return shaderSources;
 	}
 
+	void Shader::ResolveIncludes(std::string &source, const std::string &directory, std::unordered_set<std::string> &includedFiles, int depth) {
+		const char *includeToken = "#include";
+		size_t includeTokenLength = strlen(includeToken);
+		size_t pos = source.find(includeToken);
+		while (pos != std::string::npos) {
+			size_t eol = source.find_first_of("\r\n", pos);
+			if (eol == std::string::npos) {
+				eol = source.size();
+			}
+
+			// Only directives that start their line count, anything else is most likely in a comment
+			size_t lineStart = source.find_last_of("\r\n", pos);
+			lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+			if (source.find_first_not_of(" \t", lineStart) != pos) {
+				pos = source.find(includeToken, pos + includeTokenLength);
+				continue;
+			}
+
+			std::string includeSource;
+			size_t nameBegin = source.find('"', pos);
+			size_t nameEnd = (nameBegin < eol) ? source.find('"', nameBegin + 1) : std::string::npos;
+			if (nameEnd == std::string::npos || nameEnd > eol) {
+				ARC_LOG_ERROR("Shader Include Error: {0} - Malformed include {1}", m_DebugName, source.substr(pos, eol - pos));
+			}
+			else {
+				// Paths are relative to the including file, or failing that to the shader directory like the paths given to the loader
+				std::string includeName = source.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+				std::string includePath = directory + includeName;
+				if (!std::filesystem::exists(includePath)) {
+					includePath = ShaderLoader::s_ShaderFilepath + includeName;
+				}
+				includePath = std::filesystem::path(includePath).lexically_normal().string();
+
+				// Every file is only included once per stage so shared declarations can't be defined twice
+				if (includedFiles.insert(includePath).second) {
+					if (depth >= 16) {
+						ARC_LOG_ERROR("Shader Include Error: {0} - Includes nested too deeply at {1}", m_DebugName, includeName);
+					}
+					else if (!std::filesystem::exists(includePath)) {
+						ARC_LOG_ERROR("Shader Include Error: {0} - Could not find {1}", m_DebugName, includeName);
+					}
+					else {
+						includeSource = FileUtils::ReadFile(includePath);
+						ResolveIncludes(includeSource, std::filesystem::path(includePath).parent_path().string() + "/", includedFiles, depth + 1);
+					}
+				}
+			}
+
+			source.replace(pos, eol - pos, includeSource);
+			pos = source.find(includeToken, pos + includeSource.size());
+		}
+	}
+
+	void Shader::InjectDefines(std::string &source, const std::string &defineBlock) {
+		if (defineBlock.empty()) {
+			return;
+		}
+
+		// Nothing but comments can come before #version, so the defines go on the line after it
+		size_t versionPos = source.find("#version");
+		if (versionPos == std::string::npos) {
+			source.insert(0, defineBlock);
+			return;
+		}
+
+		size_t eol = source.find('\n', versionPos);
+		if (eol == std::string::npos) {
+			source += "\n" + defineBlock;
+		}
+		else {
+			source.insert(eol + 1, defineBlock);
+		}
+	}
+
 	void Shader::Compile(const std::unordered_map<GLenum, std::string> &shaderSources) {
 		m_ShaderID = glCreateProgram();
+		m_CompilePending = true;
+
+		// A cached binary for this driver skips compiling altogether, if the driver rejects it the sources are compiled like on a miss
+		m_ProgramBinaryCacheKey = GetProgramBinaryCacheKey(shaderSources);
+		if (m_ProgramBinaryCacheKey != 0 && LoadProgramBinary(m_ProgramBinaryCacheKey)) {
+			ShaderLoader::s_Stats.BinaryCacheHits++;
+			m_ProgramBinaryCacheKey = 0;
+			return;
+		}
 
-		// Attach different components of the shader (vertex, fragment, geometry, hull, domain, or compute)
+		// Attach different components of the shader (vertex, fragment, geometry, hull, domain, or compute). None of the statuses are queried here since that would block on the compile
 		for (auto &item : shaderSources) {
 			GLenum type = item.first;
 			const std::string &source = item.second;
+			if (source.empty()) {
+				ARC_LOG_ERROR("Shader Compile Error: {0} - Empty Source", m_DebugName);
+				continue;
+			}
 
 			GLuint shader = glCreateShader(type);
 			const GLchar *shaderSource = source.c_str();
 			glShaderSource(shader, 1, &shaderSource, NULL);
 			glCompileShader(shader);
 
-			// Check to see if compiling was successful
-			GLint wasCompiled;
-			glGetShaderiv(shader, GL_COMPILE_STATUS, &wasCompiled);
-			if (wasCompiled == GL_FALSE || source.empty()) {
+			glAttachShader(m_ShaderID, shader);
+			m_PendingStages.push_back(shader);
+		}
+
+		if (m_ProgramBinaryCacheKey != 0) {
+			glProgramParameteri(m_ShaderID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		glLinkProgram(m_ShaderID);
+	}
+
+	void Shader::FinishCompile() {
+		Timer waitTimer;
+		m_CompilePending = false;
+
+		// Blocks until the driver is done with the program
+		GLint wasLinked = GL_FALSE;
+		glGetProgramiv(m_ShaderID, GL_LINK_STATUS, &wasLinked);
+
+		// Check to see if compiling was successful
+		bool wasCompiled = true;
+		for (GLuint stage : m_PendingStages) {
+			GLint stageCompiled;
+			glGetShaderiv(stage, GL_COMPILE_STATUS, &stageCompiled);
+			if (stageCompiled == GL_FALSE) {
 				int length;
-				glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+				glGetShaderiv(stage, GL_INFO_LOG_LENGTH, &length);
 
 				if (length > 0) {
 					std::vector<char> error(length);
-					glGetShaderInfoLog(shader, length, &length, &error[0]);
+					glGetShaderInfoLog(stage, length, &length, &error[0]);
 					std::string errorString(error.begin(), error.end());
 
-					ARC_LOG_ERROR("Shader Compile Error: {0} - {1}", m_ShaderFilePath, errorString);
+					ARC_LOG_ERROR("Shader Compile Error: {0} - {1}", m_DebugName, errorString);
 				}
 				else {
-					ARC_LOG_ERROR("Shader Compile Error: {0} - Unknown Error", m_ShaderFilePath);
+					ARC_LOG_ERROR("Shader Compile Error: {0} - Unknown Error", m_DebugName);
 				}
-				glDeleteShader(shader);
-				break;
+				wasCompiled = false;
 			}
 
-			glAttachShader(m_ShaderID, shader);
-			glDeleteShader(shader);
+			glDetachShader(m_ShaderID, stage);
+			glDeleteShader(stage);
+		}
+		m_PendingStages.clear();
+
+		if (wasCompiled && wasLinked == GL_FALSE) {
+			int length;
+			glGetProgramiv(m_ShaderID, GL_INFO_LOG_LENGTH, &length);
+			std::vector<char> error(std::max(length, 1));
+			glGetProgramInfoLog(m_ShaderID, length, &length, &error[0]);
+			ARC_LOG_ERROR("Shader Link Error: {0} - {1}", m_DebugName, std::string(error.begin(), error.end()));
 		}
 
 		// Validate shader
-		glLinkProgram(m_ShaderID);
 		glValidateProgram(m_ShaderID);
+
+		// The shared blocks declare their own binding point so there is nothing to assign here, just note which ones are used
+		ReflectUniforms();
+
+		if (wasLinked == GL_TRUE && m_ProgramBinaryCacheKey != 0) {
+			StoreProgramBinary(m_ProgramBinaryCacheKey);
+		}
+		m_ProgramBinaryCacheKey = 0;
+
+		ShaderLoader::s_Stats.WaitTime += waitTimer.Elapsed();
+	}
+
+	u64 Shader::GetProgramBinaryCacheKey(const std::unordered_map<GLenum, std::string> &shaderSources) const {
+		if (!ShaderLoader::s_ProgramBinaryCache) {
+			return 0;
+		}
+
+		// Stages are hashed in a fixed order since the map's isn't
+		std::vector<GLenum> stageTypes;
+		for (auto &item : shaderSources) {
+			stageTypes.push_back(item.first);
+		}
+		std::sort(stageTypes.begin(), stageTypes.end());
+
+		u64 key = DerivedDataCache::HashCombine(ShaderLoader::s_DriverHash, ((u64)DerivedDataCacheVersion << 32) | ProgramBinaryVersion);
+		for (GLenum type : stageTypes) {
+			const std::string &source = shaderSources.at(type);
+			key = DerivedDataCache::HashCombine(key, type);
+			key = DerivedDataCache::HashBytes(source.data(), source.size(), key);
+		}
+
+		// Zero means no caching
+		return key == 0 ? 1 : key;
+	}
+
+	bool Shader::LoadProgramBinary(u64 cacheKey) {
+		std::string entryPath;
+		if (!DerivedDataCache::GetInstance().Find(cacheKey, entryPath)) {
+			return false;
+		}
+
+		std::ifstream file(entryPath, std::ios::in | std::ios::binary);
+		ProgramBinaryHeader header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.Magic != ProgramBinaryMagic || header.CacheKey != cacheKey || header.BinarySize == 0) {
+			ARC_LOG_WARN("Cached program binary {0} is corrupt, compiling {1} instead", entryPath, m_DebugName);
+			DerivedDataCache::GetInstance().RecordRead(false);
+			return false;
+		}
+
+		std::vector<char> binary(static_cast<size_t>(header.BinarySize));
+		if (!file.read(binary.data(), static_cast<std::streamsize>(header.BinarySize))) {
+			ARC_LOG_WARN("Cached program binary {0} is corrupt, compiling {1} instead", entryPath, m_DebugName);
+			DerivedDataCache::GetInstance().RecordRead(false);
+			return false;
+		}
+
+		// Drivers can still refuse a binary that matches the key (a different build reporting the same version), the program then needs to be linked from source
+		glProgramBinary(m_ShaderID, header.BinaryFormat, binary.data(), static_cast<GLsizei>(header.BinarySize));
+		GLint wasLinked = GL_FALSE;
+		glGetProgramiv(m_ShaderID, GL_LINK_STATUS, &wasLinked);
+		DerivedDataCache::GetInstance().RecordRead(wasLinked == GL_TRUE);
+		return wasLinked == GL_TRUE;
+	}
+
+	void Shader::StoreProgramBinary(u64 cacheKey) {
+		GLint binarySize = 0;
+		glGetProgramiv(m_ShaderID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+		if (binarySize <= 0) {
+			return;
+		}
+
+		std::vector<char> binary(binarySize);
+		ProgramBinaryHeader header;
+		header.Magic = ProgramBinaryMagic;
+		header.CacheKey = cacheKey;
+		glGetProgramBinary(m_ShaderID, binarySize, &binarySize, &header.BinaryFormat, binary.data());
+		header.BinarySize = static_cast<u64>(binarySize);
+		if (binarySize <= 0) {
+			return;
+		}
+
+		DerivedDataCache &cache = DerivedDataCache::GetInstance();
+		std::string tempPath = cache.BeginStore(cacheKey);
+		{
+			std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(binary.data(), static_cast<std::streamsize>(header.BinarySize));
+			if (!file) {
+				file.close();
+				cache.AbortStore(tempPath);
+				return;
+			}
+		}
+		if (cache.CommitStore(cacheKey, tempPath)) {
+			ShaderLoader::s_Stats.BinaryCacheStores++;
+		}
 	}
-}
\ No newline at end of file
+}
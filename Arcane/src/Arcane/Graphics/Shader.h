@@ -2,51 +2,137 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#ifndef UNIFORMBUFFER_H
+#include <Arcane/Platform/OpenGL/UniformBuffer.h>
+#endif
+
+#ifndef SHADERDEFINES_H
+#include <Arcane/Graphics/ShaderDefines.h>
+#endif
+
 namespace Arcane
 {
+	// Pre-resolved uniform that hot paths can hold on to instead of looking the name up every time. Only valid for the shader that handed it out
+	struct UniformHandle
+	{
+		int Location = -1;
+		int Index = -1; // Into the shader's reflected uniforms
+
+		inline bool IsValid() const { return Location != -1; }
+	};
+
 	class Shader
 	{
 		friend class ShaderLoader;
 	private:
-		Shader(const std::string &path);
+		Shader(const std::string &path, const ShaderDefines &defines);
 	public:
 		~Shader();
 
 		void Enable() const;
 		void Disable() const;
 
-		void SetUniform(const char *name, float value);
-		void SetUniform(const char *name, int value);
-		void SetUniform(const char *name, const glm::vec2& vector);
-		void SetUniform(const char *name, const glm::ivec2& vector);
-		void SetUniform(const char *name, const glm::vec3& vector);
-		void SetUniform(const char *name, const glm::ivec3& vector);
-		void SetUniform(const char *name, const glm::vec4& vector);
-		void SetUniform(const char *name, const glm::ivec4& vector);
-		void SetUniform(const char *name, const glm::mat3& matrix);
-		void SetUniform(const char *name, const glm::mat4& matrix);
-
-		void SetUniformArray(const char *name, int arraySize, const float *value);
-		void SetUniformArray(const char *name, int arraySize, const int *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::vec2 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::ivec2 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::vec3 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::ivec3 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::vec4 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::ivec4 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::mat3 *value);
-		void SetUniformArray(const char *name, int arraySize, const glm::mat4 *value);
-
-		inline unsigned int GetShaderID() { return m_ShaderID; }
+		// Uniforms are reflected after linking, looking one up by name is a hash table probe and never reaches the driver. Waits for the compile if it is still running
+		UniformHandle GetUniformHandle(const char *name) const;
+
+		void SetUniform(const char *name, float value) { SetUniform(GetUniformHandle(name), value); }
+		void SetUniform(const char *name, int value) { SetUniform(GetUniformHandle(name), value); }
+		void SetUniform(const char *name, const glm::vec2& vector) { SetUniform(GetUniformHandle(name), vector); }
+		void SetUniform(const char *name, const glm::ivec2& vector) { SetUniform(GetUniformHandle(name), vector); }
+		void SetUniform(const char *name, const glm::vec3& vector) { SetUniform(GetUniformHandle(name), vector); }
+		void SetUniform(const char *name, const glm::ivec3& vector) { SetUniform(GetUniformHandle(name), vector); }
+		void SetUniform(const char *name, const glm::vec4& vector) { SetUniform(GetUniformHandle(name), vector); }
+		void SetUniform(const char *name, const glm::ivec4& vector) { SetUniform(GetUniformHandle(name), vector); }
+		void SetUniform(const char *name, const glm::mat3& matrix) { SetUniform(GetUniformHandle(name), matrix); }
+		void SetUniform(const char *name, const glm::mat4& matrix) { SetUniform(GetUniformHandle(name), matrix); }
+
+		void SetUniformArray(const char *name, int arraySize, const float *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const int *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::vec2 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::ivec2 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::vec3 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::ivec3 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::vec4 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::ivec4 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::mat3 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+		void SetUniformArray(const char *name, int arraySize, const glm::mat4 *value) { SetUniformArray(GetUniformHandle(name), arraySize, value); }
+
+		// Uploads are skipped when the value matches what was last set on this shader, the shader must be bound like with any glUniform call
+		void SetUniform(UniformHandle handle, float value);
+		void SetUniform(UniformHandle handle, int value);
+		void SetUniform(UniformHandle handle, const glm::vec2& vector);
+		void SetUniform(UniformHandle handle, const glm::ivec2& vector);
+		void SetUniform(UniformHandle handle, const glm::vec3& vector);
+		void SetUniform(UniformHandle handle, const glm::ivec3& vector);
+		void SetUniform(UniformHandle handle, const glm::vec4& vector);
+		void SetUniform(UniformHandle handle, const glm::ivec4& vector);
+		void SetUniform(UniformHandle handle, const glm::mat3& matrix);
+		void SetUniform(UniformHandle handle, const glm::mat4& matrix);
+
+		void SetUniformArray(UniformHandle handle, int arraySize, const float *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const int *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::vec2 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::ivec2 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::vec3 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::ivec3 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::vec4 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::ivec4 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::mat3 *value);
+		void SetUniformArray(UniformHandle handle, int arraySize, const glm::mat4 *value);
+
+		// Counted across every shader, the renderer resets these each frame for its statistics
+		inline static u32 GetUniformUploadCount() { return s_UniformUploadCount; }
+		inline static u32 GetUniformUploadsSkippedCount() { return s_UniformUploadsSkippedCount; }
+		inline static void ResetUniformUploadCounts() { s_UniformUploadCount = 0; s_UniformUploadsSkippedCount = 0; }
+
+		inline unsigned int GetShaderID() { return m_ShaderID; } // Valid as soon as the shader is loaded, the program might still be compiling
+		inline bool UsesUniformBlock(UniformBufferBinding binding) const { WaitForCompile(); return (m_UniformBlockMask & (1u << binding)) != 0; } // Shaders that declare a shared block get their data from its buffer instead of SetUniform
+		inline bool IsCompilePending() const { return m_CompilePending; }
 	private:
-		int GetUniformLocation(const char *name);
+		struct ReflectedUniform
+		{
+			std::string Name;
+			u64 NameHash;
+			int Location;
+			u32 ValueOffset, ValueSize; // Where the last uploaded value is kept in m_UniformValues, elements of an array share their array's storage
+			bool HasValue;
+		};
+
+		void ReflectUniforms();
+		void AddReflectedUniform(const std::string &name, int location, u32 valueOffset, u32 valueSize);
+		bool ShouldUpload(UniformHandle handle, const void *value, size_t size);
+		static u64 HashUniformName(const char *name);
+		static u32 GetUniformTypeSize(GLenum type);
 
 		static GLenum ShaderTypeFromString(const std::string &type);
-		std::unordered_map<GLenum, std::string> PreProcessShaderBinary(std::string &source);
+		std::unordered_map<GLenum, std::string> PreProcessShaderBinary(std::string &source, const ShaderDefines &defines);
+		void ResolveIncludes(std::string &source, const std::string &directory, std::unordered_set<std::string> &includedFiles, int depth);
+		static void InjectDefines(std::string &source, const std::string &defineBlock);
+		// Compiling is split so that every shader can be submitted before any of them is waited on, the driver works through them in the meantime.
+		// Everything that needs the linked program (binding it, reflection) waits first, the reflected state is part of the program so that wait is allowed from const functions
 		void Compile(const std::unordered_map<GLenum, std::string> &shaderSources);
+		inline void WaitForCompile() const { if (m_CompilePending) const_cast<Shader*>(this)->FinishCompile(); }
+		void FinishCompile();
+
+		u64 GetProgramBinaryCacheKey(const std::unordered_map<GLenum, std::string> &shaderSources) const;
+		bool LoadProgramBinary(u64 cacheKey);
+		void StoreProgramBinary(u64 cacheKey);
 	private:
 		unsigned int m_ShaderID;
 		std::string m_ShaderFilePath;
+		std::string m_DebugName; // The path along with the permutation's defines
+		u32 m_UniformBlockMask = 0;
+
+		bool m_CompilePending = false;
+		std::vector<GLuint> m_PendingStages; // Kept until the compile finishes so their logs can be read
+		u64 m_ProgramBinaryCacheKey = 0; // Non-zero when the linked binary should be stored once it is ready
+
+		std::vector<ReflectedUniform> m_Uniforms;
+		std::vector<int> m_UniformLookup; // Open addressed table of indices into m_Uniforms, size is a power of two
+		std::vector<u8> m_UniformValues;
+
+		static u32 s_UniformUploadCount;
+		static u32 s_UniformUploadsSkippedCount;
 	};
 }
 #endif
@@ -0,0 +1,63 @@
+#include "arcpch.h"
+#include "ShaderDefines.h"
+
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
+
+namespace Arcane
+{
+	ShaderDefines& ShaderDefines::Set(const std::string &name, const std::string &value) {
+		auto iter = std::lower_bound(m_Defines.begin(), m_Defines.end(), name, [](const std::pair<std::string, std::string> &define, const std::string &defineName) { return define.first < defineName; });
+		if (iter != m_Defines.end() && iter->first == name) {
+			iter->second = value;
+		}
+		else {
+			m_Defines.insert(iter, { name, value });
+		}
+		return *this;
+	}
+
+	ShaderDefines& ShaderDefines::Set(const std::string &name, int value) {
+		return Set(name, std::to_string(value));
+	}
+
+	ShaderDefines& ShaderDefines::Enable(const std::string &name, bool enabled) {
+		if (enabled) {
+			Set(name, "1");
+		}
+		return *this;
+	}
+
+	void ShaderDefines::Merge(const ShaderDefines &other) {
+		for (auto &define : other.m_Defines) {
+			Set(define.first, define.second);
+		}
+	}
+
+	u64 ShaderDefines::GetHash() const {
+		u64 hash = 0;
+		for (auto &define : m_Defines) {
+			hash = DerivedDataCache::HashBytes(define.first.data(), define.first.size(), hash);
+			hash = DerivedDataCache::HashBytes(define.second.data(), define.second.size(), hash);
+		}
+		return hash;
+	}
+
+	std::string ShaderDefines::GetSourceBlock() const {
+		std::string block;
+		for (auto &define : m_Defines) {
+			block += "#define " + define.first + " " + define.second + "\n";
+		}
+		return block;
+	}
+
+	std::string ShaderDefines::ToString() const {
+		std::string result;
+		for (auto &define : m_Defines) {
+			if (!result.empty()) {
+				result += " ";
+			}
+			result += define.first + "=" + define.second;
+		}
+		return result;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef SHADERDEFINES_H
+#define SHADERDEFINES_H
+
+namespace Arcane
+{
+	// Compile time defines a shader is built with. Every distinct set is its own program (a permutation), so choices that are static for a draw are compiled in instead of being branched on per pixel
+	class ShaderDefines
+	{
+	public:
+		ShaderDefines& Set(const std::string &name, const std::string &value);
+		ShaderDefines& Set(const std::string &name, int value);
+
+		// Flags are tested with #ifdef, a disabled flag is left out entirely so that permutation shares its program with loads that never mention the flag
+		ShaderDefines& Enable(const std::string &name, bool enabled = true);
+
+		// Values from other replace the ones already set
+		void Merge(const ShaderDefines &other);
+
+		u64 GetHash() const;
+		std::string GetSourceBlock() const; // One #define per line, ready to go after a stage's #version
+		std::string ToString() const; // NAME=VALUE pairs for logging
+
+		inline bool IsEmpty() const { return m_Defines.empty(); }
+	private:
+		std::vector<std::pair<std::string, std::string>> m_Defines; // Kept sorted by name so the same set always hashes the same
+	};
+}
+#endif
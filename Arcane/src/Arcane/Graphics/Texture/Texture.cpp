@@ -5,21 +5,40 @@
 
 namespace Arcane
 {
-	Texture::Texture() : m_TextureId(0), m_TextureTarget(0), m_Width(0), m_Height(0), m_TextureSettings() {}
+	static GLsizei GetCompressedMipSize(GLenum compressedFormat, unsigned int width, unsigned int height)
+	{
+		GLsizei blockSize = (compressedFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || compressedFormat == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT || compressedFormat == GL_COMPRESSED_RED_RGTC1) ? 8 : 16;
+		return static_cast<GLsizei>(((width + 3) / 4) * ((height + 3) / 4)) * blockSize;
+	}
 
-	Texture::Texture(TextureSettings &settings) : m_TextureId(0), m_TextureTarget(0), m_Width(0), m_Height(0), m_TextureSettings(settings) {}
+	Texture::Texture() : m_TextureId(0), m_TextureTarget(0), m_Width(0), m_Height(0), m_LayerCount(1), m_CompressedMipCount(0), m_FirstResidentMip(0), m_TextureSettings() {}
+
+	Texture::Texture(TextureSettings &settings) : m_TextureId(0), m_TextureTarget(0), m_Width(0), m_Height(0), m_LayerCount(1), m_CompressedMipCount(0), m_FirstResidentMip(0), m_TextureSettings(settings) {}
 
 	// TODO: Current Texture Copy implementation only copies the highest resolution mip (level 0)
 	// This implementation is fine when the hardware generates the mips because our newly created texture will do the same
 	// This only fails if the mip levels contain custom data that was generated by the hardware via glGenerateMipmap(...)
-	Texture::Texture(const Texture &texture) : m_TextureId(0), m_TextureTarget(texture.GetTextureTarget()), m_Width(texture.GetWidth()), m_Height(texture.GetHeight()), m_TextureSettings(texture.GetTextureSettings())
+	Texture::Texture(const Texture &texture) : m_TextureId(0), m_TextureTarget(texture.GetTextureTarget()), m_Width(texture.GetWidth()), m_Height(texture.GetHeight()), m_LayerCount(texture.GetLayerCount()), m_CompressedMipCount(texture.m_CompressedMipCount), m_FirstResidentMip(texture.m_FirstResidentMip), m_TextureSettings(texture.GetTextureSettings())
 	{
 		glGenTextures(1, &m_TextureId);
 		Bind();
 
-		glTexImage2D(m_TextureTarget, 0, m_TextureSettings.TextureFormat, m_Width, m_Height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-		ApplyTextureSettings();
-		glCopyImageSubData(texture.GetTextureId(), texture.GetTextureTarget(), 0, 0, 0, 0, m_TextureId, m_TextureTarget, 0, 0, 0, 0, m_Width, m_Height, 1);
+		// Compressed formats can't have their mips generated by the hardware, so every resident mip gets copied
+		if (IsCompressed()) {
+			for (int mip = m_FirstResidentMip; mip < m_CompressedMipCount; mip++) {
+				unsigned int mipWidth = glm::max(1u, m_Width >> mip), mipHeight = glm::max(1u, m_Height >> mip);
+				int level = mip - m_FirstResidentMip;
+				glCompressedTexImage2D(m_TextureTarget, level, m_TextureSettings.TextureFormat, mipWidth, mipHeight, 0, GetCompressedMipSize(m_TextureSettings.TextureFormat, mipWidth, mipHeight), nullptr);
+				glCopyImageSubData(texture.GetTextureId(), texture.GetTextureTarget(), level, 0, 0, 0, m_TextureId, m_TextureTarget, level, 0, 0, 0, mipWidth, mipHeight, 1);
+			}
+			glTexParameteri(m_TextureTarget, GL_TEXTURE_MAX_LEVEL, m_CompressedMipCount - 1 - m_FirstResidentMip);
+			ApplyTextureSettings(false);
+		}
+		else {
+			glTexImage2D(m_TextureTarget, 0, m_TextureSettings.TextureFormat, m_Width, m_Height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+			ApplyTextureSettings();
+			glCopyImageSubData(texture.GetTextureId(), texture.GetTextureTarget(), 0, 0, 0, 0, m_TextureId, m_TextureTarget, 0, 0, 0, 0, m_Width, m_Height, 1);
+		}
 
 		Unbind();
 	}
@@ -28,27 +47,28 @@ namespace Arcane
 		glDeleteTextures(1, &m_TextureId);
 	}
 
-	void Texture::ApplyTextureSettings() {
+	void Texture::ApplyTextureSettings(bool generateMips) {
 		// Texture wrapping
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_TextureSettings.TextureWrapSMode);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_TextureSettings.TextureWrapTMode);
+		glTexParameteri(m_TextureTarget, GL_TEXTURE_WRAP_S, m_TextureSettings.TextureWrapSMode);
+		glTexParameteri(m_TextureTarget, GL_TEXTURE_WRAP_T, m_TextureSettings.TextureWrapTMode);
 		if (m_TextureSettings.HasBorder) {
-			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(m_TextureSettings.BorderColour));
+			glTexParameterfv(m_TextureTarget, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(m_TextureSettings.BorderColour));
 		}
 
 		// Texture filtering
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_TextureSettings.TextureMinificationFilterMode);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_TextureSettings.TextureMagnificationFilterMode);
+		glTexParameteri(m_TextureTarget, GL_TEXTURE_MIN_FILTER, m_TextureSettings.TextureMinificationFilterMode);
+		glTexParameteri(m_TextureTarget, GL_TEXTURE_MAG_FILTER, m_TextureSettings.TextureMagnificationFilterMode);
 
 		// Mipmapping
 		if (m_TextureSettings.HasMips) {
-			glGenerateMipmap(GL_TEXTURE_2D);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, m_TextureSettings.MipBias);
+			if (generateMips)
+				glGenerateMipmap(m_TextureTarget);
+			glTexParameteri(m_TextureTarget, GL_TEXTURE_LOD_BIAS, m_TextureSettings.MipBias);
 		}
 
 		// Anisotropic filtering (Check with renderer to see the max amount allowed
 		float anistropyAmount = glm::min<float>(m_TextureSettings.TextureAnisotropyLevel, Renderer::GetRendererData().MaxAnisotropy);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anistropyAmount);
+		glTexParameterf(m_TextureTarget, GL_TEXTURE_MAX_ANISOTROPY_EXT, anistropyAmount);
 	}
 
 	void Texture::Generate2DTexture(unsigned int width, unsigned int height, GLenum dataFormat, GLenum pixelDataType, const void *data) {
@@ -77,6 +97,99 @@ namespace Arcane
 		Unbind();
 	}
 
+	void Texture::GenerateCompressed2DTexture(unsigned int width, unsigned int height, GLenum compressedFormat, int mipCount, const void *data, int firstResidentMip) {
+		m_TextureTarget = GL_TEXTURE_2D;
+		m_Width = width;
+		m_Height = height;
+		m_CompressedMipCount = mipCount;
+		m_FirstResidentMip = glm::clamp(firstResidentMip, 0, mipCount - 1);
+		m_TextureSettings.TextureFormat = compressedFormat;
+
+		glGenTextures(1, &m_TextureId);
+		Bind();
+
+		// The mips come from the cooker since the hardware can't generate them for compressed formats
+		const unsigned char *mipData = static_cast<const unsigned char*>(data) + GetCompressedMipOffset(m_FirstResidentMip);
+		for (int mip = m_FirstResidentMip; mip < mipCount; mip++) {
+			unsigned int mipWidth = glm::max(1u, width >> mip), mipHeight = glm::max(1u, height >> mip);
+			GLsizei mipSize = GetCompressedMipSize(compressedFormat, mipWidth, mipHeight);
+			glCompressedTexImage2D(GL_TEXTURE_2D, mip - m_FirstResidentMip, compressedFormat, mipWidth, mipHeight, 0, mipSize, mipData);
+			mipData += mipSize;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - 1 - m_FirstResidentMip);
+		ApplyTextureSettings(false);
+
+		Unbind();
+	}
+
+	void Texture::SetFirstResidentMip(int firstResidentMip, const void *newMipData) {
+		if (!IsCompressed())
+			return;
+
+		firstResidentMip = glm::clamp(firstResidentMip, 0, m_CompressedMipCount - 1);
+		if (firstResidentMip == m_FirstResidentMip || (firstResidentMip < m_FirstResidentMip && newMipData == nullptr))
+			return;
+
+		// GL can't release individual mip levels, so the resident mips are moved into a new texture object and the old one is deleted
+		unsigned int newTextureId;
+		glGenTextures(1, &newTextureId);
+		glBindTexture(GL_TEXTURE_2D, newTextureId);
+
+		GLenum format = m_TextureSettings.TextureFormat;
+		const unsigned char *mipData = static_cast<const unsigned char*>(newMipData);
+		for (int mip = firstResidentMip; mip < m_CompressedMipCount; mip++) {
+			unsigned int mipWidth = glm::max(1u, m_Width >> mip), mipHeight = glm::max(1u, m_Height >> mip);
+			GLsizei mipSize = GetCompressedMipSize(format, mipWidth, mipHeight);
+			int level = mip - firstResidentMip;
+			if (mip < m_FirstResidentMip) {
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, format, mipWidth, mipHeight, 0, mipSize, mipData);
+				mipData += mipSize;
+			}
+			else {
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, format, mipWidth, mipHeight, 0, mipSize, nullptr);
+				glCopyImageSubData(m_TextureId, GL_TEXTURE_2D, mip - m_FirstResidentMip, 0, 0, 0, newTextureId, GL_TEXTURE_2D, level, 0, 0, 0, mipWidth, mipHeight, 1);
+			}
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_CompressedMipCount - 1 - firstResidentMip);
+
+		glDeleteTextures(1, &m_TextureId);
+		m_TextureId = newTextureId;
+		m_FirstResidentMip = firstResidentMip;
+		ApplyTextureSettings(false);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	size_t Texture::GetCompressedMipOffset(int mip) const {
+		size_t offset = 0;
+		for (int i = 0; i < mip && i < m_CompressedMipCount; i++) {
+			offset += GetCompressedMipSize(m_TextureSettings.TextureFormat, glm::max(1u, m_Width >> i), glm::max(1u, m_Height >> i));
+		}
+		return offset;
+	}
+
+	size_t Texture::GetResidentMemorySize() const {
+		if (!IsGenerated())
+			return 0;
+		if (IsCompressed())
+			return GetCompressedMipOffset(m_CompressedMipCount) - GetCompressedMipOffset(m_FirstResidentMip);
+
+		size_t bytesPerPixel;
+		switch (m_TextureSettings.TextureFormat) {
+		case GL_RED: case GL_R8: bytesPerPixel = 1; break;
+		case GL_RG: case GL_RG8: case GL_R16F: bytesPerPixel = 2; break;
+		case GL_RG16F: case GL_R32F: case GL_DEPTH_COMPONENT24: case GL_DEPTH24_STENCIL8: bytesPerPixel = 4; break;
+		case GL_RGBA16F: case GL_RGB16F: case GL_RG32F: bytesPerPixel = 8; break;
+		case GL_RGBA32F: case GL_RGB32F: bytesPerPixel = 16; break;
+		default: bytesPerPixel = 4; break; // 8 bit RGB(A) and sRGB, drivers pad RGB out to 4 bytes
+		}
+
+		size_t size = static_cast<size_t>(m_Width) * m_Height * m_LayerCount * bytesPerPixel;
+		if (m_TextureTarget == GL_TEXTURE_2D_MULTISAMPLE)
+			return size * MSAA_SAMPLE_AMOUNT;
+		return m_TextureSettings.HasMips ? (size * 4) / 3 : size;
+	}
+
 	void Texture::Generate2DMultisampleTexture(unsigned int width, unsigned int height) {
 		// Multisampled textures do not support mips or filtering/wrapping options
 		m_TextureTarget = GL_TEXTURE_2D_MULTISAMPLE;
@@ -89,9 +202,29 @@ namespace Arcane
 		Unbind();
 	}
 
+	void Texture::Generate2DArrayTexture(unsigned int width, unsigned int height, unsigned int layerCount, GLenum dataFormat, GLenum pixelDataType, const void *data) {
+		m_TextureTarget = GL_TEXTURE_2D_ARRAY;
+		m_Width = width;
+		m_Height = height;
+		m_LayerCount = layerCount;
+
+		// If GL_NONE is specified, set the texture format to the data format
+		if (m_TextureSettings.TextureFormat == GL_NONE) {
+			m_TextureSettings.TextureFormat = dataFormat;
+		}
+
+		glGenTextures(1, &m_TextureId);
+		Bind();
+
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, m_TextureSettings.TextureFormat, width, height, layerCount, 0, dataFormat, pixelDataType, data);
+		ApplyTextureSettings();
+
+		Unbind();
+	}
+
 	void Texture::GenerateMips() {
 		m_TextureSettings.HasMips = true;
-		if (IsGenerated()) {
+		if (IsGenerated() && !IsCompressed()) {
 			Bind();
 			glGenerateMipmap(m_TextureTarget);
 		}
@@ -200,7 +333,7 @@ namespace Arcane
 			return;
 
 		m_TextureSettings.HasMips = hasMips;
-		if (IsGenerated() && hasMips == true) {
+		if (IsGenerated() && !IsCompressed() && hasMips == true) {
 			glGenerateMipmap(m_TextureTarget);
 		}
 	}
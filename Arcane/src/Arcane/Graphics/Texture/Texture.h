@@ -4,6 +4,18 @@
 
 namespace Arcane
 {
+	// Block compression formats textures can be cooked to, Auto lets the texture compressor pick one based on the image's contents
+	enum class TextureCompression
+	{
+		Auto = 0,
+		None,
+		BC1, // RGB, 4bpp
+		BC3, // RGBA, 8bpp (BC1 colour + BC4 alpha)
+		BC4, // Single channel, 4bpp
+		BC5, // Two channels, 8bpp (used for normal maps, z is rebuilt in the shader)
+		BC7  // RGBA, 8bpp (highest quality)
+	};
+
 	struct TextureSettings {
 		// Texture format
 		GLenum TextureFormat = GL_NONE; // If set to GL_NONE, the data format will be used
@@ -27,6 +39,12 @@ namespace Arcane
 		// Mip options
 		bool HasMips = true;
 		int MipBias = 0; // positive means blurrier texture selected, negative means sharper texture which can show texture aliasing
+
+		// Compression options (only used when the texture is loaded from a file and TextureFormat is GL_NONE)
+		TextureCompression Compression = TextureCompression::Auto;
+
+		// Streaming options (only async loads with cooked mips are streamed, see TextureStreamer)
+		bool IsStreamable = true;
 	};
 
 	class Texture {
@@ -38,9 +56,15 @@ namespace Arcane
 
 		// Generation functions
 		void Generate2DTexture(unsigned int width, unsigned int height, GLenum dataFormat, GLenum pixelDataType = GL_UNSIGNED_BYTE, const void *data = nullptr);
+		void GenerateCompressed2DTexture(unsigned int width, unsigned int height, GLenum compressedFormat, int mipCount, const void *data, int firstResidentMip = 0); // Data holds every mip tightly packed, largest first. Mips above firstResidentMip are skipped
 		void Generate2DMultisampleTexture(unsigned int width, unsigned int height);
+		void Generate2DArrayTexture(unsigned int width, unsigned int height, unsigned int layerCount, GLenum dataFormat, GLenum pixelDataType = GL_UNSIGNED_BYTE, const void *data = nullptr); // Data holds every layer tightly packed
 		void GenerateMips(); // Will attempt to generate mipmaps, only works if the texture has already been generated
 
+		// Compressed textures only. Reallocates the texture so only the mips from firstResidentMip down take up memory, mips that were already resident are copied over on the GPU
+		// When mips are being added, newMipData holds the ones that weren't resident (firstResidentMip up to the old first resident mip) tightly packed
+		void SetFirstResidentMip(int firstResidentMip, const void *newMipData = nullptr);
+
 		void Bind(int unit = 0) const;
 		void Unbind() const;
 
@@ -63,16 +87,25 @@ namespace Arcane
 		inline unsigned int GetTextureId() const { return m_TextureId; }
 		inline unsigned int GetTextureTarget() const { return m_TextureTarget; }
 		inline bool IsGenerated() const { return m_TextureId != 0; }
+		inline bool IsCompressed() const { return m_CompressedMipCount != 0; }
+		inline int GetMipCount() const { return m_CompressedMipCount; } // Only tracked for compressed textures, since they carry their own mips
+		inline int GetFirstResidentMip() const { return m_FirstResidentMip; }
+		size_t GetCompressedMipOffset(int mip) const; // Offset of the mip in a tightly packed mip chain that starts at mip 0
+		size_t GetResidentMemorySize() const; // Exact for compressed textures, an estimate based on the internal format otherwise
 		inline unsigned int GetWidth() const { return m_Width; }
 		inline unsigned int GetHeight() const { return m_Height; }
+		inline unsigned int GetLayerCount() const { return m_LayerCount; } // 1 unless the texture is an array
 		inline const TextureSettings& GetTextureSettings() const { return m_TextureSettings; }
 	private:
-		void ApplyTextureSettings();
+		void ApplyTextureSettings(bool generateMips = true);
 	private:
 		unsigned int m_TextureId;
 		GLenum m_TextureTarget;
 
 		unsigned int m_Width, m_Height;
+		unsigned int m_LayerCount;
+		int m_CompressedMipCount; // Mips uploaded pre-compressed, 0 if the texture isn't compressed
+		int m_FirstResidentMip; // Streamed textures drop their largest mips, level 0 of the GL texture is this mip. Width and height stay the size of mip 0
 
 		TextureSettings m_TextureSettings;
 	};
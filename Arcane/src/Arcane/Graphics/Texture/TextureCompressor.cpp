@@ -0,0 +1,714 @@
+#include "arcpch.h"
+#include "TextureCompressor.h"
+
+#include <Arcane/Core/Threads/JobSystem.h>
+
+namespace Arcane
+{
+	namespace
+	{
+		static constexpr int BC7IndexWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		static constexpr float BC1IndexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f }; // Interpolation weight towards colour1 for each index in the 4 colour mode
+		static constexpr int BlockRowsPerJob = 8;
+
+		// Writes bits LSB first, which is how every BC format packs its fields. The block needs to be zeroed before writing
+		class BlockBitWriter
+		{
+		public:
+			BlockBitWriter(unsigned char *block) : m_Block(block), m_BitPosition(0) {}
+
+			void Write(u32 value, int bitCount)
+			{
+				for (int i = 0; i < bitCount; i++, m_BitPosition++)
+				{
+					if ((value >> i) & 1)
+						m_Block[m_BitPosition >> 3] |= static_cast<unsigned char>(1 << (m_BitPosition & 7));
+				}
+			}
+		private:
+			unsigned char *m_Block;
+			int m_BitPosition;
+		};
+
+		inline void LoadTexels(const unsigned char *rgba, float outTexels[16][4])
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				for (int c = 0; c < 4; c++)
+					outTexels[i][c] = static_cast<float>(rgba[i * 4 + c]);
+			}
+		}
+
+		inline float DistanceSquared(const float *a, const int *b, int channelCount)
+		{
+			float result = 0.0f;
+			for (int c = 0; c < channelCount; c++)
+			{
+				float delta = a[c] - static_cast<float>(b[c]);
+				result += delta * delta;
+			}
+			return result;
+		}
+
+		// Fits a line through the texels with a few power iterations on their covariance, the endpoints are the extents of the texels projected on to it
+		void FitEndpoints(const float texels[16][4], int channelCount, float outLow[4], float outHigh[4])
+		{
+			float mean[4] = {}, minimum[4], maximum[4];
+			for (int c = 0; c < 4; c++)
+			{
+				minimum[c] = 255.0f;
+				maximum[c] = 0.0f;
+			}
+			for (int i = 0; i < 16; i++)
+			{
+				for (int c = 0; c < channelCount; c++)
+				{
+					mean[c] += texels[i][c] * (1.0f / 16.0f);
+					minimum[c] = glm::min(minimum[c], texels[i][c]);
+					maximum[c] = glm::max(maximum[c], texels[i][c]);
+				}
+			}
+
+			float covariance[4][4] = {};
+			for (int i = 0; i < 16; i++)
+			{
+				for (int a = 0; a < channelCount; a++)
+				{
+					for (int b = a; b < channelCount; b++)
+						covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+				}
+			}
+			for (int a = 0; a < channelCount; a++)
+			{
+				for (int b = 0; b < a; b++)
+					covariance[a][b] = covariance[b][a];
+			}
+
+			// Starting from the bounding box diagonal converges quickly since it is usually close to the principal axis already
+			float axis[4] = {};
+			for (int c = 0; c < channelCount; c++)
+				axis[c] = maximum[c] - minimum[c];
+			for (int iteration = 0; iteration < 8; iteration++)
+			{
+				float next[4] = {};
+				float largest = 0.0f;
+				for (int a = 0; a < channelCount; a++)
+				{
+					for (int b = 0; b < channelCount; b++)
+						next[a] += covariance[a][b] * axis[b];
+					largest = glm::max(largest, glm::abs(next[a]));
+				}
+				if (largest < 1e-6f)
+					break;
+
+				for (int c = 0; c < channelCount; c++)
+					axis[c] = next[c] / largest;
+			}
+
+			float lengthSquared = 0.0f;
+			for (int c = 0; c < channelCount; c++)
+				lengthSquared += axis[c] * axis[c];
+			if (lengthSquared < 1e-12f)
+			{
+				for (int c = 0; c < 4; c++)
+					outLow[c] = outHigh[c] = mean[c];
+				return;
+			}
+
+			float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+			for (int i = 0; i < 16; i++)
+			{
+				float projection = 0.0f;
+				for (int c = 0; c < channelCount; c++)
+					projection += (texels[i][c] - mean[c]) * axis[c];
+				minProjection = glm::min(minProjection, projection);
+				maxProjection = glm::max(maxProjection, projection);
+			}
+			minProjection /= lengthSquared;
+			maxProjection /= lengthSquared;
+
+			for (int c = 0; c < 4; c++)
+			{
+				outLow[c] = glm::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+				outHigh[c] = glm::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+			}
+		}
+
+		// Least squares endpoints for the chosen per texel interpolation weights (0 is the low endpoint, 1 the high one). Returns false if the system is degenerate
+		bool RefineEndpoints(const float texels[16][4], const float weights[16], int channelCount, float outLow[4], float outHigh[4])
+		{
+			float lowLow = 0.0f, highHigh = 0.0f, lowHigh = 0.0f;
+			float lowTexel[4] = {}, highTexel[4] = {};
+			for (int i = 0; i < 16; i++)
+			{
+				float highWeight = weights[i], lowWeight = 1.0f - weights[i];
+				lowLow += lowWeight * lowWeight;
+				highHigh += highWeight * highWeight;
+				lowHigh += lowWeight * highWeight;
+				for (int c = 0; c < channelCount; c++)
+				{
+					lowTexel[c] += lowWeight * texels[i][c];
+					highTexel[c] += highWeight * texels[i][c];
+				}
+			}
+
+			float determinant = lowLow * highHigh - lowHigh * lowHigh;
+			if (glm::abs(determinant) < 1e-6f)
+				return false;
+
+			float inverseDeterminant = 1.0f / determinant;
+			for (int c = 0; c < channelCount; c++)
+			{
+				outLow[c] = glm::clamp((highHigh * lowTexel[c] - lowHigh * highTexel[c]) * inverseDeterminant, 0.0f, 255.0f);
+				outHigh[c] = glm::clamp((lowLow * highTexel[c] - lowHigh * lowTexel[c]) * inverseDeterminant, 0.0f, 255.0f);
+			}
+			return true;
+		}
+
+		inline u16 PackRGB565(const float colour[3])
+		{
+			int r = glm::clamp(static_cast<int>(colour[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+			int g = glm::clamp(static_cast<int>(colour[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+			int b = glm::clamp(static_cast<int>(colour[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+			return static_cast<u16>((r << 11) | (g << 5) | b);
+		}
+
+		inline void UnpackRGB565(u16 packed, int outColour[3])
+		{
+			int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+			outColour[0] = (r << 3) | (r >> 2);
+			outColour[1] = (g << 2) | (g >> 4);
+			outColour[2] = (b << 3) | (b >> 2);
+		}
+
+		// Quantizes the endpoints and picks the indices, always in the 4 colour mode (colour0 > colour1). Returns the squared error
+		float EncodeBC1Endpoints(const float texels[16][4], const float endpointA[4], const float endpointB[4], u16 &outColour0, u16 &outColour1, u32 &outIndices)
+		{
+			outColour0 = PackRGB565(endpointA);
+			outColour1 = PackRGB565(endpointB);
+			if (outColour0 < outColour1)
+				std::swap(outColour0, outColour1);
+
+			int palette[4][3];
+			UnpackRGB565(outColour0, palette[0]);
+			UnpackRGB565(outColour1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			// Equal endpoints decode in the 3 colour mode, where only index 0 is guaranteed to be the endpoint colour
+			int paletteSize = outColour0 == outColour1 ? 1 : 4;
+
+			float error = 0.0f;
+			outIndices = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				float bestError = DistanceSquared(texels[i], palette[0], 3);
+				for (int index = 1; index < paletteSize; index++)
+				{
+					float indexError = DistanceSquared(texels[i], palette[index], 3);
+					if (indexError < bestError)
+					{
+						bestError = indexError;
+						bestIndex = index;
+					}
+				}
+				outIndices |= static_cast<u32>(bestIndex) << (i * 2);
+				error += bestError;
+			}
+			return error;
+		}
+
+		void EncodeBC1Colour(const float texels[16][4], unsigned char *outBlock)
+		{
+			float low[4], high[4];
+			FitEndpoints(texels, 3, low, high);
+
+			u16 colour0, colour1;
+			u32 indices;
+			float error = EncodeBC1Endpoints(texels, high, low, colour0, colour1, indices);
+
+			// A least squares pass with the chosen indices usually pulls the endpoints closer to the texels than the line's extents
+			if (error > 0.0f && colour0 != colour1)
+			{
+				float weights[16];
+				for (int i = 0; i < 16; i++)
+					weights[i] = BC1IndexWeights[(indices >> (i * 2)) & 3];
+
+				float refinedColour0[4], refinedColour1[4];
+				if (RefineEndpoints(texels, weights, 3, refinedColour0, refinedColour1))
+				{
+					u16 refined0, refined1;
+					u32 refinedIndices;
+					float refinedError = EncodeBC1Endpoints(texels, refinedColour0, refinedColour1, refined0, refined1, refinedIndices);
+					if (refinedError < error)
+					{
+						colour0 = refined0;
+						colour1 = refined1;
+						indices = refinedIndices;
+					}
+				}
+			}
+
+			memcpy(outBlock, &colour0, sizeof(u16));
+			memcpy(outBlock + 2, &colour1, sizeof(u16));
+			memcpy(outBlock + 4, &indices, sizeof(u32));
+		}
+
+		inline int QuantizeBC7Channel(float value, int pBit)
+		{
+			return glm::clamp(static_cast<int>(glm::floor((value - pBit) * 0.5f + 0.5f)), 0, 127);
+		}
+
+		// Mode 6 is a single subset with 7 bit RGBA endpoints plus a shared p-bit each and 4 bit indices. Returns the squared error and fills in the indices
+		float EvaluateBC7Mode6(const float texels[16][4], const int endpoint0[4], const int endpoint1[4], int outIndices[16])
+		{
+			int palette[16][4];
+			for (int index = 0; index < 16; index++)
+			{
+				for (int c = 0; c < 4; c++)
+					palette[index][c] = ((64 - BC7IndexWeights[index]) * endpoint0[c] + BC7IndexWeights[index] * endpoint1[c] + 32) >> 6;
+			}
+
+			float direction[4], directionLengthSquared = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				direction[c] = static_cast<float>(endpoint1[c] - endpoint0[c]);
+				directionLengthSquared += direction[c] * direction[c];
+			}
+
+			// The palette lies on a line so projecting the texel on to it finds the nearest entry, the neighbours are checked since the weights and rounding aren't perfectly even
+			float error = 0.0f;
+			for (int i = 0; i < 16; i++)
+			{
+				int guess = 0;
+				if (directionLengthSquared > 0.0f)
+				{
+					float projection = 0.0f;
+					for (int c = 0; c < 4; c++)
+						projection += (texels[i][c] - endpoint0[c]) * direction[c];
+					guess = glm::clamp(static_cast<int>(projection / directionLengthSquared * 15.0f + 0.5f), 0, 15);
+				}
+
+				int bestIndex = guess;
+				float bestError = DistanceSquared(texels[i], palette[guess], 4);
+				for (int index = glm::max(guess - 1, 0); index <= glm::min(guess + 1, 15); index++)
+				{
+					float indexError = DistanceSquared(texels[i], palette[index], 4);
+					if (indexError < bestError)
+					{
+						bestError = indexError;
+						bestIndex = index;
+					}
+				}
+				outIndices[i] = bestIndex;
+				error += bestError;
+			}
+			return error;
+		}
+
+		inline float SRGBToLinear(float value)
+		{
+			return value <= 0.04045f ? value / 12.92f : glm::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		inline float LinearToSRGB(float value)
+		{
+			return value <= 0.0031308f ? value * 12.92f : 1.055f * glm::pow(value, 1.0f / 2.4f) - 0.055f;
+		}
+
+		// Box filters the level down to the next mip. sRGB colour is averaged in linear space and normal maps are renormalized so the mips don't get shorter normals
+		void DownsampleLevel(const std::vector<unsigned char> &source, int sourceWidth, int sourceHeight, const CompressedImageInfo &info, std::vector<unsigned char> &outLevel)
+		{
+			static const std::array<float, 256> s_SRGBToLinearTable = []()
+			{
+				std::array<float, 256> table;
+				for (int i = 0; i < 256; i++)
+					table[i] = SRGBToLinear(i / 255.0f);
+				return table;
+			}();
+
+			int width = glm::max(1, sourceWidth / 2), height = glm::max(1, sourceHeight / 2);
+			outLevel.resize(static_cast<size_t>(width) * height * 4);
+			bool isNormalMap = info.Format == TextureCompression::BC5;
+
+			for (int y = 0; y < height; y++)
+			{
+				int sourceY[2] = { glm::min(y * 2, sourceHeight - 1), glm::min(y * 2 + 1, sourceHeight - 1) };
+				for (int x = 0; x < width; x++)
+				{
+					int sourceX[2] = { glm::min(x * 2, sourceWidth - 1), glm::min(x * 2 + 1, sourceWidth - 1) };
+
+					float sum[4] = {};
+					for (int sampleY = 0; sampleY < 2; sampleY++)
+					{
+						for (int sampleX = 0; sampleX < 2; sampleX++)
+						{
+							const unsigned char *texel = &source[(static_cast<size_t>(sourceY[sampleY]) * sourceWidth + sourceX[sampleX]) * 4];
+							for (int c = 0; c < 3; c++)
+							{
+								if (info.IsSRGB)
+									sum[c] += s_SRGBToLinearTable[texel[c]];
+								else if (isNormalMap)
+									sum[c] += texel[c] / 127.5f - 1.0f;
+								else
+									sum[c] += texel[c];
+							}
+							sum[3] += texel[3];
+						}
+					}
+
+					unsigned char *output = &outLevel[(static_cast<size_t>(y) * width + x) * 4];
+					if (info.IsSRGB)
+					{
+						for (int c = 0; c < 3; c++)
+							output[c] = static_cast<unsigned char>(glm::clamp(LinearToSRGB(sum[c] * 0.25f), 0.0f, 1.0f) * 255.0f + 0.5f);
+					}
+					else if (isNormalMap)
+					{
+						glm::vec3 normal(sum[0], sum[1], sum[2]);
+						float length = glm::length(normal);
+						normal = length > 1e-6f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+						for (int c = 0; c < 3; c++)
+							output[c] = static_cast<unsigned char>(glm::clamp(normal[c] * 127.5f + 127.5f, 0.0f, 255.0f) + 0.5f);
+					}
+					else
+					{
+						for (int c = 0; c < 3; c++)
+							output[c] = static_cast<unsigned char>(sum[c] * 0.25f + 0.5f);
+					}
+					output[3] = static_cast<unsigned char>(sum[3] * 0.25f + 0.5f);
+				}
+			}
+		}
+
+		void EncodeBlock(TextureCompression format, const unsigned char *rgba, unsigned char *outBlock)
+		{
+			switch (format)
+			{
+			case TextureCompression::BC1: TextureCompressor::EncodeBC1Block(rgba, outBlock); break;
+			case TextureCompression::BC3: TextureCompressor::EncodeBC3Block(rgba, outBlock); break;
+			case TextureCompression::BC4: TextureCompressor::EncodeBC4Block(rgba, 0, outBlock); break;
+			case TextureCompression::BC5: TextureCompressor::EncodeBC5Block(rgba, outBlock); break;
+			case TextureCompression::BC7: TextureCompressor::EncodeBC7Block(rgba, outBlock); break;
+			default: break;
+			}
+		}
+
+		void CompressLevel(const unsigned char *rgba, int width, int height, TextureCompression format, unsigned char *outData, bool multithreaded)
+		{
+			int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+			size_t blockSize = TextureCompressor::GetBlockSize(format);
+
+			auto encodeRows = [=](int firstRow, int lastRow)
+			{
+				unsigned char blockTexels[16 * 4];
+				for (int blockY = firstRow; blockY < lastRow; blockY++)
+				{
+					for (int blockX = 0; blockX < blocksX; blockX++)
+					{
+						// Edge blocks of levels that aren't a multiple of 4 repeat the last row/column
+						for (int y = 0; y < 4; y++)
+						{
+							int texelY = glm::min(blockY * 4 + y, height - 1);
+							for (int x = 0; x < 4; x++)
+							{
+								int texelX = glm::min(blockX * 4 + x, width - 1);
+								memcpy(&blockTexels[(y * 4 + x) * 4], &rgba[(static_cast<size_t>(texelY) * width + texelX) * 4], 4);
+							}
+						}
+						EncodeBlock(format, blockTexels, outData + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize);
+					}
+				}
+			};
+
+			if (!multithreaded || blocksY <= BlockRowsPerJob)
+			{
+				encodeRows(0, blocksY);
+				return;
+			}
+
+			// Waiting helps execute the row jobs, so this is fine to call from a job that is loading the texture
+			JobSystem &jobSystem = JobSystem::GetInstance();
+			std::vector<JobHandle> rowJobs;
+			rowJobs.reserve((blocksY + BlockRowsPerJob - 1) / BlockRowsPerJob);
+			for (int firstRow = 0; firstRow < blocksY; firstRow += BlockRowsPerJob)
+			{
+				int lastRow = glm::min(firstRow + BlockRowsPerJob, blocksY);
+				rowJobs.push_back(jobSystem.Submit([&encodeRows, firstRow, lastRow]() { encodeRows(firstRow, lastRow); }));
+			}
+			for (const JobHandle &rowJob : rowJobs)
+			{
+				jobSystem.Wait(rowJob);
+			}
+		}
+	}
+
+	TextureCompression TextureCompressor::ChooseFormat(const unsigned char *pixels, int width, int height, int componentCount, bool isSRGB)
+	{
+		// The smallest textures aren't worth the block artifacts
+		if (width < 4 || height < 4 || (componentCount != 1 && componentCount != 3 && componentCount != 4))
+			return TextureCompression::None;
+		// BC4 only stores red and has no sRGB variant, so it is kept for sources that really have a single channel. Nothing swizzles it back out to green and
+		// blue, an RGB source that happens to be grey would lose the channels a shader reads
+		if (componentCount == 1)
+			return isSRGB ? TextureCompression::BC1 : TextureCompression::BC4;
+
+		// Only sample up to ~64k texels so classifying large textures stays cheap
+		size_t texelCount = static_cast<size_t>(width) * height;
+		size_t step = glm::max<size_t>(1, texelCount / 65536);
+		size_t sampleCount = 0, normalCount = 0;
+		bool isOpaque = true;
+		for (size_t i = 0; i < texelCount; i += step)
+		{
+			const unsigned char *texel = pixels + i * componentCount;
+			int r = texel[0], g = texel[1], b = texel[2];
+			if (componentCount == 4 && texel[3] < 255)
+				isOpaque = false;
+
+			// Tangent space normals are unit length and point out of the surface
+			glm::vec3 normal(r / 127.5f - 1.0f, g / 127.5f - 1.0f, b / 127.5f - 1.0f);
+			float lengthSquared = glm::dot(normal, normal);
+			if (normal.z >= 0.0f && lengthSquared > 0.8f * 0.8f && lengthSquared < 1.2f * 1.2f)
+				normalCount++;
+			sampleCount++;
+		}
+
+		if (isSRGB)
+			return isOpaque ? TextureCompression::BC1 : TextureCompression::BC7;
+		if (isOpaque && normalCount * 100 >= sampleCount * 95)
+			return TextureCompression::BC5;
+		return TextureCompression::BC7;
+	}
+
+	void TextureCompressor::Compress(const unsigned char *pixels, int width, int height, int componentCount, const CompressedImageInfo &info, unsigned char *outData, bool multithreaded)
+	{
+		// Everything is expanded to RGBA8 first so the mip filter and the encoders only deal with one layout
+		std::vector<unsigned char> level(static_cast<size_t>(width) * height * 4);
+		for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+		{
+			const unsigned char *source = pixels + i * componentCount;
+			unsigned char *destination = &level[i * 4];
+			destination[0] = source[0];
+			destination[1] = componentCount >= 3 ? source[1] : source[0];
+			destination[2] = componentCount >= 3 ? source[2] : source[0];
+			destination[3] = componentCount == 4 ? source[3] : 255;
+		}
+
+		std::vector<unsigned char> nextLevel;
+		int mipWidth = width, mipHeight = height;
+		unsigned char *mipOutput = outData;
+		for (int mip = 0; mip < info.MipCount; mip++)
+		{
+			if (mip > 0)
+			{
+				DownsampleLevel(level, mipWidth, mipHeight, info, nextLevel);
+				level.swap(nextLevel);
+				mipWidth = glm::max(1, mipWidth / 2);
+				mipHeight = glm::max(1, mipHeight / 2);
+			}
+
+			CompressLevel(level.data(), mipWidth, mipHeight, info.Format, mipOutput, multithreaded);
+			mipOutput += static_cast<size_t>((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * GetBlockSize(info.Format);
+		}
+	}
+
+	int TextureCompressor::GetFullMipCount(int width, int height)
+	{
+		int mipCount = 1;
+		for (int size = glm::max(width, height); size > 1; size /= 2)
+			mipCount++;
+		return mipCount;
+	}
+
+	size_t TextureCompressor::GetBlockSize(TextureCompression format)
+	{
+		switch (format)
+		{
+		case TextureCompression::BC1:
+		case TextureCompression::BC4:
+			return 8;
+		case TextureCompression::BC3:
+		case TextureCompression::BC5:
+		case TextureCompression::BC7:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	size_t TextureCompressor::GetCompressedSize(const CompressedImageInfo &info)
+	{
+		size_t size = 0;
+		int mipWidth = info.Width, mipHeight = info.Height;
+		for (int mip = 0; mip < info.MipCount; mip++)
+		{
+			size += static_cast<size_t>((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * GetBlockSize(info.Format);
+			mipWidth = glm::max(1, mipWidth / 2);
+			mipHeight = glm::max(1, mipHeight / 2);
+		}
+		return size;
+	}
+
+	GLenum TextureCompressor::GetGLFormat(TextureCompression format, bool isSRGB)
+	{
+		switch (format)
+		{
+		case TextureCompression::BC1: return isSRGB ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TextureCompression::BC3: return isSRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case TextureCompression::BC4: return GL_COMPRESSED_RED_RGTC1;
+		case TextureCompression::BC5: return GL_COMPRESSED_RG_RGTC2;
+		case TextureCompression::BC7: return isSRGB ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+		default: return GL_NONE;
+		}
+	}
+
+	const char* TextureCompressor::GetFormatName(TextureCompression format)
+	{
+		switch (format)
+		{
+		case TextureCompression::Auto: return "Auto";
+		case TextureCompression::None: return "None";
+		case TextureCompression::BC1: return "BC1";
+		case TextureCompression::BC3: return "BC3";
+		case TextureCompression::BC4: return "BC4";
+		case TextureCompression::BC5: return "BC5";
+		case TextureCompression::BC7: return "BC7";
+		}
+		return "Unknown";
+	}
+
+	void TextureCompressor::EncodeBC1Block(const unsigned char *rgba, unsigned char *outBlock)
+	{
+		float texels[16][4];
+		LoadTexels(rgba, texels);
+		EncodeBC1Colour(texels, outBlock);
+	}
+
+	void TextureCompressor::EncodeBC3Block(const unsigned char *rgba, unsigned char *outBlock)
+	{
+		// BC3 is a BC4 alpha block followed by a BC1 colour block
+		EncodeBC4Block(rgba, 3, outBlock);
+		EncodeBC1Block(rgba, outBlock + 8);
+	}
+
+	void TextureCompressor::EncodeBC4Block(const unsigned char *rgba, int channel, unsigned char *outBlock)
+	{
+		int minimum = 255, maximum = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minimum = glm::min(minimum, static_cast<int>(rgba[i * 4 + channel]));
+			maximum = glm::max(maximum, static_cast<int>(rgba[i * 4 + channel]));
+		}
+
+		memset(outBlock, 0, 8);
+		outBlock[0] = static_cast<unsigned char>(maximum);
+		outBlock[1] = static_cast<unsigned char>(minimum);
+		if (maximum == minimum)
+			return;
+
+		// Endpoint0 > endpoint1 selects the 8 value mode, indices 2-7 step from endpoint0 towards endpoint1
+		int palette[8] = { maximum, minimum };
+		for (int i = 1; i < 7; i++)
+			palette[i + 1] = ((7 - i) * maximum + i * minimum + 3) / 7;
+
+		u64 indices = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int value = rgba[i * 4 + channel];
+			int bestIndex = 0, bestError = INT_MAX;
+			for (int index = 0; index < 8; index++)
+			{
+				int error = glm::abs(value - palette[index]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			indices |= static_cast<u64>(bestIndex) << (i * 3);
+		}
+
+		for (int i = 0; i < 6; i++)
+			outBlock[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+	}
+
+	void TextureCompressor::EncodeBC5Block(const unsigned char *rgba, unsigned char *outBlock)
+	{
+		EncodeBC4Block(rgba, 0, outBlock);
+		EncodeBC4Block(rgba, 1, outBlock + 8);
+	}
+
+	void TextureCompressor::EncodeBC7Block(const unsigned char *rgba, unsigned char *outBlock)
+	{
+		float texels[16][4];
+		LoadTexels(rgba, texels);
+
+		float low[4], high[4];
+		FitEndpoints(texels, 4, low, high);
+
+		float bestError = FLT_MAX;
+		int bestEndpoints[2][4], bestPBits[2], bestIndices[16];
+		for (int attempt = 0; attempt < 2; attempt++)
+		{
+			// Every p-bit combination is tried since the shared bit moves all four channels of an endpoint at once
+			for (int pBits = 0; pBits < 4; pBits++)
+			{
+				int pBit0 = pBits & 1, pBit1 = pBits >> 1;
+				int quantized[2][4], endpoint0[4], endpoint1[4], indices[16];
+				for (int c = 0; c < 4; c++)
+				{
+					quantized[0][c] = QuantizeBC7Channel(low[c], pBit0);
+					quantized[1][c] = QuantizeBC7Channel(high[c], pBit1);
+					endpoint0[c] = (quantized[0][c] << 1) | pBit0;
+					endpoint1[c] = (quantized[1][c] << 1) | pBit1;
+				}
+
+				float error = EvaluateBC7Mode6(texels, endpoint0, endpoint1, indices);
+				if (error < bestError)
+				{
+					bestError = error;
+					memcpy(bestEndpoints, quantized, sizeof(bestEndpoints));
+					bestPBits[0] = pBit0;
+					bestPBits[1] = pBit1;
+					memcpy(bestIndices, indices, sizeof(bestIndices));
+				}
+			}
+
+			if (attempt > 0 || bestError == 0.0f)
+				break;
+
+			float weights[16];
+			for (int i = 0; i < 16; i++)
+				weights[i] = BC7IndexWeights[bestIndices[i]] / 64.0f;
+			if (!RefineEndpoints(texels, weights, 4, low, high))
+				break;
+		}
+
+		// The first texel's index is stored without its top bit, so the endpoints are swapped if it would need it
+		if (bestIndices[0] >= 8)
+		{
+			for (int c = 0; c < 4; c++)
+				std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+			std::swap(bestPBits[0], bestPBits[1]);
+			for (int i = 0; i < 16; i++)
+				bestIndices[i] = 15 - bestIndices[i];
+		}
+
+		memset(outBlock, 0, 16);
+		BlockBitWriter writer(outBlock);
+		writer.Write(1 << 6, 7); // Mode 6
+		for (int c = 0; c < 4; c++)
+		{
+			writer.Write(bestEndpoints[0][c], 7);
+			writer.Write(bestEndpoints[1][c], 7);
+		}
+		writer.Write(bestPBits[0], 1);
+		writer.Write(bestPBits[1], 1);
+		writer.Write(bestIndices[0], 3);
+		for (int i = 1; i < 16; i++)
+			writer.Write(bestIndices[i], 4);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef TEXTURECOMPRESSOR_H
+#define TEXTURECOMPRESSOR_H
+
+#ifndef TEXTURE_H
+#include <Arcane/Graphics/Texture/Texture.h>
+#endif
+
+namespace Arcane
+{
+	struct CompressedImageInfo
+	{
+		int Width, Height;
+		int MipCount;
+		TextureCompression Format;
+		bool IsSRGB;
+	};
+
+	// Offline block compressor used when textures are cooked. It builds the mip chain on the CPU (in linear space for sRGB textures and renormalized for normal maps)
+	// and encodes every level, spreading rows of blocks across the job system. Compressed data is laid out tightly packed, mip 0 first, which is what the DDS container and GL want
+	class TextureCompressor
+	{
+	public:
+		// Picks a format from the image's contents: BC5 for normal maps, BC4 for single channel linear sources and BC1/BC7 for everything else depending on alpha and colour space
+		static TextureCompression ChooseFormat(const unsigned char *pixels, int width, int height, int componentCount, bool isSRGB);
+
+		// Compresses the image and its mips into outData, which needs to be GetCompressedSize bytes. Single threaded mode is only used for benchmarking
+		static void Compress(const unsigned char *pixels, int width, int height, int componentCount, const CompressedImageInfo &info, unsigned char *outData, bool multithreaded = true);
+
+		static int GetFullMipCount(int width, int height);
+		static size_t GetBlockSize(TextureCompression format);
+		static size_t GetCompressedSize(const CompressedImageInfo &info);
+		static GLenum GetGLFormat(TextureCompression format, bool isSRGB);
+		static const char* GetFormatName(TextureCompression format);
+
+		// Block encoders, rgba points to 16 texels (4x4, row major) with 4 components each
+		static void EncodeBC1Block(const unsigned char *rgba, unsigned char *outBlock);
+		static void EncodeBC3Block(const unsigned char *rgba, unsigned char *outBlock);
+		static void EncodeBC4Block(const unsigned char *rgba, int channel, unsigned char *outBlock);
+		static void EncodeBC5Block(const unsigned char *rgba, unsigned char *outBlock);
+		static void EncodeBC7Block(const unsigned char *rgba, unsigned char *outBlock);
+	};
+}
+#endif
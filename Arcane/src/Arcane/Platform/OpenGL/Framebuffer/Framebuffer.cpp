@@ -164,6 +164,26 @@ namespace Arcane
 		glFramebufferTexture2D(GL_FRAMEBUFFER, attachmentType, targetType, target, 0);
 	}
 
+	void Framebuffer::SetDepthAttachmentLayer(DepthStencilAttachmentFormat textureFormat, unsigned int target, int layer) {
+		GLenum attachmentType = GL_DEPTH_STENCIL_ATTACHMENT;
+		if (textureFormat == NormalizedDepthOnly)
+		{
+			attachmentType = GL_DEPTH_ATTACHMENT;
+		}
+
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, attachmentType, target, 0, layer);
+	}
+
+	void Framebuffer::SetDepthAttachmentLayered(DepthStencilAttachmentFormat textureFormat, unsigned int target) {
+		GLenum attachmentType = GL_DEPTH_STENCIL_ATTACHMENT;
+		if (textureFormat == NormalizedDepthOnly)
+		{
+			attachmentType = GL_DEPTH_ATTACHMENT;
+		}
+
+		glFramebufferTexture(GL_FRAMEBUFFER, attachmentType, target, 0);
+	}
+
 	void Framebuffer::Bind() {
 		glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
 	}
@@ -46,6 +46,8 @@ namespace Arcane
 		// Assumes framebuffer is bound
 		void SetColorAttachment(unsigned int target, unsigned int targetType, int mipToWriteTo = 0);
 		void SetDepthAttachment(DepthStencilAttachmentFormat textureFormat, unsigned int target, unsigned int targetType);
+		void SetDepthAttachmentLayer(DepthStencilAttachmentFormat textureFormat, unsigned int target, int layer); // For rendering to one layer of an array texture
+		void SetDepthAttachmentLayered(DepthStencilAttachmentFormat textureFormat, unsigned int target); // Attaches every layer of an array texture or cubemap, the geometry shader picks one with gl_Layer
 		void ClearAll();
 		void ClearColour();
 		void ClearDepth();
@@ -0,0 +1,55 @@
+#include "arcpch.h"
+#include "ShaderStorageBuffer.h"
+
+namespace Arcane
+{
+	// Binding a buffer without a data store isn't allowed, so even empty buffers get a little storage
+	static constexpr size_t s_MinCapacity = 16;
+
+	ShaderStorageBuffer::ShaderStorageBuffer(ShaderStorageBufferBinding binding) : m_Capacity(0), m_Binding(binding), m_HasData(false)
+	{
+		glGenBuffers(1, &m_BufferID);
+		Reserve(s_MinCapacity);
+	}
+
+	ShaderStorageBuffer::~ShaderStorageBuffer()
+	{
+		glDeleteBuffers(1, &m_BufferID);
+	}
+
+	bool ShaderStorageBuffer::SetData(const void *data, size_t size)
+	{
+		if (m_HasData && m_UploadedData.size() == size && std::memcmp(m_UploadedData.data(), data, size) == 0)
+			return false;
+
+		m_UploadedData.assign(static_cast<const u8*>(data), static_cast<const u8*>(data) + size);
+		m_HasData = true;
+
+		Reserve(size);
+		if (size > 0)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_BufferID);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		}
+		return true;
+	}
+
+	void ShaderStorageBuffer::Reserve(size_t size)
+	{
+		if (size <= m_Capacity)
+			return;
+
+		// Doubling keeps a scene that keeps adding lights from reallocating every frame
+		m_Capacity = glm::max(glm::max(size, m_Capacity * 2), s_MinCapacity);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_BufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_Capacity, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		Bind();
+	}
+
+	void ShaderStorageBuffer::Bind() const
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Binding, m_BufferID);
+	}
+}
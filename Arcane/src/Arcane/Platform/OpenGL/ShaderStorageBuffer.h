@@ -0,0 +1,42 @@
+#pragma once
+#ifndef SHADERSTORAGEBUFFER_H
+#define SHADERSTORAGEBUFFER_H
+
+namespace Arcane
+{
+	// Fixed binding points for storage buffers that stay bound while passes draw. 0 to 3 are rebound by every GPU skinning dispatch so they aren't used here
+	enum ShaderStorageBufferBinding
+	{
+		ShaderStorageBufferBindingPointLights = 4,			// PointLightBuffer
+		ShaderStorageBufferBindingSpotLights = 5,			// SpotLightBuffer
+		ShaderStorageBufferBindingLightClusterCounts = 6,	// LightClusterCounts
+		ShaderStorageBufferBindingLightClusterIndices = 7	// LightClusterIndices
+	};
+
+	// std430 storage buffer that grows to fit whatever it is given. Like UniformBuffer it keeps a copy of what was last uploaded, so setting the same contents
+	// again is a memcmp instead of a GL call. Buffers the GPU fills itself only need to be reserved
+	class ShaderStorageBuffer
+	{
+	public:
+		ShaderStorageBuffer(ShaderStorageBufferBinding binding);
+		~ShaderStorageBuffer();
+
+		// Returns true if the data was different and got uploaded
+		bool SetData(const void *data, size_t size);
+
+		// Makes room for at least size bytes, the contents are lost if the buffer has to grow
+		void Reserve(size_t size);
+
+		void Bind() const;
+
+		inline size_t GetCapacity() const { return m_Capacity; }
+		inline ShaderStorageBufferBinding GetBinding() const { return m_Binding; }
+	private:
+		unsigned int m_BufferID;
+		size_t m_Capacity;
+		ShaderStorageBufferBinding m_Binding;
+		std::vector<u8> m_UploadedData;
+		bool m_HasData;
+	};
+}
+#endif
@@ -0,0 +1,161 @@
+#include "arcpch.h"
+#include "StagingRingBuffer.h"
+
+namespace Arcane
+{
+	static constexpr size_t StagingAllocationAlignment = 256; // Keeps every allocation suitably aligned for any pixel or vertex format read out of it
+
+	StagingRingBuffer::StagingRingBuffer() : m_BufferID(0), m_MappedData(nullptr), m_Size(0), m_Head(0), m_Tail(0), m_FailedAllocationCount(0), m_CurrentFrame(1), m_CompletedFrame(0), m_ReleasedThisFrame(false)
+	{
+	}
+
+	StagingRingBuffer::~StagingRingBuffer()
+	{
+		Shutdown();
+	}
+
+	void StagingRingBuffer::Init(size_t size)
+	{
+		if (IsInitialized() || size == 0)
+			return;
+
+		// Coherent so writes from the workers are visible to commands issued after them without any explicit flushing
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &m_BufferID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+		m_MappedData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		if (!m_MappedData)
+		{
+			ARC_LOG_WARN("Failed to persistently map a {0}MB staging buffer, assets will be uploaded from client memory", size / (1024 * 1024));
+			glDeleteBuffers(1, &m_BufferID);
+			m_BufferID = 0;
+			return;
+		}
+		m_Size = size;
+	}
+
+	void StagingRingBuffer::Shutdown()
+	{
+		for (FrameFence &frameFence : m_Fences)
+		{
+			glDeleteSync(frameFence.Fence);
+		}
+		m_Fences.clear();
+
+		if (m_BufferID != 0)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glDeleteBuffers(1, &m_BufferID);
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_BufferID = 0;
+		m_MappedData = nullptr;
+		m_Size = 0;
+		m_Head = m_Tail = 0;
+		m_Blocks.clear();
+	}
+
+	StagingAllocation StagingRingBuffer::Allocate(size_t size)
+	{
+		StagingAllocation allocation;
+		size_t alignedSize = (size + (StagingAllocationAlignment - 1)) & ~(StagingAllocationAlignment - 1);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (!m_MappedData || size == 0 || alignedSize > m_Size)
+			return allocation;
+
+		// Allocations are contiguous, so skip the space left at the end of the buffer if this one would wrap
+		u64 begin = m_Head;
+		u64 offset = begin % m_Size;
+		if (offset + alignedSize > m_Size)
+		{
+			begin += m_Size - offset;
+			offset = 0;
+		}
+		u64 end = begin + alignedSize;
+		if (end - m_Tail > m_Size)
+		{
+			m_FailedAllocationCount++;
+			return allocation;
+		}
+
+		m_Blocks.push_back({ m_Head, end, 0 });
+		m_Head = end;
+
+		allocation.Owner = this;
+		allocation.Data = m_MappedData + offset;
+		allocation.Offset = static_cast<size_t>(offset);
+		allocation.Size = size;
+		allocation.End = end;
+		return allocation;
+	}
+
+	void StagingRingBuffer::Release(const StagingAllocation &allocation)
+	{
+		if (!allocation.IsValid())
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (Block &block : m_Blocks)
+		{
+			if (block.End == allocation.End)
+			{
+				block.ReleaseFrame = m_CurrentFrame;
+				m_ReleasedThisFrame = true;
+				break;
+			}
+		}
+	}
+
+	void StagingRingBuffer::EndFrame()
+	{
+		if (!IsInitialized())
+			return;
+
+		if (m_ReleasedThisFrame)
+		{
+			m_Fences.push_back({ m_CurrentFrame, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+			m_ReleasedThisFrame = false;
+			m_CurrentFrame++;
+		}
+
+		// Fences signal in order, so stop at the first one that hasn't. A zero timeout means this never stalls, the flush makes sure the fence
+		// gets submitted even when nothing is presenting (ie the blocking load before the first frame)
+		while (!m_Fences.empty())
+		{
+			GLenum result = glClientWaitSync(m_Fences.front().Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+				break;
+
+			m_CompletedFrame = m_Fences.front().Frame;
+			glDeleteSync(m_Fences.front().Fence);
+			m_Fences.pop_front();
+		}
+
+		// Blocks are reclaimed in allocation order, one that is still being filled or waiting for its upload holds back the ones after it
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		while (!m_Blocks.empty() && m_Blocks.front().ReleaseFrame != 0 && m_Blocks.front().ReleaseFrame <= m_CompletedFrame)
+		{
+			m_Tail = m_Blocks.front().End;
+			m_Blocks.pop_front();
+		}
+	}
+
+	size_t StagingRingBuffer::GetUsedSize() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return static_cast<size_t>(m_Head - m_Tail);
+	}
+
+	u64 StagingRingBuffer::GetFailedAllocationCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_FailedAllocationCount;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef STAGINGRINGBUFFER_H
+#define STAGINGRINGBUFFER_H
+
+#include <deque>
+
+namespace Arcane
+{
+	class StagingRingBuffer;
+
+	struct StagingAllocation
+	{
+		StagingRingBuffer *Owner = nullptr;
+		unsigned char *Data = nullptr; // Persistently mapped memory the payload gets written to
+		size_t Offset = 0; // Offset in the staging buffer, this is what the GL upload calls read from while it is bound
+		size_t Size = 0;
+		u64 End = 0; // Ring position right after the allocation, identifies it when it is released
+
+		inline bool IsValid() const { return Data != nullptr; }
+	};
+
+	// Persistently mapped buffer that asset data is staged in before it is uploaded. Worker threads allocate and fill space in the ring, the main thread issues
+	// the GL copies out of it and releases the space. Released space is only reused once a fence placed after the copies has signalled, so the CPU never
+	// overwrites data the GPU is still reading
+	class StagingRingBuffer
+	{
+	public:
+		StagingRingBuffer();
+		~StagingRingBuffer();
+
+		// Main thread only, requires a GL context
+		void Init(size_t size);
+		void Shutdown();
+
+		// Thread safe. Returns an invalid allocation if there isn't room, callers should upload from their own memory instead of waiting on the GPU
+		StagingAllocation Allocate(size_t size);
+
+		// Main thread only. Call after the upload commands reading from the allocation have been issued
+		void Release(const StagingAllocation &allocation);
+
+		// Main thread only, once per frame after the uploads. Fences the frame's releases and reclaims any space whose fence has signalled
+		void EndFrame();
+
+		size_t GetUsedSize() const;
+		u64 GetFailedAllocationCount() const; // Allocations turned away because the ring was full
+		inline size_t GetSize() const { return m_Size; }
+		inline unsigned int GetBufferID() const { return m_BufferID; }
+		inline bool IsInitialized() const { return m_MappedData != nullptr; }
+	private:
+		struct Block
+		{
+			u64 Begin, End; // Ring positions, Begin includes any padding skipped to avoid wrapping
+			u64 ReleaseFrame; // 0 until the main thread releases the block
+		};
+
+		struct FrameFence
+		{
+			u64 Frame;
+			GLsync Fence;
+		};
+
+		unsigned int m_BufferID;
+		unsigned char *m_MappedData;
+		size_t m_Size;
+
+		// Positions only ever increase, the offset in the buffer is the position modulo the size
+		mutable std::mutex m_Mutex;
+		u64 m_Head, m_Tail;
+		std::deque<Block> m_Blocks;
+		u64 m_FailedAllocationCount;
+
+		// Main thread only
+		std::deque<FrameFence> m_Fences;
+		u64 m_CurrentFrame;
+		u64 m_CompletedFrame;
+		bool m_ReleasedThisFrame;
+	};
+}
+#endif
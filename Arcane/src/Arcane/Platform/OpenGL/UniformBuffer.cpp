@@ -0,0 +1,57 @@
+#include "arcpch.h"
+#include "UniformBuffer.h"
+
+namespace Arcane
+{
+	UniformBuffer::UniformBuffer(size_t size, UniformBufferBinding binding) : m_Size(size), m_Binding(binding), m_UploadedData(size), m_HasData(false)
+	{
+		glGenBuffers(1, &m_BufferID);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		Bind();
+	}
+
+	UniformBuffer::~UniformBuffer()
+	{
+		glDeleteBuffers(1, &m_BufferID);
+	}
+
+	bool UniformBuffer::SetData(const void *data, size_t size)
+	{
+		ARC_ASSERT(size <= m_Size, "Uniform buffer data is larger than the buffer");
+		if (m_HasData && std::memcmp(m_UploadedData.data(), data, size) == 0)
+			return false;
+
+		std::memcpy(m_UploadedData.data(), data, size);
+		m_HasData = true;
+
+		glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		return true;
+	}
+
+	void UniformBuffer::Bind() const
+	{
+		glBindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_BufferID);
+	}
+
+	const char* UniformBuffer::GetBlockName(UniformBufferBinding binding)
+	{
+		switch (binding)
+		{
+		case UniformBufferBindingCamera:
+			return "CameraUniforms";
+		case UniformBufferBindingLights:
+			return "LightUniforms";
+		case UniformBufferBindingShadows:
+			return "ShadowUniforms";
+		case UniformBufferBindingLightClusters:
+			return "LightClusterUniforms";
+		default:
+			ARC_ASSERT(false, "Unknown uniform buffer binding");
+			return "";
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef UNIFORMBUFFER_H
+#define UNIFORMBUFFER_H
+
+namespace Arcane
+{
+	// Fixed binding points shared by every shader that declares the matching std140 block, so buffers only get bound once and never per shader
+	enum UniformBufferBinding
+	{
+		UniformBufferBindingCamera = 0,		// CameraUniforms
+		UniformBufferBindingLights = 1,		// LightUniforms
+		UniformBufferBindingShadows = 2,	// ShadowUniforms
+		UniformBufferBindingLightClusters = 3,	// LightClusterUniforms
+		UniformBufferBindingCount
+	};
+
+	// std140 uniform buffer that keeps a copy of what was last uploaded. Setting the same contents again is a memcmp instead of a GL call,
+	// which lets the passes push their data every time they run while the buffer only gets written when something actually changed
+	class UniformBuffer
+	{
+	public:
+		UniformBuffer(size_t size, UniformBufferBinding binding);
+		~UniformBuffer();
+
+		// Returns true if the data was different and got uploaded
+		bool SetData(const void *data, size_t size);
+
+		void Bind() const;
+
+		inline size_t GetSize() const { return m_Size; }
+		inline UniformBufferBinding GetBinding() const { return m_Binding; }
+
+		static const char* GetBlockName(UniformBufferBinding binding);
+	private:
+		unsigned int m_BufferID;
+		size_t m_Size;
+		UniformBufferBinding m_Binding;
+		std::vector<u8> m_UploadedData;
+		bool m_HasData;
+	};
+}
+#endif
@@ -0,0 +1,539 @@
+#include "arcpch.h"
+#include "BVH.h"
+
+#include <Arcane/Graphics/Camera/Frustum.h>
+
+namespace Arcane
+{
+	namespace
+	{
+		static constexpr int SAHBinCount = 16;
+
+		// Traversal stack that only touches the heap for unusually deep trees
+		class TraversalStack
+		{
+		public:
+			inline void Push(int node)
+			{
+				if (m_Count < InlineCapacity)
+					m_Inline[m_Count] = node;
+				else
+					m_Overflow.push_back(node);
+				m_Count++;
+			}
+
+			inline int Pop()
+			{
+				m_Count--;
+				if (m_Count < InlineCapacity)
+					return m_Inline[m_Count];
+
+				int node = m_Overflow.back();
+				m_Overflow.pop_back();
+				return node;
+			}
+
+			inline bool IsEmpty() const { return m_Count == 0; }
+		private:
+			static constexpr int InlineCapacity = 64;
+			int m_Inline[InlineCapacity];
+			std::vector<int> m_Overflow;
+			int m_Count = 0;
+		};
+
+		bool RayIntersectsAABB(const glm::vec3 &origin, const glm::vec3 &inverseDirection, const AABB &bounds, float maxDistance, float &outEnterDistance)
+		{
+			glm::vec3 t1 = (bounds.Min - origin) * inverseDirection;
+			glm::vec3 t2 = (bounds.Max - origin) * inverseDirection;
+			glm::vec3 tNear = glm::min(t1, t2), tFar = glm::max(t1, t2);
+
+			float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+			float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+			outEnterDistance = enter;
+			return enter <= exit;
+		}
+
+		bool SphereIntersectsAABB(const glm::vec3 &center, float radiusSquared, const AABB &bounds)
+		{
+			glm::vec3 closestPoint = glm::clamp(center, bounds.Min, bounds.Max);
+			return glm::length2(closestPoint - center) <= radiusSquared;
+		}
+	}
+
+	BVH::BVH(float fatMargin) : m_Root(BVHNullNode), m_LeafCount(0), m_FatMargin(fatMargin)
+	{
+	}
+
+	void BVH::Clear()
+	{
+		m_Nodes.clear();
+		m_FreeNodes.clear();
+		m_Root = BVHNullNode;
+		m_LeafCount = 0;
+	}
+
+	void BVH::Build(const std::vector<AABB> &bounds, const std::vector<u32> &userData)
+	{
+		Clear();
+		if (bounds.empty())
+			return;
+
+		// Leaves take the first indices, so a leaf's node index is also the index of its item
+		int itemCount = static_cast<int>(bounds.size());
+		m_Nodes.reserve(2 * itemCount - 1);
+		std::vector<int> leaves(itemCount);
+		std::vector<glm::vec3> centroids(itemCount);
+		for (int i = 0; i < itemCount; i++)
+		{
+			int leaf = AllocateNode();
+			m_Nodes[leaf].Bounds = Fatten(bounds[i]);
+			m_Nodes[leaf].InsertedBounds = m_Nodes[leaf].Bounds;
+			m_Nodes[leaf].UserData = userData[i];
+			leaves[i] = leaf;
+			centroids[i] = bounds[i].GetCenter();
+		}
+
+		m_LeafCount = itemCount;
+		m_Root = BuildRange(leaves, centroids, 0, itemCount, BVHNullNode);
+	}
+
+	int BVH::BuildRange(std::vector<int> &leaves, const std::vector<glm::vec3> &centroids, int begin, int end, int parent)
+	{
+		int count = end - begin;
+		if (count == 1)
+		{
+			m_Nodes[leaves[begin]].Parent = parent;
+			return leaves[begin];
+		}
+
+		// Split along the axis the centroids are most spread out on
+		AABB centroidBounds;
+		for (int i = begin; i < end; i++)
+		{
+			centroidBounds.Expand(centroids[leaves[i]]);
+		}
+		glm::vec3 centroidExtents = centroidBounds.Max - centroidBounds.Min;
+		int axis = (centroidExtents.x > centroidExtents.y && centroidExtents.x > centroidExtents.z) ? 0 : (centroidExtents.y > centroidExtents.z ? 1 : 2);
+		float axisMin = centroidBounds.Min[axis];
+		float axisExtent = centroidExtents[axis];
+
+		int middle = begin + count / 2;
+		if (axisExtent > 0.0f)
+		{
+			// Bin the centroids and evaluate the surface area heuristic for the split after each bin
+			AABB binBounds[SAHBinCount];
+			int binCounts[SAHBinCount] = {};
+			float binScale = static_cast<float>(SAHBinCount) / axisExtent;
+			auto getBin = [&](int leaf)
+			{
+				return glm::min(static_cast<int>((centroids[leaf][axis] - axisMin) * binScale), SAHBinCount - 1);
+			};
+
+			for (int i = begin; i < end; i++)
+			{
+				int bin = getBin(leaves[i]);
+				binCounts[bin]++;
+				binBounds[bin].Expand(m_Nodes[leaves[i]].Bounds);
+			}
+
+			float rightAreas[SAHBinCount];
+			int rightCounts[SAHBinCount];
+			AABB accumulated;
+			int accumulatedCount = 0;
+			for (int bin = SAHBinCount - 1; bin > 0; bin--)
+			{
+				accumulated.Expand(binBounds[bin]);
+				accumulatedCount += binCounts[bin];
+				rightAreas[bin] = accumulatedCount > 0 ? accumulated.GetSurfaceArea() : 0.0f;
+				rightCounts[bin] = accumulatedCount;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			int bestSplit = -1;
+			accumulated = AABB();
+			accumulatedCount = 0;
+			for (int bin = 0; bin < SAHBinCount - 1; bin++)
+			{
+				accumulated.Expand(binBounds[bin]);
+				accumulatedCount += binCounts[bin];
+				if (accumulatedCount == 0 || rightCounts[bin + 1] == 0)
+					continue;
+
+				float cost = accumulatedCount * accumulated.GetSurfaceArea() + rightCounts[bin + 1] * rightAreas[bin + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = bin;
+				}
+			}
+
+			if (bestSplit != -1)
+			{
+				middle = static_cast<int>(std::partition(leaves.begin() + begin, leaves.begin() + end, [&](int leaf) { return getBin(leaf) <= bestSplit; }) - leaves.begin());
+			}
+			else
+			{
+				std::nth_element(leaves.begin() + begin, leaves.begin() + middle, leaves.begin() + end, [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+			}
+		}
+
+		// Nodes are only ever referred to by index here, allocating can move the node storage
+		int node = AllocateNode();
+		int left = BuildRange(leaves, centroids, begin, middle, node);
+		int right = BuildRange(leaves, centroids, middle, end, node);
+		m_Nodes[node].Parent = parent;
+		m_Nodes[node].Left = left;
+		m_Nodes[node].Right = right;
+		m_Nodes[node].Bounds = AABB::Union(m_Nodes[left].Bounds, m_Nodes[right].Bounds);
+		return node;
+	}
+
+	int BVH::Insert(const AABB &bounds, u32 userData)
+	{
+		int leaf = AllocateNode();
+		m_Nodes[leaf].Bounds = Fatten(bounds);
+		m_Nodes[leaf].InsertedBounds = m_Nodes[leaf].Bounds;
+		m_Nodes[leaf].UserData = userData;
+
+		InsertLeaf(leaf);
+		m_LeafCount++;
+		return leaf;
+	}
+
+	void BVH::Remove(int proxy)
+	{
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		m_LeafCount--;
+	}
+
+	bool BVH::Update(int proxy, const AABB &bounds)
+	{
+		if (m_Nodes[proxy].Bounds.Contains(bounds))
+			return false;
+
+		// Small movements just refit the path to the root. Once the leaf no longer overlaps where it was inserted the refits have made its ancestors
+		// a poor fit, so it gets reinserted in the best spot for where it is now
+		AABB fatBounds = Fatten(bounds);
+		if (fatBounds.Intersects(m_Nodes[proxy].InsertedBounds))
+		{
+			m_Nodes[proxy].Bounds = fatBounds;
+			RefitAncestors(m_Nodes[proxy].Parent);
+		}
+		else
+		{
+			RemoveLeaf(proxy);
+			m_Nodes[proxy].Bounds = fatBounds;
+			m_Nodes[proxy].InsertedBounds = fatBounds;
+			InsertLeaf(proxy);
+		}
+		return true;
+	}
+
+	void BVH::InsertLeaf(int leaf)
+	{
+		if (m_Root == BVHNullNode)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].Parent = BVHNullNode;
+			return;
+		}
+
+		// Walk down towards the sibling that adds the least surface area, stopping when pairing with the current node is cheaper than going deeper
+		AABB leafBounds = m_Nodes[leaf].Bounds;
+		int index = m_Root;
+		while (!m_Nodes[index].IsLeaf())
+		{
+			const BVHNode &node = m_Nodes[index];
+			float area = node.Bounds.GetSurfaceArea();
+			float combinedArea = AABB::Union(node.Bounds, leafBounds).GetSurfaceArea();
+
+			float cost = 2.0f * combinedArea;
+			float inheritanceCost = 2.0f * (combinedArea - area); // Every ancestor grows by this much no matter which child the leaf goes under
+
+			auto getChildCost = [&](int child)
+			{
+				const BVHNode &childNode = m_Nodes[child];
+				float unionArea = AABB::Union(childNode.Bounds, leafBounds).GetSurfaceArea();
+				return (childNode.IsLeaf() ? unionArea : unionArea - childNode.Bounds.GetSurfaceArea()) + inheritanceCost;
+			};
+			float leftCost = getChildCost(node.Left);
+			float rightCost = getChildCost(node.Right);
+
+			if (cost < leftCost && cost < rightCost)
+				break;
+			index = leftCost < rightCost ? node.Left : node.Right;
+		}
+
+		int sibling = index;
+		int oldParent = m_Nodes[sibling].Parent;
+		int newParent = AllocateNode();
+		m_Nodes[newParent].Parent = oldParent;
+		m_Nodes[newParent].Left = sibling;
+		m_Nodes[newParent].Right = leaf;
+		m_Nodes[newParent].Bounds = AABB::Union(m_Nodes[sibling].Bounds, leafBounds);
+		m_Nodes[sibling].Parent = newParent;
+		m_Nodes[leaf].Parent = newParent;
+
+		if (oldParent == BVHNullNode)
+		{
+			m_Root = newParent;
+			return;
+		}
+
+		if (m_Nodes[oldParent].Left == sibling)
+			m_Nodes[oldParent].Left = newParent;
+		else
+			m_Nodes[oldParent].Right = newParent;
+		RefitAncestors(oldParent);
+	}
+
+	void BVH::RemoveLeaf(int leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = BVHNullNode;
+			return;
+		}
+
+		// The leaf's parent goes away and its sibling takes the parent's place
+		int parent = m_Nodes[leaf].Parent;
+		int grandParent = m_Nodes[parent].Parent;
+		int sibling = m_Nodes[parent].Left == leaf ? m_Nodes[parent].Right : m_Nodes[parent].Left;
+		m_Nodes[sibling].Parent = grandParent;
+		m_Nodes[leaf].Parent = BVHNullNode;
+		FreeNode(parent);
+
+		if (grandParent == BVHNullNode)
+		{
+			m_Root = sibling;
+			return;
+		}
+
+		if (m_Nodes[grandParent].Left == parent)
+			m_Nodes[grandParent].Left = sibling;
+		else
+			m_Nodes[grandParent].Right = sibling;
+		RefitAncestors(grandParent);
+	}
+
+	void BVH::RefitAncestors(int node)
+	{
+		while (node != BVHNullNode)
+		{
+			// Once a node comes out the same its ancestors will too
+			BVHNode &current = m_Nodes[node];
+			AABB refitBounds = AABB::Union(m_Nodes[current.Left].Bounds, m_Nodes[current.Right].Bounds);
+			if (refitBounds.Min == current.Bounds.Min && refitBounds.Max == current.Bounds.Max)
+				break;
+
+			current.Bounds = refitBounds;
+			node = current.Parent;
+		}
+	}
+
+	void BVH::QueryAABB(const AABB &bounds, std::vector<u32> &outUserData) const
+	{
+		if (m_Root == BVHNullNode)
+			return;
+
+		TraversalStack stack;
+		stack.Push(m_Root);
+		while (!stack.IsEmpty())
+		{
+			const BVHNode &node = m_Nodes[stack.Pop()];
+			if (!node.Bounds.Intersects(bounds))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				outUserData.push_back(node.UserData);
+			}
+			else
+			{
+				stack.Push(node.Left);
+				stack.Push(node.Right);
+			}
+		}
+	}
+
+	void BVH::QuerySphere(const glm::vec3 &center, float radius, std::vector<u32> &outUserData) const
+	{
+		if (m_Root == BVHNullNode)
+			return;
+
+		float radiusSquared = radius * radius;
+		TraversalStack stack;
+		stack.Push(m_Root);
+		while (!stack.IsEmpty())
+		{
+			const BVHNode &node = m_Nodes[stack.Pop()];
+			if (!SphereIntersectsAABB(center, radiusSquared, node.Bounds))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				outUserData.push_back(node.UserData);
+			}
+			else
+			{
+				stack.Push(node.Left);
+				stack.Push(node.Right);
+			}
+		}
+	}
+
+	void BVH::QueryFrustum(const Frustum &frustum, std::vector<u32> &outInside, std::vector<u32> &outIntersecting) const
+	{
+		if (m_Root == BVHNullNode)
+			return;
+
+		TraversalStack stack;
+		stack.Push(m_Root);
+		while (!stack.IsEmpty())
+		{
+			int index = stack.Pop();
+			const BVHNode &node = m_Nodes[index];
+			FrustumTestResult result = frustum.ClassifyAABB(node.Bounds.Min, node.Bounds.Max);
+			if (result == FrustumTestResult::Outside)
+				continue;
+
+			if (result == FrustumTestResult::Inside)
+			{
+				AddSubtreeLeaves(index, outInside);
+			}
+			else if (node.IsLeaf())
+			{
+				outIntersecting.push_back(node.UserData);
+			}
+			else
+			{
+				stack.Push(node.Left);
+				stack.Push(node.Right);
+			}
+		}
+	}
+
+	bool BVH::Raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, BVHRayHit &outHit) const
+	{
+		if (m_Root == BVHNullNode)
+			return false;
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+		float closestDistance = maxDistance;
+		bool hit = false;
+
+		TraversalStack stack;
+		stack.Push(m_Root);
+		while (!stack.IsEmpty())
+		{
+			const BVHNode &node = m_Nodes[stack.Pop()];
+			float enterDistance;
+			if (!RayIntersectsAABB(origin, inverseDirection, node.Bounds, closestDistance, enterDistance))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				closestDistance = enterDistance;
+				outHit.UserData = node.UserData;
+				outHit.Distance = enterDistance;
+				hit = true;
+				continue;
+			}
+
+			// Visit the nearer child first so the closest hit shrinks the ray early and prunes more of the far child
+			float leftDistance, rightDistance;
+			bool hitsLeft = RayIntersectsAABB(origin, inverseDirection, m_Nodes[node.Left].Bounds, closestDistance, leftDistance);
+			bool hitsRight = RayIntersectsAABB(origin, inverseDirection, m_Nodes[node.Right].Bounds, closestDistance, rightDistance);
+			if (hitsLeft && hitsRight)
+			{
+				bool leftIsNearer = leftDistance <= rightDistance;
+				stack.Push(leftIsNearer ? node.Right : node.Left);
+				stack.Push(leftIsNearer ? node.Left : node.Right);
+			}
+			else if (hitsLeft)
+			{
+				stack.Push(node.Left);
+			}
+			else if (hitsRight)
+			{
+				stack.Push(node.Right);
+			}
+		}
+		return hit;
+	}
+
+	BVHStats BVH::GetStats() const
+	{
+		BVHStats stats = {};
+		stats.LeafCount = m_LeafCount;
+		if (m_Root == BVHNullNode)
+			return stats;
+
+		// Depths are tracked by pushing them alongside the nodes
+		float internalArea = 0.0f;
+		std::vector<std::pair<int, int>> stack;
+		stack.emplace_back(m_Root, 1);
+		while (!stack.empty())
+		{
+			std::pair<int, int> current = stack.back();
+			stack.pop_back();
+			const BVHNode &node = m_Nodes[current.first];
+			stats.NodeCount++;
+			stats.Height = glm::max(stats.Height, current.second);
+			if (!node.IsLeaf())
+			{
+				internalArea += node.Bounds.GetSurfaceArea();
+				stack.emplace_back(node.Left, current.second + 1);
+				stack.emplace_back(node.Right, current.second + 1);
+			}
+		}
+
+		float rootArea = m_Nodes[m_Root].Bounds.GetSurfaceArea();
+		stats.SAHCost = rootArea > 0.0f ? internalArea / rootArea : 0.0f;
+		return stats;
+	}
+
+	int BVH::AllocateNode()
+	{
+		if (!m_FreeNodes.empty())
+		{
+			int node = m_FreeNodes.back();
+			m_FreeNodes.pop_back();
+			return node;
+		}
+
+		m_Nodes.emplace_back();
+		return static_cast<int>(m_Nodes.size() - 1);
+	}
+
+	void BVH::FreeNode(int node)
+	{
+		m_Nodes[node] = BVHNode();
+		m_FreeNodes.push_back(node);
+	}
+
+	void BVH::AddSubtreeLeaves(int node, std::vector<u32> &outUserData) const
+	{
+		TraversalStack stack;
+		stack.Push(node);
+		while (!stack.IsEmpty())
+		{
+			const BVHNode &current = m_Nodes[stack.Pop()];
+			if (current.IsLeaf())
+			{
+				outUserData.push_back(current.UserData);
+			}
+			else
+			{
+				stack.Push(current.Left);
+				stack.Push(current.Right);
+			}
+		}
+	}
+
+	AABB BVH::Fatten(const AABB &bounds) const
+	{
+		return AABB(bounds.Min - glm::vec3(m_FatMargin), bounds.Max + glm::vec3(m_FatMargin));
+	}
+}
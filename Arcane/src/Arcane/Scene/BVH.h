@@ -0,0 +1,111 @@
+#pragma once
+#ifndef BVH_H
+#define BVH_H
+
+namespace Arcane
+{
+	class Frustum;
+
+	static constexpr int BVHNullNode = -1;
+
+	struct AABB
+	{
+		glm::vec3 Min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 Max = glm::vec3(-std::numeric_limits<float>::max());
+
+		AABB() = default;
+		AABB(const glm::vec3 &min, const glm::vec3 &max) : Min(min), Max(max) {}
+
+		inline glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+		inline glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+		inline float GetSurfaceArea() const
+		{
+			glm::vec3 size = Max - Min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		inline bool Contains(const AABB &other) const { return glm::all(glm::lessThanEqual(Min, other.Min)) && glm::all(glm::greaterThanEqual(Max, other.Max)); }
+		inline bool Intersects(const AABB &other) const { return glm::all(glm::lessThanEqual(Min, other.Max)) && glm::all(glm::greaterThanEqual(Max, other.Min)); }
+
+		inline void Expand(const AABB &other) { Min = glm::min(Min, other.Min); Max = glm::max(Max, other.Max); }
+		inline void Expand(const glm::vec3 &point) { Min = glm::min(Min, point); Max = glm::max(Max, point); }
+		static inline AABB Union(const AABB &a, const AABB &b) { return AABB(glm::min(a.Min, b.Min), glm::max(a.Max, b.Max)); }
+	};
+
+	struct BVHNode
+	{
+		AABB Bounds; // Leaves in a tree with a margin store the fattened bounds
+		AABB InsertedBounds; // Leaves only, the fattened bounds the leaf had when it was last inserted
+		int Parent = BVHNullNode;
+		int Left = BVHNullNode, Right = BVHNullNode;
+		u32 UserData = 0;
+
+		inline bool IsLeaf() const { return Left == BVHNullNode; }
+	};
+
+	struct BVHRayHit
+	{
+		u32 UserData;
+		float Distance; // Distance along the ray to where it enters the leaf's bounds
+	};
+
+	struct BVHStats
+	{
+		int NodeCount;
+		int LeafCount;
+		int Height;
+		float SAHCost; // Summed surface area of the internal nodes relative to the root's, lower means cheaper queries
+	};
+
+	// Bounding volume hierarchy with one item per leaf. It can be built all at once with a binned surface area heuristic, which gives the best tree for items that never
+	// move, or maintained incrementally: inserts pick the sibling that adds the least surface area, and updates with small movements refit the leaf and its ancestors.
+	// Leaves can be fattened by a margin so items moving a little don't touch the tree at all. Leaves that drift away from where they were inserted get reinserted so
+	// the refits don't slowly degrade the tree. Query results are appended to the output vectors, they aren't cleared
+	class BVH
+	{
+	public:
+		BVH(float fatMargin = 0.0f);
+
+		void Clear();
+
+		// Replaces the whole tree with a surface area heuristic build. Proxies returned by Insert before the build are invalidated, each item's proxy is its index
+		void Build(const std::vector<AABB> &bounds, const std::vector<u32> &userData);
+
+		// Returns the proxy the item is referred to by until it is removed
+		int Insert(const AABB &bounds, u32 userData);
+		void Remove(int proxy);
+		// Returns true if the tree had to change, false if the bounds were still inside the leaf's fattened bounds
+		bool Update(int proxy, const AABB &bounds);
+
+		void QueryAABB(const AABB &bounds, std::vector<u32> &outUserData) const;
+		void QuerySphere(const glm::vec3 &center, float radius, std::vector<u32> &outUserData) const;
+		// Leaves in subtrees that are entirely inside the frustum are added to outInside without being tested, the other leaves that touch it go in outIntersecting
+		void QueryFrustum(const Frustum &frustum, std::vector<u32> &outInside, std::vector<u32> &outIntersecting) const;
+		// Finds the closest leaf whose bounds the ray enters within maxDistance, the direction should be normalized
+		bool Raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, BVHRayHit &outHit) const;
+
+		inline u32 GetUserData(int proxy) const { return m_Nodes[proxy].UserData; }
+		inline const AABB& GetFatBounds(int proxy) const { return m_Nodes[proxy].Bounds; }
+		inline int GetLeafCount() const { return m_LeafCount; }
+		inline bool IsEmpty() const { return m_Root == BVHNullNode; }
+		BVHStats GetStats() const;
+	private:
+		int AllocateNode();
+		void FreeNode(int node);
+
+		void InsertLeaf(int leaf);
+		void RemoveLeaf(int leaf);
+		void RefitAncestors(int node);
+		int BuildRange(std::vector<int> &leaves, const std::vector<glm::vec3> &centroids, int begin, int end, int parent);
+
+		void AddSubtreeLeaves(int node, std::vector<u32> &outUserData) const;
+		AABB Fatten(const AABB &bounds) const;
+	private:
+		std::vector<BVHNode> m_Nodes;
+		std::vector<int> m_FreeNodes;
+		int m_Root;
+		int m_LeafCount;
+		float m_FatMargin;
+	};
+}
+#endif
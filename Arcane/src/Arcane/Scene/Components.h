@@ -78,6 +78,24 @@ namespace Arcane
 		}
 	};
 
+	// World space bounds of a mesh component, cached by the scene and only rebuilt when the entity's transform or model changes
+	struct MeshWorldBounds
+	{
+		// What the cache was built from
+		glm::vec3 Translation = glm::vec3(0.0f), Rotation = glm::vec3(0.0f), Scale = glm::vec3(0.0f);
+		const Model *SourceModel = nullptr;
+		bool IsValid = false; // False while the model has no bounds (ie it is still loading), then it can't be culled
+
+		glm::mat4 Transform = glm::mat4(1.0f);
+		glm::vec3 Center = glm::vec3(0.0f), Extents = glm::vec3(0.0f);
+		float Radius = 0.0f;
+
+		// Where the entity lives in the scene's BVHs
+		int DynamicBVHProxy = -1;
+		bool InStaticBVH = false; // Belongs in the static tree, it may not have been built into it yet
+		int StaticBVHProxy = -1; // Leaf from the last static tree build
+	};
+
 	struct MeshComponent
 	{
 		Model *AssetModel;
@@ -91,6 +109,8 @@ namespace Arcane
 		bool IsTransparent = false; // Should be true if the model contains any translucent material
 		bool IsStatic = false;		// Should be true if the model will never have its transform modified
 		bool ShouldBackfaceCull = true; // Should be true for majority of models, unless a model isn't double sided
+
+		MeshWorldBounds WorldBounds; // Should not be set by the user, it is maintained by the scene for culling
 	};
 
 	struct LightComponent
@@ -110,7 +130,12 @@ namespace Arcane
 		bool CastShadows = false;
 		float ShadowBias = SHADOWMAP_BIAS_DEFAULT;
 		ShadowQuality ShadowResolution = ShadowQuality::ShadowQuality_Medium;
-		float ShadowNearPlane = SHADOWMAP_NEAR_PLANE_DEFAULT, ShadowFarPlane = SHADOWMAP_FAR_PLANE_DEFAULT;
+		float ShadowNearPlane = SHADOWMAP_NEAR_PLANE_DEFAULT, ShadowFarPlane = SHADOWMAP_FAR_PLANE_DEFAULT; // Used for spot and point lights only
+
+		// Used for directional lights only, the camera's frustum is split into cascades that each get a ShadowResolution sized shadowmap
+		int ShadowCascadeCount = SHADOW_CASCADE_COUNT_DEFAULT;
+		float ShadowCascadeSplitLambda = SHADOW_CASCADE_SPLIT_LAMBDA_DEFAULT;
+		float ShadowCascadeDistance = SHADOW_CASCADE_DISTANCE_DEFAULT;
 	};
 
 	struct PoseAnimatorComponent
@@ -4,6 +4,7 @@
 #include <Arcane/Graphics/Window.h>
 #include <Arcane/Graphics/Skybox.h>
 #include <Arcane/Graphics/Mesh/Mesh.h>
+#include <Arcane/Graphics/Mesh/Model.h>
 #include <Arcane/Graphics/Renderer/GLCache.h>
 #include <Arcane/Graphics/Renderer/Renderer.h>
 #include <Arcane/Scene/Entity.h>
@@ -29,7 +30,7 @@ namespace Arcane
 
 	Scene::~Scene()
 	{
-
+		m_Registry.on_destroy<MeshComponent>().disconnect<&Scene::OnMeshComponentDestroyed>(this);
 	}
 
 	void Scene::PreInit()
@@ -39,6 +40,9 @@ namespace Arcane
 		auto partialOwningGroup1 = m_Registry.group<LightComponent>(entt::get<TransformComponent>);
 		auto partialOwningGroup2 = m_Registry.group<TransformComponent, MeshComponent>(entt::get<PoseAnimatorComponent>);
 
+		// Entities removed from the scene need to be taken out of the BVHs
+		m_Registry.on_destroy<MeshComponent>().connect<&Scene::OnMeshComponentDestroyed>(this);
+
 		// Temp terrain things
 		m_Terrain = new Terrain();
 		m_Terrain->LoadTerrainFromTexture(std::string("res/terrain/heightMap.png"));
@@ -59,6 +63,9 @@ namespace Arcane
 	{
 		m_LightManager.Init();
 		m_WaterManager.Init();
+
+		// Probes get baked before the first update, so the BVHs need to contain the scene by then
+		UpdateBVH();
 	}
 
 	Entity Scene::CreateEntity(const std::string &name)
@@ -72,6 +79,15 @@ namespace Arcane
 
 	void Scene::OnUpdate(float deltaTime)
 	{
+		// Kick off the Animated Entities, nothing else in the update touches the animators so they can run alongside it
+		auto animatedView = m_Registry.view<PoseAnimatorComponent>();
+		m_Animators.clear();
+		for (auto entity : animatedView)
+		{
+			m_Animators.push_back(&animatedView.get<PoseAnimatorComponent>(entity).PoseAnimator);
+		}
+		m_AnimationSystem.BeginUpdate(m_Animators.data(), m_Animators.size(), deltaTime);
+
 		// Camera Update
 		m_SceneCamera->ProcessInput(deltaTime);
 
@@ -81,67 +97,374 @@ namespace Arcane
 		// Update Water
 		m_WaterManager.Update();
 
-		// Update Animated Entities
-		auto animatedView = m_Registry.view<PoseAnimatorComponent>();
-		for (auto entity : animatedView)
+		// Bone palettes need to be finished before the bounds are updated and the renderer reads them
+		m_AnimationSystem.EndUpdate();
+
+		// Update Spatial Acceleration
+		UpdateBVH();
+	}
+
+	static bool PassesModelFilter(ModelFilterType filter, const MeshComponent &model)
+	{
+		switch (filter)
+		{
+		case ModelFilterType::AllModels:
+			return true;
+		case ModelFilterType::StaticModels:
+			return model.IsStatic;
+		case ModelFilterType::OpaqueModels:
+			return model.IsTransparent == false;
+		case ModelFilterType::OpaqueStaticModels:
+			return model.IsTransparent == false && model.IsStatic;
+		case ModelFilterType::TransparentModels:
+			return model.IsTransparent;
+		case ModelFilterType::TransparentStaticModels:
+			return model.IsTransparent && model.IsStatic;
+		case ModelFilterType::DynamicModels:
+			return !model.IsStatic;
+		}
+		return false;
+	}
+
+	// Bounded meshes are in the static tree exactly when they are static, so a filter that only passes one kind never has to walk the other tree
+	static bool FilterUsesStaticBVH(ModelFilterType filter)
+	{
+		return filter != ModelFilterType::DynamicModels;
+	}
+
+	static bool FilterUsesDynamicBVH(ModelFilterType filter)
+	{
+		return filter != ModelFilterType::StaticModels && filter != ModelFilterType::OpaqueStaticModels && filter != ModelFilterType::TransparentStaticModels;
+	}
+
+	// The bounded counts are only brought up to date in UpdateBVH, a mesh edited since then (made static, transparent etc) can be queued without being counted
+	static unsigned int GetCulledCount(unsigned int boundedCount, unsigned int queuedCount)
+	{
+		return queuedCount < boundedCount ? boundedCount - queuedCount : 0;
+	}
+
+	void Scene::AddModelsToRenderer(ModelFilterType filter, const Frustum &frustum)
+	{
+		auto queueModel = [this, filter](entt::entity entity) -> bool
+		{
+			MeshComponent &model = m_Registry.get<MeshComponent>(entity);
+			if (!PassesModelFilter(filter, model))
+				return false;
+
+			PoseAnimatorComponent *poseAnimatorComponent = m_Registry.try_get<PoseAnimatorComponent>(entity);
+			PoseAnimator *poseAnimator = poseAnimatorComponent ? &poseAnimatorComponent->PoseAnimator : nullptr;
+			Renderer::QueueMesh(model.AssetModel, model.WorldBounds.Transform, poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
+			return true;
+		};
+
+		for (entt::entity entity : m_UnboundedEntities)
+		{
+			queueModel(entity);
+		}
+
+		m_QueryInside.clear();
+		m_QueryIntersecting.clear();
+#if USE_FRUSTUM_CULLING
+		if (FilterUsesStaticBVH(filter))
+			m_StaticBVH.QueryFrustum(frustum, m_QueryInside, m_QueryIntersecting);
+		if (FilterUsesDynamicBVH(filter))
+			m_DynamicBVH.QueryFrustum(frustum, m_QueryInside, m_QueryIntersecting);
+#else
+		m_StaticBVH.QueryAABB(AABB(glm::vec3(-std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::max())), m_QueryInside);
+		m_DynamicBVH.QueryAABB(AABB(glm::vec3(-std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::max())), m_QueryInside);
+#endif
+
+		// Leaves the tree found entirely inside are visible, the ones straddling a plane are tested with their tighter box and sphere four at a time
+		unsigned int queuedCount = 0;
+		for (u32 userData : m_QueryInside)
+		{
+			queuedCount += queueModel(static_cast<entt::entity>(userData)) ? 1 : 0;
+		}
+
+		m_CullingBounds.Clear();
+		for (u32 userData : m_QueryIntersecting)
+		{
+			const MeshWorldBounds &bounds = m_Registry.get<MeshComponent>(static_cast<entt::entity>(userData)).WorldBounds;
+			m_CullingBounds.Add(bounds.Center, bounds.Extents, bounds.Radius);
+		}
+		frustum.Cull(m_CullingBounds, m_CullingVisibility);
+		for (size_t i = 0; i < m_QueryIntersecting.size(); i++)
+		{
+			if (m_CullingVisibility[i])
+				queuedCount += queueModel(static_cast<entt::entity>(m_QueryIntersecting[i])) ? 1 : 0;
+		}
+
+		Renderer::AddCulledMeshes(GetCulledCount(m_BoundedModelCounts[static_cast<int>(filter)], queuedCount));
+	}
+
+	void Scene::AddModelsToRendererLayered(ModelFilterType filter, const Frustum *layerFrustums, int layerCount, const glm::vec3 &center, float radius)
+	{
+		ARC_ASSERT(layerCount > 0 && layerCount <= 32, "Layer masks only have room for 32 layers");
+		u32 allLayersMask = layerCount == 32 ? ~0u : (1u << layerCount) - 1;
+
+		auto queueModel = [this, filter](entt::entity entity, u32 layerMask) -> bool
+		{
+			MeshComponent &model = m_Registry.get<MeshComponent>(entity);
+			if (!PassesModelFilter(filter, model))
+				return false;
+
+			PoseAnimatorComponent *poseAnimatorComponent = m_Registry.try_get<PoseAnimatorComponent>(entity);
+			PoseAnimator *poseAnimator = poseAnimatorComponent ? &poseAnimatorComponent->PoseAnimator : nullptr;
+			Renderer::QueueMesh(model.AssetModel, model.WorldBounds.Transform, poseAnimator, model.IsTransparent, model.ShouldBackfaceCull, layerMask);
+			return true;
+		};
+
+		// Nothing is known about where models that are still loading end up, so they go to every layer
+		for (entt::entity entity : m_UnboundedEntities)
+		{
+			queueModel(entity, allLayersMask);
+		}
+
+		unsigned int queuedCount = 0;
+		m_QueryIntersecting.clear();
+#if USE_FRUSTUM_CULLING
+		if (FilterUsesStaticBVH(filter))
+			m_StaticBVH.QuerySphere(center, radius, m_QueryIntersecting);
+		if (FilterUsesDynamicBVH(filter))
+			m_DynamicBVH.QuerySphere(center, radius, m_QueryIntersecting);
+
+		// Every candidate's bounds are gathered once and tested against each layer's frustum four at a time, the results are folded into one mask per model
+		m_CullingBounds.Clear();
+		for (u32 userData : m_QueryIntersecting)
+		{
+			const MeshWorldBounds &bounds = m_Registry.get<MeshComponent>(static_cast<entt::entity>(userData)).WorldBounds;
+			m_CullingBounds.Add(bounds.Center, bounds.Extents, bounds.Radius);
+		}
+		m_CullingLayerMasks.assign(m_QueryIntersecting.size(), 0);
+		for (int layer = 0; layer < layerCount; layer++)
+		{
+			layerFrustums[layer].Cull(m_CullingBounds, m_CullingVisibility);
+			for (size_t i = 0; i < m_QueryIntersecting.size(); i++)
+			{
+				if (m_CullingVisibility[i])
+					m_CullingLayerMasks[i] |= 1u << layer;
+			}
+		}
+		for (size_t i = 0; i < m_QueryIntersecting.size(); i++)
+		{
+			if (m_CullingLayerMasks[i] != 0)
+				queuedCount += queueModel(static_cast<entt::entity>(m_QueryIntersecting[i]), m_CullingLayerMasks[i]) ? 1 : 0;
+		}
+#else
+		m_StaticBVH.QueryAABB(AABB(glm::vec3(-std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::max())), m_QueryIntersecting);
+		m_DynamicBVH.QueryAABB(AABB(glm::vec3(-std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::max())), m_QueryIntersecting);
+		for (u32 userData : m_QueryIntersecting)
+		{
+			queuedCount += queueModel(static_cast<entt::entity>(userData), allLayersMask) ? 1 : 0;
+		}
+#endif
+
+		Renderer::AddCulledMeshes(GetCulledCount(m_BoundedModelCounts[static_cast<int>(filter)], queuedCount));
+	}
+
+	void Scene::QueryFrustum(const Frustum &frustum, std::vector<Entity> &outEntities)
+	{
+		m_QueryInside.clear();
+		m_QueryIntersecting.clear();
+		m_StaticBVH.QueryFrustum(frustum, m_QueryInside, m_QueryIntersecting);
+		m_DynamicBVH.QueryFrustum(frustum, m_QueryInside, m_QueryIntersecting);
+
+		for (u32 userData : m_QueryInside)
+		{
+			outEntities.emplace_back(this, static_cast<entt::entity>(userData));
+		}
+		for (u32 userData : m_QueryIntersecting)
+		{
+			const MeshWorldBounds &bounds = m_Registry.get<MeshComponent>(static_cast<entt::entity>(userData)).WorldBounds;
+			if (frustum.IntersectsAABB(bounds.Center - bounds.Extents, bounds.Center + bounds.Extents) && frustum.IntersectsSphere(bounds.Center, bounds.Radius))
+				outEntities.emplace_back(this, static_cast<entt::entity>(userData));
+		}
+	}
+
+	void Scene::QueryAABB(const AABB &bounds, std::vector<Entity> &outEntities)
+	{
+		m_QueryIntersecting.clear();
+		m_StaticBVH.QueryAABB(bounds, m_QueryIntersecting);
+		m_DynamicBVH.QueryAABB(bounds, m_QueryIntersecting);
+
+		// The dynamic tree's leaves are fattened, so its results are checked against the actual bounds
+		for (u32 userData : m_QueryIntersecting)
+		{
+			const MeshWorldBounds &worldBounds = m_Registry.get<MeshComponent>(static_cast<entt::entity>(userData)).WorldBounds;
+			if (bounds.Intersects(AABB(worldBounds.Center - worldBounds.Extents, worldBounds.Center + worldBounds.Extents)))
+				outEntities.emplace_back(this, static_cast<entt::entity>(userData));
+		}
+	}
+
+	void Scene::QuerySphere(const glm::vec3 &center, float radius, std::vector<Entity> &outEntities)
+	{
+		m_QueryIntersecting.clear();
+		m_StaticBVH.QuerySphere(center, radius, m_QueryIntersecting);
+		m_DynamicBVH.QuerySphere(center, radius, m_QueryIntersecting);
+
+		for (u32 userData : m_QueryIntersecting)
 		{
-			auto& poseAnimator = animatedView.get<PoseAnimatorComponent>(entity);
+			const MeshWorldBounds &worldBounds = m_Registry.get<MeshComponent>(static_cast<entt::entity>(userData)).WorldBounds;
+			glm::vec3 closestPoint = glm::clamp(center, worldBounds.Center - worldBounds.Extents, worldBounds.Center + worldBounds.Extents);
+			if (glm::length2(closestPoint - center) <= radius * radius && glm::length2(worldBounds.Center - center) <= (radius + worldBounds.Radius) * (radius + worldBounds.Radius))
+				outEntities.emplace_back(this, static_cast<entt::entity>(userData));
+		}
+	}
 
-			poseAnimator.PoseAnimator.UpdateAnimation(deltaTime);
+	bool Scene::Raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, Entity &outEntity, float &outDistance)
+	{
+		BVHRayHit staticHit, dynamicHit;
+		bool hitStatic = m_StaticBVH.Raycast(origin, direction, maxDistance, staticHit);
+		bool hitDynamic = m_DynamicBVH.Raycast(origin, direction, hitStatic ? staticHit.Distance : maxDistance, dynamicHit);
+		if (!hitStatic && !hitDynamic)
+			return false;
+
+		const BVHRayHit &closestHit = hitDynamic ? dynamicHit : staticHit;
+		outEntity = Entity(this, static_cast<entt::entity>(closestHit.UserData));
+		outDistance = closestHit.Distance;
+		return true;
+	}
+
+	bool Scene::UpdateWorldBounds(const TransformComponent &transform, MeshComponent &meshComponent, bool isSkinned)
+	{
+		// Animations can move vertices outside of the bind pose the bounds were computed from, so skinned models get some slack
+		static constexpr float s_SkinnedBoundsPadding = 1.5f;
+
+		MeshWorldBounds &bounds = meshComponent.WorldBounds;
+		const Model *model = meshComponent.AssetModel;
+		bool modelHasBounds = model && model->HasBounds();
+		if (bounds.SourceModel == model && bounds.IsValid == modelHasBounds &&
+			bounds.Translation == transform.Translation && bounds.Rotation == transform.Rotation && bounds.Scale == transform.Scale)
+		{
+			return false;
 		}
+
+		bounds.Translation = transform.Translation;
+		bounds.Rotation = transform.Rotation;
+		bounds.Scale = transform.Scale;
+		bounds.SourceModel = model;
+		bounds.IsValid = modelHasBounds;
+		bounds.Transform = transform.GetTransform();
+		if (!modelHasBounds)
+			return true;
+
+		// The AABB is transformed by taking the absolute value of the rotation and scale so it encloses the rotated box, the sphere only needs the largest scale
+		glm::mat3 linear(bounds.Transform);
+		glm::mat3 absLinear(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2]));
+		glm::vec3 localExtents = (model->GetBoundsMax() - model->GetBoundsMin()) * 0.5f;
+		float maxScale = glm::sqrt(glm::max(glm::length2(linear[0]), glm::max(glm::length2(linear[1]), glm::length2(linear[2]))));
+
+		float padding = isSkinned ? s_SkinnedBoundsPadding : 1.0f;
+		bounds.Center = glm::vec3(bounds.Transform * glm::vec4(model->GetBoundingSphereCenter(), 1.0f));
+		bounds.Extents = absLinear * localExtents * padding;
+		bounds.Radius = model->GetBoundingSphereRadius() * maxScale * padding;
+		return true;
 	}
 
-	void Scene::AddModelsToRenderer(ModelFilterType filter)
+	void Scene::UpdateBVH()
 	{
+		m_UnboundedEntities.clear();
+		std::fill(std::begin(m_BoundedModelCounts), std::end(m_BoundedModelCounts), 0);
+
 		auto group = m_Registry.group<TransformComponent, MeshComponent>();
 		for (auto entity : group)
 		{
 			auto&[transform, model] = group.get<TransformComponent, MeshComponent>(entity);
-			Entity currentEntity(this, entity);
+			bool boundsChanged = UpdateWorldBounds(transform, model, m_Registry.any_of<PoseAnimatorComponent>(entity));
 
-			PoseAnimator *poseAnimator = nullptr;
-			if (currentEntity.HasComponent<PoseAnimatorComponent>())
+			MeshWorldBounds &bounds = model.WorldBounds;
+			if (!bounds.IsValid)
 			{
-				poseAnimator = &currentEntity.GetComponent<PoseAnimatorComponent>().PoseAnimator;
+				RemoveFromBVH(model);
+				m_UnboundedEntities.push_back(entity);
+				continue;
 			}
 
-			switch (filter)
+			for (int filter = 0; filter < ModelFilterTypeCount; filter++)
 			{
-			case ModelFilterType::AllModels:
-				Renderer::QueueMesh(model.AssetModel, transform.GetTransform(), poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
-				break;
-			case ModelFilterType::StaticModels:
-				if (model.IsStatic)
-				{
-					Renderer::QueueMesh(model.AssetModel, transform.GetTransform(), poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
-				}
-				break;
-			case ModelFilterType::OpaqueModels:
-				if (model.IsTransparent == false)
-				{
-					Renderer::QueueMesh(model.AssetModel, transform.GetTransform(), poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
-				}
-				break;
-			case ModelFilterType::OpaqueStaticModels:
-				if (model.IsTransparent == false && model.IsStatic)
-				{
-					Renderer::QueueMesh(model.AssetModel, transform.GetTransform(), poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
-				}
-				break;
-			case ModelFilterType::TransparentModels:
-				if (model.IsTransparent)
+				m_BoundedModelCounts[filter] += PassesModelFilter(static_cast<ModelFilterType>(filter), model) ? 1 : 0;
+			}
+
+			AABB worldAABB(bounds.Center - bounds.Extents, bounds.Center + bounds.Extents);
+			if (model.IsStatic)
+			{
+				if (bounds.DynamicBVHProxy != BVHNullNode)
 				{
-					Renderer::QueueMesh(model.AssetModel, transform.GetTransform(), poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
+					m_DynamicBVH.Remove(bounds.DynamicBVHProxy);
+					bounds.DynamicBVHProxy = BVHNullNode;
 				}
-				break;
-			case ModelFilterType::TransparentStaticModels:
-				if (model.IsTransparent && model.IsStatic)
+				// Static entities aren't expected to move, so if one does the whole tree is just rebuilt
+				m_StaticBVHDirty |= !bounds.InStaticBVH || boundsChanged;
+				bounds.InStaticBVH = true;
+			}
+			else
+			{
+				if (bounds.InStaticBVH)
 				{
-					Renderer::QueueMesh(model.AssetModel, transform.GetTransform(), poseAnimator, model.IsTransparent, model.ShouldBackfaceCull);
+					bounds.InStaticBVH = false;
+					bounds.StaticBVHProxy = BVHNullNode;
+					m_StaticBVHDirty = true;
 				}
-				break;
+
+				if (bounds.DynamicBVHProxy == BVHNullNode)
+					bounds.DynamicBVHProxy = m_DynamicBVH.Insert(worldAABB, static_cast<u32>(entity));
+				else if (boundsChanged)
+					m_DynamicBVH.Update(bounds.DynamicBVHProxy, worldAABB);
+			}
+		}
+
+		if (m_StaticBVHDirty)
+			RebuildStaticBVH();
+	}
+
+	void Scene::RebuildStaticBVH()
+	{
+		std::vector<AABB> bounds;
+		std::vector<u32> userData;
+		auto group = m_Registry.group<TransformComponent, MeshComponent>();
+		for (auto entity : group)
+		{
+			MeshWorldBounds &worldBounds = group.get<MeshComponent>(entity).WorldBounds;
+			if (worldBounds.InStaticBVH)
+			{
+				worldBounds.StaticBVHProxy = static_cast<int>(bounds.size());
+				bounds.emplace_back(worldBounds.Center - worldBounds.Extents, worldBounds.Center + worldBounds.Extents);
+				userData.push_back(static_cast<u32>(entity));
 			}
 		}
+
+		m_StaticBVH.Build(bounds, userData);
+		m_StaticBVHDirty = false;
+		m_StaticGeometryVersion++;
+	}
+
+	void Scene::RemoveFromBVH(MeshComponent &meshComponent)
+	{
+		MeshWorldBounds &bounds = meshComponent.WorldBounds;
+		if (bounds.DynamicBVHProxy != BVHNullNode)
+		{
+			m_DynamicBVH.Remove(bounds.DynamicBVHProxy);
+			bounds.DynamicBVHProxy = BVHNullNode;
+		}
+		if (bounds.InStaticBVH)
+		{
+			bounds.InStaticBVH = false;
+			m_StaticBVHDirty = true;
+		}
+
+		// Just the leaf is taken out of the static tree, it is rebuilt once in the next UpdateBVH so removing lots of meshes at once stays cheap
+		if (bounds.StaticBVHProxy != BVHNullNode)
+		{
+			m_StaticBVH.Remove(bounds.StaticBVHProxy);
+			bounds.StaticBVHProxy = BVHNullNode;
+		}
+	}
+
+	void Scene::OnMeshComponentDestroyed(entt::registry &registry, entt::entity entity)
+	{
+		// The trees can't be left referring to the entity until the next update
+		RemoveFromBVH(registry.get<MeshComponent>(entity));
+		m_UnboundedEntities.erase(std::remove(m_UnboundedEntities.begin(), m_UnboundedEntities.end(), entity), m_UnboundedEntities.end());
 	}
 
 	ICamera* Scene::GetCamera()
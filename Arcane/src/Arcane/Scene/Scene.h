@@ -22,6 +22,18 @@
 #include <Arcane/Graphics/Renderer/Renderpass/WaterPass.h>
 #endif
 
+#ifndef FRUSTUM_H
+#include <Arcane/Graphics/Camera/Frustum.h>
+#endif
+
+#ifndef BVH_H
+#include <Arcane/Scene/BVH.h>
+#endif
+
+#ifndef ANIMATIONSYSTEM_H
+#include <Arcane/Animation/AnimationSystem.h>
+#endif
+
 #ifndef ENTT_CONFIG_CONFIG_H
 #include "entt.hpp"
 #endif
@@ -33,6 +45,8 @@ namespace Arcane
 	class Skybox;
 	class GLCache;
 	class CameraController;
+	struct TransformComponent;
+	struct MeshComponent;
 
 	enum class ModelFilterType
 	{
@@ -41,8 +55,10 @@ namespace Arcane
 		OpaqueModels,
 		OpaqueStaticModels,
 		TransparentModels,
-		TransparentStaticModels
+		TransparentStaticModels,
+		DynamicModels
 	};
+	static constexpr int ModelFilterTypeCount = 7;
 
 	class Scene
 	{
@@ -52,6 +68,7 @@ namespace Arcane
 		friend class WaterManager;
 		friend class ScenePanel;
 		friend class WaterPass;
+		friend class TextureStreamer;
 	public:
 		Scene(Window *window);
 		~Scene();
@@ -61,16 +78,38 @@ namespace Arcane
 		void Init();
 		void OnUpdate(float deltaTime);
 
-		void AddModelsToRenderer(ModelFilterType filter);
+		// Queues the models passing the filter whose world space bounds intersect the frustum, models that are still loading are always queued
+		void AddModelsToRenderer(ModelFilterType filter, const Frustum &frustum);
+		// Queues every model passing the filter once for a layered render target (like a cubemap), with a layer mask of the frustums its bounds intersect. Only models
+		// within the radius of the center are tested, so it should enclose every frustum. Models touching none of the layers aren't queued
+		void AddModelsToRendererLayered(ModelFilterType filter, const Frustum *layerFrustums, int layerCount, const glm::vec3 &center, float radius);
+
+		// Spatial queries over the world space bounds of every entity with a MeshComponent, the results are appended. Entities whose model is still loading have no bounds and are never returned
+		void QueryFrustum(const Frustum &frustum, std::vector<Entity> &outEntities);
+		void QueryAABB(const AABB &bounds, std::vector<Entity> &outEntities);
+		void QuerySphere(const glm::vec3 &center, float radius, std::vector<Entity> &outEntities);
+		// Finds the closest entity whose bounds the ray hits within maxDistance, the direction should be normalized
+		bool Raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, Entity &outEntity, float &outDistance);
+
+		inline const BVH& GetStaticBVH() const { return m_StaticBVH; }
+		inline const BVH& GetDynamicBVH() const { return m_DynamicBVH; }
+		// Changes whenever a static mesh is added, removed or moved (anything that rebuilds the static tree), so caches of what the static meshes look like know when they are stale
+		inline u64 GetStaticGeometryVersion() const { return m_StaticGeometryVersion; }
 
 		inline Terrain* GetTerrain() { return m_Terrain; }
 		inline LightManager* GetLightManager() { return &m_LightManager; }
 		inline WaterManager* GetWaterManager() { return &m_WaterManager; }
 		inline ProbeManager* GetProbeManager() { return &m_ProbeManager; }
 		inline Skybox* GetSkybox() { return m_Skybox; }
+		inline AnimationSystem* GetAnimationSystem() { return &m_AnimationSystem; }
 		ICamera* GetCamera();
 	private:
 		void PreInit();
+		bool UpdateWorldBounds(const TransformComponent &transform, MeshComponent &meshComponent, bool isSkinned);
+		void UpdateBVH();
+		void RebuildStaticBVH();
+		void RemoveFromBVH(MeshComponent &meshComponent);
+		void OnMeshComponentDestroyed(entt::registry &registry, entt::entity entity);
 	private:
 		// Global Data
 		GLCache *m_GLCache;
@@ -88,6 +127,26 @@ namespace Arcane
 		LightManager m_LightManager;
 		ProbeManager m_ProbeManager;
 		WaterManager m_WaterManager;
+
+		// Animators are updated on the job system while the rest of the update runs, m_Animators is rebuilt every frame and has to stay alive until the update ends.
+		// It is declared first so it is destroyed after m_AnimationSystem, whose destructor ends the update in flight
+		std::vector<PoseAnimator*> m_Animators;
+		AnimationSystem m_AnimationSystem;
+
+		// Spatial acceleration for the mesh entities. Static ones are built into a tree with the surface area heuristic whenever that set changes, the rest live in a tree
+		// that is updated incrementally as they move. Both are brought up to date once a frame in OnUpdate
+		BVH m_StaticBVH;
+		BVH m_DynamicBVH{ DYNAMIC_BVH_FAT_MARGIN };
+		bool m_StaticBVHDirty = false;
+		u64 m_StaticGeometryVersion = 0;
+		std::vector<entt::entity> m_UnboundedEntities; // Mesh entities whose model is still loading, they can't be placed in the trees so they are always queued
+		unsigned int m_BoundedModelCounts[ModelFilterTypeCount] = {}; // Mesh entities in the trees that pass each ModelFilterType, so the culled count doesn't need a scan
+
+		// Scratch data for culling, kept around to avoid reallocating it for every view
+		std::vector<u32> m_QueryInside, m_QueryIntersecting;
+		CullingBoundsList m_CullingBounds;
+		std::vector<u8> m_CullingVisibility;
+		std::vector<u32> m_CullingLayerMasks;
 	};
 }
 #endif
@@ -0,0 +1,106 @@
+// Bins every point and spot light into the froxel grid of a view, one work group per depth slice with an invocation per cluster
+#shader-type compute
+#version 430 core
+layout (local_size_x = LIGHT_CLUSTER_GRID_X, local_size_y = LIGHT_CLUSTER_GRID_Y, local_size_z = 1) in;
+
+#define LIGHT_CLUSTER_BUILD
+#include "Include/LightUniforms.glsl"
+
+#include "Include/LightClusters.glsl"
+
+uniform mat4 clusterView;
+uniform mat4 clusterProjectionInverse;
+uniform int pointLightCount;
+uniform int spotLightCount;
+
+// Lights are tested in batches, every invocation moves one light's view space bounding sphere into shared memory and then tests its cluster against the whole batch
+const int BATCH_SIZE = LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y;
+shared vec4 batchBounds[BATCH_SIZE];
+
+vec3 UnprojectToNearPlane(vec2 ndc) {
+	vec4 viewSpacePos = clusterProjectionInverse * vec4(ndc, -1.0, 1.0);
+	return viewSpacePos.xyz / viewSpacePos.w;
+}
+
+vec4 GetPointLightBounds(int i) {
+	return vec4((clusterView * vec4(pointLights[i].position, 1.0)).xyz, pointLights[i].attenuationRadius);
+}
+
+vec4 GetSpotLightBounds(int i) {
+	// Smallest sphere around the cone: narrow cones are covered by the sphere through the apex and the rim of the cap, wider ones by the sphere around the cap's
+	// rim, and anything past a hemisphere by the light's whole range
+	float range = spotLights[i].attenuationRadius;
+	float cosAngle = spotLights[i].outerCutOff;
+	vec3 direction = normalize(spotLights[i].direction);
+	vec3 center = spotLights[i].position;
+	float radius = range;
+	if (cosAngle > 0.70710678) {
+		radius = range / (2.0 * cosAngle);
+		center += direction * radius;
+	}
+	else if (cosAngle > 0.0) {
+		radius = range * sqrt(1.0 - cosAngle * cosAngle);
+		center += direction * range * cosAngle;
+	}
+	return vec4((clusterView * vec4(center, 1.0)).xyz, radius);
+}
+
+bool SphereIntersectsBox(vec4 sphere, vec3 boxMin, vec3 boxMax) {
+	vec3 offset = clamp(sphere.xyz, boxMin, boxMax) - sphere.xyz;
+	return dot(offset, offset) <= sphere.w * sphere.w;
+}
+
+void main() {
+	uvec3 clusterCoord = uvec3(gl_LocalInvocationID.xy, gl_WorkGroupID.z);
+	uint cluster = (clusterCoord.z * uint(LIGHT_CLUSTER_GRID_Y) + clusterCoord.y) * uint(LIGHT_CLUSTER_GRID_X) + clusterCoord.x;
+	uint firstIndex = cluster * uint(LIGHT_CLUSTER_MAX_LIGHTS);
+
+	// View space bounds of the cluster, the corners of the tile on the near plane are pushed out along their view rays to the depths the slice starts and ends at
+	vec2 tileSize = 2.0 / vec2(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y);
+	vec2 tileMin = vec2(clusterCoord.xy) * tileSize - 1.0;
+	vec3 corners[4] = vec3[](UnprojectToNearPlane(tileMin), UnprojectToNearPlane(tileMin + vec2(tileSize.x, 0.0)), UnprojectToNearPlane(tileMin + vec2(0.0, tileSize.y)), UnprojectToNearPlane(tileMin + tileSize));
+	float sliceNear = exp((float(clusterCoord.z) - clusterDepthSliceBias) / clusterDepthSliceScale);
+	float sliceFar = clusterCoord.z == uint(LIGHT_CLUSTER_GRID_Z - 1) ? clusterFarPlane : exp((float(clusterCoord.z + 1u) - clusterDepthSliceBias) / clusterDepthSliceScale);
+	vec3 boxMin = vec3(1e30), boxMax = vec3(-1e30);
+	for (int i = 0; i < 4; i++) {
+		vec3 nearCorner = corners[i] * (sliceNear / -corners[i].z);
+		vec3 farCorner = corners[i] * (sliceFar / -corners[i].z);
+		boxMin = min(boxMin, min(nearCorner, farCorner));
+		boxMax = max(boxMax, max(nearCorner, farCorner));
+	}
+
+	// Point lights fill the cluster's list first, spot lights get whatever room is left
+	uint pointCount = 0u;
+	for (int batchStart = 0; batchStart < pointLightCount; batchStart += BATCH_SIZE) {
+		int light = batchStart + int(gl_LocalInvocationIndex);
+		if (light < pointLightCount)
+			batchBounds[gl_LocalInvocationIndex] = GetPointLightBounds(light);
+		memoryBarrierShared();
+		barrier();
+
+		int batchCount = min(BATCH_SIZE, pointLightCount - batchStart);
+		for (int i = 0; i < batchCount && pointCount < uint(LIGHT_CLUSTER_MAX_LIGHTS); i++) {
+			if (SphereIntersectsBox(batchBounds[i], boxMin, boxMax))
+				clusterLightIndices[firstIndex + pointCount++] = uint(batchStart + i);
+		}
+		barrier();
+	}
+
+	uint spotCount = 0u;
+	for (int batchStart = 0; batchStart < spotLightCount; batchStart += BATCH_SIZE) {
+		int light = batchStart + int(gl_LocalInvocationIndex);
+		if (light < spotLightCount)
+			batchBounds[gl_LocalInvocationIndex] = GetSpotLightBounds(light);
+		memoryBarrierShared();
+		barrier();
+
+		int batchCount = min(BATCH_SIZE, spotLightCount - batchStart);
+		for (int i = 0; i < batchCount && pointCount + spotCount < uint(LIGHT_CLUSTER_MAX_LIGHTS); i++) {
+			if (SphereIntersectsBox(batchBounds[i], boxMin, boxMax))
+				clusterLightIndices[firstIndex + pointCount + spotCount++] = uint(batchStart + i);
+		}
+		barrier();
+	}
+
+	clusterLightCounts[cluster] = uvec2(pointCount, spotCount);
+}
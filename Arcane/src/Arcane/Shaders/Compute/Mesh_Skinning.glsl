@@ -0,0 +1,80 @@
+// Skins every instance of one mesh into the transient skinned vertex buffer, the y work group picks the instance
+#shader-type compute
+#version 430 core
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// The mesh's own vertex buffer read as raw floats so interleaved and non-interleaved meshes can share the shader, the bone IDs are ints stored in the same buffer
+layout (std430, binding = 0) readonly buffer SourceVertices {
+	float sourceVertices[];
+};
+
+// Final bone matrices of every animator skinned this frame, back to back
+layout (std430, binding = 1) readonly buffer BonePalettes {
+	mat4 bonePalettes[];
+};
+
+// x is where the instance's palette starts (in matrices) and y is where its skinned vertices start (in vertices)
+layout (std430, binding = 2) readonly buffer SkinningInstances {
+	uvec2 skinningInstances[];
+};
+
+// Six words per vertex: the position as floats followed by the normal, tangent, and bitangent packed as signed normalized 10_10_10_2
+layout (std430, binding = 3) writeonly buffer SkinnedVertices {
+	uint skinnedVertices[];
+};
+
+uniform int vertexCount;
+uniform int firstInstance;
+
+// Offset of the first vertex's value and the stride between vertices (both in floats), a stride of 0 means the mesh doesn't have the attribute
+uniform ivec2 positionLayout;
+uniform ivec2 normalLayout;
+uniform ivec2 tangentLayout;
+uniform ivec2 bitangentLayout;
+uniform ivec2 boneIdLayout;
+uniform ivec2 boneWeightLayout;
+
+vec3 ReadVec3(ivec2 attributeLayout, uint vertex) {
+	if (attributeLayout.y == 0)
+		return vec3(0.0);
+
+	uint index = uint(attributeLayout.x) + vertex * uint(attributeLayout.y);
+	return vec3(sourceVertices[index], sourceVertices[index + 1], sourceVertices[index + 2]);
+}
+
+uint PackSnorm1010102(vec3 value) {
+	ivec3 scaled = ivec3(round(clamp(value, -1.0, 1.0) * 511.0));
+	return uint(scaled.x & 1023) | (uint(scaled.y & 1023) << 10) | (uint(scaled.z & 1023) << 20);
+}
+
+void main() {
+	uint vertex = gl_GlobalInvocationID.x;
+	if (vertex >= uint(vertexCount))
+		return;
+	uvec2 instance = skinningInstances[firstInstance + int(gl_WorkGroupID.y)];
+
+	uint boneIdIndex = uint(boneIdLayout.x) + vertex * uint(boneIdLayout.y);
+	uint boneWeightIndex = uint(boneWeightLayout.x) + vertex * uint(boneWeightLayout.y);
+	mat4 boneTransform = mat4(0.0);
+	for (int i = 0; i < MAX_BONES_PER_VERTEX; i++) {
+		int boneId = floatBitsToInt(sourceVertices[boneIdIndex + i]);
+		float weight = sourceVertices[boneWeightIndex + i];
+		if (weight > 0.0)
+			boneTransform += bonePalettes[instance.x + uint(boneId)] * weight;
+	}
+	mat3 boneRotation = mat3(boneTransform);
+
+	vec3 position = (boneTransform * vec4(ReadVec3(positionLayout, vertex), 1.0)).xyz;
+	vec3 normal = boneRotation * ReadVec3(normalLayout, vertex);
+	vec3 tangent = boneRotation * ReadVec3(tangentLayout, vertex);
+	vec3 bitangent = boneRotation * ReadVec3(bitangentLayout, vertex);
+
+	// The lighting shaders normalize these after the normal matrix is applied, they only need normalizing here to survive the packing
+	uint outputIndex = (instance.y + vertex) * 6;
+	skinnedVertices[outputIndex + 0] = floatBitsToUint(position.x);
+	skinnedVertices[outputIndex + 1] = floatBitsToUint(position.y);
+	skinnedVertices[outputIndex + 2] = floatBitsToUint(position.z);
+	skinnedVertices[outputIndex + 3] = PackSnorm1010102(normalLayout.y != 0 ? normalize(normal) : normal);
+	skinnedVertices[outputIndex + 4] = PackSnorm1010102(tangentLayout.y != 0 ? normalize(tangent) : tangent);
+	skinnedVertices[outputIndex + 5] = PackSnorm1010102(bitangentLayout.y != 0 ? normalize(bitangent) : bitangent);
+}
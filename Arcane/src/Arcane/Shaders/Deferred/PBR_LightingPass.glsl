@@ -17,48 +17,6 @@ void main() {
 #shader-type fragment
 #version 430 core
 
-struct DirLight {
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-};
-
-struct PointLight {
-	vec3 position;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-};
-
-struct SpotLight {
-	vec3 position;
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-
-	float cutOff;
-	float outerCutOff;
-};
-
-struct ShadowData {
-	mat4 lightSpaceViewProjectionMatrix;
-	float shadowBias;
-	int lightShadowIndex;
-};
-
-struct ShadowDataPointLight {
-	float farPlane;
-	float shadowBias;
-	int lightShadowIndex;
-};
-
-#define MAX_DIR_LIGHTS 3
-#define MAX_POINT_LIGHTS 6
-#define MAX_SPOT_LIGHTS 6
 const float PI = 3.14159265359;
 
 in vec2 TexCoords;
@@ -72,35 +30,26 @@ uniform sampler2D materialInfoTexture;
 uniform sampler2D ssaoTexture;
 uniform sampler2D depthTexture;
 
-// IBL
+// IBL, only compiled into the USE_IBL permutation
+#ifdef USE_IBL
 uniform int reflectionProbeMipCount;
-uniform bool computeIBL;
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
+#endif
 
-// Lighting
-uniform ivec4 numDirPointSpotLights;
-uniform DirLight dirLights[MAX_DIR_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+#include "Include/LightUniforms.glsl"
 
-uniform vec3 viewPos;
-uniform mat4 viewInverse;
-uniform mat4 projectionInverse;
+#include "Include/CameraUniforms.glsl"
 
-// Shadow Data
-uniform sampler2D dirLightShadowmap;
-uniform ShadowData dirLightShadowData;
-uniform sampler2D spotLightShadowmap;
-uniform ShadowData spotLightShadowData;
-uniform samplerCube pointLightShadowCubemap;
-uniform ShadowDataPointLight pointLightShadowData;
+#include "Include/LightClusters.glsl"
+
+#include "Include/ShadowUniforms.glsl"
 
 // Light radiance calculations
 vec3 CalculateDirectionalLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity);
-vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity);
-vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity);
+vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster);
+vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster);
 
 // Cook-Torrance BRDF functions adopted by Epic for UE4
 float NormalDistributionGGX(vec3 normal, vec3 halfwayNorm, float roughness);
@@ -110,7 +59,7 @@ vec3 FresnelSchlick(float cosTheta, vec3 baseReflectivity);
 
 // Other function prototypes
 float CalculateDirLightShadow(vec3 fragPos);
-float CalculateSpotLightShadow(vec3 fragPos);
+float CalculateSpotLightShadow(vec3 fragPos, int shadowIndex);
 float CalculatePointLightShadow(vec3 lightToFrag);
 vec3 WorldPosFromDepth();
 
@@ -145,27 +94,28 @@ void main() {
 	vec3 baseReflectivity = vec3(0.04);
 	baseReflectivity = mix(baseReflectivity, albedo, metallic);
 
-	// Calculate per light radiance for all of the direct lighting
+	// Calculate per light radiance for all of the direct lighting, point and spot lights only loop over the lights binned into this fragment's cluster
+	uint lightCluster = GetLightClusterIndex(fragPos);
 	vec3 directLightIrradiance = vec3(0.0);
 	directLightIrradiance += CalculateDirectionalLightRadiance(albedo, normal, metallic, roughness, fragPos, fragToViewNorm, baseReflectivity);
-	directLightIrradiance += CalculatePointLightRadiance(albedo, normal, metallic, roughness, fragPos, fragToViewNorm, baseReflectivity);
-	directLightIrradiance += CalculateSpotLightRadiance(albedo, normal, metallic, roughness, fragPos, fragToViewNorm, baseReflectivity);
+	directLightIrradiance += CalculatePointLightRadiance(albedo, normal, metallic, roughness, fragPos, fragToViewNorm, baseReflectivity, lightCluster);
+	directLightIrradiance += CalculateSpotLightRadiance(albedo, normal, metallic, roughness, fragPos, fragToViewNorm, baseReflectivity, lightCluster);
 
 	// Calcualte ambient IBL for both diffuse and specular
 	vec3 ambient = vec3(0.05) * albedo * ao;
-	if (computeIBL) {
-		vec3 specularRatio = FresnelSchlick(max(dot(normal, fragToViewNorm), 0.0), baseReflectivity);
-		vec3 diffuseRatio = vec3(1.0) - specularRatio;
-		diffuseRatio *= 1.0 - metallic;
+#ifdef USE_IBL
+	vec3 specularRatio = FresnelSchlick(max(dot(normal, fragToViewNorm), 0.0), baseReflectivity);
+	vec3 diffuseRatio = vec3(1.0) - specularRatio;
+	diffuseRatio *= 1.0 - metallic;
 
-		vec3 indirectDiffuse = texture(irradianceMap, normal).rgb * albedo * diffuseRatio;
+	vec3 indirectDiffuse = texture(irradianceMap, normal).rgb * albedo * diffuseRatio;
 
-		vec3 prefilterColour = textureLod(prefilterMap, reflectionVec, unclampedRoughness * (reflectionProbeMipCount - 1)).rgb;
-		vec2 brdfIntegration = texture(brdfLUT, vec2(max(dot(normal, fragToViewNorm), 0.0), roughness)).rg;
-		vec3 indirectSpecular = prefilterColour * (specularRatio * brdfIntegration.x + brdfIntegration.y);
+	vec3 prefilterColour = textureLod(prefilterMap, reflectionVec, unclampedRoughness * (reflectionProbeMipCount - 1)).rgb;
+	vec2 brdfIntegration = texture(brdfLUT, vec2(max(dot(normal, fragToViewNorm), 0.0), roughness)).rg;
+	vec3 indirectSpecular = prefilterColour * (specularRatio * brdfIntegration.x + brdfIntegration.y);
 
-		ambient = (indirectDiffuse + indirectSpecular) * ao;
-	}
+	ambient = (indirectDiffuse + indirectSpecular) * ao;
+#endif
 
 	color = vec4(ambient + directLightIrradiance, 1.0);
 }
@@ -209,10 +159,11 @@ vec3 CalculateDirectionalLightRadiance(vec3 albedo, vec3 normal, float metallic,
 }
 
 
-vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity) {
+vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster) {
 	vec3 pointLightIrradiance = vec3(0.0);
 
-	for (int i = 0; i < numDirPointSpotLights.y; ++i) {
+	for (uint c = 0u; c < clusterLightCounts[lightCluster].x; ++c) {
+		int i = GetClusterPointLight(lightCluster, c);
 		vec3 fragToLightNorm = normalize(pointLights[i].position - fragPos);
 		vec3 halfwayNorm = normalize(fragToViewNorm + fragToLightNorm);
 		vec3 lightToFrag = fragPos - pointLights[i].position;
@@ -257,10 +208,11 @@ vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float
 }
 
 
-vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness,  vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity) {
+vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness,  vec3 fragPos, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster) {
 	vec3 spotLightIrradiance = vec3(0.0);
 
-	for (int i = 0; i < numDirPointSpotLights.z; ++i) {
+	for (uint c = 0u; c < clusterLightCounts[lightCluster].y; ++c) {
+		int i = GetClusterSpotLight(lightCluster, c);
 		vec3 fragToLightNorm = normalize(spotLights[i].position - fragPos);
 		vec3 halfwayNorm = normalize(fragToViewNorm + fragToLightNorm);
 		float fragToLightDistance = length(spotLights[i].position - fragPos);
@@ -296,10 +248,8 @@ vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float
 		// Also calculate the diffuse, a lambertian calculation will be added onto the final radiance calculation
 		vec3 diffuse = diffuseRatio * albedo / PI;
 
-		// Calculate shadows, but first check to make sure the current light index is the shadow caster
-		float shadowAmount = 0.0f;
-		if (i == spotLightShadowData.lightShadowIndex)
-			shadowAmount = CalculateSpotLightShadow(fragPos);
+		// Calculate shadows, lights that weren't given a tile in the shadow atlas this frame have no shadow
+		float shadowAmount = CalculateSpotLightShadow(fragPos, spotLights[i].shadowIndex);
 
 		// Add the light's radiance to the irradiance sum
 		spotLightIrradiance += (diffuse + specular) * radiance * max(dot(normal, fragToLightNorm), 0.0) * (1.0 - shadowAmount);
@@ -351,7 +301,12 @@ float CalculateDirLightShadow(vec3 fragPos) {
 	if (dirLightShadowData.lightShadowIndex == -1)
 		return 0.0;
 
-	vec4 fragPosLightClipSpace = dirLightShadowData.lightSpaceViewProjectionMatrix * vec4(fragPos, 1.0);
+	// Each cascade covers a range of view depths, past the last one nothing is shadowed
+	int cascade = GetDirLightShadowCascade(-(view * vec4(fragPos, 1.0)).z);
+	if (cascade == -1)
+		return 0.0;
+
+	vec4 fragPosLightClipSpace = dirLightShadowData.cascadeViewProjectionMatrices[cascade] * vec4(fragPos, 1.0);
 	vec3 ndcCoords = fragPosLightClipSpace.xyz / fragPosLightClipSpace.w;
 	vec3 depthmapCoords = ndcCoords * 0.5 + 0.5;
 
@@ -361,10 +316,10 @@ float CalculateDirLightShadow(vec3 fragPos) {
 
 	// Perform Percentage Closer Filtering (PCF) in order to produce soft shadows - Use bilinear filtering to get some free samples (4 bilinear samples, 4 samples -> 16 values actually processed)
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(dirLightShadowmap, 0);
+	vec2 texelSize = 1.0 / textureSize(dirLightShadowmap, 0).xy;
 	for (float y = -1.5; y < 1.0; y += 2.0) {
 		for (float x = -1.5; x < 1.0; x += 2.0) {
-			float sampledDepthPCF = texture(dirLightShadowmap, depthmapCoords.xy + (texelSize * vec2(x, y))).r;
+			float sampledDepthPCF = texture(dirLightShadowmap, vec3(depthmapCoords.xy + (texelSize * vec2(x, y)), cascade)).r;
 			shadow += currentDepth > sampledDepthPCF + dirLightShadowData.shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
 		}
 	}
@@ -373,25 +328,32 @@ float CalculateDirLightShadow(vec3 fragPos) {
 	return shadow;
 }
 
-float CalculateSpotLightShadow(vec3 fragPos) {
-	if (spotLightShadowData.lightShadowIndex == -1)
+float CalculateSpotLightShadow(vec3 fragPos, int shadowIndex) {
+	if (shadowIndex == -1)
 		return 0.0;
 
-	vec4 fragPosLightClipSpace = spotLightShadowData.lightSpaceViewProjectionMatrix * vec4(fragPos, 1.0);
+	vec4 fragPosLightClipSpace = spotLightShadowData[shadowIndex].lightSpaceViewProjectionMatrix * vec4(fragPos, 1.0);
 	vec3 ndcCoords = fragPosLightClipSpace.xyz / fragPosLightClipSpace.w;
 	vec3 depthmapCoords = ndcCoords * 0.5 + 0.5;
 
+	// Anything outside of the light's tile is unshadowed, the same as the border of a standalone shadowmap
 	float currentDepth = depthmapCoords.z;
-	if (currentDepth > 1.0)
+	if (currentDepth > 1.0 || any(lessThan(depthmapCoords.xy, vec2(0.0))) || any(greaterThan(depthmapCoords.xy, vec2(1.0))))
 		return 0.0;
 
+	// Move into the light's tile in the atlas, the PCF taps are kept half a texel inside of it so they never filter in a neighbouring tile
+	vec4 atlasRect = spotLightShadowData[shadowIndex].atlasRect;
+	vec2 texelSize = 1.0 / textureSize(spotLightShadowAtlas, 0);
+	vec2 atlasCoords = atlasRect.xy + depthmapCoords.xy * atlasRect.zw;
+	vec2 tileMin = atlasRect.xy + texelSize * 0.5;
+	vec2 tileMax = atlasRect.xy + atlasRect.zw - texelSize * 0.5;
+
 	// Perform Percentage Closer Filtering (PCF) in order to produce soft shadows - Use bilinear filtering to get some free samples (4 bilinear samples, 4 samples -> 16 values actually processed)
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(spotLightShadowmap, 0);
 	for (float y = -1.5; y < 1.0; y += 2.0) {
 		for (float x = -1.5; x < 1.0; x += 2.0) {
-			float sampledDepthPCF = texture(spotLightShadowmap, depthmapCoords.xy + (texelSize * vec2(x, y))).r;
-			shadow += currentDepth > sampledDepthPCF + spotLightShadowData.shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
+			float sampledDepthPCF = texture(spotLightShadowAtlas, clamp(atlasCoords + (texelSize * vec2(x, y)), tileMin, tileMax)).r;
+			shadow += currentDepth > sampledDepthPCF + spotLightShadowData[shadowIndex].shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
 		}
 	}
 	shadow *= 0.25;
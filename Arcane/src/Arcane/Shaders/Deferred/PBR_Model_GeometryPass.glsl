@@ -1,3 +1,4 @@
+// Permutations: SKINNED, INSTANCED
 #shader-type vertex
 #version 430 core
 
@@ -6,6 +7,10 @@ layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 texCoords;
 layout (location = 3) in vec3 tangent;
 layout (location = 4) in vec3 bitangent;
+#ifdef INSTANCED
+layout (location = 7) in mat4 instanceModel; // Per instance, takes up locations 7 to 10
+layout (location = 11) in mat3 instanceNormalMatrix; // Per instance, takes up locations 11 to 13
+#endif
 
 out mat3 TBN;
 out vec2 TexCoords;
@@ -13,22 +18,38 @@ out vec3 FragPosTangentSpace;
 out vec3 ViewPosTangentSpace;
 
 uniform bool hasDisplacement;
-uniform vec3 viewPos;
 
+#include "Include/CameraUniforms.glsl"
+
+#ifdef INSTANCED
+#define model instanceModel
+#define normalMatrix instanceNormalMatrix
+#else
 uniform mat3 normalMatrix;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#endif
+
+#ifdef SKINNED
+#include "Include/Skinning.glsl"
+#endif
 
 void main() {
+#ifdef SKINNED
+	mat4 boneTransform = CalculateBoneTransform();
+	mat3 tangentToWorld = mat3(boneTransform) * normalMatrix;
+	vec4 localPos = boneTransform * vec4(position, 1.0f);
+#else
 	// Use the normal matrix to maintain the orthogonal property of a vector when it is scaled non-uniformly
-	vec3 T = normalize(normalMatrix * tangent);
-	vec3 B = normalize(normalMatrix * bitangent);
-	vec3 N = normalize(normalMatrix * normal);
+	mat3 tangentToWorld = normalMatrix;
+	vec4 localPos = vec4(position, 1.0f);
+#endif
+	vec3 T = normalize(tangentToWorld * tangent);
+	vec3 B = normalize(tangentToWorld * bitangent);
+	vec3 N = normalize(tangentToWorld * normal);
 	TBN = mat3(T, B, N);
 
 	TexCoords = texCoords;
-	vec3 fragPos = vec3(model * vec4(position, 1.0f));
+	vec3 fragPos = vec3(model * localPos);
 	if (hasDisplacement) {
 		mat3 inverseTBN = transpose(TBN); // Calculate matrix to go from world -> tangent (orthogonal matrix's transpose = inverse)
 		FragPosTangentSpace = inverseTBN * fragPos;
@@ -76,8 +97,9 @@ uniform float parallaxStrength;
 uniform bool hasEmission;
 uniform Material material;
 
+#include "Include/NormalMapping.glsl"
+
 // Functions
-vec3 UnpackNormal(vec3 textureNormal);
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDirTangentSpace);
 
 void main() {
@@ -123,11 +145,6 @@ void main() {
 	gb_MaterialInfo = vec4(metallic, roughness, ao, emissionIntensity);
 }
 
-// Unpacks the normal from the texture and returns the normal in tangent space
-vec3 UnpackNormal(vec3 textureNormal) {
-	return normalize(textureNormal * 2.0 - 1.0);
-}
-
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDirTangentSpace) {
 	// Figure out the LoD we should sample from while raymarching the heightfield in tangent space. Required to fix an artifacting issue
 	vec2 lodInfo = textureQueryLod(material.texture_displacement, texCoords);
@@ -12,8 +12,8 @@ out vec2 TexCoords;
 
 uniform mat3 normalMatrix;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "Include/CameraUniforms.glsl"
 
 void main() {
 	// Use the normal matrix to maintain the orthogonal property of a vector when it is scaled non-uniformly
@@ -72,8 +72,7 @@ in vec2 TexCoords;
 
 uniform Material material;
 
-// Functions
-vec3 UnpackNormal(vec3 textureNormal);
+#include "Include/NormalMapping.glsl"
 
 void main() {
 	vec4 blendMapColour = texture(material.blendmap, TexCoords);
@@ -118,8 +117,3 @@ void main() {
 	gb_Normal = normal;
 	gb_MaterialInfo = vec4(metallic, roughness, ao, 0.0);
 }
-
-// Unpacks the normal from the texture and returns the normal in tangent space
-vec3 UnpackNormal(vec3 textureNormal) {
-	return normalize(textureNormal * 2.0 - 1.0);
-}
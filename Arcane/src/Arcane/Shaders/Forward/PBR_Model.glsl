@@ -1,3 +1,4 @@
+// Permutations: SKINNED, INSTANCED, USE_IBL
 #shader-type vertex
 #version 430 core
 
@@ -6,6 +7,10 @@ layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 texCoords;
 layout (location = 3) in vec3 tangent;
 layout (location = 4) in vec3 bitangent;
+#ifdef INSTANCED
+layout (location = 7) in mat4 instanceModel; // Per instance, takes up locations 7 to 10
+layout (location = 11) in mat3 instanceNormalMatrix; // Per instance, takes up locations 11 to 13
+#endif
 
 out mat3 TBN;
 out vec2 TexCoords;
@@ -14,25 +19,41 @@ out vec3 FragPosTangentSpace;
 out vec3 ViewPosTangentSpace;
 
 uniform bool hasDisplacement;
-uniform vec3 viewPos;
+
+#include "Include/CameraUniforms.glsl"
 
 uniform bool usesClipPlane;
 uniform vec4 clipPlane;
 
+#ifdef INSTANCED
+#define model instanceModel
+#define normalMatrix instanceNormalMatrix
+#else
 uniform mat3 normalMatrix;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#endif
+
+#ifdef SKINNED
+#include "Include/Skinning.glsl"
+#endif
 
 void main() {
+#ifdef SKINNED
+	mat4 boneTransform = CalculateBoneTransform();
+	mat3 tangentToWorld = mat3(boneTransform) * normalMatrix;
+	vec4 localPos = boneTransform * vec4(position, 1.0f);
+#else
 	// Use the normal matrix to maintain the orthogonal property of a vector when it is scaled non-uniformly
-	vec3 T = normalize(normalMatrix * tangent);
-	vec3 B = normalize(normalMatrix * bitangent);
-	vec3 N = normalize(normalMatrix * normal);
+	mat3 tangentToWorld = normalMatrix;
+	vec4 localPos = vec4(position, 1.0f);
+#endif
+	vec3 T = normalize(tangentToWorld * tangent);
+	vec3 B = normalize(tangentToWorld * bitangent);
+	vec3 N = normalize(tangentToWorld * normal);
 	TBN = mat3(T, B, N);
 
 	TexCoords = texCoords;
-	FragPos = vec3(model * vec4(position, 1.0f));
+	FragPos = vec3(model * localPos);
 	if (hasDisplacement) {
 		mat3 inverseTBN = transpose(TBN); // Calculate matrix to go from world -> tangent (orthogonal matrix's transpose = inverse)
 		FragPosTangentSpace = inverseTBN * FragPos;
@@ -68,48 +89,6 @@ struct Material {
 	bool hasAlbedoTexture, hasMetallicTexture, hasRoughnessTexture, hasEmissionTexture;
 };
 
-struct DirLight {
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-};
-
-struct PointLight {
-	vec3 position;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-};
-
-struct SpotLight {
-	vec3 position;
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-
-	float cutOff;
-	float outerCutOff;
-};
-
-struct ShadowData {
-	mat4 lightSpaceViewProjectionMatrix;
-	float shadowBias;
-	int lightShadowIndex;
-};
-
-struct ShadowDataPointLight {
-	float farPlane;
-	float shadowBias;
-	int lightShadowIndex;
-};
-
-#define MAX_DIR_LIGHTS 3
-#define MAX_POINT_LIGHTS 6
-#define MAX_SPOT_LIGHTS 6
 const float PI = 3.14159265359;
 
 in mat3 TBN;
@@ -120,38 +99,32 @@ in vec3 ViewPosTangentSpace;
 
 out vec4 color;
 
-// IBL
+// IBL, only compiled into the USE_IBL permutation
+#ifdef USE_IBL
 uniform int reflectionProbeMipCount;
-uniform bool computeIBL;
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
+#endif
 
-// Lighting
-uniform ivec4 numDirPointSpotLights;
-uniform DirLight dirLights[MAX_DIR_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+#include "Include/LightUniforms.glsl"
 
-// Shadow Data
-uniform sampler2D dirLightShadowmap;
-uniform ShadowData dirLightShadowData;
-uniform sampler2D spotLightShadowmap;
-uniform ShadowData spotLightShadowData;
-uniform samplerCube pointLightShadowCubemap;
-uniform ShadowDataPointLight pointLightShadowData;
+#include "Include/ShadowUniforms.glsl"
 
 uniform bool hasDisplacement;
 uniform vec2 minMaxDisplacementSteps;
 uniform float parallaxStrength;
 uniform bool hasEmission;
 uniform Material material;
-uniform vec3 viewPos;
+
+#include "Include/CameraUniforms.glsl"
+
+#include "Include/LightClusters.glsl"
 
 // Light radiance calculations
 vec3 CalculateDirectionalLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity);
-vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity);
-vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity);
+vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster);
+vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster);
 
 // Cook-Torrance BRDF functions adopted by Epic for UE4
 float NormalDistributionGGX(vec3 normal, vec3 halfwayNorm, float roughness);
@@ -159,10 +132,11 @@ float GeometrySmith(vec3 normal, vec3 viewDirNorm, vec3 lightDirNorm, float roug
 float GeometrySchlickGGX(float cosTheta, float roughness);
 vec3 FresnelSchlick(float cosTheta, vec3 baseReflectivity);
 
+#include "Include/NormalMapping.glsl"
+
 // Other function prototypes
-vec3 UnpackNormal(vec3 textureNormal);
 float CalculateDirLightShadow();
-float CalculateSpotLightShadow();
+float CalculateSpotLightShadow(int shadowIndex);
 float CalculatePointLightShadow(vec3 lightToFrag);
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDirTangentSpace);
 
@@ -201,27 +175,28 @@ void main() {
 	vec3 baseReflectivity = vec3(0.04);
 	baseReflectivity = mix(baseReflectivity, albedo, metallic);
 
-	// Calculate per light radiance for all of the direct lighting
+	// Calculate per light radiance for all of the direct lighting, point and spot lights only loop over the lights binned into this fragment's cluster
+	uint lightCluster = GetLightClusterIndex(FragPos);
 	vec3 directLightIrradiance = vec3(0.0);
 	directLightIrradiance += CalculateDirectionalLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity);
-	directLightIrradiance += CalculatePointLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity);
-	directLightIrradiance += CalculateSpotLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity);
+	directLightIrradiance += CalculatePointLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity, lightCluster);
+	directLightIrradiance += CalculateSpotLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity, lightCluster);
 
 	// Calcualte ambient IBL for both diffuse and specular
 	vec3 ambient = vec3(0.05) * albedo * ao;
-	if (computeIBL) {
-		vec3 specularRatio = FresnelSchlick(max(dot(normal, fragToViewNorm), 0.0), baseReflectivity);
-		vec3 diffuseRatio = vec3(1.0) - specularRatio;
-		diffuseRatio *= 1.0 - metallic;
+#ifdef USE_IBL
+	vec3 specularRatio = FresnelSchlick(max(dot(normal, fragToViewNorm), 0.0), baseReflectivity);
+	vec3 diffuseRatio = vec3(1.0) - specularRatio;
+	diffuseRatio *= 1.0 - metallic;
 
-		vec3 indirectDiffuse = texture(irradianceMap, normal).rgb * albedo * diffuseRatio;
+	vec3 indirectDiffuse = texture(irradianceMap, normal).rgb * albedo * diffuseRatio;
 
-		vec3 prefilterColour = textureLod(prefilterMap, reflectionVec, unclampedRoughness * (reflectionProbeMipCount - 1)).rgb;
-		vec2 brdfIntegration = texture(brdfLUT, vec2(max(dot(normal, fragToViewNorm), 0.0), roughness)).rg;
-		vec3 indirectSpecular = prefilterColour * (specularRatio * brdfIntegration.x + brdfIntegration.y);
+	vec3 prefilterColour = textureLod(prefilterMap, reflectionVec, unclampedRoughness * (reflectionProbeMipCount - 1)).rgb;
+	vec2 brdfIntegration = texture(brdfLUT, vec2(max(dot(normal, fragToViewNorm), 0.0), roughness)).rg;
+	vec3 indirectSpecular = prefilterColour * (specularRatio * brdfIntegration.x + brdfIntegration.y);
 
-		ambient = (indirectDiffuse + indirectSpecular) * ao;
-	}
+	ambient = (indirectDiffuse + indirectSpecular) * ao;
+#endif
 
 	color = vec4(ambient + directLightIrradiance, albedoAlpha);
 }
@@ -265,10 +240,11 @@ vec3 CalculateDirectionalLightRadiance(vec3 albedo, vec3 normal, float metallic,
 }
 
 
-vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity) {
+vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster) {
 	vec3 pointLightIrradiance = vec3(0.0);
 
-	for (int i = 0; i < numDirPointSpotLights.y; ++i) {
+	for (uint c = 0u; c < clusterLightCounts[lightCluster].x; ++c) {
+		int i = GetClusterPointLight(lightCluster, c);
 		vec3 fragToLightNorm = normalize(pointLights[i].position - FragPos);
 		vec3 halfwayNorm = normalize(fragToViewNorm + fragToLightNorm);
 		vec3 lightToFrag = FragPos - pointLights[i].position;
@@ -313,10 +289,11 @@ vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float
 }
 
 
-vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity) {
+vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster) {
 	vec3 spotLightIrradiance = vec3(0.0);
 
-	for (int i = 0; i < numDirPointSpotLights.z; ++i) {
+	for (uint c = 0u; c < clusterLightCounts[lightCluster].y; ++c) {
+		int i = GetClusterSpotLight(lightCluster, c);
 		vec3 fragToLightNorm = normalize(spotLights[i].position - FragPos);
 		vec3 halfwayNorm = normalize(fragToViewNorm + fragToLightNorm);
 		float fragToLightDistance = length(spotLights[i].position - FragPos);
@@ -352,10 +329,8 @@ vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float
 		// Also calculate the diffuse, a lambertian calculation will be added onto the final radiance calculation
 		vec3 diffuse = diffuseRatio * albedo / PI;
 
-		// Calculate shadows, but first check to make sure the current light index is the shadow caster
-		float shadowAmount = 0.0f;
-		if (i == spotLightShadowData.lightShadowIndex)
-			shadowAmount = CalculateSpotLightShadow();
+		// Calculate shadows, lights that weren't given a tile in the shadow atlas this frame have no shadow
+		float shadowAmount = CalculateSpotLightShadow(spotLights[i].shadowIndex);
 
 		// Add the light's radiance to the irradiance sum
 		spotLightIrradiance += (diffuse + specular) * radiance * max(dot(normal, fragToLightNorm), 0.0) * (1.0 - shadowAmount);
@@ -403,17 +378,16 @@ vec3 FresnelSchlick(float cosTheta, vec3 baseReflectivity) {
 }
 
 
-// Unpacks the normal from the texture and returns the normal in tangent space
-vec3 UnpackNormal(vec3 textureNormal) {
-	return normalize(textureNormal * 2.0 - 1.0);
-}
-
-
 float CalculateDirLightShadow() {
 	if (dirLightShadowData.lightShadowIndex == -1)
 		return 0.0;
 
-	vec4 fragPosLightClipSpace = dirLightShadowData.lightSpaceViewProjectionMatrix * vec4(FragPos, 1.0);
+	// Each cascade covers a range of view depths, past the last one nothing is shadowed
+	int cascade = GetDirLightShadowCascade(-(view * vec4(FragPos, 1.0)).z);
+	if (cascade == -1)
+		return 0.0;
+
+	vec4 fragPosLightClipSpace = dirLightShadowData.cascadeViewProjectionMatrices[cascade] * vec4(FragPos, 1.0);
 	vec3 ndcCoords = fragPosLightClipSpace.xyz / fragPosLightClipSpace.w;
 	vec3 depthmapCoords = ndcCoords * 0.5 + 0.5;
 
@@ -423,10 +397,10 @@ float CalculateDirLightShadow() {
 
 	// Perform Percentage Closer Filtering (PCF) in order to produce soft shadows - Use bilinear filtering to get some free samples (4 bilinear samples, 4 samples -> 16 values actually processed)
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(dirLightShadowmap, 0);
+	vec2 texelSize = 1.0 / textureSize(dirLightShadowmap, 0).xy;
 	for (float y = -1.5; y < 1.0; y += 2.0) {
 		for (float x = -1.5; x < 1.0; x += 2.0) {
-			float sampledDepthPCF = texture(dirLightShadowmap, depthmapCoords.xy + (texelSize * vec2(x, y))).r;
+			float sampledDepthPCF = texture(dirLightShadowmap, vec3(depthmapCoords.xy + (texelSize * vec2(x, y)), cascade)).r;
 			shadow += currentDepth > sampledDepthPCF + dirLightShadowData.shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
 		}
 	}
@@ -435,25 +409,32 @@ float CalculateDirLightShadow() {
 	return shadow;
 }
 
-float CalculateSpotLightShadow() {
-	if (spotLightShadowData.lightShadowIndex == -1)
+float CalculateSpotLightShadow(int shadowIndex) {
+	if (shadowIndex == -1)
 		return 0.0;
 
-	vec4 fragPosLightClipSpace = spotLightShadowData.lightSpaceViewProjectionMatrix * vec4(FragPos, 1.0);
+	vec4 fragPosLightClipSpace = spotLightShadowData[shadowIndex].lightSpaceViewProjectionMatrix * vec4(FragPos, 1.0);
 	vec3 ndcCoords = fragPosLightClipSpace.xyz / fragPosLightClipSpace.w;
 	vec3 depthmapCoords = ndcCoords * 0.5 + 0.5;
 
+	// Anything outside of the light's tile is unshadowed, the same as the border of a standalone shadowmap
 	float currentDepth = depthmapCoords.z;
-	if (currentDepth > 1.0)
+	if (currentDepth > 1.0 || any(lessThan(depthmapCoords.xy, vec2(0.0))) || any(greaterThan(depthmapCoords.xy, vec2(1.0))))
 		return 0.0;
 
+	// Move into the light's tile in the atlas, the PCF taps are kept half a texel inside of it so they never filter in a neighbouring tile
+	vec4 atlasRect = spotLightShadowData[shadowIndex].atlasRect;
+	vec2 texelSize = 1.0 / textureSize(spotLightShadowAtlas, 0);
+	vec2 atlasCoords = atlasRect.xy + depthmapCoords.xy * atlasRect.zw;
+	vec2 tileMin = atlasRect.xy + texelSize * 0.5;
+	vec2 tileMax = atlasRect.xy + atlasRect.zw - texelSize * 0.5;
+
 	// Perform Percentage Closer Filtering (PCF) in order to produce soft shadows - Use bilinear filtering to get some free samples (4 bilinear samples, 4 samples -> 16 values actually processed)
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(spotLightShadowmap, 0);
 	for (float y = -1.5; y < 1.0; y += 2.0) {
 		for (float x = -1.5; x < 1.0; x += 2.0) {
-			float sampledDepthPCF = texture(spotLightShadowmap, depthmapCoords.xy + (texelSize * vec2(x, y))).r;
-			shadow += currentDepth > sampledDepthPCF + spotLightShadowData.shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
+			float sampledDepthPCF = texture(spotLightShadowAtlas, clamp(atlasCoords + (texelSize * vec2(x, y)), tileMin, tileMax)).r;
+			shadow += currentDepth > sampledDepthPCF + spotLightShadowData[shadowIndex].shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
 		}
 	}
 	shadow *= 0.25;
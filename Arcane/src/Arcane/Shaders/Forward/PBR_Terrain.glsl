@@ -16,8 +16,8 @@ uniform vec4 clipPlane;
 
 uniform mat3 normalMatrix;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "Include/CameraUniforms.glsl"
 
 void main() {
 	// Use the normal matrix to maintain the orthogonal property of a vector when it is scaled non-uniformly
@@ -71,48 +71,6 @@ struct Material {
 	float tilingAmount;
 };
 
-struct DirLight {
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-};
-
-struct PointLight {
-	vec3 position;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-};
-
-struct SpotLight {
-	vec3 position;
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-
-	float cutOff;
-	float outerCutOff;
-};
-
-struct ShadowData {
-	mat4 lightSpaceViewProjectionMatrix;
-	float shadowBias;
-	int lightShadowIndex;
-};
-
-struct ShadowDataPointLight {
-	float farPlane;
-	float shadowBias;
-	int lightShadowIndex;
-};
-
-#define MAX_DIR_LIGHTS 3
-#define MAX_POINT_LIGHTS 6
-#define MAX_SPOT_LIGHTS 6
 const float PI = 3.14159265359;
 
 in mat3 TBN;
@@ -121,26 +79,20 @@ in vec3 FragPos;
 
 out vec4 color;
 
-// Shadow Data
-uniform sampler2D dirLightShadowmap;
-uniform ShadowData dirLightShadowData;
-uniform sampler2D spotLightShadowmap;
-uniform ShadowData spotLightShadowData;
-uniform samplerCube pointLightShadowCubemap;
-uniform ShadowDataPointLight pointLightShadowData;
+#include "Include/ShadowUniforms.glsl"
 
-uniform ivec4 numDirPointSpotLights;
-uniform DirLight dirLights[MAX_DIR_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+#include "Include/LightUniforms.glsl"
 
 uniform Material material;
-uniform vec3 viewPos;
+
+#include "Include/CameraUniforms.glsl"
+
+#include "Include/LightClusters.glsl"
 
 // Light radiance calculations
 vec3 CalculateDirectionalLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity);
-vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity);
-vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity);
+vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster);
+vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster);
 
 // Cook-Torrance BRDF functions adopted by Epic for UE4
 float NormalDistributionGGX(vec3 normal, vec3 halfwayNorm, float roughness);
@@ -148,10 +100,11 @@ float GeometrySmith(vec3 normal, vec3 viewDirNorm, vec3 lightDirNorm, float roug
 float GeometrySchlickGGX(float cosTheta, float roughness);
 vec3 FresnelSchlick(float cosTheta, vec3 baseReflectivity);
 
+#include "Include/NormalMapping.glsl"
+
 // Other function prototypes
-vec3 UnpackNormal(vec3 textureNormal);
 float CalculateDirLightShadow();
-float CalculateSpotLightShadow();
+float CalculateSpotLightShadow(int shadowIndex);
 float CalculatePointLightShadow(vec3 lightToFrag);
 
 void main() {
@@ -199,11 +152,12 @@ void main() {
 	vec3 baseReflectivity = vec3(0.04);
 	baseReflectivity = mix(baseReflectivity, albedo, metallic);
 
-	// Calculate per light radiance for all of the direct lighting
+	// Calculate per light radiance for all of the direct lighting, point and spot lights only loop over the lights binned into this fragment's cluster
+	uint lightCluster = GetLightClusterIndex(FragPos);
 	vec3 directLightIrradiance = vec3(0.0);
 	directLightIrradiance += CalculateDirectionalLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity);
-	directLightIrradiance += CalculatePointLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity);
-	directLightIrradiance += CalculateSpotLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity);
+	directLightIrradiance += CalculatePointLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity, lightCluster);
+	directLightIrradiance += CalculateSpotLightRadiance(albedo, normal, metallic, roughness, fragToViewNorm, baseReflectivity, lightCluster);
 
 	// Calculate ambient term
 	vec3 ambient = vec3(0.05) * albedo * ao;
@@ -251,10 +205,11 @@ vec3 CalculateDirectionalLightRadiance(vec3 albedo, vec3 normal, float metallic,
 }
 
 
-vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity) {
+vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster) {
 	vec3 pointLightIrradiance = vec3(0.0);
 
-	for (int i = 0; i < numDirPointSpotLights.y; ++i) {
+	for (uint c = 0u; c < clusterLightCounts[lightCluster].x; ++c) {
+		int i = GetClusterPointLight(lightCluster, c);
 		vec3 fragToLightNorm = normalize(pointLights[i].position - FragPos);
 		vec3 halfwayNorm = normalize(fragToViewNorm + fragToLightNorm);
 		vec3 lightToFrag = FragPos - pointLights[i].position;
@@ -299,10 +254,11 @@ vec3 CalculatePointLightRadiance(vec3 albedo, vec3 normal, float metallic, float
 }
 
 
-vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity) {
+vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float roughness, vec3 fragToViewNorm, vec3 baseReflectivity, uint lightCluster) {
 	vec3 spotLightIrradiance = vec3(0.0);
 
-	for (int i = 0; i < numDirPointSpotLights.z; ++i) {
+	for (uint c = 0u; c < clusterLightCounts[lightCluster].y; ++c) {
+		int i = GetClusterSpotLight(lightCluster, c);
 		vec3 fragToLightNorm = normalize(spotLights[i].position - FragPos);
 		vec3 halfwayNorm = normalize(fragToViewNorm + fragToLightNorm);
 		float fragToLightDistance = length(spotLights[i].position - FragPos);
@@ -338,10 +294,8 @@ vec3 CalculateSpotLightRadiance(vec3 albedo, vec3 normal, float metallic, float
 		// Also calculate the diffuse, a lambertian calculation will be added onto the final radiance calculation
 		vec3 diffuse = diffuseRatio * albedo / PI;
 
-		// Calculate shadows, but first check to make sure the current light index is the shadow caster
-		float shadowAmount = 0.0f;
-		if (i == spotLightShadowData.lightShadowIndex)
-			shadowAmount = CalculateSpotLightShadow();
+		// Calculate shadows, lights that weren't given a tile in the shadow atlas this frame have no shadow
+		float shadowAmount = CalculateSpotLightShadow(spotLights[i].shadowIndex);
 
 		// Add the light's radiance to the irradiance sum
 		spotLightIrradiance += (diffuse + specular) * radiance * max(dot(normal, fragToLightNorm), 0.0) * (1.0 - shadowAmount);
@@ -389,17 +343,16 @@ vec3 FresnelSchlick(float cosTheta, vec3 baseReflectivity) {
 }
 
 
-// Unpacks the normal from the texture and returns the normal in tangent space
-vec3 UnpackNormal(vec3 textureNormal) {
-	return normalize(textureNormal * 2.0 - 1.0);
-}
-
-
 float CalculateDirLightShadow() {
 	if (dirLightShadowData.lightShadowIndex == -1)
 		return 0.0;
 
-	vec4 fragPosLightClipSpace = dirLightShadowData.lightSpaceViewProjectionMatrix * vec4(FragPos, 1.0);
+	// Each cascade covers a range of view depths, past the last one nothing is shadowed
+	int cascade = GetDirLightShadowCascade(-(view * vec4(FragPos, 1.0)).z);
+	if (cascade == -1)
+		return 0.0;
+
+	vec4 fragPosLightClipSpace = dirLightShadowData.cascadeViewProjectionMatrices[cascade] * vec4(FragPos, 1.0);
 	vec3 ndcCoords = fragPosLightClipSpace.xyz / fragPosLightClipSpace.w;
 	vec3 depthmapCoords = ndcCoords * 0.5 + 0.5;
 
@@ -409,10 +362,10 @@ float CalculateDirLightShadow() {
 
 	// Perform Percentage Closer Filtering (PCF) in order to produce soft shadows - Use bilinear filtering to get some free samples (4 bilinear samples, 4 samples -> 16 values actually processed)
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(dirLightShadowmap, 0);
+	vec2 texelSize = 1.0 / textureSize(dirLightShadowmap, 0).xy;
 	for (float y = -1.5; y < 1.0; y += 2.0) {
 		for (float x = -1.5; x < 1.0; x += 2.0) {
-			float sampledDepthPCF = texture(dirLightShadowmap, depthmapCoords.xy + (texelSize * vec2(x, y))).r;
+			float sampledDepthPCF = texture(dirLightShadowmap, vec3(depthmapCoords.xy + (texelSize * vec2(x, y)), cascade)).r;
 			shadow += currentDepth > sampledDepthPCF + dirLightShadowData.shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
 		}
 	}
@@ -421,25 +374,32 @@ float CalculateDirLightShadow() {
 	return shadow;
 }
 
-float CalculateSpotLightShadow() {
-	if (spotLightShadowData.lightShadowIndex == -1)
+float CalculateSpotLightShadow(int shadowIndex) {
+	if (shadowIndex == -1)
 		return 0.0;
 
-	vec4 fragPosLightClipSpace = spotLightShadowData.lightSpaceViewProjectionMatrix * vec4(FragPos, 1.0);
+	vec4 fragPosLightClipSpace = spotLightShadowData[shadowIndex].lightSpaceViewProjectionMatrix * vec4(FragPos, 1.0);
 	vec3 ndcCoords = fragPosLightClipSpace.xyz / fragPosLightClipSpace.w;
 	vec3 depthmapCoords = ndcCoords * 0.5 + 0.5;
 
+	// Anything outside of the light's tile is unshadowed, the same as the border of a standalone shadowmap
 	float currentDepth = depthmapCoords.z;
-	if (currentDepth > 1.0)
+	if (currentDepth > 1.0 || any(lessThan(depthmapCoords.xy, vec2(0.0))) || any(greaterThan(depthmapCoords.xy, vec2(1.0))))
 		return 0.0;
 
+	// Move into the light's tile in the atlas, the PCF taps are kept half a texel inside of it so they never filter in a neighbouring tile
+	vec4 atlasRect = spotLightShadowData[shadowIndex].atlasRect;
+	vec2 texelSize = 1.0 / textureSize(spotLightShadowAtlas, 0);
+	vec2 atlasCoords = atlasRect.xy + depthmapCoords.xy * atlasRect.zw;
+	vec2 tileMin = atlasRect.xy + texelSize * 0.5;
+	vec2 tileMax = atlasRect.xy + atlasRect.zw - texelSize * 0.5;
+
 	// Perform Percentage Closer Filtering (PCF) in order to produce soft shadows - Use bilinear filtering to get some free samples (4 bilinear samples, 4 samples -> 16 values actually processed)
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(spotLightShadowmap, 0);
 	for (float y = -1.5; y < 1.0; y += 2.0) {
 		for (float x = -1.5; x < 1.0; x += 2.0) {
-			float sampledDepthPCF = texture(spotLightShadowmap, depthmapCoords.xy + (texelSize * vec2(x, y))).r;
-			shadow += currentDepth > sampledDepthPCF + spotLightShadowData.shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
+			float sampledDepthPCF = texture(spotLightShadowAtlas, clamp(atlasCoords + (texelSize * vec2(x, y)), tileMin, tileMax)).r;
+			shadow += currentDepth > sampledDepthPCF + spotLightShadowData[shadowIndex].shadowBias ? 1.0 : 0.0; // Add shadow bias to avoid shadow acne. However too much bias can cause peter panning
 		}
 	}
 	shadow *= 0.25;
@@ -0,0 +1,8 @@
+// Filled once per view by Renderer::BindCameraUniforms
+layout (std140, binding = 0) uniform CameraUniforms {
+	mat4 view;
+	mat4 projection;
+	mat4 viewInverse;
+	mat4 projectionInverse;
+	vec3 viewPos;
+};
@@ -0,0 +1,44 @@
+// Filled by LightClusters::Build, the LIGHT_CLUSTER_* sizes are injected by the engine. Every cluster owns LIGHT_CLUSTER_MAX_LIGHTS entries of the index list,
+// its point lights come first followed by its spot lights
+layout (std140, binding = 3) uniform LightClusterUniforms {
+	float clusterDepthSliceScale;
+	float clusterDepthSliceBias;
+	float clusterNearPlane;
+	float clusterFarPlane;
+};
+
+#ifdef LIGHT_CLUSTER_BUILD
+#define LIGHT_CLUSTER_ACCESS writeonly
+#else
+#define LIGHT_CLUSTER_ACCESS readonly
+#endif
+
+// x is the number of point lights in the cluster and y the number of spot lights
+layout (std430, binding = 6) LIGHT_CLUSTER_ACCESS buffer LightClusterCounts {
+	uvec2 clusterLightCounts[];
+};
+
+layout (std430, binding = 7) LIGHT_CLUSTER_ACCESS buffer LightClusterIndices {
+	uint clusterLightIndices[];
+};
+
+#ifndef LIGHT_CLUSTER_BUILD
+// Needs the CameraUniforms block, the cluster is found the same way the binning shader laid them out (screen tile from NDC and a log depth slice)
+uint GetLightClusterIndex(vec3 fragPos) {
+	vec4 viewSpacePos = view * vec4(fragPos, 1.0);
+	vec4 clipSpacePos = projection * viewSpacePos;
+	vec2 tile = clamp(clipSpacePos.xy / clipSpacePos.w * 0.5 + 0.5, 0.0, 0.99999) * vec2(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y);
+	float slice = log(max(-viewSpacePos.z, clusterNearPlane)) * clusterDepthSliceScale + clusterDepthSliceBias;
+	uint depthSlice = uint(clamp(slice, 0.0, float(LIGHT_CLUSTER_GRID_Z - 1)));
+	return (depthSlice * uint(LIGHT_CLUSTER_GRID_Y) + uint(tile.y)) * uint(LIGHT_CLUSTER_GRID_X) + uint(tile.x);
+}
+
+// Index into pointLights/spotLights of the n-th light of that type in the cluster
+int GetClusterPointLight(uint cluster, uint n) {
+	return int(clusterLightIndices[cluster * uint(LIGHT_CLUSTER_MAX_LIGHTS) + n]);
+}
+
+int GetClusterSpotLight(uint cluster, uint n) {
+	return int(clusterLightIndices[cluster * uint(LIGHT_CLUSTER_MAX_LIGHTS) + clusterLightCounts[cluster].x + n]);
+}
+#endif
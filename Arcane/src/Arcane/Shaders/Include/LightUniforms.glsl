@@ -0,0 +1,41 @@
+// Matches LightBindings::LightUniformData, MAX_DIR_LIGHTS is injected by the engine. Point and spot lights have no limit so they are read from storage buffers,
+// numDirPointSpotLights still holds how many of each there are
+struct DirLight {
+	vec3 direction;
+
+	float intensity;
+	vec3 lightColour;
+};
+
+struct PointLight {
+	vec3 position;
+
+	float intensity;
+	vec3 lightColour;
+	float attenuationRadius;
+};
+
+struct SpotLight {
+	vec3 position;
+	float intensity;
+	vec3 direction;
+	float attenuationRadius;
+	vec3 lightColour;
+
+	float cutOff;
+	float outerCutOff;
+	int shadowIndex; // Index into spotLightShadowData, -1 if the light has no tile in the shadow atlas
+};
+
+layout (std140, binding = 1) uniform LightUniforms {
+	ivec4 numDirPointSpotLights;
+	DirLight dirLights[MAX_DIR_LIGHTS];
+};
+
+layout (std430, binding = 4) readonly buffer PointLightBuffer {
+	PointLight pointLights[];
+};
+
+layout (std430, binding = 5) readonly buffer SpotLightBuffer {
+	SpotLight spotLights[];
+};
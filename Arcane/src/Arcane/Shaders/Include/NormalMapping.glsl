@@ -0,0 +1,6 @@
+// Unpacks the normal from the texture and returns the normal in tangent space
+// Only xy are read since normal maps can be compressed to two channels (BC5), z is rebuilt knowing the normal is unit length and faces out of the surface
+vec3 UnpackNormal(vec3 textureNormal) {
+	vec2 normalXY = textureNormal.xy * 2.0 - 1.0;
+	return normalize(vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0))));
+}
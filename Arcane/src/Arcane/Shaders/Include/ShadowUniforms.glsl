@@ -0,0 +1,41 @@
+// Matches LightManager::ShadowUniformData, the maps are bound to fixed units by the lighting passes
+
+// One per tile of the spot light shadow atlas, a spot light's shadowIndex picks its tile. The rect's xy is the tile's offset and zw its scale, SHADOW_ATLAS_MAX_LIGHTS is injected by the engine
+struct AtlasShadowData {
+	mat4 lightSpaceViewProjectionMatrix;
+	vec4 atlasRect;
+	float shadowBias;
+};
+
+// The split depths are the view space depth each cascade ends at, SHADOW_CASCADE_MAX_COUNT is injected by the engine
+struct CascadedShadowData {
+	mat4 cascadeViewProjectionMatrices[SHADOW_CASCADE_MAX_COUNT];
+	vec4 cascadeSplitDepths;
+	float shadowBias;
+	int lightShadowIndex;
+	int cascadeCount;
+};
+
+struct ShadowDataPointLight {
+	float farPlane;
+	float shadowBias;
+	int lightShadowIndex;
+};
+
+layout (binding = 0) uniform sampler2DArray dirLightShadowmap;
+layout (binding = 1) uniform sampler2D spotLightShadowAtlas;
+layout (binding = 2) uniform samplerCube pointLightShadowCubemap;
+layout (std140, binding = 2) uniform ShadowUniforms {
+	CascadedShadowData dirLightShadowData;
+	AtlasShadowData spotLightShadowData[SHADOW_ATLAS_MAX_LIGHTS];
+	ShadowDataPointLight pointLightShadowData;
+};
+
+// Returns the first cascade that reaches past the view space depth, or -1 if it is further than every cascade
+int GetDirLightShadowCascade(float viewDepth) {
+	for (int i = 0; i < dirLightShadowData.cascadeCount; ++i) {
+		if (viewDepth <= dirLightShadowData.cascadeSplitDepths[i])
+			return i;
+	}
+	return -1;
+}
@@ -0,0 +1,12 @@
+// Vertex stage only, MAX_BONES is injected by the engine
+layout (location = 5) in ivec4 boneIds;
+layout (location = 6) in vec4 weights;
+
+uniform mat4 bonesMatrices[MAX_BONES];
+
+mat4 CalculateBoneTransform() {
+	return bonesMatrices[boneIds[0]] * weights[0] +
+		   bonesMatrices[boneIds[1]] * weights[1] +
+		   bonesMatrices[boneIds[2]] * weights[2] +
+		   bonesMatrices[boneIds[3]] * weights[3];
+}
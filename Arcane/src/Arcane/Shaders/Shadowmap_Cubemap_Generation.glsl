@@ -0,0 +1,75 @@
+// Permutations: SKINNED, INSTANCED
+// Renders a point light's whole shadow cubemap in one pass, the geometry shader sends every triangle to the faces in layerMask (found on the CPU from the
+// model's bounds) and each face stores the distance to the light like the LINEAR_DEPTH permutation of Shadowmap_Generation
+#shader-type vertex
+#version 430 core
+
+layout (location = 0) in vec3 position;
+#ifdef INSTANCED
+layout (location = 7) in mat4 instanceModel; // Per instance, takes up locations 7 to 10
+#endif
+
+#ifdef INSTANCED
+#define model instanceModel
+#else
+uniform mat4 model;
+#endif
+
+#ifdef SKINNED
+#include "Include/Skinning.glsl"
+#endif
+
+void main() {
+#ifdef SKINNED
+	gl_Position = model * CalculateBoneTransform() * vec4(position, 1.0f);
+#else
+	gl_Position = model * vec4(position, 1.0f);
+#endif
+	// Left in world space, the geometry shader projects it once for every face it is sent to
+}
+
+
+
+
+#shader-type geometry
+#version 430 core
+
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 18) out;
+
+out vec4 worldFragPos;
+
+uniform mat4 faceViewProjectionMatrices[6]; // Same order as the cubemap's faces, +X -X +Y -Y +Z -Z
+uniform int layerMask; // Bit per face, batches of instances use every face any of them touch
+
+void main() {
+	for (int face = 0; face < 6; face++) {
+		if ((layerMask & (1 << face)) == 0)
+			continue;
+
+		gl_Layer = face;
+		for (int i = 0; i < 3; i++) {
+			worldFragPos = gl_in[i].gl_Position;
+			gl_Position = faceViewProjectionMatrices[face] * worldFragPos;
+			EmitVertex();
+		}
+		EndPrimitive();
+	}
+}
+
+
+
+
+#shader-type fragment
+#version 430 core
+
+in vec4 worldFragPos;
+
+uniform vec3 lightPos;
+uniform float lightFarPlane;
+
+void main() {
+	float lightDistance = length(worldFragPos.xyz - lightPos);
+	lightDistance = lightDistance / lightFarPlane; // Map value to [0, 1]
+	gl_FragDepth = lightDistance;
+}
@@ -1,13 +1,38 @@
+// Permutations: SKINNED, INSTANCED, LINEAR_DEPTH (point lights store the distance to the light instead of the projected depth)
 #shader-type vertex
 #version 430 core
 
 layout (location = 0) in vec3 position;
+#ifdef INSTANCED
+layout (location = 7) in mat4 instanceModel; // Per instance, takes up locations 7 to 10
+#endif
+
+#ifdef LINEAR_DEPTH
+out vec4 worldFragPos;
+#endif
 
 uniform mat4 lightSpaceViewProjectionMatrix;
+#ifdef INSTANCED
+#define model instanceModel
+#else
 uniform mat4 model;
+#endif
+
+#ifdef SKINNED
+#include "Include/Skinning.glsl"
+#endif
 
 void main() {
-	gl_Position = lightSpaceViewProjectionMatrix * model * vec4(position, 1.0f);
+#ifdef SKINNED
+	vec4 worldPos = model * CalculateBoneTransform() * vec4(position, 1.0f);
+#else
+	vec4 worldPos = model * vec4(position, 1.0f);
+#endif
+
+#ifdef LINEAR_DEPTH
+	worldFragPos = worldPos;
+#endif
+	gl_Position = lightSpaceViewProjectionMatrix * worldPos;
 }
 
 
@@ -16,6 +41,19 @@ void main() {
 #shader-type fragment
 #version 430 core
 
+#ifdef LINEAR_DEPTH
+in vec4 worldFragPos;
+
+uniform vec3 lightPos;
+uniform float lightFarPlane;
+#endif
+
 void main() {
+#ifdef LINEAR_DEPTH
+	float lightDistance = length(worldFragPos.xyz - lightPos);
+	lightDistance = lightDistance / lightFarPlane; // Map value to [0, 1]
+	gl_FragDepth = lightDistance;
+#else
 	// Nothing needs to be done, we just need to write to the depth buffer
+#endif
 }
@@ -9,11 +9,10 @@ out vec4 clipSpace;
 out vec2 planeTexCoords;
 out vec3 fragToView;
 
-uniform vec3 viewPos;
+#include "Include/CameraUniforms.glsl"
+
 uniform vec2 waveTiling;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
 	worldFragPos = vec3(model * vec4(position, 1.0));
@@ -30,37 +29,6 @@ void main() {
 #shader-type fragment
 #version 430 core
 
-#define MAX_DIR_LIGHTS 3
-#define MAX_POINT_LIGHTS 6
-#define MAX_SPOT_LIGHTS 6
-
-struct DirLight {
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-};
-
-struct PointLight {
-	vec3 position;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-};
-
-struct SpotLight {
-	vec3 position;
-	vec3 direction;
-
-	float intensity;
-	vec3 lightColour;
-	float attenuationRadius;
-
-	float cutOff;
-	float outerCutOff;
-};
-
 in vec3 worldFragPos;
 in vec4 clipSpace;
 in vec2 planeTexCoords;
@@ -75,14 +43,11 @@ uniform sampler2D dudvWaveTexture;
 uniform sampler2D normalMap;
 uniform sampler2D refractionDepthTexture;
 
-// Lighting
-uniform ivec4 numDirPointSpotLights;
-uniform DirLight dirLights[MAX_DIR_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+#include "Include/LightUniforms.glsl"
+
+#include "Include/CameraUniforms.glsl"
 
-uniform mat4 viewInverse;
-uniform mat4 projectionInverse;
+#include "Include/LightClusters.glsl"
 
 uniform bool reflectionEnabled;
 uniform bool refractionEnabled;
@@ -146,8 +111,9 @@ void main() {
 		normal = vec3(0.0, 1.0, 0.0);
 	}
 	else {
-		normal = texture(normalMap, distortion).rgb;
-		normal = normalize(vec3(normal.r * 2.0 - 1.0, normal.b * waterNormalSmoothing, normal.g * 2.0 - 1.0)); // Normal maps are in tangent space but we know tangent space z component = y component in world space since plane is always flat and assume normal is (0, 1, 0)
+		vec2 normalXY = texture(normalMap, distortion).rg * 2.0 - 1.0;
+		float normalZ = sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)) * 0.5 + 0.5; // Rebuilt since the normal map can be compressed to two channels (BC5), kept in the texture's [0, 1] range that the smoothing was tuned for
+		normal = normalize(vec3(normalXY.x, normalZ * waterNormalSmoothing, normalXY.y)); // Normal maps are in tangent space but we know tangent space z component = y component in world space since plane is always flat and assume normal is (0, 1, 0)
 	}
 	
 	vec3 viewVec = normalize(fragToView);
@@ -162,8 +128,10 @@ void main() {
 			specHighlight += dirLights[i].intensity * dirLights[i].lightColour * specular * dampeningEffect2;
 		}
 
-		// Point light specular contribution
-		for (int i = 0; i < numDirPointSpotLights.y; i++) {
+		// Point light specular contribution, point and spot lights only come from the lights binned into this fragment's cluster
+		uint lightCluster = GetLightClusterIndex(worldFragPos);
+		for (uint c = 0u; c < clusterLightCounts[lightCluster].x; c++) {
+			int i = GetClusterPointLight(lightCluster, c);
 			vec3 lightToFrag = worldFragPos - pointLights[i].position;
 			vec3 reflectedVec = reflect(normalize(lightToFrag), normal);
 			float specular = pow(max(dot(reflectedVec, viewVec), 0.0), shineDamper);
@@ -180,7 +148,8 @@ void main() {
 		}
 
 		// Spot light specular contribution
-		for (int i = 0; i < numDirPointSpotLights.z; i++) {
+		for (uint c = 0u; c < clusterLightCounts[lightCluster].y; c++) {
+			int i = GetClusterSpotLight(lightCluster, c);
 			vec3 lightToFrag = worldFragPos - spotLights[i].position;
 			vec3 lightToFragNorm = normalize(lightToFrag);
 			vec3 reflectedVec = reflect(lightToFragNorm, normal);
@@ -3,26 +3,31 @@
 
 #include <Arcane/Graphics/Texture/Cubemap.h>
 #include <Arcane/Graphics/Mesh/Model.h>
+#include <Arcane/Graphics/Texture/Texture.h>
+#include <Arcane/Util/Loaders/TextureStreamer.h>
+#include <Arcane/Util/Timer.h>
 
 namespace Arcane
 {
-	AssetManager::AssetManager() : m_AsyncLoadingActive(true)
+	enum UploadQueue
+	{
+		UploadQueueTextures = 0,
+		UploadQueueCubemaps,
+		UploadQueueModels,
+		UploadQueueCount
+	};
+
+	static constexpr double InitialUploadBytesPerMS = 512.0 * 1024.0; // Starting guess for the throughput until some uploads have been measured
+	static constexpr double UploadRateSmoothing = 0.1;
+
+	AssetManager::AssetManager() : m_JobSystem(JobSystem::GetInstance())
 	{
-		// Query for how many cores are on the machine
-		int threadCount = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() / 2: 2;
-		ARC_LOG_INFO("Spawning {0} threads for the asset manager", threadCount);
-		for (int i = 0; i < threadCount; i++)
-		{
-			m_WorkerThreads.push_back(std::thread(&AssetManager::LoaderThread, this));
-		}
 	}
 
 	AssetManager::~AssetManager()
 	{
-		for (int i = 0; i < m_WorkerThreads.size(); i++)
-		{
-			m_WorkerThreads[i].join();
-		}
+		// Queued loads capture the asset manager, the job system outlives it so they have to finish before the members are torn down
+		m_JobSystem.WaitForIdle();
 	}
 
 	AssetManager& AssetManager::GetInstance()
@@ -65,8 +70,14 @@ namespace Arcane
 			job.callback = callback;
 		m_ModelCache.insert(std::pair<std::string, Model*>(path, model));
 		
+		// Models are prioritized since their load callbacks usually kick off more texture loads
 		++m_AssetsInFlight;
-		m_LoadingModelQueue.Push(job);
+		m_JobSystem.Submit([this, job]() mutable
+		{
+			job.model->LoadModel(job.path);
+			job.uploadSize = job.model->StageGpuData(m_StagingBuffer);
+			m_GenerateModelQueue.Push(job);
+		}, JobPriority::High);
 
 		return model;
 	}
@@ -144,7 +155,12 @@ namespace Arcane
 		m_TextureCache.insert(std::pair<std::string, Texture*>(path, texture));
 
 		++m_AssetsInFlight;
-		m_LoadingTexturesQueue.Push(job);
+		m_JobSystem.Submit([this, job]() mutable
+		{
+			TextureLoader::Load2DTextureData(job.texturePath, job.generationData);
+			StageUploadData(job.generationData.data, job.generationData.dataSize, job.generationData.staging);
+			m_GenerateTexturesQueue.Push(job);
+		});
 
 		return texture;
 	}
@@ -202,119 +218,238 @@ namespace Arcane
 				job.callback = callback;
 
 			++m_AssetsInFlight;
-			m_LoadingCubemapQueue.Push(job);
+			m_JobSystem.Submit([this, job]() mutable
+			{
+				TextureLoader::LoadCubemapTextureData(job.texturePath, job.generationData);
+				StageUploadData(job.generationData.data, job.generationData.dataSize, job.generationData.staging);
+				m_GenerateCubemapQueue.Push(job);
+			});
 		}
 
 		return cubemap;
 	}
 
-	void AssetManager::LoaderThread()
+	void AssetManager::InitUploadStaging(size_t size)
+	{
+		m_StagingBuffer.Init(size);
+	}
+
+	void AssetManager::ShutdownUploadStaging()
+	{
+		// Workers could still be writing into the mapped memory
+		m_JobSystem.WaitForIdle();
+		m_StagingBuffer.Shutdown();
+	}
+
+	void AssetManager::StageUploadData(unsigned char *&data, size_t dataSize, StagingAllocation &outStaging)
+	{
+		if (!data || dataSize == 0)
+			return;
+
+		StagingAllocation allocation = m_StagingBuffer.Allocate(dataSize);
+		if (!allocation.IsValid())
+			return;
+
+		memcpy(allocation.Data, data, dataSize);
+		stbi_image_free(data);
+		data = nullptr;
+		outStaging = allocation;
+	}
+
+	void AssetManager::Update(u64 uploadBudgetBytes, double uploadBudgetMS)
 	{
-		while (m_AsyncLoadingActive)
+		// Must be done on the main thread since OpenGL is single-threaded in nature
+		Timer timer;
+		if (m_UploadStats.MeasuredBytesPerMS <= 0.0)
+			m_UploadStats.MeasuredBytesPerMS = InitialUploadBytesPerMS;
+
+		// Failed loads have nothing to upload so they are cleaned up right away, the rest wait for budget
+		TextureLoadJob textureJob;
+		while (m_GenerateTexturesQueue.TryPop(textureJob))
 		{
-			if (!m_LoadingTexturesQueue.Empty())
+			if (!textureJob.generationData.data && !textureJob.generationData.staging.IsValid())
 			{
-				TextureLoadJob loadJob;
-				if (m_LoadingTexturesQueue.TryPop(loadJob))
-				{
-					TextureLoader::Load2DTextureData(loadJob.texturePath, loadJob.generationData);
-					m_GenerateTexturesQueue.Push(loadJob);
-				}
+				m_TextureCache.erase(textureJob.texturePath);
+				delete textureJob.generationData.texture;
+				--m_AssetsInFlight;
+				continue;
 			}
-			if (!m_LoadingCubemapQueue.Empty())
+			m_PendingTextureUploads.push_back(std::move(textureJob));
+		}
+		CubemapLoadJob cubemapJob;
+		while (m_GenerateCubemapQueue.TryPop(cubemapJob))
+		{
+			if (!cubemapJob.generationData.data && !cubemapJob.generationData.staging.IsValid())
 			{
-				CubemapLoadJob loadJob;
-				if (m_LoadingCubemapQueue.TryPop(loadJob))
-				{
-					TextureLoader::LoadCubemapTextureData(loadJob.texturePath, loadJob.generationData);
-					m_GenerateCubemapQueue.Push(loadJob);
-				}
+				--m_AssetsInFlight;
+				continue;
 			}
-			if (!m_LoadingModelQueue.Empty())
+			m_PendingCubemapUploads.push_back(std::move(cubemapJob));
+		}
+		ModelLoadJob modelJob;
+		while (m_GenerateModelQueue.TryPop(modelJob))
+		{
+			if (modelJob.model->m_Meshes.size() == 0)
 			{
-				ModelLoadJob loadJob;
-				if (m_LoadingModelQueue.TryPop(loadJob))
-				{
-					loadJob.model->LoadModel(loadJob.path);
-					m_GenerateModelQueue.Push(loadJob);
-				}
+				m_ModelCache.erase(modelJob.path);
+				delete modelJob.model;
+				--m_AssetsInFlight;
+				continue;
 			}
-
-			// Should these asset threads be sleeping?
-			unsigned int workLoadSizeRemaining = m_LoadingTexturesQueue.Size() + m_LoadingCubemapQueue.Size() + m_LoadingModelQueue.Size();
-			const int msToWait = 10;
-			if (workLoadSizeRemaining <= 0)
-				std::this_thread::sleep_for(std::chrono::milliseconds(msToWait));
+			m_PendingModelUploads.push_back(std::move(modelJob));
 		}
-	}
 
-	void AssetManager::Update(int texturesPerFrame, int cubemapFacesPerFrame, int modelsPerFrame)
-	{
-		// Must be done on the main thread since OpenGL is single-threaded in nature
-		while (!m_GenerateTexturesQueue.Empty())
+		u64 bytesUploaded = 0;
+		int uploadCount = 0;
+		while (true)
 		{
-			TextureLoadJob loadJob;
-			if (m_GenerateTexturesQueue.TryPop(loadJob))
+			int uploadQueue = -1;
+			size_t uploadSize = 0;
+			for (int i = 0; i < UploadQueueCount && uploadQueue == -1; i++)
 			{
-				if (!loadJob.generationData.data)
-				{
-					m_TextureCache.erase(loadJob.texturePath);
-					delete loadJob.generationData.texture;
-					--m_AssetsInFlight;
-					break;
-				}
-
-				TextureLoader::Generate2DTexture(loadJob.texturePath, loadJob.generationData);
-				--m_AssetsInFlight;
-				if (loadJob.callback)
-					loadJob.callback(loadJob.generationData.texture);
+				int candidate = (m_NextUploadQueue + i) % UploadQueueCount;
+				if (PeekUploadSize(candidate, uploadSize))
+					uploadQueue = candidate;
+			}
+			if (uploadQueue == -1)
+				break;
 
-				if (--texturesPerFrame <= 0)
+			if (uploadCount > 0)
+			{
+				double predictedMS = static_cast<double>(uploadSize) / m_UploadStats.MeasuredBytesPerMS;
+				if (bytesUploaded + uploadSize > uploadBudgetBytes || (timer.Elapsed() * 1000.0) + predictedMS > uploadBudgetMS)
 					break;
 			}
-		}
-		while (!m_GenerateCubemapQueue.Empty())
-		{
-			CubemapLoadJob loadJob;
-			if (m_GenerateCubemapQueue.TryPop(loadJob))
+
+			double uploadStart = timer.Elapsed();
+			ProcessUpload(uploadQueue);
+			double uploadMS = (timer.Elapsed() - uploadStart) * 1000.0;
+			if (uploadSize > 0 && uploadMS > 0.0)
 			{
-				if (!loadJob.generationData.data)
-				{
-					delete loadJob.generationData.data;
-					--m_AssetsInFlight;
-					break;
-				}
+				double bytesPerMS = static_cast<double>(uploadSize) / uploadMS;
+				m_UploadStats.MeasuredBytesPerMS += (bytesPerMS - m_UploadStats.MeasuredBytesPerMS) * UploadRateSmoothing;
+			}
 
-				TextureLoader::GenerateCubemapTexture(loadJob.texturePath, loadJob.generationData);
-				--m_AssetsInFlight;
-				if (loadJob.callback)
-					loadJob.callback();
+			bytesUploaded += uploadSize;
+			uploadCount++;
+			m_NextUploadQueue = (uploadQueue + 1) % UploadQueueCount;
+		}
 
-				if (--cubemapFacesPerFrame <= 0)
-					break;
-			}
+		// Fences this frame's uploads so their staging space can be reused once the GPU is done with it
+		m_StagingBuffer.EndFrame();
+
+		m_UploadStats.BytesUploaded = bytesUploaded;
+		m_UploadStats.UploadTimeMS = timer.Elapsed() * 1000.0;
+		m_UploadStats.UploadCount = uploadCount;
+		m_UploadStats.PendingUploads = static_cast<int>(m_PendingTextureUploads.size() + m_PendingCubemapUploads.size() + m_PendingModelUploads.size());
+		m_UploadStats.StagingUsed = m_StagingBuffer.GetUsedSize();
+		m_UploadStats.StagingSize = m_StagingBuffer.GetSize();
+		m_UploadStats.StagingFallbacks = m_StagingBuffer.GetFailedAllocationCount();
+	}
+
+	bool AssetManager::PeekUploadSize(int uploadQueue, size_t &outSize) const
+	{
+		switch (uploadQueue)
+		{
+		case UploadQueueTextures:
+			if (m_PendingTextureUploads.empty())
+				return false;
+			outSize = m_PendingTextureUploads.front().generationData.dataSize;
+			return true;
+		case UploadQueueCubemaps:
+			if (m_PendingCubemapUploads.empty())
+				return false;
+			outSize = m_PendingCubemapUploads.front().generationData.dataSize;
+			return true;
+		case UploadQueueModels:
+			if (m_PendingModelUploads.empty())
+				return false;
+			outSize = m_PendingModelUploads.front().uploadSize;
+			return true;
 		}
-		while (!m_GenerateModelQueue.Empty())
+		return false;
+	}
+
+	void AssetManager::ProcessUpload(int uploadQueue)
+	{
+		// Jobs are popped before their callbacks run since callbacks can start more loads
+		switch (uploadQueue)
 		{
-			ModelLoadJob loadJob;
-			if (m_GenerateModelQueue.TryPop(loadJob))
-			{
-				if (loadJob.model->m_Meshes.size() == 0)
-				{
-					m_ModelCache.erase(loadJob.path);
-					delete loadJob.model;
-					--m_AssetsInFlight;
-					break;
-				}
+		case UploadQueueTextures:
+		{
+			TextureLoadJob loadJob = std::move(m_PendingTextureUploads.front());
+			m_PendingTextureUploads.pop_front();
+
+			TextureStreamer::GetInstance().OnTextureLoaded(loadJob.texturePath, loadJob.generationData);
+			TextureLoader::Generate2DTexture(loadJob.texturePath, loadJob.generationData);
+			--m_AssetsInFlight;
+			if (loadJob.callback)
+				loadJob.callback(loadJob.generationData.texture);
+			break;
+		}
+		case UploadQueueCubemaps:
+		{
+			CubemapLoadJob loadJob = std::move(m_PendingCubemapUploads.front());
+			m_PendingCubemapUploads.pop_front();
+
+			TextureLoader::GenerateCubemapTexture(loadJob.texturePath, loadJob.generationData);
+			--m_AssetsInFlight;
+			if (loadJob.callback)
+				loadJob.callback();
+			break;
+		}
+		case UploadQueueModels:
+		{
+			ModelLoadJob loadJob = std::move(m_PendingModelUploads.front());
+			m_PendingModelUploads.pop_front();
+
+			loadJob.model->GenerateGpuData();
+			--m_AssetsInFlight;
+			if (loadJob.callback)
+				loadJob.callback(loadJob.model);
+			break;
+		}
+		}
+	}
 
-				loadJob.model->GenerateGpuData();
-				--m_AssetsInFlight;
-				if (loadJob.callback)
-					loadJob.callback(loadJob.model);
+	void AssetManager::WarmDerivedDataCache(const std::string &directory)
+	{
+		static const std::unordered_set<std::string> modelExtensions = { ".fbx", ".obj", ".dae", ".gltf", ".glb", ".3ds", ".blend" };
+		static const std::unordered_set<std::string> imageExtensions = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd" };
 
-				if (--modelsPerFrame <= 0)
-					break;
+		int modelCount = 0, textureCount = 0;
+		std::error_code error;
+		for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(directory, error))
+		{
+			if (!entry.is_regular_file(error))
+				continue;
+
+			std::string path = entry.path().generic_string();
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+			if (modelExtensions.find(extension) != modelExtensions.end())
+			{
+				// Material textures go straight to the derived data cache, the asset manager's caches aren't safe to touch from the workers
+				m_JobSystem.Submit([path]()
+				{
+					Model model;
+					model.LoadModel(path, true);
+				}, JobPriority::High);
+				modelCount++;
+			}
+			else if (imageExtensions.find(extension) != imageExtensions.end())
+			{
+				// Warmed with the settings the loaders used for it last time, the cache key covers them so anything else would never be hit
+				m_JobSystem.Submit([path]()
+				{
+					TextureLoader::WarmRecordedTextureData(path);
+				});
+				textureCount++;
 			}
 		}
+		m_JobSystem.WaitForIdle();
+
+		ARC_LOG_INFO("Warmed the derived data cache with {0} models and {1} textures from {2}", modelCount, textureCount, directory);
 	}
 }
@@ -2,14 +2,22 @@
 #ifndef ASSETMANAGER_H
 #define ASSETMANAGER_H
 
-#ifndef THREADSAFEQUEUE_H
-#include <Arcane/Core/Threads/ThreadSafeQueue.h>
+#ifndef LOCKFREEQUEUE_H
+#include <Arcane/Core/Threads/LockFreeQueue.h>
+#endif
+
+#ifndef JOBSYSTEM_H
+#include <Arcane/Core/Threads/JobSystem.h>
 #endif
 
 #ifndef TEXTURELOADER_H
 #include <Arcane/Util/Loaders/TextureLoader.h>
 #endif
 
+#ifndef STAGINGRINGBUFFER_H
+#include <Arcane/Platform/OpenGL/StagingRingBuffer.h>
+#endif
+
 namespace Arcane
 {
 	struct TextureSettings;
@@ -34,6 +42,59 @@ namespace Arcane
 		std::string path;
 		Model *model;
 		std::function<void(Model*)> callback = nullptr;
+		size_t uploadSize = 0;
+	};
+
+	// Hands finished loads from the workers to the main thread through a lock-free queue. The main thread is the only consumer and a producer can be running on it
+	// (inside JobSystem::Wait or WaitForIdle), so a push that finds the queue full spills into a mutex guarded overflow list instead of waiting for space
+	template<typename T>
+	class GenerateQueue
+	{
+	public:
+		void Push(T job)
+		{
+			if (m_Queue.TryPush(std::move(job)))
+				return;
+
+			std::lock_guard<std::mutex> lock(m_OverflowMutex);
+			m_Overflow.push_back(std::move(job));
+			m_HasOverflow.store(true, std::memory_order_release);
+		}
+
+		bool TryPop(T &outJob)
+		{
+			if (m_Queue.TryPop(outJob))
+				return true;
+			if (!m_HasOverflow.load(std::memory_order_acquire))
+				return false;
+
+			std::lock_guard<std::mutex> lock(m_OverflowMutex);
+			if (m_Overflow.empty())
+				return false;
+
+			outJob = std::move(m_Overflow.front());
+			m_Overflow.pop_front();
+			m_HasOverflow.store(!m_Overflow.empty(), std::memory_order_release);
+			return true;
+		}
+	private:
+		LockFreeQueue<T> m_Queue;
+		std::mutex m_OverflowMutex;
+		std::deque<T> m_Overflow;
+		std::atomic<bool> m_HasOverflow = false;
+	};
+
+	struct AssetUploadStats
+	{
+		// Last frame
+		u64 BytesUploaded = 0;
+		double UploadTimeMS = 0.0;
+		int UploadCount = 0;
+
+		int PendingUploads = 0; // Loaded and waiting for upload budget
+		double MeasuredBytesPerMS = 0.0; // Running average used to predict how long an upload is going to take
+		size_t StagingUsed = 0, StagingSize = 0;
+		u64 StagingFallbacks = 0; // Loads that didn't fit in the staging buffer and were uploaded from client memory instead
 	};
 
 	class AssetManager : public Singleton
@@ -55,7 +116,16 @@ namespace Arcane
 		Cubemap* LoadCubemapTexture(const std::string &right, const std::string &left, const std::string &top, const std::string &bottom, const std::string &back, const std::string &front, CubemapSettings *settings = nullptr);
 		Cubemap* LoadCubemapTextureAsync(const std::string &right, const std::string &left, const std::string &top, const std::string &bottom, const std::string &back, const std::string &front, CubemapSettings *settings = nullptr, std::function<void()> callback = nullptr);
 
-		void Update(int texturesPerFrame, int cubemapFacesPerFrame, int modelsPerFrame);
+		// The staging buffer needs a GL context, so it is created by the application after the renderer rather than with the asset manager
+		void InitUploadStaging(size_t size);
+		void ShutdownUploadStaging();
+
+		// Uploads finished loads until either budget for the frame runs out. At least one upload always goes through so an asset larger than the budget can't stall
+		void Update(u64 uploadBudgetBytes, double uploadBudgetMS);
+		inline const AssetUploadStats& GetUploadStats() const { return m_UploadStats; }
+
+		// Processes every model and texture found under the directory into the derived data cache without creating any GPU resources (used by --ddc-warm)
+		void WarmDerivedDataCache(const std::string &directory);
 
 		inline static Texture* GetWhiteTexture() { return TextureLoader::s_WhiteTexture; }
 		inline static Texture* GetBlackTexture() { return TextureLoader::s_BlackTexture; }
@@ -69,29 +139,39 @@ namespace Arcane
 		inline static Texture* GetNoRoughnessTexture() { return TextureLoader::s_BlackTexture; }
 		inline static Texture* GetDefaultWaterDistortionTexture() { return TextureLoader::s_DefaultWaterDistortion; }
 	private:
-		// Used to load resources asynchronously on a threadpool
-		void LoaderThread();
-
 		Model* FetchModelFromCache(const std::string &path);
 		Texture* FetchTextureFromCache(const std::string &path);
 
-		std::vector<std::thread> m_WorkerThreads;
-		std::atomic<bool> m_LoadingThreadsActive;
-		bool m_AsyncLoadingActive = true;
+		// Worker side, moves the decoded data into the staging buffer. The data stays where it is if the staging buffer is full or disabled
+		void StageUploadData(unsigned char *&data, size_t dataSize, StagingAllocation &outStaging);
+
+		// Main thread side of the upload queues, returns false if the queue has nothing waiting
+		bool PeekUploadSize(int uploadQueue, size_t &outSize) const;
+		void ProcessUpload(int uploadQueue);
+
+		// Async loads are decoded on the engine's job system workers, only the GPU generation is done here on the main thread
+		// Workers hand the decoded data back through lock-free queues so they never contend with the main thread draining them
+		JobSystem &m_JobSystem;
 
 		// Keeps tracks of assets in flight, there can be a gap between the two queues and we need a way to know when all in-flight assets are complete. This is only incremented on asset load (main thread) and decremented on main thread when finishing creating the asset
 		int m_AssetsInFlight = 0;
 
 		std::unordered_map<std::string, Texture*> m_TextureCache;
-		ThreadSafeQueue<TextureLoadJob> m_LoadingTexturesQueue;
-		ThreadSafeQueue<TextureLoadJob> m_GenerateTexturesQueue;
+		GenerateQueue<TextureLoadJob> m_GenerateTexturesQueue;
 
-		ThreadSafeQueue<CubemapLoadJob> m_LoadingCubemapQueue;
-		ThreadSafeQueue<CubemapLoadJob> m_GenerateCubemapQueue;
+		GenerateQueue<CubemapLoadJob> m_GenerateCubemapQueue;
 
 		std::unordered_map<std::string, Model*> m_ModelCache;
-		ThreadSafeQueue<ModelLoadJob> m_LoadingModelQueue;
-		ThreadSafeQueue<ModelLoadJob> m_GenerateModelQueue;
+		GenerateQueue<ModelLoadJob> m_GenerateModelQueue;
+
+		// Finished loads are moved off the generate queues into these so the upload budget can look at the next item's size before committing to it
+		std::deque<TextureLoadJob> m_PendingTextureUploads;
+		std::deque<CubemapLoadJob> m_PendingCubemapUploads;
+		std::deque<ModelLoadJob> m_PendingModelUploads;
+		int m_NextUploadQueue = 0; // Round robin between the pending queues so one asset type can't starve the others
+
+		StagingRingBuffer m_StagingBuffer;
+		AssetUploadStats m_UploadStats;
 	};
 }
 #endif
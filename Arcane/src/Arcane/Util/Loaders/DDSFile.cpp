@@ -0,0 +1,196 @@
+#include "arcpch.h"
+#include "DDSFile.h"
+
+namespace Arcane
+{
+	namespace
+	{
+		constexpr u32 MakeFourCC(char a, char b, char c, char d)
+		{
+			return static_cast<u32>(a) | (static_cast<u32>(b) << 8) | (static_cast<u32>(c) << 16) | (static_cast<u32>(d) << 24);
+		}
+
+		static constexpr u32 DDSMagic = MakeFourCC('D', 'D', 'S', ' ');
+
+		// Header flags
+		static constexpr u32 DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+		static constexpr u32 DDPF_FOURCC = 0x4;
+		static constexpr u32 DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+		static constexpr u32 DDSCAPS2_CUBEMAP = 0x200, DDSCAPS2_VOLUME = 0x200000;
+		static constexpr u32 D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+		enum DXGIFormat : u32
+		{
+			DXGI_FORMAT_BC1_UNORM = 71,
+			DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+			DXGI_FORMAT_BC3_UNORM = 77,
+			DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+			DXGI_FORMAT_BC4_UNORM = 80,
+			DXGI_FORMAT_BC5_UNORM = 83,
+			DXGI_FORMAT_BC7_UNORM = 98,
+			DXGI_FORMAT_BC7_UNORM_SRGB = 99
+		};
+
+		struct DDSPixelFormat
+		{
+			u32 Size;
+			u32 Flags;
+			u32 FourCC;
+			u32 RGBBitCount;
+			u32 RBitMask, GBitMask, BBitMask, ABitMask;
+		};
+
+		struct DDSHeader
+		{
+			u32 Size;
+			u32 Flags;
+			u32 Height;
+			u32 Width;
+			u32 PitchOrLinearSize;
+			u32 Depth;
+			u32 MipMapCount;
+			u32 Reserved1[11];
+			DDSPixelFormat PixelFormat;
+			u32 Caps, Caps2, Caps3, Caps4;
+			u32 Reserved2;
+		};
+
+		struct DDSHeaderDX10
+		{
+			u32 DXGIFormat;
+			u32 ResourceDimension;
+			u32 MiscFlag;
+			u32 ArraySize;
+			u32 MiscFlags2;
+		};
+
+		static_assert(sizeof(DDSHeader) == 124, "DDS header must match the file layout");
+
+		bool FromDXGIFormat(u32 dxgiFormat, TextureCompression &outFormat, bool &outIsSRGB)
+		{
+			outIsSRGB = false;
+			switch (dxgiFormat)
+			{
+			case DXGI_FORMAT_BC1_UNORM_SRGB: outIsSRGB = true; // Fallthrough
+			case DXGI_FORMAT_BC1_UNORM: outFormat = TextureCompression::BC1; return true;
+			case DXGI_FORMAT_BC3_UNORM_SRGB: outIsSRGB = true; // Fallthrough
+			case DXGI_FORMAT_BC3_UNORM: outFormat = TextureCompression::BC3; return true;
+			case DXGI_FORMAT_BC4_UNORM: outFormat = TextureCompression::BC4; return true;
+			case DXGI_FORMAT_BC5_UNORM: outFormat = TextureCompression::BC5; return true;
+			case DXGI_FORMAT_BC7_UNORM_SRGB: outIsSRGB = true; // Fallthrough
+			case DXGI_FORMAT_BC7_UNORM: outFormat = TextureCompression::BC7; return true;
+			}
+			return false;
+		}
+
+		u32 ToDXGIFormat(TextureCompression format, bool isSRGB)
+		{
+			switch (format)
+			{
+			case TextureCompression::BC1: return isSRGB ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+			case TextureCompression::BC3: return isSRGB ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+			case TextureCompression::BC4: return DXGI_FORMAT_BC4_UNORM;
+			case TextureCompression::BC5: return DXGI_FORMAT_BC5_UNORM;
+			case TextureCompression::BC7: return isSRGB ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+			default: return 0;
+			}
+		}
+
+		bool FromLegacyFourCC(u32 fourCC, TextureCompression &outFormat)
+		{
+			switch (fourCC)
+			{
+			case MakeFourCC('D', 'X', 'T', '1'): outFormat = TextureCompression::BC1; return true;
+			case MakeFourCC('D', 'X', 'T', '5'): outFormat = TextureCompression::BC3; return true;
+			case MakeFourCC('A', 'T', 'I', '1'):
+			case MakeFourCC('B', 'C', '4', 'U'): outFormat = TextureCompression::BC4; return true;
+			case MakeFourCC('A', 'T', 'I', '2'):
+			case MakeFourCC('B', 'C', '5', 'U'): outFormat = TextureCompression::BC5; return true;
+			}
+			return false;
+		}
+	}
+
+	unsigned char* DDSFile::Read(const std::string &path, CompressedImageInfo &outInfo)
+	{
+		std::ifstream file(path, std::ios::in | std::ios::binary);
+		u32 magic;
+		DDSHeader header;
+		if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) || magic != DDSMagic || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.Size != sizeof(DDSHeader))
+			return nullptr;
+
+		if ((header.Caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) || !(header.PixelFormat.Flags & DDPF_FOURCC))
+		{
+			ARC_LOG_WARN("DDS file {0} isn't a block compressed 2D texture", path);
+			return nullptr;
+		}
+
+		bool validFormat;
+		if (header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0'))
+		{
+			DDSHeaderDX10 headerDX10;
+			validFormat = file.read(reinterpret_cast<char*>(&headerDX10), sizeof(headerDX10)) && headerDX10.ResourceDimension == D3D10_RESOURCE_DIMENSION_TEXTURE2D &&
+				headerDX10.ArraySize <= 1 && FromDXGIFormat(headerDX10.DXGIFormat, outInfo.Format, outInfo.IsSRGB);
+		}
+		else
+		{
+			// Legacy headers don't store the colour space, the caller's texture settings decide it
+			outInfo.IsSRGB = false;
+			validFormat = FromLegacyFourCC(header.PixelFormat.FourCC, outInfo.Format);
+		}
+
+		if (!validFormat || header.Width == 0 || header.Height == 0 || header.Width > 16384 || header.Height > 16384)
+		{
+			ARC_LOG_WARN("DDS file {0} uses an unsupported format", path);
+			return nullptr;
+		}
+
+		outInfo.Width = static_cast<int>(header.Width);
+		outInfo.Height = static_cast<int>(header.Height);
+		int fullMipCount = TextureCompressor::GetFullMipCount(outInfo.Width, outInfo.Height);
+		outInfo.MipCount = (header.Flags & DDSD_MIPMAPCOUNT) ? glm::clamp(static_cast<int>(header.MipMapCount), 1, fullMipCount) : 1;
+
+		size_t dataSize = TextureCompressor::GetCompressedSize(outInfo);
+		unsigned char *data = static_cast<unsigned char*>(malloc(dataSize));
+		if (!data || !file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(dataSize)))
+		{
+			ARC_LOG_WARN("DDS file {0} is truncated", path);
+			free(data);
+			return nullptr;
+		}
+
+		return data;
+	}
+
+	bool DDSFile::Write(const std::string &path, const CompressedImageInfo &info, const unsigned char *data)
+	{
+		CompressedImageInfo mip0Info = info;
+		mip0Info.MipCount = 1;
+
+		DDSHeader header = {};
+		header.Size = sizeof(DDSHeader);
+		header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | (info.MipCount > 1 ? DDSD_MIPMAPCOUNT : 0);
+		header.Height = static_cast<u32>(info.Height);
+		header.Width = static_cast<u32>(info.Width);
+		header.PitchOrLinearSize = static_cast<u32>(TextureCompressor::GetCompressedSize(mip0Info));
+		header.MipMapCount = static_cast<u32>(info.MipCount);
+		header.PixelFormat.Size = sizeof(DDSPixelFormat);
+		header.PixelFormat.Flags = DDPF_FOURCC;
+		header.PixelFormat.FourCC = MakeFourCC('D', 'X', '1', '0');
+		header.Caps = DDSCAPS_TEXTURE | (info.MipCount > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+		DDSHeaderDX10 headerDX10 = {};
+		headerDX10.DXGIFormat = ToDXGIFormat(info.Format, info.IsSRGB);
+		headerDX10.ResourceDimension = D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+		headerDX10.ArraySize = 1;
+		if (headerDX10.DXGIFormat == 0)
+			return false;
+
+		std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&DDSMagic), sizeof(DDSMagic));
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+		file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(TextureCompressor::GetCompressedSize(info)));
+		return static_cast<bool>(file);
+	}
+}
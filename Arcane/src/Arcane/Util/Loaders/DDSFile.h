@@ -0,0 +1,21 @@
+#pragma once
+#ifndef DDSFILE_H
+#define DDSFILE_H
+
+#ifndef TEXTURECOMPRESSOR_H
+#include <Arcane/Graphics/Texture/TextureCompressor.h>
+#endif
+
+namespace Arcane
+{
+	// Reads and writes block compressed 2D textures in the DDS container. Cooked textures are always written with the DX10 header,
+	// reading also accepts the legacy DXT1/DXT5/ATI1/ATI2 FourCCs so .dds files exported by other tools can be used as sources directly
+	class DDSFile
+	{
+	public:
+		// The data holds every mip tightly packed and is allocated with malloc, so it is freed with stbi_image_free like the rest of the texture data
+		static unsigned char* Read(const std::string &path, CompressedImageInfo &outInfo);
+		static bool Write(const std::string &path, const CompressedImageInfo &info, const unsigned char *data);
+	};
+}
+#endif
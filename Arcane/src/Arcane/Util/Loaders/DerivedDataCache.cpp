@@ -0,0 +1,431 @@
+#include "arcpch.h"
+#include "DerivedDataCache.h"
+
+#include <Arcane/Util/Loaders/AssetManager.h>
+
+namespace Arcane
+{
+	static constexpr u32 SourceHashesVersion = 2;
+	static constexpr u32 MaxSourceVariants = 64;
+	static const char *s_SourceHashesFilename = "SourceHashes.bin";
+	static const char *s_EntryExtension = ".ddc";
+
+	DerivedDataCache::DerivedDataCache() : m_Directory(DERIVED_DATA_CACHE_DIRECTORY), m_MaxSize((u64)DERIVED_DATA_CACHE_MAX_SIZE_MB * 1024 * 1024), m_TotalSize(0), m_SourceHashesDirty(false), m_NextTempId(0)
+	{
+		ResetStats();
+
+		std::error_code error;
+		std::filesystem::create_directories(m_Directory, error);
+		if (error)
+		{
+			ARC_LOG_WARN("Failed to create the derived data cache directory {0} - {1}", m_Directory, error.message());
+			return;
+		}
+
+		// Build the entry table from what is on disk, anything left over from an interrupted write gets cleaned up
+		for (const std::filesystem::directory_entry &file : std::filesystem::directory_iterator(m_Directory, error))
+		{
+			const std::filesystem::path &path = file.path();
+			if (path.extension() == ".tmp")
+			{
+				std::filesystem::remove(path, error);
+				continue;
+			}
+			if (path.extension() != s_EntryExtension)
+				continue;
+
+			CacheEntry entry;
+			entry.Size = static_cast<u64>(file.file_size(error));
+			entry.LastUsed = static_cast<s64>(file.last_write_time(error).time_since_epoch().count());
+			u64 key = std::strtoull(path.stem().string().c_str(), nullptr, 16);
+
+			m_Entries[key] = entry;
+			m_TotalSize += entry.Size;
+		}
+
+		LoadSourceHashes();
+		ARC_LOG_INFO("Derived data cache has {0} entries ({1} MB)", m_Entries.size(), m_TotalSize / (1024 * 1024));
+	}
+
+	DerivedDataCache::~DerivedDataCache()
+	{
+		SaveSourceHashes();
+	}
+
+	DerivedDataCache& DerivedDataCache::GetInstance()
+	{
+		static DerivedDataCache cache;
+		return cache;
+	}
+
+	u64 DerivedDataCache::GetSourceHash(const std::string &sourcePath)
+	{
+		std::error_code error;
+		u64 fileSize = static_cast<u64>(std::filesystem::file_size(sourcePath, error));
+		if (error)
+			return 0;
+		s64 writeTime = static_cast<s64>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+		if (error)
+			return 0;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto iter = m_SourceHashes.find(sourcePath);
+			if (iter != m_SourceHashes.end() && iter->second.FileSize == fileSize && iter->second.WriteTime == writeTime)
+				return iter->second.Hash;
+		}
+
+		// Hash the file in chunks so large sources don't need to be fully resident
+		std::ifstream file(sourcePath, std::ios::in | std::ios::binary);
+		if (!file)
+			return 0;
+
+		std::vector<char> chunk(1024 * 1024);
+		u64 hash = fileSize;
+		while (file)
+		{
+			file.read(chunk.data(), chunk.size());
+			std::streamsize readCount = file.gcount();
+			if (readCount <= 0)
+				break;
+			hash = HashBytes(chunk.data(), static_cast<size_t>(readCount), hash);
+		}
+
+		// Zero is reserved for failure
+		if (hash == 0)
+			hash = 1;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SourceHashes[sourcePath] = { fileSize, writeTime, hash };
+		m_SourceHashesDirty = true;
+		return hash;
+	}
+
+	void DerivedDataCache::RecordSourceVariant(const std::string &sourcePath, u64 variant)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::vector<u64> &variants = m_SourceVariants[sourcePath];
+		if (variants.size() >= MaxSourceVariants || std::find(variants.begin(), variants.end(), variant) != variants.end())
+			return;
+
+		variants.push_back(variant);
+		m_SourceHashesDirty = true;
+	}
+
+	std::vector<u64> DerivedDataCache::GetSourceVariants(const std::string &sourcePath) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto iter = m_SourceVariants.find(sourcePath);
+		return iter != m_SourceVariants.end() ? iter->second : std::vector<u64>();
+	}
+
+	bool DerivedDataCache::Find(u64 key, std::string &outEntryPath)
+	{
+		std::string entryPath = GetEntryPath(key);
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto iter = m_Entries.find(key);
+			if (iter == m_Entries.end())
+			{
+				++m_Misses;
+				return false;
+			}
+
+			// Touch the entry so it is the last to be evicted, storing it on disk keeps the order across runs
+			std::error_code error;
+			std::filesystem::file_time_type now = std::filesystem::file_time_type::clock::now();
+			std::filesystem::last_write_time(entryPath, now, error);
+			iter->second.LastUsed = static_cast<s64>(now.time_since_epoch().count());
+		}
+
+		outEntryPath = std::move(entryPath);
+		return true;
+	}
+
+	void DerivedDataCache::RecordRead(bool succeeded)
+	{
+		// A corrupt or stale entry means the data had to be produced from the source anyway
+		if (succeeded)
+			++m_Hits;
+		else
+			++m_Misses;
+	}
+
+	std::string DerivedDataCache::BeginStore(u64 key)
+	{
+		// Unique per store so two workers producing the same entry never write to the same file
+		return GetEntryPath(key) + "." + std::to_string(m_NextTempId.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+	}
+
+	bool DerivedDataCache::CommitStore(u64 key, const std::string &tempPath)
+	{
+		std::string entryPath = GetEntryPath(key);
+
+		std::error_code error;
+		u64 size = static_cast<u64>(std::filesystem::file_size(tempPath, error));
+		if (error)
+		{
+			AbortStore(tempPath);
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::filesystem::rename(tempPath, entryPath, error);
+		if (error)
+		{
+			// Most likely another worker already stored this entry and it is currently mapped, either way the cache stays consistent
+			ARC_LOG_WARN("Failed to store derived data {0} - {1}", entryPath, error.message());
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		CacheEntry &entry = m_Entries[key];
+		m_TotalSize = m_TotalSize - entry.Size + size;
+		entry.Size = size;
+		entry.LastUsed = static_cast<s64>(std::filesystem::file_time_type::clock::now().time_since_epoch().count());
+		++m_Stores;
+
+		if (m_TotalSize > m_MaxSize)
+			EvictLeastRecentlyUsed(m_MaxSize);
+
+		return true;
+	}
+
+	void DerivedDataCache::AbortStore(const std::string &tempPath)
+	{
+		std::error_code error;
+		std::filesystem::remove(tempPath, error);
+	}
+
+	void DerivedDataCache::Prune(u64 maxSize)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		u64 sizeBefore = m_TotalSize;
+		size_t countBefore = m_Entries.size();
+		EvictLeastRecentlyUsed(maxSize);
+
+		// Forget hashes of sources that no longer exist
+		for (auto iter = m_SourceHashes.begin(); iter != m_SourceHashes.end();)
+		{
+			std::error_code error;
+			if (!std::filesystem::exists(iter->first, error))
+			{
+				m_SourceVariants.erase(iter->first);
+				iter = m_SourceHashes.erase(iter);
+				m_SourceHashesDirty = true;
+			}
+			else
+			{
+				++iter;
+			}
+		}
+
+		ARC_LOG_INFO("Pruned derived data cache to {0} MB, evicted {1} entries ({2} MB)", m_TotalSize / (1024 * 1024), countBefore - m_Entries.size(), (sizeBefore - m_TotalSize) / (1024 * 1024));
+	}
+
+	void DerivedDataCache::EvictLeastRecentlyUsed(u64 maxSize)
+	{
+		std::vector<std::pair<s64, u64>> entriesByAge;
+		entriesByAge.reserve(m_Entries.size());
+		for (auto &entry : m_Entries)
+		{
+			entriesByAge.push_back({ entry.second.LastUsed, entry.first });
+		}
+		std::sort(entriesByAge.begin(), entriesByAge.end());
+
+		for (size_t i = 0; i < entriesByAge.size() && m_TotalSize > maxSize; i++)
+		{
+			u64 key = entriesByAge[i].second;
+
+			// Entries that are currently mapped can't be deleted, they will be picked up by a later eviction
+			std::error_code error;
+			std::filesystem::remove(GetEntryPath(key), error);
+			if (error)
+				continue;
+
+			m_TotalSize -= m_Entries[key].Size;
+			m_Entries.erase(key);
+			++m_Evictions;
+		}
+	}
+
+	void DerivedDataCache::LoadSourceHashes()
+	{
+		std::ifstream file(m_Directory + "/" + s_SourceHashesFilename, std::ios::in | std::ios::binary);
+		if (!file)
+			return;
+
+		u32 version = 0, count = 0;
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		file.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!file || version != SourceHashesVersion)
+			return;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			u32 pathLength = 0;
+			file.read(reinterpret_cast<char*>(&pathLength), sizeof(pathLength));
+			if (!file || pathLength > 4096)
+				break;
+
+			std::string path(pathLength, '\0');
+			SourceHashRecord record;
+			u32 variantCount = 0;
+			file.read(&path[0], pathLength);
+			file.read(reinterpret_cast<char*>(&record), sizeof(record));
+			file.read(reinterpret_cast<char*>(&variantCount), sizeof(variantCount));
+			if (!file || variantCount > MaxSourceVariants)
+				break;
+
+			std::vector<u64> variants(variantCount);
+			file.read(reinterpret_cast<char*>(variants.data()), variantCount * sizeof(u64));
+			if (!file)
+				break;
+
+			m_SourceHashes[path] = record;
+			if (variantCount > 0)
+				m_SourceVariants[path] = std::move(variants);
+		}
+	}
+
+	void DerivedDataCache::SaveSourceHashes()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (!m_SourceHashesDirty)
+			return;
+
+		std::ofstream file(m_Directory + "/" + s_SourceHashesFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file)
+			return;
+
+		u32 count = static_cast<u32>(m_SourceHashes.size());
+		file.write(reinterpret_cast<const char*>(&SourceHashesVersion), sizeof(SourceHashesVersion));
+		file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (auto &source : m_SourceHashes)
+		{
+			u32 pathLength = static_cast<u32>(source.first.size());
+			file.write(reinterpret_cast<const char*>(&pathLength), sizeof(pathLength));
+			file.write(source.first.data(), pathLength);
+			file.write(reinterpret_cast<const char*>(&source.second), sizeof(source.second));
+
+			auto variants = m_SourceVariants.find(source.first);
+			u32 variantCount = variants != m_SourceVariants.end() ? static_cast<u32>(variants->second.size()) : 0;
+			file.write(reinterpret_cast<const char*>(&variantCount), sizeof(variantCount));
+			if (variantCount > 0)
+				file.write(reinterpret_cast<const char*>(variants->second.data()), variantCount * sizeof(u64));
+		}
+
+		m_SourceHashesDirty = false;
+	}
+
+	DerivedDataCacheStats DerivedDataCache::GetStats() const
+	{
+		DerivedDataCacheStats stats;
+		stats.Hits = m_Hits.load(std::memory_order_relaxed);
+		stats.Misses = m_Misses.load(std::memory_order_relaxed);
+		stats.Stores = m_Stores.load(std::memory_order_relaxed);
+		stats.Evictions = m_Evictions.load(std::memory_order_relaxed);
+		stats.MaxSize = m_MaxSize;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		stats.TotalSize = m_TotalSize;
+		stats.EntryCount = static_cast<unsigned int>(m_Entries.size());
+		return stats;
+	}
+
+	void DerivedDataCache::ResetStats()
+	{
+		m_Hits = 0;
+		m_Misses = 0;
+		m_Stores = 0;
+		m_Evictions = 0;
+	}
+
+	bool DerivedDataCache::RunCommandLine(int argc, char **argv)
+	{
+		bool ranCommand = false;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string argument = argv[i];
+			bool hasValue = (i + 1 < argc) && std::strncmp(argv[i + 1], "--", 2) != 0;
+
+			if (argument == "--ddc-warm")
+			{
+				std::string directory = hasValue ? argv[++i] : "res";
+				AssetManager::GetInstance().WarmDerivedDataCache(directory);
+				ranCommand = true;
+			}
+			else if (argument == "--ddc-prune")
+			{
+				u64 maxSizeMB = hasValue ? std::strtoull(argv[++i], nullptr, 10) : DERIVED_DATA_CACHE_MAX_SIZE_MB;
+				GetInstance().Prune(maxSizeMB * 1024 * 1024);
+				ranCommand = true;
+			}
+		}
+
+		if (ranCommand)
+		{
+			DerivedDataCache &cache = GetInstance();
+			cache.SaveSourceHashes();
+
+			DerivedDataCacheStats stats = cache.GetStats();
+			ARC_LOG_INFO("Derived data cache - Entries:{0} Size:{1}MB Hits:{2} Misses:{3} Stores:{4} Evictions:{5}", stats.EntryCount, stats.TotalSize / (1024 * 1024), stats.Hits, stats.Misses, stats.Stores, stats.Evictions);
+		}
+
+		return ranCommand;
+	}
+
+	// MurmurHash64A
+	u64 DerivedDataCache::HashBytes(const void *data, size_t size, u64 seed)
+	{
+		const u64 m = 0xc6a4a7935bd1e995ull;
+		const int r = 47;
+
+		u64 hash = seed ^ (size * m);
+
+		const u8 *bytes = static_cast<const u8*>(data);
+		const u8 *end = bytes + (size & ~(size_t)7);
+		for (; bytes != end; bytes += 8)
+		{
+			u64 k;
+			memcpy(&k, bytes, sizeof(k));
+
+			k *= m;
+			k ^= k >> r;
+			k *= m;
+
+			hash ^= k;
+			hash *= m;
+		}
+
+		switch (size & 7)
+		{
+		case 7: hash ^= u64(bytes[6]) << 48;
+		case 6: hash ^= u64(bytes[5]) << 40;
+		case 5: hash ^= u64(bytes[4]) << 32;
+		case 4: hash ^= u64(bytes[3]) << 24;
+		case 3: hash ^= u64(bytes[2]) << 16;
+		case 2: hash ^= u64(bytes[1]) << 8;
+		case 1: hash ^= u64(bytes[0]);
+			hash *= m;
+		}
+
+		hash ^= hash >> r;
+		hash *= m;
+		hash ^= hash >> r;
+
+		return hash;
+	}
+
+	u64 DerivedDataCache::HashCombine(u64 seed, u64 value)
+	{
+		return HashBytes(&value, sizeof(value), seed);
+	}
+
+	std::string DerivedDataCache::GetEntryPath(u64 key) const
+	{
+		char filename[17];
+		snprintf(filename, sizeof(filename), "%016llx", static_cast<unsigned long long>(key));
+		return m_Directory + "/" + filename + s_EntryExtension;
+	}
+}
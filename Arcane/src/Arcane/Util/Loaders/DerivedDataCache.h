@@ -0,0 +1,105 @@
+#pragma once
+#ifndef DERIVEDDATACACHE_H
+#define DERIVEDDATACACHE_H
+
+#ifndef SINGLETON_H
+#include <Arcane/Util/Singleton.h>
+#endif
+
+#include <atomic>
+
+namespace Arcane
+{
+	static constexpr u32 DerivedDataCacheVersion = 1; // Mixed into every key, bumping it invalidates the whole cache
+
+	struct DerivedDataCacheStats
+	{
+		u64 Hits;
+		u64 Misses;
+		u64 Stores;
+		u64 Evictions;
+		u64 TotalSize;
+		u64 MaxSize;
+		unsigned int EntryCount;
+	};
+
+	// On-disk cache for data derived from source assets (decoded textures, cooked models etc). Entries are keyed by a hash of the source file's contents
+	// combined with whatever settings were used to process it, so editing a source or changing how it is processed naturally misses the cache.
+	// The cache is kept under a size budget by evicting the least recently used entries, the use time is stored as the entry's write time so it survives restarts
+	class DerivedDataCache : public Singleton
+	{
+	public:
+		DerivedDataCache();
+		~DerivedDataCache();
+
+		static DerivedDataCache& GetInstance();
+
+		// Hash of the source file's contents, or 0 if it can't be read. Hashes are remembered along with the file's size and write time so unchanged files aren't re-read every launch
+		u64 GetSourceHash(const std::string &sourcePath);
+
+		// Loaders record each variant (a loader defined encoding of the settings that go into its keys) a source gets loaded with. They are saved with the
+		// source hashes, so warming the cache can produce the entries that are actually going to be asked for
+		void RecordSourceVariant(const std::string &sourcePath, u64 variant);
+		std::vector<u64> GetSourceVariants(const std::string &sourcePath) const;
+
+		// On a hit the entry becomes the most recently used one and outEntryPath is set to the file containing the data. Only misses are counted here, the
+		// caller reports whether it could actually read the entry with RecordRead
+		bool Find(u64 key, std::string &outEntryPath);
+		void RecordRead(bool succeeded);
+
+		// Writers fill the file returned by BeginStore and then commit it, which moves it into place and evicts old entries if the cache is over budget
+		std::string BeginStore(u64 key);
+		bool CommitStore(u64 key, const std::string &tempPath);
+		void AbortStore(const std::string &tempPath);
+
+		void Prune(u64 maxSize);
+		void SaveSourceHashes();
+
+		DerivedDataCacheStats GetStats() const;
+		void ResetStats();
+
+		// Handles --ddc-warm [directory] and --ddc-prune [maxSizeMB], returns true if a cache command was run and the application shouldn't start
+		static bool RunCommandLine(int argc, char **argv);
+
+		static u64 HashBytes(const void *data, size_t size, u64 seed = 0);
+		static u64 HashCombine(u64 seed, u64 value);
+	private:
+		std::string GetEntryPath(u64 key) const;
+		void EvictLeastRecentlyUsed(u64 maxSize); // Caller must hold m_Mutex
+
+		void LoadSourceHashes();
+	private:
+		struct CacheEntry
+		{
+			u64 Size;
+			s64 LastUsed;
+		};
+
+		struct SourceHashRecord
+		{
+			u64 FileSize;
+			s64 WriteTime;
+			u64 Hash;
+		};
+
+		std::string m_Directory;
+		u64 m_MaxSize;
+
+		// Guards the entry table and the source hashes since assets are loaded from the job system's workers
+		mutable std::mutex m_Mutex;
+		std::unordered_map<u64, CacheEntry> m_Entries;
+		u64 m_TotalSize;
+		std::unordered_map<std::string, SourceHashRecord> m_SourceHashes;
+		std::unordered_map<std::string, std::vector<u64>> m_SourceVariants;
+		bool m_SourceHashesDirty;
+
+		std::atomic<u32> m_NextTempId;
+
+		// Stats
+		std::atomic<u64> m_Hits;
+		std::atomic<u64> m_Misses;
+		std::atomic<u64> m_Stores;
+		std::atomic<u64> m_Evictions;
+	};
+}
+#endif
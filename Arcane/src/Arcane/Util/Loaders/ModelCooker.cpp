@@ -0,0 +1,283 @@
+#include "arcpch.h"
+#include "ModelCooker.h"
+
+#include <Arcane/Graphics/Mesh/Model.h>
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
+#include <Arcane/Util/MemoryMappedFile.h>
+
+namespace Arcane
+{
+	namespace
+	{
+		inline u64 AlignOffset(u64 offset)
+		{
+			return (offset + (CookedModelDataAlignment - 1)) & ~(u64)(CookedModelDataAlignment - 1);
+		}
+
+		template<typename T>
+		void WriteValue(std::string &buffer, const T &value)
+		{
+			buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		void WriteString(std::string &buffer, const std::string &value)
+		{
+			WriteValue(buffer, static_cast<u32>(value.size()));
+			buffer.append(value);
+		}
+
+		// Bounds checked cursor over the mapped file, a truncated or corrupt file makes the reads fail instead of walking off the end of the mapping
+		class CookedFileReader
+		{
+		public:
+			CookedFileReader(const u8 *data, size_t size) : m_Data(data), m_Size(size), m_Cursor(0) {}
+
+			template<typename T>
+			bool Read(T &outValue)
+			{
+				if (m_Size - m_Cursor < sizeof(T))
+					return false;
+
+				// Memcpy since the metadata section isn't aligned
+				memcpy(&outValue, m_Data + m_Cursor, sizeof(T));
+				m_Cursor += sizeof(T);
+				return true;
+			}
+
+			bool ReadString(std::string &outValue)
+			{
+				u32 length;
+				if (!Read(length) || m_Size - m_Cursor < length)
+					return false;
+
+				outValue.assign(reinterpret_cast<const char*>(m_Data + m_Cursor), length);
+				m_Cursor += length;
+				return true;
+			}
+
+			inline bool ContainsRange(u64 offset, u64 size) const { return offset <= m_Size && size <= m_Size - offset; }
+		private:
+			const u8 *m_Data;
+			size_t m_Size;
+			size_t m_Cursor;
+		};
+	}
+
+	bool ModelCooker::LoadCookedModel(const std::string &sourcePath, unsigned int importFlags, Model &model)
+	{
+		u64 cacheKey = GetCacheKey(sourcePath, importFlags);
+		std::string entryPath;
+		if (cacheKey == 0 || !DerivedDataCache::GetInstance().Find(cacheKey, entryPath))
+			return false;
+
+		bool loaded = ReadCookedModel(sourcePath, entryPath, model);
+		DerivedDataCache::GetInstance().RecordRead(loaded);
+		return loaded;
+	}
+
+	bool ModelCooker::ReadCookedModel(const std::string &sourcePath, const std::string &entryPath, Model &model)
+	{
+		std::shared_ptr<MemoryMappedFile> cookedFile = std::make_shared<MemoryMappedFile>();
+		if (!cookedFile->Open(entryPath))
+			return false;
+
+		CookedFileReader reader(cookedFile->GetData(), cookedFile->GetSize());
+		CookedModelHeader header;
+		if (!reader.Read(header) || header.Magic != CookedModelMagic)
+		{
+			ARC_LOG_WARN("Cooked model for {0} is corrupt, it will be cooked again", sourcePath);
+			return false;
+		}
+		if (header.Version != CookedModelVersion)
+			return false;
+
+		std::vector<CookedMeshHeader> meshHeaders(header.MeshCount);
+		for (u32 i = 0; i < header.MeshCount; i++)
+		{
+			if (!reader.Read(meshHeaders[i]))
+				return false;
+		}
+
+		std::unordered_map<std::string, BoneData> boneDataMap;
+		for (u32 i = 0; i < header.BoneCount; i++)
+		{
+			BoneData boneData;
+			std::string boneName;
+			if (!reader.Read(boneData.boneID) || !reader.Read(boneData.inverseBindPose) || !reader.ReadString(boneName))
+				return false;
+
+			boneDataMap[boneName] = boneData;
+		}
+
+		std::vector<std::array<std::string, CookedMaterialTextureCount>> materialTexturePaths(header.MeshCount);
+		for (u32 i = 0; i < header.MeshCount; i++)
+		{
+			for (int j = 0; j < CookedMaterialTextureCount; j++)
+			{
+				if (!reader.ReadString(materialTexturePaths[i][j]))
+					return false;
+			}
+		}
+
+		// Validate every blob before touching the model, so a bad file can't leave it half loaded
+		for (const CookedMeshHeader &meshHeader : meshHeaders)
+		{
+			u64 vertexDataSize = static_cast<u64>(meshHeader.VertexCount) * meshHeader.ComponentCount * sizeof(float);
+			u64 indexDataSize = static_cast<u64>(meshHeader.IndexCount) * sizeof(unsigned int);
+			bool validLayout = (meshHeader.VertexAttributes & VertexAttributePosition) && meshHeader.VertexCount > 0 &&
+				(meshHeader.VertexDataOffset % sizeof(float)) == 0 && (meshHeader.IndexDataOffset % sizeof(unsigned int)) == 0;
+			if (!validLayout || !reader.ContainsRange(meshHeader.VertexDataOffset, vertexDataSize) || !reader.ContainsRange(meshHeader.IndexDataOffset, indexDataSize))
+			{
+				ARC_LOG_WARN("Cooked model for {0} is corrupt, it will be cooked again", sourcePath);
+				return false;
+			}
+		}
+
+		model.m_Meshes.clear();
+		model.m_Meshes.reserve(header.MeshCount);
+		for (u32 i = 0; i < header.MeshCount; i++)
+		{
+			const CookedMeshHeader &meshHeader = meshHeaders[i];
+
+			Mesh mesh;
+			mesh.m_IsInterleaved = true;
+			mesh.m_BufferComponentCount = meshHeader.ComponentCount;
+			mesh.m_VertexAttributes = meshHeader.VertexAttributes;
+			mesh.m_VertexCount = meshHeader.VertexCount;
+			mesh.m_IndexCount = meshHeader.IndexCount;
+			mesh.m_BoundsMin = meshHeader.BoundsMin;
+			mesh.m_BoundsMax = meshHeader.BoundsMax;
+			mesh.m_MappedVertexData = cookedFile->GetData() + meshHeader.VertexDataOffset;
+			mesh.m_MappedIndexData = reinterpret_cast<const unsigned int*>(cookedFile->GetData() + meshHeader.IndexDataOffset);
+
+			model.LoadMaterialTextures(mesh, materialTexturePaths[i]);
+			model.ExpandBounds(mesh, i == 0);
+			model.m_Meshes.emplace_back(std::move(mesh));
+		}
+		model.m_BoneDataMap = std::move(boneDataMap);
+		model.m_BoneCount = static_cast<int>(header.BoneCount);
+		model.m_GlobalInverseTransform = header.GlobalInverseTransform;
+
+		// The meshes point into the mapping, so the model keeps it alive until its GPU data has been generated
+		model.m_CookedFile = cookedFile;
+
+		return true;
+	}
+
+	bool ModelCooker::CookModel(const std::string &sourcePath, unsigned int importFlags, const Model &model)
+	{
+		if (model.m_Meshes.size() == 0)
+			return false;
+
+		u64 cacheKey = GetCacheKey(sourcePath, importFlags);
+		if (cacheKey == 0)
+			return false;
+
+		// Build everything that comes before the vertex and index blobs in memory, the mesh headers get patched once the blob offsets are known
+		std::string metadata;
+
+		CookedModelHeader header;
+		header.Magic = CookedModelMagic;
+		header.Version = CookedModelVersion;
+		header.MeshCount = static_cast<u32>(model.m_Meshes.size());
+		header.BoneCount = static_cast<u32>(model.m_BoneDataMap.size());
+		header.GlobalInverseTransform = model.m_GlobalInverseTransform;
+		WriteValue(metadata, header);
+
+		size_t meshHeadersOffset = metadata.size();
+		metadata.resize(metadata.size() + sizeof(CookedMeshHeader) * model.m_Meshes.size());
+
+		for (auto &bone : model.m_BoneDataMap)
+		{
+			WriteValue(metadata, static_cast<s32>(bone.second.boneID));
+			WriteValue(metadata, bone.second.inverseBindPose);
+			WriteString(metadata, bone.first);
+		}
+
+		for (size_t i = 0; i < model.m_Meshes.size(); i++)
+		{
+			for (int j = 0; j < CookedMaterialTextureCount; j++)
+			{
+				WriteString(metadata, i < model.m_MaterialTexturePaths.size() ? model.m_MaterialTexturePaths[i][j] : std::string());
+			}
+		}
+
+		std::vector<CookedMeshHeader> meshHeaders(model.m_Meshes.size());
+		u64 dataOffset = AlignOffset(metadata.size());
+		for (size_t i = 0; i < model.m_Meshes.size(); i++)
+		{
+			const Mesh &mesh = model.m_Meshes[i];
+			if (!mesh.m_IsInterleaved || mesh.m_BufferData.size() != static_cast<size_t>(mesh.m_VertexCount) * mesh.m_BufferComponentCount)
+			{
+				ARC_LOG_WARN("Can't cook model {0}, only interleaved meshes with CPU side data can be cooked", sourcePath);
+				return false;
+			}
+
+			CookedMeshHeader &meshHeader = meshHeaders[i];
+			meshHeader.VertexAttributes = mesh.m_VertexAttributes;
+			meshHeader.VertexCount = mesh.m_VertexCount;
+			meshHeader.IndexCount = mesh.m_IndexCount;
+			meshHeader.ComponentCount = mesh.m_BufferComponentCount;
+			meshHeader.BoundsMin = mesh.m_BoundsMin;
+			meshHeader.BoundsMax = mesh.m_BoundsMax;
+
+			meshHeader.VertexDataOffset = dataOffset;
+			dataOffset = AlignOffset(dataOffset + mesh.m_BufferData.size() * sizeof(float));
+			meshHeader.IndexDataOffset = dataOffset;
+			dataOffset = AlignOffset(dataOffset + mesh.m_Indices.size() * sizeof(unsigned int));
+		}
+		memcpy(&metadata[meshHeadersOffset], meshHeaders.data(), sizeof(CookedMeshHeader) * meshHeaders.size());
+
+		// The cache hands out a temporary file and swaps it in at the end, so a crash mid-write never leaves an entry behind that looks valid
+		DerivedDataCache &cache = DerivedDataCache::GetInstance();
+		std::string tempPath = cache.BeginStore(cacheKey);
+		{
+			std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				ARC_LOG_WARN("Failed to open {0} for writing, model {1} won't be cooked", tempPath, sourcePath);
+				return false;
+			}
+
+			const char padding[CookedModelDataAlignment] = {};
+			u64 written = metadata.size();
+			file.write(metadata.data(), metadata.size());
+			for (size_t i = 0; i < model.m_Meshes.size(); i++)
+			{
+				const Mesh &mesh = model.m_Meshes[i];
+
+				file.write(padding, meshHeaders[i].VertexDataOffset - written);
+				file.write(reinterpret_cast<const char*>(mesh.m_BufferData.data()), mesh.m_BufferData.size() * sizeof(float));
+				written = meshHeaders[i].VertexDataOffset + mesh.m_BufferData.size() * sizeof(float);
+
+				file.write(padding, meshHeaders[i].IndexDataOffset - written);
+				file.write(reinterpret_cast<const char*>(mesh.m_Indices.data()), mesh.m_Indices.size() * sizeof(unsigned int));
+				written = meshHeaders[i].IndexDataOffset + mesh.m_Indices.size() * sizeof(unsigned int);
+			}
+
+			if (!file)
+			{
+				ARC_LOG_WARN("Failed writing cooked model {0}", tempPath);
+				file.close();
+				cache.AbortStore(tempPath);
+				return false;
+			}
+		}
+
+		if (!cache.CommitStore(cacheKey, tempPath))
+			return false;
+
+		ARC_LOG_INFO("Cooked model {0} ({1} meshes)", sourcePath, header.MeshCount);
+		return true;
+	}
+
+	u64 ModelCooker::GetCacheKey(const std::string &sourcePath, unsigned int importFlags)
+	{
+		u64 sourceHash = DerivedDataCache::GetInstance().GetSourceHash(sourcePath);
+		if (sourceHash == 0)
+			return 0;
+
+		u64 key = DerivedDataCache::HashCombine(sourceHash, ((u64)DerivedDataCacheVersion << 32) | CookedModelVersion);
+		return DerivedDataCache::HashCombine(key, importFlags);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef MODELCOOKER_H
+#define MODELCOOKER_H
+
+namespace Arcane
+{
+	class Model;
+
+	static constexpr u32 CookedModelMagic = 0x4D435241; // "ARCM"
+	static constexpr u32 CookedModelVersion = 2; // Bump whenever the layout below or the way the data is produced changes
+	static constexpr u32 CookedModelDataAlignment = 16;
+	static constexpr int CookedMaterialTextureCount = 4; // Albedo, Normal, Ambient Occlusion, Displacement
+
+	// File layout: CookedModelHeader, CookedMeshHeader[MeshCount], bones, material texture paths, then the aligned vertex and index blobs
+	// Bones are written as (s32 ID, mat4 InverseBindPose, string Name) and paths as strings, a string being a u32 length followed by its characters
+	struct CookedModelHeader
+	{
+		u32 Magic;
+		u32 Version;
+		u32 MeshCount;
+		u32 BoneCount;
+		glm::mat4 GlobalInverseTransform;
+	};
+
+	struct CookedMeshHeader
+	{
+		u32 VertexAttributes;
+		u32 VertexCount;
+		u32 IndexCount;
+		u32 ComponentCount; // Floats per interleaved vertex
+		u64 VertexDataOffset; // From the start of the file
+		u64 IndexDataOffset;
+		glm::vec3 BoundsMin;
+		glm::vec3 BoundsMax;
+	};
+
+	// Converts imported models into a binary file that is already laid out the way the GPU wants it. Cooked models live in the derived data cache keyed by
+	// the source's contents and the importer flags. Loading one memory maps the entry and points the meshes straight at the mapped vertex and index data,
+	// so the only work left is the glBufferData copy
+	class ModelCooker
+	{
+	public:
+		// Returns false if there is no cooked entry or it is corrupt, in which case the model should be imported from the source
+		static bool LoadCookedModel(const std::string &sourcePath, unsigned int importFlags, Model &model);
+		static bool CookModel(const std::string &sourcePath, unsigned int importFlags, const Model &model);
+	private:
+		static u64 GetCacheKey(const std::string &sourcePath, unsigned int importFlags);
+		static bool ReadCookedModel(const std::string &sourcePath, const std::string &entryPath, Model &model);
+	};
+}
+#endif
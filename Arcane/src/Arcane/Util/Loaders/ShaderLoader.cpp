@@ -2,6 +2,8 @@
 #include "ShaderLoader.h"
 
 #include <Arcane/Graphics/Shader.h>
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
+#include <Arcane/Util/Timer.h>
 
 namespace Arcane
 {
@@ -9,10 +11,41 @@ namespace Arcane
 	std::string ShaderLoader::s_ShaderFilepath;
 	std::unordered_map<std::size_t, Shader*> ShaderLoader::s_ShaderCache;
 	std::hash<std::string> ShaderLoader::s_Hasher;
+	std::unordered_set<std::size_t> ShaderLoader::s_LoadedFiles;
+	ShaderDefines ShaderLoader::s_GlobalDefines;
+	bool ShaderLoader::s_ParallelCompile = false;
+	bool ShaderLoader::s_ProgramBinaryCache = false;
+	u64 ShaderLoader::s_DriverHash = 0;
+	ShaderLoaderStats ShaderLoader::s_Stats = {};
 
-	Shader* ShaderLoader::LoadShader(const std::string &path) {
+	void ShaderLoader::Init() {
+		const char *vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+		const char *renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+		const char *version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+		std::string driver = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+		s_DriverHash = DerivedDataCache::HashBytes(driver.data(), driver.size());
+
+#if USE_DERIVED_DATA_CACHE && USE_SHADER_PROGRAM_BINARY_CACHE
+		GLint binaryFormatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+		s_ProgramBinaryCache = binaryFormatCount > 0;
+#endif
+
+#if USE_SHADER_PARALLEL_COMPILE
+		// The KHR and ARB versions share their tokens, only the ARB one has an entry point in our GLEW so the KHR one keeps the driver's default thread count
+		s_ParallelCompile = GLEW_ARB_parallel_shader_compile || glfwExtensionSupported("GL_KHR_parallel_shader_compile");
+		if (GLEW_ARB_parallel_shader_compile) {
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF); // Let the driver decide
+		}
+#endif
+
+		ARC_LOG_INFO("Shader compiling - Parallel:{0} Program Binary Cache:{1}", s_ParallelCompile, s_ProgramBinaryCache);
+	}
+
+	Shader* ShaderLoader::LoadShader(const std::string &path, const ShaderDefines &defines) {
 		std::string shaderPath = s_ShaderFilepath + path;
-		std::size_t hash = s_Hasher(shaderPath);
+		std::size_t fileHash = s_Hasher(shaderPath);
+		std::size_t hash = defines.IsEmpty() ? fileHash : static_cast<std::size_t>(DerivedDataCache::HashCombine(fileHash, defines.GetHash()));
 
 		// Check the cache
 		auto iter = s_ShaderCache.find(hash);
@@ -20,10 +53,25 @@ namespace Arcane
 			return iter->second;
 		}
 
-		// Load the shader
-		Shader *shader = new Shader(shaderPath);
+		// Load the shader, this only submits the compile
+		Timer submitTimer;
+		Shader *shader = new Shader(shaderPath, defines);
+		s_Stats.SubmitTime += submitTimer.Elapsed();
+		s_Stats.ProgramsLoaded++;
+		if (!defines.IsEmpty()) {
+			s_Stats.Permutations++;
+		}
+		if (s_LoadedFiles.insert(fileHash).second) {
+			s_Stats.ShaderFiles++;
+		}
 
 		s_ShaderCache.insert(std::pair<std::size_t, Shader*>(hash, shader));
 		return s_ShaderCache[hash];
 	}
+
+	void ShaderLoader::FinishPendingShaders() {
+		for (auto &item : s_ShaderCache) {
+			item.second->WaitForCompile();
+		}
+	}
 }
@@ -2,19 +2,58 @@
 #ifndef SHADERLOADER_H
 #define SHADERLOADER_H
 
+#ifndef SHADERDEFINES_H
+#include <Arcane/Graphics/ShaderDefines.h>
+#endif
+
 namespace Arcane
 {
 	class Shader;
 
+	struct ShaderLoaderStats
+	{
+		u32 ProgramsLoaded;
+		u32 ShaderFiles; // Distinct files the programs came from, anything above this is a permutation
+		u32 Permutations; // Programs loaded with defines
+		u32 BinaryCacheHits;
+		u32 BinaryCacheStores;
+		double SubmitTime; // Seconds spent handing sources (or cached binaries) to the driver
+		double WaitTime; // Seconds spent blocked on compiles finishing, including reflecting the linked programs
+	};
+
 	class ShaderLoader
 	{
+		friend class Shader;
 	public:
-		static Shader* LoadShader(const std::string &path);
+		// Queries what the driver supports for compiling and caching programs, needs to be called with the context current before any shader is loaded
+		static void Init();
+
+		// Shaders are returned as soon as their compile is submitted, they are waited on the first time they are used.
+		// Each set of defines is cached as its own program, shader files can #include others relative to themselves or the shader directory
+		static Shader* LoadShader(const std::string &path, const ShaderDefines &defines = ShaderDefines());
+
+		// Blocks until every loaded shader is ready so that the wait happens at a known point instead of in the first frame
+		static void FinishPendingShaders();
+
 		inline static void SetShaderFilepath(const std::string &path) { s_ShaderFilepath = path; }
+
+		// Injected into every shader, these are limits shared with the engine (light and bone counts) so they only live in one place. Set before any shader that uses them is loaded
+		inline static void SetGlobalDefine(const std::string &name, int value) { s_GlobalDefines.Set(name, value); }
+
+		inline static const ShaderLoaderStats& GetStats() { return s_Stats; }
+		inline static bool IsParallelCompileSupported() { return s_ParallelCompile; }
+		inline static bool IsProgramBinaryCacheEnabled() { return s_ProgramBinaryCache; }
 	private:
 		static std::string s_ShaderFilepath;
 		static std::unordered_map<std::size_t, Shader*> s_ShaderCache;
 		static std::hash<std::string> s_Hasher;
+		static std::unordered_set<std::size_t> s_LoadedFiles;
+		static ShaderDefines s_GlobalDefines;
+
+		static bool s_ParallelCompile;
+		static bool s_ProgramBinaryCache;
+		static u64 s_DriverHash; // Vendor, renderer and version, binaries are only valid for the driver that produced them
+		static ShaderLoaderStats s_Stats;
 	};
 }
 #endif
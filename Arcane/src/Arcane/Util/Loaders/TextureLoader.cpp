@@ -3,10 +3,90 @@
 
 #include <Arcane/Graphics/Texture/Texture.h>
 #include <Arcane/Graphics/Texture/Cubemap.h>
+#include <Arcane/Graphics/Texture/TextureCompressor.h>
 #include <Arcane/Util/Loaders/AssetManager.h>
+#include <Arcane/Util/Loaders/DDSFile.h>
+#include <Arcane/Util/Loaders/DerivedDataCache.h>
+#include <Arcane/Util/Timer.h>
 
 namespace Arcane
 {
+	static constexpr u32 CachedImageMagic = 0x54435241; // "ARCT"
+	static constexpr u32 CachedImageVersion = 3;
+	static constexpr u64 CubemapFaceVariant = ~0ull; // Faces only have the one variant, their key doesn't depend on any settings
+
+	struct CachedImageHeader
+	{
+		u32 Magic;
+		s32 Width;
+		s32 Height;
+		u32 DataFormat;
+		u64 DataSize;
+	};
+
+	static bool IsDDSFile(const std::string &path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(::tolower(c)); });
+		return extension == ".dds";
+	}
+
+	static int GetComponentCount(GLenum dataFormat)
+	{
+		switch (dataFormat)
+		{
+		case GL_RED:  return 1;
+		case GL_RGB:  return 3;
+		case GL_RGBA: return 4;
+		}
+		return 0;
+	}
+
+	static GLenum GetDataFormat(int componentCount)
+	{
+		switch (componentCount)
+		{
+		case 1: return GL_RED;
+		case 3: return GL_RGB;
+		case 4: return GL_RGBA;
+		}
+		return GL_NONE;
+	}
+
+	static void SetCompressedGenerationData(const CompressedImageInfo &info, TextureGenerationData &inOutData)
+	{
+		inOutData.width = info.Width;
+		inOutData.height = info.Height;
+		inOutData.dataFormat = GL_NONE;
+		inOutData.compressedFormat = TextureCompressor::GetGLFormat(info.Format, info.IsSRGB);
+		inOutData.mipCount = info.MipCount;
+		inOutData.dataSize = TextureCompressor::GetCompressedSize(info);
+	}
+
+	// Staged data is read by the driver out of the bound staging buffer, so the pointer becomes an offset into it
+	static const unsigned char* BeginUpload(const StagingAllocation &staging, const unsigned char *data)
+	{
+		if (!staging.IsValid())
+			return data;
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.Owner->GetBufferID());
+		return reinterpret_cast<const unsigned char*>(static_cast<uintptr_t>(staging.Offset));
+	}
+
+	static void EndUpload(StagingAllocation &staging, unsigned char *data)
+	{
+		if (staging.IsValid())
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			staging.Owner->Release(staging);
+			staging = StagingAllocation();
+		}
+		else
+		{
+			stbi_image_free(data);
+		}
+	}
+
 	// Static declarations
 	Texture *TextureLoader::s_DefaultNormal; Texture *TextureLoader::s_DefaultWaterDistortion;
 	Texture *TextureLoader::s_WhiteTexture; Texture *TextureLoader::s_BlackTexture;
@@ -14,53 +94,320 @@ namespace Arcane
 
 	void TextureLoader::Load2DTextureData(const std::string &path, TextureGenerationData &inOutData)
 	{
-		// Load the texture data from file
-		int numComponents;
-		inOutData.data = stbi_load(path.c_str(), &inOutData.width, &inOutData.height, &numComponents, 0);
+		inOutData.data = LoadTextureData(path, inOutData.texture->GetTextureSettings(), inOutData);
 		if (!inOutData.data)
 		{
 			ARC_LOG_ERROR("Failed to load texture path: {0}", path);
-			stbi_image_free(inOutData.data);
-			return;
-		}
-
-		switch (numComponents)
-		{
-		case 1: inOutData.dataFormat = GL_RED;  break;
-		case 3: inOutData.dataFormat = GL_RGB;  break;
-		case 4: inOutData.dataFormat = GL_RGBA; break;
 		}
 	}
 
 	void TextureLoader::Generate2DTexture(const std::string &path, TextureGenerationData &inOutData)
 	{
-		inOutData.texture->Generate2DTexture(inOutData.width, inOutData.height, inOutData.dataFormat, GL_UNSIGNED_BYTE, inOutData.data);
-		stbi_image_free(inOutData.data);
+		const unsigned char *data = BeginUpload(inOutData.staging, inOutData.data);
+		if (inOutData.compressedFormat != GL_NONE)
+			inOutData.texture->GenerateCompressed2DTexture(inOutData.width, inOutData.height, inOutData.compressedFormat, inOutData.mipCount, data, inOutData.firstResidentMip);
+		else
+			inOutData.texture->Generate2DTexture(inOutData.width, inOutData.height, inOutData.dataFormat, GL_UNSIGNED_BYTE, data);
+		EndUpload(inOutData.staging, inOutData.data);
 	}
 	void TextureLoader::LoadCubemapTextureData(const std::string &path, CubemapGenerationData &inOutData)
 	{
-		// Load the cubemap data from file
-		int numComponents;
-		inOutData.data = stbi_load(path.c_str(), &inOutData.width, &inOutData.height, &numComponents, 0);
+		u64 cacheKey = GetCubemapFaceCacheKey(path);
+		if (cacheKey != 0)
+			DerivedDataCache::GetInstance().RecordSourceVariant(path, CubemapFaceVariant);
+
+		inOutData.data = LoadImageData(path, cacheKey, inOutData.width, inOutData.height, inOutData.dataFormat);
 		if (!inOutData.data)
 		{
 			ARC_LOG_ERROR("Failed to load cubemap face: {0}, at path: {1} - Reason: {2}", inOutData.face, path, stbi_failure_reason());
-			stbi_image_free(inOutData.data);
 			return;
 		}
+		inOutData.dataSize = static_cast<size_t>(inOutData.width) * inOutData.height * GetComponentCount(inOutData.dataFormat);
+	}
+
+	void TextureLoader::GenerateCubemapTexture(const std::string &path, CubemapGenerationData &inOutData)
+	{
+		const unsigned char *data = BeginUpload(inOutData.staging, inOutData.data);
+		inOutData.cubemap->GenerateCubemapFace(inOutData.face, inOutData.width, inOutData.height, inOutData.dataFormat, data);
+		EndUpload(inOutData.staging, inOutData.data);
+	}
+
+	void TextureLoader::WarmTextureData(const std::string &path, const TextureSettings &settings)
+	{
+		TextureGenerationData genData = {};
+		unsigned char *data = LoadTextureData(path, settings, genData);
+		if (data)
+			stbi_image_free(data);
+	}
 
-		switch (numComponents)
+	void TextureLoader::WarmRecordedTextureData(const std::string &path)
+	{
+		std::vector<u64> variants = DerivedDataCache::GetInstance().GetSourceVariants(path);
+		if (variants.empty())
 		{
-		case 1: inOutData.dataFormat = GL_RED;  break;
-		case 3: inOutData.dataFormat = GL_RGB;  break;
-		case 4: inOutData.dataFormat = GL_RGBA; break;
+			TextureSettings linearSettings;
+			TextureSettings srgbSettings;
+			srgbSettings.IsSRGB = true;
+			variants = { GetTextureVariant(linearSettings), GetTextureVariant(srgbSettings) };
+		}
+
+		for (u64 variant : variants)
+		{
+			if (variant == CubemapFaceVariant)
+			{
+				int width, height;
+				GLenum dataFormat;
+				unsigned char *data = LoadImageData(path, GetCubemapFaceCacheKey(path), width, height, dataFormat);
+				if (data)
+					stbi_image_free(data);
+				continue;
+			}
+
+			WarmTextureData(path, GetVariantSettings(variant));
 		}
 	}
 
-	void TextureLoader::GenerateCubemapTexture(const std::string &path, CubemapGenerationData &inOutData)
+	unsigned char* TextureLoader::LoadTextureData(const std::string &path, const TextureSettings &settings, TextureGenerationData &inOutData)
+	{
+		inOutData.compressedFormat = GL_NONE;
+		inOutData.mipCount = 1;
+
+		u64 cacheKey = GetTextureCacheKey(path, settings);
+		if (cacheKey != 0)
+			DerivedDataCache::GetInstance().RecordSourceVariant(path, GetTextureVariant(settings));
+
+		unsigned char *data;
+		if (UsesCompression(path, settings))
+			data = LoadCompressedImageData(path, cacheKey, settings, inOutData);
+		else
+			data = LoadImageData(path, cacheKey, inOutData.width, inOutData.height, inOutData.dataFormat);
+
+		if (data && inOutData.compressedFormat == GL_NONE)
+			inOutData.dataSize = static_cast<size_t>(inOutData.width) * inOutData.height * GetComponentCount(inOutData.dataFormat);
+		return data;
+	}
+
+	unsigned char* TextureLoader::LoadImageData(const std::string &path, u64 cacheKey, int &outWidth, int &outHeight, GLenum &outDataFormat)
+	{
+		std::string entryPath;
+		if (cacheKey != 0 && DerivedDataCache::GetInstance().Find(cacheKey, entryPath))
+		{
+			unsigned char *cachedData = ReadCachedImageData(entryPath, outWidth, outHeight, outDataFormat);
+			DerivedDataCache::GetInstance().RecordRead(cachedData != nullptr);
+			if (cachedData)
+				return cachedData;
+		}
+
+		// Load the texture data from file
+		int numComponents;
+		unsigned char *data = stbi_load(path.c_str(), &outWidth, &outHeight, &numComponents, 0);
+		if (!data)
+			return nullptr;
+
+		// Two component images have no matching format, don't cache something we can't read back
+		outDataFormat = GetDataFormat(numComponents);
+		if (outDataFormat == GL_NONE)
+			return data;
+
+		if (cacheKey != 0)
+			WriteCachedImageData(cacheKey, outWidth, outHeight, outDataFormat, data);
+
+		return data;
+	}
+
+	unsigned char* TextureLoader::ReadCachedImageData(const std::string &entryPath, int &outWidth, int &outHeight, GLenum &outDataFormat)
+	{
+		std::ifstream file(entryPath, std::ios::in | std::ios::binary);
+		CachedImageHeader header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.Magic != CachedImageMagic || header.Width <= 0 || header.Height <= 0 ||
+			header.DataSize != static_cast<u64>(header.Width) * static_cast<u64>(header.Height) * GetComponentCount(header.DataFormat) || header.DataSize == 0)
+		{
+			ARC_LOG_WARN("Cached texture data {0} is corrupt, decoding the source instead", entryPath);
+			return nullptr;
+		}
+
+		// Allocated with malloc since stb_image uses the CRT allocator, that way every caller frees the data with stbi_image_free regardless of where it came from
+		unsigned char *data = static_cast<unsigned char*>(malloc(static_cast<size_t>(header.DataSize)));
+		if (!data || !file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(header.DataSize)))
+		{
+			free(data);
+			return nullptr;
+		}
+
+		outWidth = header.Width;
+		outHeight = header.Height;
+		outDataFormat = header.DataFormat;
+		return data;
+	}
+
+	void TextureLoader::WriteCachedImageData(u64 cacheKey, int width, int height, GLenum dataFormat, const unsigned char *data)
+	{
+		DerivedDataCache &cache = DerivedDataCache::GetInstance();
+
+		CachedImageHeader header;
+		header.Magic = CachedImageMagic;
+		header.Width = width;
+		header.Height = height;
+		header.DataFormat = dataFormat;
+		header.DataSize = static_cast<u64>(width) * static_cast<u64>(height) * GetComponentCount(dataFormat);
+
+		std::string tempPath = cache.BeginStore(cacheKey);
+		{
+			std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(header.DataSize));
+			if (!file)
+			{
+				file.close();
+				cache.AbortStore(tempPath);
+				return;
+			}
+		}
+		cache.CommitStore(cacheKey, tempPath);
+	}
+
+	unsigned char* TextureLoader::LoadCompressedImageData(const std::string &path, u64 cacheKey, const TextureSettings &settings, TextureGenerationData &inOutData)
 	{
-		inOutData.cubemap->GenerateCubemapFace(inOutData.face, inOutData.width, inOutData.height, inOutData.dataFormat, inOutData.data);
-		stbi_image_free(inOutData.data);
+		CompressedImageInfo info;
+		if (IsDDSFile(path))
+		{
+			unsigned char *ddsData = DDSFile::Read(path, info);
+			info.IsSRGB = info.IsSRGB || settings.IsSRGB;
+			if (ddsData)
+				SetCompressedGenerationData(info, inOutData);
+			return ddsData;
+		}
+
+		std::string entryPath;
+		if (cacheKey != 0 && DerivedDataCache::GetInstance().Find(cacheKey, entryPath))
+		{
+			unsigned char *cachedData = DDSFile::Read(entryPath, info);
+			if (cachedData)
+			{
+				DerivedDataCache::GetInstance().RecordRead(true);
+				SetCompressedGenerationData(info, inOutData);
+				return cachedData;
+			}
+
+			// Images that weren't worth compressing are cached as plain pixels
+			cachedData = ReadCachedImageData(entryPath, inOutData.width, inOutData.height, inOutData.dataFormat);
+			DerivedDataCache::GetInstance().RecordRead(cachedData != nullptr);
+			if (cachedData)
+				return cachedData;
+		}
+
+		int numComponents;
+		unsigned char *data = stbi_load(path.c_str(), &inOutData.width, &inOutData.height, &numComponents, 0);
+		if (!data)
+			return nullptr;
+
+		inOutData.dataFormat = GetDataFormat(numComponents);
+		if (inOutData.dataFormat == GL_NONE)
+			return data;
+
+		info.Width = inOutData.width;
+		info.Height = inOutData.height;
+		info.IsSRGB = settings.IsSRGB;
+		info.MipCount = settings.HasMips ? TextureCompressor::GetFullMipCount(info.Width, info.Height) : 1;
+		info.Format = settings.Compression == TextureCompression::Auto ? TextureCompressor::ChooseFormat(data, info.Width, info.Height, numComponents, info.IsSRGB) : settings.Compression;
+		if (info.Format == TextureCompression::None)
+		{
+			if (cacheKey != 0)
+				WriteCachedImageData(cacheKey, inOutData.width, inOutData.height, inOutData.dataFormat, data);
+			return data;
+		}
+
+		// Allocated with malloc so it gets freed with stbi_image_free like every other texture's data
+		Timer compressTimer;
+		unsigned char *compressedData = static_cast<unsigned char*>(malloc(TextureCompressor::GetCompressedSize(info)));
+		if (!compressedData)
+			return data;
+		TextureCompressor::Compress(data, info.Width, info.Height, numComponents, info, compressedData);
+		stbi_image_free(data);
+		ARC_LOG_INFO("Compressed texture {0} to {1} ({2}x{3}, {4} mips) in {5}ms", path, TextureCompressor::GetFormatName(info.Format), info.Width, info.Height, info.MipCount, compressTimer.Elapsed() * 1000.0);
+
+		if (cacheKey != 0)
+			WriteCachedCompressedData(cacheKey, info, compressedData);
+
+		SetCompressedGenerationData(info, inOutData);
+		return compressedData;
+	}
+
+	void TextureLoader::WriteCachedCompressedData(u64 cacheKey, const CompressedImageInfo &info, const unsigned char *data)
+	{
+		// Cached compressed textures are plain DDS files, which makes them easy to inspect with other tools
+		DerivedDataCache &cache = DerivedDataCache::GetInstance();
+		std::string tempPath = cache.BeginStore(cacheKey);
+		if (!DDSFile::Write(tempPath, info, data))
+		{
+			cache.AbortStore(tempPath);
+			return;
+		}
+		cache.CommitStore(cacheKey, tempPath);
+	}
+
+	bool TextureLoader::UsesCompression(const std::string &path, const TextureSettings &settings)
+	{
+		// Already compressed sources always take the compressed path since stb_image can't decode them
+		if (IsDDSFile(path))
+			return true;
+
+#if USE_TEXTURE_COMPRESSION
+		// Textures that ask for a specific format are left alone
+		return settings.TextureFormat == GL_NONE && settings.Compression != TextureCompression::None;
+#else
+		return false;
+#endif
+	}
+
+	u64 TextureLoader::GetTextureCacheKey(const std::string &path, const TextureSettings &settings)
+	{
+#if USE_DERIVED_DATA_CACHE
+		u64 sourceHash = DerivedDataCache::GetInstance().GetSourceHash(path);
+		if (sourceHash == 0)
+			return 0;
+
+		u64 key = DerivedDataCache::HashCombine(sourceHash, ((u64)DerivedDataCacheVersion << 32) | CachedImageVersion);
+		key = DerivedDataCache::HashCombine(key, settings.TextureFormat);
+		key = DerivedDataCache::HashCombine(key, ((u64)settings.IsSRGB << 1) | (u64)settings.HasMips);
+
+		// Uncompressed and compressed entries never share a key, so toggling compression can't serve the other kind of data
+		TextureCompression compression = UsesCompression(path, settings) ? settings.Compression : TextureCompression::None;
+		key = DerivedDataCache::HashCombine(key, static_cast<u64>(compression));
+		return key;
+#else
+		return 0;
+#endif
+	}
+
+	u64 TextureLoader::GetCubemapFaceCacheKey(const std::string &path)
+	{
+#if USE_DERIVED_DATA_CACHE
+		u64 sourceHash = DerivedDataCache::GetInstance().GetSourceHash(path);
+		if (sourceHash == 0)
+			return 0;
+
+		// Tagged so cubemap faces never share entries with 2D textures, their processing can diverge
+		u64 key = DerivedDataCache::HashCombine(sourceHash, ((u64)DerivedDataCacheVersion << 32) | CachedImageVersion);
+		return DerivedDataCache::HashCombine(key, GL_TEXTURE_CUBE_MAP);
+#else
+		return 0;
+#endif
+	}
+
+	u64 TextureLoader::GetTextureVariant(const TextureSettings &settings)
+	{
+		return ((u64)settings.TextureFormat << 32) | ((u64)settings.Compression << 8) | ((u64)settings.IsSRGB << 1) | (u64)settings.HasMips;
+	}
+
+	TextureSettings TextureLoader::GetVariantSettings(u64 variant)
+	{
+		TextureSettings settings;
+		settings.TextureFormat = static_cast<GLenum>(variant >> 32);
+		settings.Compression = static_cast<TextureCompression>((variant >> 8) & 0xFF);
+		settings.IsSRGB = (variant & 2) != 0;
+		settings.HasMips = (variant & 1) != 0;
+		return settings;
 	}
 
 	void TextureLoader::InitializeDefaultTextures()
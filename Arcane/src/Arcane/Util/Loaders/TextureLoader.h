@@ -2,12 +2,17 @@
 #ifndef TEXTURELOADER_H
 #define TEXTURELOADER_H
 
+#ifndef STAGINGRINGBUFFER_H
+#include <Arcane/Platform/OpenGL/StagingRingBuffer.h>
+#endif
+
 namespace Arcane
 {
 	class Texture;
 	struct TextureSettings;
 	class Cubemap;
 	struct CubemapSettings;
+	struct CompressedImageInfo;
 
 	struct TextureGenerationData
 	{
@@ -15,6 +20,13 @@ namespace Arcane
 		GLenum dataFormat;
 		unsigned char *data;
 		Texture *texture;
+
+		GLenum compressedFormat = GL_NONE; // When set, data holds block compressed mips instead of pixels
+		int mipCount = 1;
+		int firstResidentMip = 0; // Set by the texture streamer, compressed mips above it aren't uploaded
+
+		size_t dataSize = 0;
+		StagingAllocation staging; // When valid the data was moved into the staging buffer and data is null
 	};
 
 	struct CubemapGenerationData
@@ -24,12 +36,17 @@ namespace Arcane
 		unsigned char *data;
 		Cubemap *cubemap;
 		GLenum face;
+
+		size_t dataSize = 0;
+		StagingAllocation staging; // When valid the data was moved into the staging buffer and data is null
 	};
 
 	class TextureLoader
 	{
 		friend class AssetManager;
 		friend class Application;
+		friend class TextureStreamer;
+		friend class Model;
 	private:
 		static void InitializeDefaultTextures();
 
@@ -38,6 +55,35 @@ namespace Arcane
 
 		static void LoadCubemapTextureData(const std::string &path, CubemapGenerationData &inOutData);
 		static void GenerateCubemapTexture(const std::string &path, CubemapGenerationData &inOutData);
+
+		// Makes sure the derived data cache has the processed texture without creating it, used to warm the cache offline
+		static void WarmTextureData(const std::string &path, const TextureSettings &settings);
+
+		// Warms every variant the texture has been loaded with before (recorded by the derived data cache), textures that never were get both colour spaces
+		// with otherwise default settings
+		static void WarmRecordedTextureData(const std::string &path);
+
+		// Fills in everything but the texture, compressing the image when the settings ask for it
+		static unsigned char* LoadTextureData(const std::string &path, const TextureSettings &settings, TextureGenerationData &inOutData);
+
+		// Decodes the image, going through the derived data cache when it is enabled. The returned data is freed with stbi_image_free
+		static unsigned char* LoadImageData(const std::string &path, u64 cacheKey, int &outWidth, int &outHeight, GLenum &outDataFormat);
+		static unsigned char* ReadCachedImageData(const std::string &entryPath, int &outWidth, int &outHeight, GLenum &outDataFormat);
+		static void WriteCachedImageData(u64 cacheKey, int width, int height, GLenum dataFormat, const unsigned char *data);
+
+		// Like LoadImageData but returns block compressed mips, either from a .dds source, the derived data cache or by compressing the decoded image.
+		// Images the compressor decides to leave alone come back as plain pixels with compressedFormat left as GL_NONE
+		static unsigned char* LoadCompressedImageData(const std::string &path, u64 cacheKey, const TextureSettings &settings, TextureGenerationData &inOutData);
+		static void WriteCachedCompressedData(u64 cacheKey, const CompressedImageInfo &info, const unsigned char *data);
+		static bool UsesCompression(const std::string &path, const TextureSettings &settings);
+
+		// Only the settings that change the processed data are part of the key, sampler state is applied at generation time
+		static u64 GetTextureCacheKey(const std::string &path, const TextureSettings &settings);
+		static u64 GetCubemapFaceCacheKey(const std::string &path);
+
+		// Packs the settings that go into GetTextureCacheKey, so they can be recorded with the source and turned back into settings to warm the cache
+		static u64 GetTextureVariant(const TextureSettings &settings);
+		static TextureSettings GetVariantSettings(u64 variant);
 	private:
 		// Default Textures
 		static Texture *s_DefaultNormal, *s_DefaultWaterDistortion;
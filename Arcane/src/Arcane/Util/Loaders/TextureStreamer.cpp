@@ -0,0 +1,290 @@
+#include "arcpch.h"
+#include "TextureStreamer.h"
+
+#include <Arcane/Core/Threads/JobSystem.h>
+#include <Arcane/Graphics/Camera/ICamera.h>
+#include <Arcane/Graphics/Mesh/Model.h>
+#include <Arcane/Graphics/Window.h>
+#include <Arcane/Scene/Components.h>
+#include <Arcane/Scene/Scene.h>
+#include <Arcane/Util/Loaders/TextureLoader.h>
+
+#include <numeric>
+
+namespace Arcane
+{
+	static constexpr int EvictionHysteresisMips = 1; // Under budget a texture only gives up mips once it wants more than this many fewer, so small camera moves don't cause reloads
+
+	TextureStreamer::TextureStreamer() : m_JobSystem(JobSystem::GetInstance()), m_BudgetBytes(static_cast<u64>(TEXTURE_STREAMING_BUDGET_MB) * 1024 * 1024)
+	{
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		MipLoadResult result;
+		while (m_CompletedLoads.TryPop(result))
+		{
+			if (result.Data)
+				stbi_image_free(result.Data);
+		}
+	}
+
+	TextureStreamer& TextureStreamer::GetInstance()
+	{
+		static TextureStreamer streamer;
+		return streamer;
+	}
+
+	void TextureStreamer::OnTextureLoaded(const std::string &path, TextureGenerationData &inOutData)
+	{
+#if USE_TEXTURE_STREAMING
+		// Only cooked mips can be re-read later, uncompressed textures need their top mip to generate the rest
+		const TextureSettings &settings = inOutData.texture->GetTextureSettings();
+		if (inOutData.compressedFormat == GL_NONE || inOutData.mipCount <= 1 || !settings.HasMips || !settings.IsStreamable)
+			return;
+		if (m_StreamedTextureLookup.find(inOutData.texture) != m_StreamedTextureLookup.end())
+			return;
+
+		StreamedTexture streamedTexture;
+		streamedTexture.AssetTexture = inOutData.texture;
+		streamedTexture.Path = path;
+		streamedTexture.LoadSettings = settings;
+		streamedTexture.TailMip = 0;
+		while (streamedTexture.TailMip < inOutData.mipCount - 1 && glm::max(inOutData.width >> streamedTexture.TailMip, inOutData.height >> streamedTexture.TailMip) > TEXTURE_STREAMING_MIN_RESIDENT_SIZE)
+		{
+			streamedTexture.TailMip++;
+		}
+		streamedTexture.WantedMip = streamedTexture.TailMip;
+		streamedTexture.ScreenSize = 0.0f;
+		streamedTexture.LoadInFlight = false;
+
+		inOutData.firstResidentMip = streamedTexture.TailMip;
+		m_StreamedTextureLookup[inOutData.texture] = m_StreamedTextures.size();
+		m_StreamedTextures.push_back(std::move(streamedTexture));
+#endif
+	}
+
+	void TextureStreamer::Update(Scene *scene)
+	{
+		ProcessCompletedLoads();
+		if (m_StreamedTextures.empty())
+			return;
+
+		GatherScreenSizes(scene);
+		ChooseWantedMips();
+
+		// Evict before loading so the memory is free for the loads. Over budget every texture drops to its wanted mip, otherwise a little slack is allowed
+		u64 residentBytes = 0;
+		for (const StreamedTexture &streamedTexture : m_StreamedTextures)
+		{
+			residentBytes += streamedTexture.AssetTexture->GetResidentMemorySize();
+		}
+		for (StreamedTexture &streamedTexture : m_StreamedTextures)
+		{
+			Texture *texture = streamedTexture.AssetTexture;
+			int residentMip = texture->GetFirstResidentMip();
+			if (streamedTexture.WantedMip <= residentMip)
+				continue;
+
+			if (residentBytes > m_BudgetBytes || streamedTexture.WantedMip - residentMip > EvictionHysteresisMips)
+			{
+				size_t previousSize = texture->GetResidentMemorySize();
+				texture->SetFirstResidentMip(streamedTexture.WantedMip);
+				residentBytes -= previousSize - texture->GetResidentMemorySize();
+				m_MipsEvicted += streamedTexture.WantedMip - residentMip;
+			}
+		}
+
+		// Textures that are largest on screen get their loads in first
+		for (auto iter = m_PriorityOrder.rbegin(); iter != m_PriorityOrder.rend() && m_LoadsInFlight < TEXTURE_STREAMING_MAX_LOADS_IN_FLIGHT; ++iter)
+		{
+			StreamedTexture &streamedTexture = m_StreamedTextures[*iter];
+			if (!streamedTexture.LoadInFlight && streamedTexture.WantedMip < streamedTexture.AssetTexture->GetFirstResidentMip())
+				RequestMips(streamedTexture);
+		}
+	}
+
+	void TextureStreamer::ProcessCompletedLoads()
+	{
+		MipLoadResult result;
+		while (m_CompletedLoads.TryPop(result))
+		{
+			m_LoadsInFlight--;
+
+			auto lookupIter = m_StreamedTextureLookup.find(result.AssetTexture);
+			if (lookupIter != m_StreamedTextureLookup.end())
+			{
+				StreamedTexture &streamedTexture = m_StreamedTextures[lookupIter->second];
+				Texture *texture = streamedTexture.AssetTexture;
+				streamedTexture.LoadInFlight = false;
+
+				// The source could have been changed since the texture was created, in which case the mips won't line up with what is resident
+				bool matchesTexture = result.Data && result.CompressedFormat == texture->GetTextureSettings().TextureFormat && result.MipCount == texture->GetMipCount() &&
+					result.Width == static_cast<int>(texture->GetWidth()) && result.Height == static_cast<int>(texture->GetHeight());
+				if (matchesTexture)
+				{
+					// Only take the mips that are still wanted, the camera could have moved away while they were loading
+					int firstMip = glm::max(result.FirstMip, streamedTexture.WantedMip);
+					int residentMip = texture->GetFirstResidentMip();
+					if (firstMip < residentMip)
+					{
+						texture->SetFirstResidentMip(firstMip, result.Data + texture->GetCompressedMipOffset(firstMip));
+						m_MipsStreamedIn += residentMip - firstMip;
+					}
+				}
+				else
+				{
+					// Stop asking for mips that can't be loaded
+					ARC_LOG_WARN("Failed to stream mips for texture: {0}", streamedTexture.Path);
+					streamedTexture.TailMip = texture->GetFirstResidentMip();
+				}
+			}
+
+			if (result.Data)
+				stbi_image_free(result.Data);
+		}
+	}
+
+	void TextureStreamer::GatherScreenSizes(Scene *scene)
+	{
+		for (StreamedTexture &streamedTexture : m_StreamedTextures)
+		{
+			streamedTexture.ScreenSize = 0.0f;
+		}
+
+		// Pixels a world space unit covers at a distance of 1, or at any distance for an orthographic projection
+		ICamera *camera = scene->GetCamera();
+		glm::mat4 projection = camera->GetProjectionMatrix();
+		bool isPerspective = projection[3][3] == 0.0f;
+		float pixelsPerUnit = projection[1][1] * 0.5f * static_cast<float>(Window::GetRenderResolutionHeight());
+		glm::vec3 cameraPosition = camera->GetPosition();
+
+		auto group = scene->m_Registry.group<TransformComponent, MeshComponent>();
+		for (auto entity : group)
+		{
+			auto&[transform, meshComponent] = group.get<TransformComponent, MeshComponent>(entity);
+			if (!meshComponent.AssetModel)
+				continue;
+
+			glm::mat4 transformMatrix = transform.GetTransform();
+			float maxScale = glm::max(glm::abs(transform.Scale.x), glm::max(glm::abs(transform.Scale.y), glm::abs(transform.Scale.z)));
+			for (Mesh &mesh : meshComponent.AssetModel->GetMeshes())
+			{
+				// Uses the mesh's bounding sphere and assumes its UVs cover the texture about once across it
+				glm::vec3 centre = glm::vec3(transformMatrix * glm::vec4((mesh.GetBoundsMin() + mesh.GetBoundsMax()) * 0.5f, 1.0f));
+				float radius = glm::length(mesh.GetBoundsMax() - mesh.GetBoundsMin()) * 0.5f * maxScale;
+				float screenSize = 2.0f * radius * pixelsPerUnit;
+				if (isPerspective)
+					screenSize /= glm::max(glm::length(centre - cameraPosition) - radius, camera->GetNearPlane());
+
+				Material &material = mesh.GetMaterial();
+				Texture *textures[] = { material.GetAlbedoMap(), material.GetNormalMap(), material.GetMetallicMap(), material.GetRoughnessMap(), material.GetAmbientOcclusionMap(), material.GetDisplacementMap(), material.GetEmissionMap() };
+				for (Texture *texture : textures)
+				{
+					if (!texture)
+						continue;
+
+					auto lookupIter = m_StreamedTextureLookup.find(texture);
+					if (lookupIter != m_StreamedTextureLookup.end())
+					{
+						StreamedTexture &streamedTexture = m_StreamedTextures[lookupIter->second];
+						streamedTexture.ScreenSize = glm::max(streamedTexture.ScreenSize, screenSize);
+					}
+				}
+			}
+		}
+	}
+
+	void TextureStreamer::ChooseWantedMips()
+	{
+		m_PriorityOrder.resize(m_StreamedTextures.size());
+		std::iota(m_PriorityOrder.begin(), m_PriorityOrder.end(), 0);
+		std::sort(m_PriorityOrder.begin(), m_PriorityOrder.end(), [this](size_t a, size_t b) { return m_StreamedTextures[a].ScreenSize < m_StreamedTextures[b].ScreenSize; });
+
+		u64 wantedBytes = 0;
+		for (StreamedTexture &streamedTexture : m_StreamedTextures)
+		{
+			streamedTexture.WantedMip = GetWantedMip(streamedTexture);
+			wantedBytes += GetSizeFromMip(streamedTexture, streamedTexture.WantedMip);
+		}
+		m_WantedBytes = wantedBytes;
+
+		// Over budget, each pass takes a mip from every texture in order of smallest on screen until it fits or everything is down to its tail
+		bool droppedMip = true;
+		while (wantedBytes > m_BudgetBytes && droppedMip)
+		{
+			droppedMip = false;
+			for (size_t index : m_PriorityOrder)
+			{
+				StreamedTexture &streamedTexture = m_StreamedTextures[index];
+				if (streamedTexture.WantedMip >= streamedTexture.TailMip)
+					continue;
+
+				wantedBytes -= GetSizeFromMip(streamedTexture, streamedTexture.WantedMip) - GetSizeFromMip(streamedTexture, streamedTexture.WantedMip + 1);
+				streamedTexture.WantedMip++;
+				droppedMip = true;
+				if (wantedBytes <= m_BudgetBytes)
+					break;
+			}
+		}
+	}
+
+	void TextureStreamer::RequestMips(StreamedTexture &streamedTexture)
+	{
+		streamedTexture.LoadInFlight = true;
+		m_LoadsInFlight++;
+
+		// The whole chain is read back since it is a single entry in the derived data cache, only the wanted mips get uploaded
+		Texture *texture = streamedTexture.AssetTexture;
+		std::string path = streamedTexture.Path;
+		TextureSettings settings = streamedTexture.LoadSettings;
+		int firstMip = streamedTexture.WantedMip;
+		m_JobSystem.Submit([this, texture, path, settings, firstMip]()
+		{
+			TextureGenerationData genData = {};
+			MipLoadResult result;
+			result.AssetTexture = texture;
+			result.Data = TextureLoader::LoadTextureData(path, settings, genData);
+			result.CompressedFormat = genData.compressedFormat;
+			result.Width = genData.width;
+			result.Height = genData.height;
+			result.MipCount = genData.mipCount;
+			result.FirstMip = firstMip;
+			m_CompletedLoads.Push(result);
+		}, JobPriority::Low);
+	}
+
+	int TextureStreamer::GetWantedMip(const StreamedTexture &streamedTexture) const
+	{
+		if (streamedTexture.ScreenSize <= 0.0f)
+			return streamedTexture.TailMip;
+
+		// Aim for a texel per pixel
+		float texelCount = static_cast<float>(glm::max(streamedTexture.AssetTexture->GetWidth(), streamedTexture.AssetTexture->GetHeight()));
+		int mip = static_cast<int>(glm::floor(glm::log2(texelCount / streamedTexture.ScreenSize)));
+		return glm::clamp(mip, 0, streamedTexture.TailMip);
+	}
+
+	size_t TextureStreamer::GetSizeFromMip(const StreamedTexture &streamedTexture, int firstMip) const
+	{
+		Texture *texture = streamedTexture.AssetTexture;
+		return texture->GetCompressedMipOffset(texture->GetMipCount()) - texture->GetCompressedMipOffset(firstMip);
+	}
+
+	TextureStreamerStats TextureStreamer::GetStats() const
+	{
+		TextureStreamerStats stats;
+		stats.ResidentBytes = 0;
+		for (const StreamedTexture &streamedTexture : m_StreamedTextures)
+		{
+			stats.ResidentBytes += streamedTexture.AssetTexture->GetResidentMemorySize();
+		}
+		stats.WantedBytes = m_WantedBytes;
+		stats.BudgetBytes = m_BudgetBytes;
+		stats.StreamedTextureCount = static_cast<unsigned int>(m_StreamedTextures.size());
+		stats.LoadsInFlight = m_LoadsInFlight;
+		stats.MipsStreamedIn = m_MipsStreamedIn;
+		stats.MipsEvicted = m_MipsEvicted;
+		return stats;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#ifndef SINGLETON_H
+#include <Arcane/Util/Singleton.h>
+#endif
+
+#ifndef LOCKFREEQUEUE_H
+#include <Arcane/Core/Threads/LockFreeQueue.h>
+#endif
+
+#ifndef TEXTURE_H
+#include <Arcane/Graphics/Texture/Texture.h>
+#endif
+
+namespace Arcane
+{
+	class Scene;
+	class JobSystem;
+	struct TextureGenerationData;
+
+	struct StreamedTexture
+	{
+		Texture *AssetTexture;
+		std::string Path;
+		TextureSettings LoadSettings; // Settings the texture was loaded with, generating it overwrites the format so these are needed to find the same cooked data again
+		int TailMip; // Smallest mips (TEXTURE_STREAMING_MIN_RESIDENT_SIZE and under) are always resident
+		int WantedMip;
+		float ScreenSize; // Largest on-screen size in pixels of any mesh using the texture this frame, 0 if nothing referenced it
+		bool LoadInFlight;
+	};
+
+	struct TextureStreamerStats
+	{
+		u64 ResidentBytes;
+		u64 WantedBytes; // What the streamed textures would take at their wanted mips before the budget was applied
+		u64 BudgetBytes;
+		unsigned int StreamedTextureCount;
+		unsigned int LoadsInFlight;
+		u64 MipsStreamedIn;
+		u64 MipsEvicted;
+	};
+
+	// Streams the mips of async loaded compressed textures in and out based on how large the meshes using them are on screen. Textures are created with only their
+	// smallest mips resident, then every frame the wanted mip of each texture is worked out from the MeshComponents referencing it, and if that doesn't fit in the
+	// budget the textures that are smallest on screen give up mips first. Higher mips are re-read on the job system (the derived data cache keeps the cooked mips)
+	// and the texture is reallocated with them, evicting reallocates it without them so the memory actually goes back to the driver
+	class TextureStreamer : public Singleton
+	{
+	public:
+		TextureStreamer();
+		~TextureStreamer();
+
+		static TextureStreamer& GetInstance();
+
+		// Called by the asset manager right before an async loaded texture is generated. If the texture can be streamed it is registered and set up to only upload its tail mips
+		void OnTextureLoaded(const std::string &path, TextureGenerationData &inOutData);
+
+		// Main thread, once per frame
+		void Update(Scene *scene);
+
+		inline void SetBudget(u64 budgetBytes) { m_BudgetBytes = budgetBytes; }
+		inline u64 GetBudget() const { return m_BudgetBytes; }
+		inline const std::vector<StreamedTexture>& GetStreamedTextures() const { return m_StreamedTextures; }
+		TextureStreamerStats GetStats() const;
+	private:
+		struct MipLoadResult
+		{
+			Texture *AssetTexture;
+			unsigned char *Data; // Every mip of the texture tightly packed, freed with stbi_image_free
+			GLenum CompressedFormat;
+			int Width, Height;
+			int MipCount;
+			int FirstMip; // First mip the load was requested for
+		};
+
+		void ProcessCompletedLoads();
+		void GatherScreenSizes(Scene *scene);
+		void ChooseWantedMips();
+		void RequestMips(StreamedTexture &streamedTexture);
+
+		int GetWantedMip(const StreamedTexture &streamedTexture) const;
+		size_t GetSizeFromMip(const StreamedTexture &streamedTexture, int firstMip) const;
+	private:
+		JobSystem &m_JobSystem;
+		u64 m_BudgetBytes;
+
+		std::vector<StreamedTexture> m_StreamedTextures;
+		std::unordered_map<Texture*, size_t> m_StreamedTextureLookup;
+		std::vector<size_t> m_PriorityOrder; // Indices into m_StreamedTextures, re-sorted every frame by screen size
+
+		LockFreeQueue<MipLoadResult> m_CompletedLoads;
+		unsigned int m_LoadsInFlight = 0;
+
+		u64 m_WantedBytes = 0;
+		u64 m_MipsStreamedIn = 0, m_MipsEvicted = 0;
+	};
+}
+#endif
@@ -0,0 +1,71 @@
+#include "arcpch.h"
+#include "MemoryMappedFile.h"
+
+#include <Windows.h>
+
+namespace Arcane
+{
+	MemoryMappedFile::MemoryMappedFile() : m_Data(nullptr), m_Size(0), m_FileHandle(INVALID_HANDLE_VALUE), m_MappingHandle(nullptr)
+	{
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		Close();
+	}
+
+	bool MemoryMappedFile::Open(const std::string &filepath)
+	{
+		Close();
+
+		m_FileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_FileHandle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(m_FileHandle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_MappingHandle)
+		{
+			ARC_LOG_WARN("Failed to create a file mapping for: {0}", filepath);
+			Close();
+			return false;
+		}
+
+		m_Data = static_cast<const u8*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (!m_Data)
+		{
+			ARC_LOG_WARN("Failed to map a view of file: {0}", filepath);
+			Close();
+			return false;
+		}
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+		return true;
+	}
+
+	void MemoryMappedFile::Close()
+	{
+		if (m_Data)
+		{
+			UnmapViewOfFile(m_Data);
+			m_Data = nullptr;
+		}
+		if (m_MappingHandle)
+		{
+			CloseHandle(m_MappingHandle);
+			m_MappingHandle = nullptr;
+		}
+		if (m_FileHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_FileHandle);
+			m_FileHandle = INVALID_HANDLE_VALUE;
+		}
+		m_Size = 0;
+	}
+}
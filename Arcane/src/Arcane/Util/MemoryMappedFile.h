@@ -0,0 +1,31 @@
+#pragma once
+#ifndef MEMORYMAPPEDFILE_H
+#define MEMORYMAPPEDFILE_H
+
+namespace Arcane
+{
+	// Read-only view of a file that is mapped into the address space, pages are faulted in by the OS as they are touched so nothing is copied up front
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile();
+		~MemoryMappedFile();
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+		bool Open(const std::string &filepath);
+		void Close();
+
+		inline bool IsOpen() const { return m_Data != nullptr; }
+		inline const u8* GetData() const { return m_Data; }
+		inline size_t GetSize() const { return m_Size; }
+	private:
+		const u8 *m_Data;
+		size_t m_Size;
+
+		void *m_FileHandle;
+		void *m_MappingHandle;
+	};
+}
+#endif